@@ -0,0 +1,588 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// LogDecode.cpp
+// =============
+// Expands a binary log (log.bin of LOG_MODE_BINARY, see BinaryLog.h) to text,
+// and measures the deferred-formatting log against the text log.
+//
+// USAGE:
+//     LogDecode log.bin [log.txt]         expand to log.txt or to the console
+//     LogDecode -bench [count]            caller ns/call and bytes written of
+//                                         Win::log()-style text messages and
+//                                         LOG_DEFERRED()-style binary messages
+//     LogDecode -ratebench [seconds]      cost of disabled levels, and the
+//                                         messages written by a flooding call
+//                                         site against its rate limit
+//     LogDecode -convbench [count]        ns per call of toWchar()/toChar() of
+//                                         wcharUtil against the string stream
+//                                         and shared ring they replaced; the
+//                                         output must be the one of snprintf()
+//                                         and swprintf()
+//     LogDecode -convstress [count]       threads convert at once, each result
+//                                         must stay its own for WCHAR_MAX_COUNT
+//                                         calls (run it under ThreadSanitizer)
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../oglMRDemo/Common/LogQueue.h"
+#include "../oglMRDemo/Common/BinaryLog.h"
+#include "../oglMRDemo/Common/wcharUtil.h"
+
+// LOG_DEBUG() and LOG_TRACE() are compiled out here, the others go to benchQueue
+static LogQueue* benchQueue = 0;
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#define LOG_EMIT(formatId, ...) putLogBinary(*benchQueue, formatId, ##__VA_ARGS__)
+#include "../oglMRDemo/Common/LogLevel.h"
+
+const int DEFAULT_BENCH_COUNT = 100000;
+const int BENCH_FLUSH_INTERVAL = 32;    // messages between flushes, so the rings never drop
+const int TIME_LENGTH = 16;
+const char* BENCH_TEXT_FILE = "bench_log.txt";
+const char* BENCH_BINARY_FILE = "bench_log.bin";
+const int DEFAULT_RATE_SECONDS = 2;
+const int RATE_THREADS = 4;
+const int LEVEL_LOOP_COUNT = 10000000;
+const int DEFAULT_CONVERSION_COUNT = 1000000;
+const int CONVERSION_THREADS = 4;
+const char* CONVERSION_PATH = "C:\\Users\\someone\\log\\output_file.txt";
+const wchar_t* CONVERSION_WIDE_PATH = L"C:\\Users\\someone\\log\\output_file.txt";
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the sink of Log in file mode: time and text per line, one write per batch
+///////////////////////////////////////////////////////////////////////////////
+class TextFileSink : public LogSink
+{
+public:
+    TextFileSink(const char* fileName) : file(fopen(fileName, "wb")), bytes(0) {}
+    ~TextFileSink()                                 { if(file) fclose(file); }
+
+    void write(int64_t time, int /*thread*/, const wchar_t* text, size_t length)
+    {
+        int seconds = (int)((time / 1000000000) % (24 * 60 * 60));
+        wchar_t stamp[TIME_LENGTH];
+        int stampLength = swprintf(stamp, TIME_LENGTH, L"%d:%02d:%02d", seconds / 3600, seconds / 60 % 60, seconds % 60);
+        batch.append(stamp, stampLength > 0 ? stampLength : 0);
+        batch += L"  ";
+        batch.append(text, length);
+        batch += L'\n';
+
+        texts.push_back(std::string());
+        appendUtf8(texts.back(), text, length);
+    }
+
+    void endBatch()
+    {
+        utf8.clear();
+        appendUtf8(utf8, batch.data(), batch.size());
+        if(file)
+        {
+            fwrite(utf8.data(), 1, utf8.size(), file);
+            fflush(file);
+        }
+        bytes += utf8.size();
+        batch.clear();
+    }
+
+    FILE* file;
+    std::wstring batch;
+    std::string utf8;
+    int64_t bytes;
+    std::vector<std::string> texts;                 // messages, to compare with the decoded ones
+};
+
+// the sink of Log in LOG_MODE_BINARY
+class BinaryFileSink : public LogSink
+{
+public:
+    BinaryFileSink(const char* fileName)            { writer.open(fileName, LogQueue::now(), 0); }
+
+    void write(int64_t time, int thread, const wchar_t* text, size_t length)   { writer.writeText(time, thread, text, length); }
+    void writeBinary(int64_t time, int thread, const void* data, size_t bytes) { writer.writeMessage(time, thread, data, bytes); }
+    void endBatch()                                                            { writer.flush(); }
+
+    BinaryLogWriter writer;
+};
+
+// what Win::log(const char*, ...) does on the caller thread
+static void logText(LogQueue& queue, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    queue.vput(format, args);
+    va_end(args);
+}
+
+static void printTimes(const char* name, std::vector<int64_t>& times, int64_t bytes, int count)
+{
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for(size_t i = 0; i < times.size(); ++i)
+        sum += (double)times[i];
+    printf("%-8s mean %6.1f ns, p50 %5lld ns, p99 %6lld ns | %9lld bytes, %5.1f bytes/message\n", name,
+           sum / times.size(), (long long)times[times.size() / 2], (long long)times[times.size() * 99 / 100],
+           (long long)bytes, (double)bytes / count);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// same messages through both paths, then decode the binary file and compare
+///////////////////////////////////////////////////////////////////////////////
+static int bench(int count)
+{
+    static const char* modes[] = { "vsync", "fixed", "uncapped" };
+    const char* format = "Frame %d (%s): avg %.2f ms, max %.2f ms, cpu %.2f ms, missed %d/%d";
+    std::vector<int64_t> times(count);
+
+    TextFileSink textSink(BENCH_TEXT_FILE);
+    {
+        LogQueue queue(&textSink);
+        queue.start();
+        for(int i = 0; i < count; ++i)
+        {
+            int64_t start = LogQueue::now();
+            logText(queue, format, i, modes[i % 3], 16.6 + (i % 7) * 0.01, 18.0 + (i % 5) * 0.1, 3.1 + (i % 3) * 0.2, i % 4, 600);
+            times[i] = LogQueue::now() - start;
+            if(i % BENCH_FLUSH_INTERVAL == BENCH_FLUSH_INTERVAL - 1)
+                queue.flush();
+        }
+        queue.stop();
+        if(queue.getDroppedCount())
+            printf("text: %lld messages dropped\n", (long long)queue.getDroppedCount());
+    }
+    printTimes("text", times, textSink.bytes, count);
+
+    int64_t binaryBytes = 0;
+    {
+        BinaryFileSink binarySink(BENCH_BINARY_FILE);
+        LogQueue queue(&binarySink);
+        queue.start();
+        static const int id = registerLogFormat(format, __FILE__, __LINE__);
+        for(int i = 0; i < count; ++i)
+        {
+            int64_t start = LogQueue::now();
+            putLogBinary(queue, id, i, modes[i % 3], 16.6 + (i % 7) * 0.01, 18.0 + (i % 5) * 0.1, 3.1 + (i % 3) * 0.2, i % 4, 600);
+            times[i] = LogQueue::now() - start;
+            if(i % BENCH_FLUSH_INTERVAL == BENCH_FLUSH_INTERVAL - 1)
+                queue.flush();
+        }
+        queue.stop();
+        if(queue.getDroppedCount())
+            printf("binary: %lld messages dropped\n", (long long)queue.getDroppedCount());
+        binarySink.writer.close();
+        binaryBytes = binarySink.writer.getBytesWritten();
+    }
+    printTimes("binary", times, binaryBytes, count);
+
+    // the decoded text must be the text of the text path
+    BinaryLogReader reader;
+    if(!reader.open(BENCH_BINARY_FILE))
+    {
+        printf("cannot read %s\n", BENCH_BINARY_FILE);
+        return 1;
+    }
+    std::string line;
+    int decoded = 0;
+    int mismatches = 0;
+    while(reader.readLine(line))
+    {
+        size_t text = line.find("] ");
+        text = text == std::string::npos ? 0 : text + 2;
+        if(decoded >= (int)textSink.texts.size() || line.compare(text, std::string::npos, textSink.texts[decoded]) != 0)
+        {
+            if(mismatches++ == 0)
+                printf("first mismatch at %d: \"%s\"\n", decoded, line.c_str() + text);
+        }
+        ++decoded;
+    }
+    printf("decoded %d of %d messages, %d mismatches\n", decoded, (int)textSink.texts.size(), mismatches);
+    return mismatches == 0 && decoded == (int)textSink.texts.size() ? 0 : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// counts the messages of the rate bench and the suppressed counts logged
+///////////////////////////////////////////////////////////////////////////////
+class CountingSink : public LogSink
+{
+public:
+    CountingSink() : messages(0), summaries(0), suppressed(0) {}
+
+    void write(int64_t /*time*/, int /*thread*/, const wchar_t* /*text*/, size_t /*length*/) {}
+    void writeBinary(int64_t /*time*/, int /*thread*/, const void* data, size_t bytes)
+    {
+        // id, then the count of a suppressed-count message: tag and uint32
+        uint32_t id = 0;
+        memcpy(&id, data, sizeof(id));
+        if((int)id == getLogSuppressedFormat() && bytes >= sizeof(id) + 1 + sizeof(uint32_t))
+        {
+            uint32_t count;
+            memcpy(&count, (const char*)data + sizeof(id) + 1, sizeof(count));
+            ++summaries;
+            suppressed += count;
+        }
+        else
+        {
+            ++messages;
+        }
+    }
+
+    int64_t messages;
+    int64_t summaries;
+    int64_t suppressed;
+};
+
+static int evaluated = 0;
+static int countEvaluation()
+{
+    return ++evaluated;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// disabled levels cost nothing, a flooding call site is bounded by its rate
+///////////////////////////////////////////////////////////////////////////////
+static int rateBench(int seconds)
+{
+    CountingSink sink;
+    LogQueue queue(&sink);
+    benchQueue = &queue;
+    queue.start();
+
+    // compiled out: no code, the arguments are not evaluated
+    volatile int value = 0;
+    int64_t start = LogQueue::now();
+    for(int i = 0; i < LEVEL_LOOP_COUNT; ++i)
+        value = i;
+    double emptyTime = (double)(LogQueue::now() - start) / LEVEL_LOOP_COUNT;
+    start = LogQueue::now();
+    for(int i = 0; i < LEVEL_LOOP_COUNT; ++i)
+    {
+        value = i;
+        LOG_DEBUG(RENDER, "never %d", countEvaluation());
+    }
+    double compiledOutTime = (double)(LogQueue::now() - start) / LEVEL_LOOP_COUNT;
+    printf("compiled out (LOG_DEBUG): %.2f ns/call, empty loop %.2f ns/call, arguments evaluated %d times\n",
+           compiledOutTime, emptyTime, evaluated);
+
+    // disabled at run time: one load and a branch
+    setLogCategoryLevel(LOG_CATEGORY_RENDER, LOG_LEVEL_ERROR);
+    start = LogQueue::now();
+    for(int i = 0; i < LEVEL_LOOP_COUNT; ++i)
+    {
+        value = i;
+        LOG_INFO(RENDER, "filtered %d", countEvaluation());
+    }
+    printf("filtered at run time (LOG_INFO, RENDER at ERROR): %.2f ns/call, arguments evaluated %d times\n",
+           (double)(LogQueue::now() - start) / LEVEL_LOOP_COUNT, evaluated);
+    if(value != LEVEL_LOOP_COUNT - 1)
+        return 1;                                   // the loops ran
+    setLogCategoryLevel(LOG_CATEGORY_RENDER, LOG_LEVEL_TRACE);
+
+    // one call site flooded by several threads for seconds
+    const double rate = 10;
+    const int burst = 20;
+    setLogRateLimit(LOG_CATEGORY_TRACKING, rate, burst);
+    std::atomic<int64_t> calls(0);
+    int64_t end = LogQueue::now() + (int64_t)seconds * 1000000000;
+    std::vector<std::thread> threads;
+    start = LogQueue::now();
+    for(int t = 0; t < RATE_THREADS; ++t)
+    {
+        threads.push_back(std::thread([&calls, end, t]()
+        {
+            int64_t count = 0;
+            while(LogQueue::now() < end)
+            {
+                LOG_INFO(TRACKING, "flood from thread %d, call %lld", t, (long long)count);
+                ++count;
+            }
+            calls += count;
+        }));
+    }
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    double elapsed = (double)(LogQueue::now() - start) / 1e9;
+    queue.stop();
+    benchQueue = 0;
+
+    int64_t bound = burst + (int64_t)(rate * elapsed) + 1;
+    printf("flood: %lld calls from %d threads in %.2f s, %lld messages written (bound %lld), "
+           "%lld suppressed-count messages reporting %lld\n",
+           (long long)calls.load(), RATE_THREADS, elapsed, (long long)sink.messages, (long long)bound,
+           (long long)sink.summaries, (long long)sink.suppressed);
+
+    bool passed = evaluated == 0 && sink.messages <= bound && sink.messages + sink.suppressed <= calls.load();
+    printf("%s\n", passed ? "passed" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the conversions as wcharUtil did them before, for the timing only: a string
+// stream (or the C locale) per call, copied into a ring of buffers whose index
+// all threads share, so they are NOT thread-safe
+///////////////////////////////////////////////////////////////////////////////
+static wchar_t oldWideRing[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];
+static char oldRing[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];
+static int oldWideIndex = 0;
+static int oldIndex = 0;
+
+template<typename T>
+static const wchar_t* oldToWchar(T number, int precision = -1)
+{
+    oldWideIndex = (oldWideIndex + 1) % WCHAR_MAX_COUNT;
+    std::wstringstream wss;
+    if(precision >= 0)
+        wss << std::fixed << std::setprecision(precision);
+    wss << number;
+    wcsncpy(oldWideRing[oldWideIndex], wss.str().c_str(), WCHAR_MAX_LENGTH - 1);
+    return oldWideRing[oldWideIndex];
+}
+
+template<typename T>
+static const char* oldToChar(T number, int precision = -1)
+{
+    oldIndex = (oldIndex + 1) % WCHAR_MAX_COUNT;
+    std::stringstream ss;
+    if(precision >= 0)
+        ss << std::fixed << std::setprecision(precision);
+    ss << number;
+    strncpy(oldRing[oldIndex], ss.str().c_str(), WCHAR_MAX_LENGTH - 1);
+    return oldRing[oldIndex];
+}
+
+static const wchar_t* oldToWchar(const char* str)
+{
+    oldWideIndex = (oldWideIndex + 1) % WCHAR_MAX_COUNT;
+    mbstowcs(oldWideRing[oldWideIndex], str, WCHAR_MAX_LENGTH - 1);
+    return oldWideRing[oldWideIndex];
+}
+
+static const char* oldToChar(const wchar_t* str)
+{
+    oldIndex = (oldIndex + 1) % WCHAR_MAX_COUNT;
+    wcstombs(oldRing[oldIndex], str, WCHAR_MAX_LENGTH - 1);
+    return oldRing[oldIndex];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ns per call of a conversion, the 1st character is read so it is not optimized out
+///////////////////////////////////////////////////////////////////////////////
+template<typename Convert>
+static double timeConversion(int count, Convert convert)
+{
+    volatile int sum = 0;
+    int64_t start = LogQueue::now();
+    for(int i = 0; i < count; ++i)
+        sum = sum + (int)convert(i)[0];
+    return (double)(LogQueue::now() - start) / count;
+}
+
+static void printConversion(const char* name, double oldTime, double newTime)
+{
+    printf("%-28s %9.1f %9.1f %8.1fx\n", name, oldTime, newTime, oldTime / newTime);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the thread-safe conversions must give the text of printf ("%ld", "%g" by
+// default, "%.*f" with a precision, like the string streams before), faster
+// than the old ones
+///////////////////////////////////////////////////////////////////////////////
+static int convBench(int count)
+{
+    static const long integers[] = { 0, 1, -1, 10, -180, 180, 2147483647L, -2147483647L - 1 };
+    static const double numbers[] = { 0.0, -0.0, 1.0, 0.1, 3.14159265358979, -2.5, 1e6, 1234567.0, 1e-5,
+                                      123456.0, 1e300, -1e-300, 0.0049, -0.001, 0.125, 2.675 };
+    char expected[WCHAR_MAX_LENGTH];
+    wchar_t expectedWide[WCHAR_MAX_LENGTH];
+    int compared = 0, mismatches = 0;
+    for(size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); ++i)
+    {
+        snprintf(expected, WCHAR_MAX_LENGTH, "%ld", integers[i]);
+        swprintf(expectedWide, WCHAR_MAX_LENGTH, L"%ld", integers[i]);
+        mismatches += wcscmp(toWchar(integers[i]), expectedWide) != 0;
+        mismatches += strcmp(toChar(integers[i]), expected) != 0;
+        compared += 2;
+    }
+    for(size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i)
+    {
+        for(int precision = -1; precision <= 4; ++precision)
+        {
+            char expectedFloat[WCHAR_MAX_LENGTH];
+            float number = (float)numbers[i];
+            if(precision < 0)
+            {
+                snprintf(expected, WCHAR_MAX_LENGTH, "%g", numbers[i]);
+                swprintf(expectedWide, WCHAR_MAX_LENGTH, L"%g", numbers[i]);
+                snprintf(expectedFloat, WCHAR_MAX_LENGTH, "%g", number);
+            }
+            else
+            {
+                snprintf(expected, WCHAR_MAX_LENGTH, "%.*f", precision, numbers[i]);
+                swprintf(expectedWide, WCHAR_MAX_LENGTH, L"%.*f", precision, numbers[i]);
+                snprintf(expectedFloat, WCHAR_MAX_LENGTH, "%.*f", precision, number);
+            }
+            if(wcscmp(toWchar(numbers[i], precision), expectedWide) != 0 ||
+               strcmp(toChar(numbers[i], precision), expected) != 0 ||
+               strcmp(toChar(number, precision), expectedFloat) != 0)
+            {
+                if(mismatches++ == 0)
+                    printf("first mismatch: %s (expected %s) of %g, precision %d\n",
+                           toChar(numbers[i], precision), expected, numbers[i], precision);
+            }
+            compared += 3;
+        }
+    }
+    mismatches += wcscmp(toWchar(CONVERSION_PATH), CONVERSION_WIDE_PATH) != 0;
+    mismatches += strcmp(toChar(CONVERSION_WIDE_PATH), CONVERSION_PATH) != 0;
+    compared += 2;
+    printf("%d conversions compared, %d mismatches\n\n", compared, mismatches);
+
+    printf("%-28s %9s %9s %9s\n", "ns/call", "old", "new", "speedup");
+    printConversion("toWchar(int)", timeConversion(count, [](int i) { return oldToWchar(i - 1000); }),
+                                    timeConversion(count, [](int i) { return toWchar(i - 1000); }));
+    printConversion("toWchar(float, 2)", timeConversion(count, [](int i) { return oldToWchar(i * 0.013f - 7, 2); }),
+                                         timeConversion(count, [](int i) { return toWchar(i * 0.013f - 7, 2); }));
+    printConversion("toChar(double)", timeConversion(count, [](int i) { return oldToChar(i * 0.37); }),
+                                      timeConversion(count, [](int i) { return toChar(i * 0.37); }));
+    printConversion("toWchar(const char*)", timeConversion(count, [](int) { return oldToWchar(CONVERSION_PATH); }),
+                                            timeConversion(count, [](int) { return toWchar(CONVERSION_PATH); }));
+    printConversion("toChar(const wchar_t*)", timeConversion(count, [](int) { return oldToChar(CONVERSION_WIDE_PATH); }),
+                                              timeConversion(count, [](int) { return toChar(CONVERSION_WIDE_PATH); }));
+    return mismatches == 0 ? 0 : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// each thread keeps its last WCHAR_MAX_COUNT results of toWchar() and toChar()
+// and checks they are still its own numbers, while the other threads convert
+// theirs; the UTF-8 round trip of the buffers of the caller too
+///////////////////////////////////////////////////////////////////////////////
+static int convStress(int count)
+{
+    std::atomic<int> wrong(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < CONVERSION_THREADS; ++t)
+    {
+        threads.push_back(std::thread([&wrong, t, count]()
+        {
+            const wchar_t* wideResults[WCHAR_MAX_COUNT] = {};
+            const char* results[WCHAR_MAX_COUNT] = {};
+            wchar_t expectedWide[NUMBER_MAX_LENGTH];
+            char expected[NUMBER_MAX_LENGTH];
+            wchar_t wide[64];
+            char utf8[64];
+            char text[64];
+            for(int i = 0; i < count; ++i)
+            {
+                int slot = i % WCHAR_MAX_COUNT;
+                int number = t * count + i;
+                wideResults[slot] = toWchar(number);
+                results[slot] = toChar(number);
+
+                // the oldest of the ring is still valid, it is reused by the next call
+                int oldest = (i + 1) % WCHAR_MAX_COUNT;
+                if(i >= WCHAR_MAX_COUNT - 1)
+                {
+                    int previous = number - (WCHAR_MAX_COUNT - 1);
+                    swprintf(expectedWide, NUMBER_MAX_LENGTH, L"%d", previous);
+                    snprintf(expected, NUMBER_MAX_LENGTH, "%d", previous);
+                    if(wcscmp(wideResults[oldest], expectedWide) != 0 || strcmp(results[oldest], expected) != 0)
+                        ++wrong;
+                }
+
+                snprintf(text, sizeof(text), "thread %d \xe2\x82\xac %d", t, i);
+                utf8ToWide(wide, 64, text);
+                wideToUtf8(utf8, 64, wide);
+                if(strcmp(utf8, text) != 0)
+                    ++wrong;
+            }
+        }));
+    }
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    printf("%d threads x %d conversions, %d wrong results\n", CONVERSION_THREADS, count, wrong.load());
+    return wrong.load() == 0 ? 0 : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// expand a binary log to text
+///////////////////////////////////////////////////////////////////////////////
+static int decode(const char* inputName, const char* outputName)
+{
+    BinaryLogReader reader;
+    if(!reader.open(inputName))
+    {
+        fprintf(stderr, "%s is not a binary log\n", inputName);
+        return 1;
+    }
+
+    FILE* output = outputName ? fopen(outputName, "wb") : stdout;
+    if(!output)
+    {
+        fprintf(stderr, "cannot create %s\n", outputName);
+        return 1;
+    }
+
+    std::string line;
+    while(reader.readLine(line))
+    {
+        fwrite(line.data(), 1, line.size(), output);
+        fputc('\n', output);
+    }
+    if(output != stdout)
+        fclose(output);
+
+    fprintf(stderr, "%lld messages, %d formats\n", (long long)reader.getMessageCount(), reader.getFormatCount());
+    return 0;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    if(argc >= 2 && strcmp(argv[1], "-bench") == 0)
+        return bench(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_BENCH_COUNT);
+    if(argc >= 2 && strcmp(argv[1], "-ratebench") == 0)
+        return rateBench(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_RATE_SECONDS);
+    if(argc >= 2 && strcmp(argv[1], "-convbench") == 0)
+        return convBench(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_CONVERSION_COUNT);
+    if(argc >= 2 && strcmp(argv[1], "-convstress") == 0)
+        return convStress(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_CONVERSION_COUNT);
+    if(argc >= 2)
+        return decode(argv[1], argc >= 3 ? argv[2] : 0);
+
+    fprintf(stderr, "usage: LogDecode log.bin [log.txt]\n"
+                    "       LogDecode -bench [count]\n"
+                    "       LogDecode -ratebench [seconds]\n"
+                    "       LogDecode -convbench [count]\n"
+                    "       LogDecode -convstress [count]\n");
+    return 1;
+}
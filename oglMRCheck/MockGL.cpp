@@ -0,0 +1,383 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MockGL.cpp
+// ==========
+// OpenGL entry points without a driver, see MockGL.h
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#pragma warning(disable: 4273)          // GL 1.1 functions are declared as imports of opengl32.dll
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES
+#include "../oglMRDemo/GL/glext.h"
+
+#include <cstring>
+#include <map>
+#include "MockGL.h"
+
+// GL_CLIP_DISTANCE0 is GL 3.0, older gl.h/glext.h pairs do not have it
+#ifndef GL_CLIP_DISTANCE0
+#define GL_CLIP_DISTANCE0 0x3000
+#endif
+
+// the extensions ModelGL, StrokeRenderer and glExtension look for
+// NOTE: glExtension takes a name at each space, so the string ends with one
+static const char* MOCK_EXTENSIONS = "GL_ARB_shader_objects GL_ARB_vertex_shader GL_ARB_fragment_shader "
+                                     "GL_ARB_vertex_buffer_object GL_ARB_draw_instanced "
+                                     "GL_ARB_uniform_buffer_object ";
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// state GL would have and the counters
+///////////////////////////////////////////////////////////////////////////////
+namespace
+{
+struct MockState
+{
+    std::map<GLenum, bool> caps;
+    GLenum depthFunc;
+    GLfloat lineWidth;
+    GLfloat pointSize;
+    GLenum blendSrc;
+    GLenum blendDst;
+    GLenum polygonMode;
+    GLuint program;
+    GLfloat clearColor[4];
+    GLint viewport[4];
+    GLint scissor[4];
+
+    GLuint nextName;                    // shaders, programs, buffers and lists
+    int stateCalls;
+    int redundantCalls;
+    int drawCalls;
+    long long uploadBytes;
+    long long largestUpload;
+};
+
+MockState mock;
+
+// count a state call, same is true if it does not change the state
+void countState(bool same)
+{
+    ++mock.stateCalls;
+    if(same)
+        ++mock.redundantCalls;
+}
+
+void setCap(GLenum cap, bool on)
+{
+    // GL_DITHER and GL_MULTISAMPLE are on by default, nothing here uses them
+    std::map<GLenum, bool>::iterator iter = mock.caps.find(cap);
+    bool current = iter != mock.caps.end() ? iter->second : false;
+    countState(current == on);
+    mock.caps[cap] = on;
+}
+
+void countUpload(long long bytes)
+{
+    mock.uploadBytes += bytes;
+    if(bytes > mock.largestUpload)
+        mock.largestUpload = bytes;
+}
+
+void setRect(GLint* rect, GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    countState(rect[0] == x && rect[1] == y && rect[2] == w && rect[3] == h);
+    rect[0] = x;
+    rect[1] = y;
+    rect[2] = w;
+    rect[3] = h;
+}
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// control and counters
+///////////////////////////////////////////////////////////////////////////////
+namespace mockgl {
+
+void reset()
+{
+    mock.caps.clear();
+    mock.depthFunc = GL_LESS;
+    mock.lineWidth = 1;
+    mock.pointSize = 1;
+    mock.blendSrc = GL_ONE;
+    mock.blendDst = GL_ZERO;
+    mock.polygonMode = GL_FILL;
+    mock.program = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        mock.clearColor[i] = 0;
+        mock.viewport[i] = mock.scissor[i] = -1;    // the size of the window, unknown here
+    }
+    mock.nextName = 1;
+    clearCounters();
+}
+
+void clearCounters()
+{
+    mock.stateCalls = mock.redundantCalls = mock.drawCalls = 0;
+    mock.uploadBytes = mock.largestUpload = 0;
+}
+
+int getStateCalls()         { return mock.stateCalls; }
+int getRedundantCalls()     { return mock.redundantCalls; }
+int getDrawCalls()          { return mock.drawCalls; }
+long long getUploadBytes()  { return mock.uploadBytes; }
+long long getLargestUpload() { return mock.largestUpload; }
+
+} // namespace mockgl
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GL 1.1, the states shadowed by glStateCache are tracked
+///////////////////////////////////////////////////////////////////////////////
+extern "C" {
+
+void APIENTRY glEnable(GLenum cap)                              { setCap(cap, true); }
+void APIENTRY glDisable(GLenum cap)                             { setCap(cap, false); }
+
+void APIENTRY glDepthFunc(GLenum func)
+{
+    countState(mock.depthFunc == func);
+    mock.depthFunc = func;
+}
+
+void APIENTRY glLineWidth(GLfloat width)
+{
+    countState(mock.lineWidth == width);
+    mock.lineWidth = width;
+}
+
+void APIENTRY glPointSize(GLfloat size)
+{
+    countState(mock.pointSize == size);
+    mock.pointSize = size;
+}
+
+void APIENTRY glBlendFunc(GLenum src, GLenum dst)
+{
+    countState(mock.blendSrc == src && mock.blendDst == dst);
+    mock.blendSrc = src;
+    mock.blendDst = dst;
+}
+
+void APIENTRY glPolygonMode(GLenum, GLenum mode)
+{
+    countState(mock.polygonMode == mode);
+    mock.polygonMode = mode;
+}
+
+void APIENTRY glClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    countState(mock.clearColor[0] == r && mock.clearColor[1] == g && mock.clearColor[2] == b && mock.clearColor[3] == a);
+    mock.clearColor[0] = r;
+    mock.clearColor[1] = g;
+    mock.clearColor[2] = b;
+    mock.clearColor[3] = a;
+}
+
+void APIENTRY glViewport(GLint x, GLint y, GLsizei w, GLsizei h) { setRect(mock.viewport, x, y, w, h); }
+void APIENTRY glScissor(GLint x, GLint y, GLsizei w, GLsizei h)  { setRect(mock.scissor, x, y, w, h); }
+
+void APIENTRY glBegin(GLenum)                                   { ++mock.drawCalls; }
+void APIENTRY glDrawArrays(GLenum, GLint, GLsizei)              { ++mock.drawCalls; }
+void APIENTRY glDrawElements(GLenum, GLsizei, GLenum, const GLvoid*) { ++mock.drawCalls; }
+
+GLuint APIENTRY glGenLists(GLsizei range)
+{
+    GLuint name = mock.nextName;
+    mock.nextName += range;
+    return name;
+}
+
+const GLubyte* APIENTRY glGetString(GLenum name)
+{
+    switch(name)
+    {
+    case GL_VENDOR:     return (const GLubyte*)"oglMRCheck";
+    case GL_RENDERER:   return (const GLubyte*)"MockGL";
+    case GL_VERSION:    return (const GLubyte*)"3.0 MockGL";
+    case GL_EXTENSIONS: return (const GLubyte*)MOCK_EXTENSIONS;
+    }
+    return 0;
+}
+
+void APIENTRY glReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels)
+{
+    int size = (format == GL_RGBA ? 4 : 1) * (type == GL_FLOAT ? 4 : 1);
+    memset(pixels, 0, (size_t)width * height * size);
+}
+
+// no effect on the counted states
+void APIENTRY glClear(GLbitfield)                               {}
+void APIENTRY glClearDepth(GLclampd)                            {}
+void APIENTRY glClearStencil(GLint)                             {}
+void APIENTRY glColor3f(GLfloat, GLfloat, GLfloat)              {}
+void APIENTRY glColor3fv(const GLfloat*)                        {}
+void APIENTRY glColor4fv(const GLfloat*)                        {}
+void APIENTRY glColorMaterial(GLenum, GLenum)                   {}
+void APIENTRY glColorPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+void APIENTRY glDisableClientState(GLenum)                      {}
+void APIENTRY glDrawPixels(GLsizei, GLsizei, GLenum, GLenum, const GLvoid*) {}
+void APIENTRY glEnableClientState(GLenum)                       {}
+void APIENTRY glEnd()                                           {}
+void APIENTRY glEndList()                                       {}
+void APIENTRY glHint(GLenum, GLenum)                            {}
+void APIENTRY glLightfv(GLenum, GLenum, const GLfloat*)         {}
+void APIENTRY glLoadIdentity()                                  {}
+void APIENTRY glLoadMatrixf(const GLfloat*)                     {}
+void APIENTRY glMaterialf(GLenum, GLenum, GLfloat)              {}
+void APIENTRY glMaterialfv(GLenum, GLenum, const GLfloat*)      {}
+void APIENTRY glMatrixMode(GLenum)                              {}
+void APIENTRY glNewList(GLuint, GLenum)                         {}
+void APIENTRY glNormalPointer(GLenum, GLsizei, const GLvoid*)   {}
+void APIENTRY glPixelStorei(GLenum, GLint)                      {}
+void APIENTRY glPopMatrix()                                     {}
+void APIENTRY glPushMatrix()                                    {}
+void APIENTRY glRasterPos2f(GLfloat, GLfloat)                   {}
+void APIENTRY glShadeModel(GLenum)                              {}
+void APIENTRY glVertex3f(GLfloat, GLfloat, GLfloat)             {}
+void APIENTRY glVertex3fv(const GLfloat*)                       {}
+void APIENTRY glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// extensions, function pointers of glExtension on Windows
+///////////////////////////////////////////////////////////////////////////////
+void APIENTRY glUseProgram(GLuint program)
+{
+    countState(mock.program == program);
+    mock.program = program;
+}
+
+void APIENTRY glDrawArraysInstancedARB(GLenum, GLint, GLsizei, GLsizei) { ++mock.drawCalls; }
+void APIENTRY glDrawElementsInstancedARB(GLenum, GLsizei, GLenum, const void*, GLsizei) { ++mock.drawCalls; }
+
+GLuint APIENTRY glCreateShader(GLenum)                          { return mock.nextName++; }
+GLuint APIENTRY glCreateProgram()                               { return mock.nextName++; }
+
+void APIENTRY glGenBuffersARB(GLsizei n, GLuint* buffers)
+{
+    for(GLsizei i = 0; i < n; ++i)
+        buffers[i] = mock.nextName++;
+}
+
+// every shader compiles and every program links, without a log
+void APIENTRY glGetShaderiv(GLuint, GLenum pname, GLint* params)
+{
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+void APIENTRY glGetProgramiv(GLuint, GLenum pname, GLint* params)
+{
+    *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+
+// buffer data given to GL, storage allocated without data is not counted
+void APIENTRY glBufferDataARB(GLenum, GLsizeiptrARB size, const void* data, GLenum)
+{
+    if(data)
+        countUpload(size);
+}
+
+void APIENTRY glBufferSubDataARB(GLenum, GLintptrARB, GLsizeiptrARB size, const void*)
+{
+    countUpload(size);
+}
+
+void APIENTRY glGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if(length)
+        *length = 0;
+    if(bufSize > 0)
+        infoLog[0] = 0;
+}
+
+void APIENTRY glGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    if(length)
+        *length = 0;
+    if(bufSize > 0)
+        infoLog[0] = 0;
+}
+
+GLuint APIENTRY glGetUniformBlockIndex(GLuint, const GLchar*)  { return 0; }
+
+void APIENTRY glAttachShader(GLuint, GLuint)                    {}
+void APIENTRY glBindBufferARB(GLenum, GLuint)                   {}
+void APIENTRY glBindBufferBase(GLenum, GLuint, GLuint)          {}
+void APIENTRY glCompileShader(GLuint)                           {}
+void APIENTRY glDeleteBuffersARB(GLsizei, const GLuint*)        {}
+void APIENTRY glLinkProgram(GLuint)                             {}
+void APIENTRY glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+void APIENTRY glUniformBlockBinding(GLuint, GLuint, GLuint)     {}
+
+} // extern "C"
+
+
+
+#ifdef _WIN32
+///////////////////////////////////////////////////////////////////////////////
+// WGL used by glExtension, the extension functions above by name
+///////////////////////////////////////////////////////////////////////////////
+struct MockProc
+{
+    const char* name;
+    PROC proc;
+};
+
+static const MockProc MOCK_PROCS[] = {
+    { "glUseProgram",               (PROC)glUseProgram },
+    { "glDrawArraysInstancedARB",   (PROC)glDrawArraysInstancedARB },
+    { "glDrawElementsInstancedARB", (PROC)glDrawElementsInstancedARB },
+    { "glCreateShader",             (PROC)glCreateShader },
+    { "glCreateProgram",            (PROC)glCreateProgram },
+    { "glGenBuffersARB",            (PROC)glGenBuffersARB },
+    { "glGetShaderiv",              (PROC)glGetShaderiv },
+    { "glGetProgramiv",             (PROC)glGetProgramiv },
+    { "glGetShaderInfoLog",         (PROC)glGetShaderInfoLog },
+    { "glGetProgramInfoLog",        (PROC)glGetProgramInfoLog },
+    { "glGetUniformBlockIndex",     (PROC)glGetUniformBlockIndex },
+    { "glAttachShader",             (PROC)glAttachShader },
+    { "glBindBufferARB",            (PROC)glBindBufferARB },
+    { "glBindBufferBase",           (PROC)glBindBufferBase },
+    { "glBufferDataARB",            (PROC)glBufferDataARB },
+    { "glBufferSubDataARB",         (PROC)glBufferSubDataARB },
+    { "glCompileShader",            (PROC)glCompileShader },
+    { "glDeleteBuffersARB",         (PROC)glDeleteBuffersARB },
+    { "glLinkProgram",              (PROC)glLinkProgram },
+    { "glShaderSource",             (PROC)glShaderSource },
+    { "glUniformBlockBinding",      (PROC)glUniformBlockBinding },
+};
+
+PROC WINAPI wglGetProcAddress(LPCSTR name)
+{
+    for(size_t i = 0; i < sizeof(MOCK_PROCS) / sizeof(MOCK_PROCS[0]); ++i)
+    {
+        if(strcmp(MOCK_PROCS[i].name, name) == 0)
+            return MOCK_PROCS[i].proc;
+    }
+    return 0;                                       // glExtension leaves the pointer null
+}
+
+HDC WINAPI wglGetCurrentDC()
+{
+    return 0;                                       // no WGL extensions
+}
+#endif
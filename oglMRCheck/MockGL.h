@@ -0,0 +1,34 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MockGL.h
+// ========
+// OpenGL entry points without a driver, for checks of ModelGL in a console.
+// MockGL.cpp defines the GL functions used by ModelGL and its helpers, and on
+// Windows wglGetProcAddress() for the extension pointers of glExtension. Link
+// it instead of opengl32.lib (the check project ignores that default lib).
+//
+// Nothing is drawn. The mock keeps the state GL would have, so it can tell
+// which state calls really change something: a call that sets a state to the
+// value it already has is counted as redundant. Draw calls and the bytes given
+// to buffer objects are counted too.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MOCK_GL_H
+#define MOCK_GL_H
+
+namespace mockgl {
+
+void reset();                   // GL default states, counters cleared
+void clearCounters();
+
+int getStateCalls();            // glEnable(), glDepthFunc(), glUseProgram(), ... since clearCounters()
+int getRedundantCalls();        // state calls that did not change the state
+int getDrawCalls();             // glBegin() and glDraw*() calls
+long long getUploadBytes();     // data of glBufferDataARB() and glBufferSubDataARB()
+long long getLargestUpload();   // bytes of the largest of these calls
+
+} // namespace mockgl
+
+#endif
@@ -0,0 +1,1963 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// oglMRCheck.cpp
+// ==============
+// Checks of oglMRDemo that run in a console, without a window or a tracker.
+// ModelGL draws into MockGL.cpp and FSCore is the simulator (FSCORE_SIMULATOR).
+// Every mode prints what it measured and returns 1 if a check fails.
+//
+// USAGE:
+//     oglMRCheck -glstate [frames]        state calls issued to GL and filtered
+//                                         by glStateCache per frame of drawDebug()
+//                                         and drawVR(); fails if a call that does
+//                                         not change GL state reaches GL; then
+//                                         many setter calls in one frame must
+//                                         rebuild each matrix once, and frames
+//                                         of the same pose must hit the frustum
+//                                         cache
+//     oglMRCheck -scheduler [frames]      frame times of FrameScheduler in each
+//                                         mode, swapping to a simulated display
+//                                         (FrameScheduler::makeMockSwap())
+//     oglMRCheck -pose [frames]           eye matrices and pen ray of each frame
+//                                         against StereoFrustum::solve() of the
+//                                         latched pose and of the FSCore pose, or
+//                                         of the recorded frame when replaying
+//     oglMRCheck -frustum [poses]         StereoFrustum::solve() and solveBatch()
+//                                         against fmModifyFrustum() of the
+//                                         simulator along its trajectory, and the
+//                                         viewer 0 of drawMultiView() against the
+//                                         frame frustum of drawVR()
+//     oglMRCheck -triplebuffer [reads]    cost of a TrackingPose read while a
+//                                         writer thread publishes, and torn or
+//                                         out of order reads; a mutex for reference
+//     oglMRCheck -scene [commands]        UI thread posts scene commands while a
+//                                         rendering thread draws and resizes; the
+//                                         pending count must stay in range and
+//                                         reach 0 (run it under ThreadSanitizer);
+//                                         the drawing stalls for the 1st half, so
+//                                         the queue overflows and the whole state
+//                                         must be sent and drawn instead
+//     oglMRCheck -logqueue [messages]     threads log faster than a slow sink
+//                                         writes; every message must arrive once
+//                                         and in order while callers wait for
+//                                         space (opt-in), and drops are counted
+//                                         without the wait (default); p50 and
+//                                         p99 of a put() with 4 threads
+//     oglMRCheck -reproject [warps]       StereoReprojector warps a side-by-side
+//                                         frame of a plane at a known depth; the
+//                                         same eye matrices must give the source
+//                                         back, and a sideways head move must
+//                                         shift it by the expected pixels
+//     oglMRCheck -predict [recording]     evaluatePrediction() of each method of
+//                                         PosePredictor over a recording of the
+//                                         demo (-record), or over the simulator
+//                                         trajectory at the tracker rate; error
+//                                         and cpu time per sample for each
+//                                         look-ahead, the filters must beat no
+//                                         prediction on the simulator trajectory
+//     oglMRCheck -strokes [count]         StrokePool and StrokeRenderer with the
+//                                         mock GL: chunks, draw calls and bytes
+//                                         uploaded per frame while count strokes
+//                                         are added, then while one stroke grows;
+//                                         fails if such a frame uploads a chunk
+//                                         again
+//     oglMRCheck -strokegrid [count]      StrokeGrid of a StrokePool of count
+//                                         strokes close together: ns per sample
+//                                         added, us per pick and erase, bytes
+//                                         per point; pickStroke() must find the
+//                                         stroke a search of every segment finds
+//     oglMRCheck -posefilter [seconds]    filterTrace() (4 parameter sets at a
+//                                         time with SSE) against the scalar
+//                                         OneEuroFilter::filter() on a noisy
+//                                         trace of the simulator; the outputs
+//                                         must match, and both are timed
+//     oglMRCheck -poseshm [readers] [seconds]
+//                                         PoseServer ring read by reader threads
+//                                         (benchmarkPoseShm()) and by reader
+//                                         processes: reads/s, retries and
+//                                         publish-to-read latency; fails if a
+//                                         reader sees no pose or a torn one
+//     oglMRCheck -posereader name seconds one reader process of -poseshm
+//     oglMRCheck -multiview [frames]      draw() in VR mode with 1 to 8 viewers:
+//                                         us per frame and per viewer, plan time
+//                                         of MultiViewPlanner; every viewer must
+//                                         get a frustum of its own
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MockGL.h"
+#include "../oglMRDemo/Common/FrameScheduler.h"
+#include "../oglMRDemo/Common/LogQueue.h"
+#include "../oglMRDemo/Model/ModelGL.h"
+#include "../oglMRDemo/Model/StereoReprojector.h"
+#include "../oglMRDemo/Model/StrokePool.h"
+#include "../oglMRDemo/Model/StrokeRenderer.h"
+#include "../oglMRDemo/Tracking/OneEuroFilter.h"
+#include "../oglMRDemo/Tracking/PoseClient.h"
+#include "../oglMRDemo/Tracking/PoseServer.h"
+#include "../oglMRDemo/Tracking/PosePredictor.h"
+#include "../oglMRDemo/Tracking/TrackingReplay.h"
+#include "../oglMRDemo/Tracking/TripleBuffer.h"
+#include "../oglMRDemo/FCore/FSCoreSim.h"
+
+const int DEFAULT_GLSTATE_FRAMES = 100;
+const int GLSTATE_WARMUP_FRAMES = 2;    // mode changes are applied by the next draw()
+const int CACHE_SETTER_CALLS = 100;     // camera and model setter calls in one frame
+const int CACHE_FRAMES = 10;            // frames of the same pose
+const int WINDOW_WIDTH = 1280;
+const int WINDOW_HEIGHT = 720;
+const double SIM_TIME = 2.5;            // seconds, the pen is in front of the screen
+const int DEFAULT_SCHEDULER_FRAMES = 120;
+const double SCHEDULER_TOLERANCE = 0.1; // allowed error of the average frame time
+const double SCHEDULER_MISS_RATIO = 0.05; // allowed misses of a frame within its budget
+const int DEFAULT_POSE_FRAMES = 60;
+const double POSE_START_TIME = 1.0;     // seconds of simulated time
+const double POSE_FRAME_TIME = 1.0 / 60;
+const int POSE_POLL_COUNT = 2;          // publishes of the tracking thread until a new time is seen
+const int64_t POSE_LOOK_AHEAD = 30000;  // microseconds of prediction
+const char* POSE_RECORDING = "oglMRCheck_pose.rec";
+const float SCREEN_DISTANCE = -10;      // screen of ModelGL::latchPose()
+const float SCREEN_HEIGHT = 10;
+const float PUPIL_DISTANCE = 0.066f;
+const int DEFAULT_FRUSTUM_POSES = 4000;
+const double FRUSTUM_TIME_STEP = 0.0137;  // seconds of simulated time between poses
+const double FRUSTUM_TOLERANCE = 1e-5;  // allowed error relative to max(1, |value|)
+const int FRUSTUM_NO_GLASSES = 5;       // every 5th pose of the batch has no glasses
+const int FRUSTUM_VIEWERS = 3;
+const int FRUSTUM_FRAMES = 10;          // frames of drawMultiView()
+const int DEFAULT_TRIPLE_BUFFER_READS = 10000000;
+const int DEFAULT_SCENE_COMMANDS = 100000;
+const int SCENE_RESIZE_FRAMES = 3;      // the rendering thread resizes every 3 frames
+const int SCENE_DRAIN_TIMEOUT = 5000;   // ms for the last commands to be applied
+const int SCENE_QUEUE_CAPACITY = 4096;  // commands queued by ModelGL::postCommand()
+const int DEFAULT_LOG_MESSAGES = 100000;  // per thread
+const int LOG_THREADS = 4;
+const int LOG_BATCH_SLEEP = 2;          // ms the sink takes for each batch
+const int LOG_TEXT_LENGTH = 64;
+const int LOG_FULL_WAIT = 100;          // ms, opt-in wait for space of the 1st pass
+const int DEFAULT_REPROJECT_WARPS = 20;
+const int REPROJECT_WIDTH = 1281;       // odd, the right eye is 1 column wider like ModelGL::drawVR()
+const int REPROJECT_HEIGHT = 720;
+const float REPROJECT_NEAR = 0.1f;
+const float REPROJECT_FAR = 100;
+const float REPROJECT_DEPTH = 4;        // distance of the plane that fills the frame
+const float REPROJECT_MOVE = 0.1f;      // sideways head move, 0.1 / 4 * 720 / 2 = 9 pixels
+const double PREDICT_DURATION = 30;     // seconds of the simulator trajectory
+const int64_t PREDICT_LOOK_AHEADS[] = { 0, 10000, 20000, 30000, 50000 };   // microseconds
+const int64_t PREDICT_MIN_LOOK_AHEAD = 20000;   // filters must beat no prediction from here
+const int DEFAULT_STROKES = 100000;
+const int STROKE_SAMPLES = 32;          // pen samples of a stroke, all kept
+const float STROKE_RADIUS = 0.2f;       // strokes are arcs of this radius, 2 cm between samples
+const float STROKE_STEP = 0.1f;         // radian between samples
+const float STROKE_SPACE = 10;          // strokes start in a cube of this size
+const int STROKES_PER_FRAME = 1000;     // while filling
+const int STROKE_STEADY_FRAMES = 120;   // one stroke grows by 2 samples per frame
+const int DEFAULT_GRID_STROKES = 20000;
+const float GRID_SPACE = 5;             // strokes start in a cube of this size, many near each pick
+const int GRID_CHECKED_PICKS = 200;     // against a search of every segment
+const int GRID_TIMED_PICKS = 100000;
+const int GRID_ERASES = 1000;
+const float GRID_PICK_OFFSET = 0.25f;   // picks are up to this far from a sample in each axis
+const float GRID_PICK_RADIUS = 0.05f;
+const float GRID_TOLERANCE = 1e-5f;     // allowed distance difference of 2 segments
+const double DEFAULT_FILTER_SECONDS = PREDICT_DURATION;   // of the trace, at most PREDICT_DURATION
+const int FILTER_POLLS = 4;             // polls of the tracking thread per tracker frame
+const float FILTER_NOISE = 0.0005f;     // meter of position noise
+const double FILTER_GAP_TIME = 10;      // seconds, the tracker stops for a second here
+const float FILTER_SCALES[] = { 0.25f, 0.5f, 1, 2, 4, 8 };  // of the default minCutoff, 4 with SSE + 2 scalar
+const float FILTER_TOLERANCE = 1e-5f;   // allowed difference of an output value
+const int DEFAULT_SHM_READERS = 4;
+const double DEFAULT_SHM_SECONDS = 1;   // of each run
+const double SHM_RATES[] = { 1000, 0 }; // publish rates, 0 = as fast as possible
+const char* const SHM_NAME = "fmTrackingPosesCheck";
+const double SHM_TIMEOUT = 10;          // seconds a reader process waits longer than the run
+const int SHM_LATENCY_BUCKETS = 10000;  // 1 us each, the last one holds everything above
+const int DEFAULT_MULTIVIEW_FRAMES = 100;
+const double MULTIVIEW_FRAME_TIME = 1.0 / 90;   // seconds of simulated time per frame
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw the same scene in each mode, count the calls that reach the mock GL
+///////////////////////////////////////////////////////////////////////////////
+static int glState(int frames)
+{
+    struct Case
+    {
+        const char* name;
+        bool vrMode;
+        bool instanced;
+        int viewerCount;
+        int drawMode;
+    };
+    static const Case cases[] = {
+        { "drawDebug",            false, false, 1, 0 },
+        { "drawDebug wireframe",  false, false, 1, 1 },
+        { "drawVR 2 passes",      true,  false, 1, 0 },
+        { "drawVR instanced",     true,  true,  1, 0 },
+        { "drawMultiView 3",      true,  false, 3, 0 },
+    };
+
+    f3d::sim::setManualClock(true);
+    f3d::sim::setTime(SIM_TIME);
+    mockgl::reset();
+
+    ModelGL model;
+    model.init();
+    model.initShaders();
+    model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    printf("%-20s %6s %8s %8s %9s %10s\n", "frame of", "draws", "issued", "filtered", "filtered%", "redundant");
+    int failures = 0;
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const Case& c = cases[i];
+        model.setVRMode(c.vrMode);
+        model.setStereoInstanced(c.instanced);
+        model.setViewerCount(c.viewerCount);
+        model.setDrawMode(c.drawMode);
+        for(int j = 0; j < GLSTATE_WARMUP_FRAMES; ++j)
+            model.draw();
+
+        // the counters of glStateCache are read one frame late, see beginFrame()
+        int64_t draws = 0, issued = 0, filtered = 0, redundant = 0, mismatches = 0;
+        int lastStateCalls = 0;
+        for(int j = 0; j <= frames; ++j)
+        {
+            mockgl::clearCounters();
+            model.draw();
+            if(j > 0)
+            {
+                issued += model.getStateCallsIssued();
+                filtered += model.getStateCallsFiltered();
+                if(model.getStateCallsIssued() != lastStateCalls)
+                    ++mismatches;
+            }
+            if(j < frames)
+            {
+                draws += mockgl::getDrawCalls();
+                redundant += mockgl::getRedundantCalls();
+            }
+            lastStateCalls = mockgl::getStateCalls();
+        }
+
+        double total = (double)(issued + filtered);
+        printf("%-20s %6.1f %8.1f %8.1f %8.1f%% %10.1f\n", c.name, (double)draws / frames, (double)issued / frames,
+               (double)filtered / frames, total > 0 ? filtered * 100.0 / total : 0.0, (double)redundant / frames);
+
+        if(redundant > 0)
+        {
+            printf("  FAILED: %lld state calls did not change GL state\n", (long long)redundant);
+            ++failures;
+        }
+        if(mismatches > 0)
+        {
+            printf("  FAILED: state calls bypassed glStateCache in %lld frames\n", (long long)mismatches);
+            ++failures;
+        }
+    }
+
+    // the setters of a frame end up in one rebuild of the view and one of the model matrix
+    int requests = model.getMatrixUpdateRequests();
+    int rebuilds = model.getMatrixRebuilds();
+    for(int i = 0; i < CACHE_SETTER_CALLS; ++i)
+    {
+        model.setCameraAngleX((float)(i % 30));
+        model.setModelAngleY((float)(i % 90));
+    }
+    model.draw();
+    requests = model.getMatrixUpdateRequests() - requests;
+    rebuilds = model.getMatrixRebuilds() - rebuilds;
+
+    // the simulated time does not move, every frame after the 1st one reuses the frustum
+    model.setVRMode(true);
+    model.setViewerCount(1);
+    model.draw();
+    int hits = model.getFrustumCacheHits();
+    int misses = model.getFrustumCacheMisses();
+    for(int i = 0; i < CACHE_FRAMES; ++i)
+        model.draw();
+    hits = model.getFrustumCacheHits() - hits;
+    misses = model.getFrustumCacheMisses() - misses;
+
+    printf("\nmatrix rebuilds %d of %d requests (%d avoided), frustum cache %d hits %d misses of %d frames\n",
+           rebuilds, requests, requests - rebuilds, hits, misses, CACHE_FRAMES);
+    if(requests < CACHE_SETTER_CALLS * 2 || rebuilds > 2)
+    {
+        printf("  FAILED: %d rebuilds for %d setter calls\n", rebuilds, CACHE_SETTER_CALLS * 2);
+        ++failures;
+    }
+    if(hits != CACHE_FRAMES || misses != 0)
+    {
+        printf("  FAILED: the frustum of an unchanged pose was solved again\n");
+        ++failures;
+    }
+
+    model.quit();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// pace frames of a fixed CPU cost in each mode, check the frame times
+// The simulated display blocks the swap until its next vblank only while the
+// swap interval is 1, like SwapBuffers().
+///////////////////////////////////////////////////////////////////////////////
+static int scheduler(int frames)
+{
+    struct Case
+    {
+        const char* name;
+        FrameScheduler::Mode mode;
+        double rate;            // target rate, refresh rate of the display in vsync mode
+        double cpuTime;         // ms of work per frame
+        double frameTime;       // expected average, 0 if only less than cpuTime + 1 ms
+        bool missAll;           // every frame is expected to miss
+    };
+    static const Case cases[] = {
+        { "vsync 60",           FrameScheduler::MODE_VSYNC,      60,  5,  1000.0 / 60,  false },
+        { "vsync 60 overrun",   FrameScheduler::MODE_VSYNC,      60,  20, 2000.0 / 60,  true  },
+        { "vsync 120",          FrameScheduler::MODE_VSYNC,      120, 3,  1000.0 / 120, false },
+        { "fixed 90",           FrameScheduler::MODE_FIXED_RATE, 90,  3,  1000.0 / 90,  false },
+        { "uncapped",           FrameScheduler::MODE_UNCAPPED,   60,  2,  0,            false },
+    };
+
+    printf("%-18s %9s %9s %9s %7s %9s\n", "mode", "expected", "average", "max", "missed", "interval");
+    int failures = 0;
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const Case& c = cases[i];
+        int interval = -1;
+        FrameScheduler::SwapFunction vblankSwap = FrameScheduler::makeMockSwap(c.rate);
+
+        FrameScheduler frameScheduler;
+        frameScheduler.setSwapIntervalFunction([&interval](int value) { interval = value; });
+        frameScheduler.setSwapFunction([&interval, &vblankSwap]() { if(interval == 1) vblankSwap(); });
+        frameScheduler.setMode(c.mode, c.rate);
+
+        // the 1st frame applies the mode and has no frame time
+        for(int j = 0; j <= frames; ++j)
+        {
+            if(j == 1)
+                frameScheduler.resetStats();
+            frameScheduler.beginFrame();
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(c.cpuTime));
+            while(std::chrono::steady_clock::now() < end)
+                ;
+            frameScheduler.endFrame();
+        }
+
+        double average = frameScheduler.getAverageFrameTime();
+        int missed = frameScheduler.getMissedCount();
+        printf("%-18s %9.2f %9.2f %9.2f %7d %9d\n", c.name, c.frameTime > 0 ? c.frameTime : c.cpuTime,
+               average, frameScheduler.getMaxFrameTime(), missed, interval);
+
+        bool failed = false;
+        if(interval != (c.mode == FrameScheduler::MODE_VSYNC ? 1 : 0))
+        {
+            printf("  FAILED: swap interval %d\n", interval);
+            failed = true;
+        }
+        if(c.frameTime > 0 && fabs(average - c.frameTime) > c.frameTime * SCHEDULER_TOLERANCE)
+        {
+            printf("  FAILED: average frame time %.2f ms, expected %.2f ms\n", average, c.frameTime);
+            failed = true;
+        }
+        if(c.frameTime == 0 && (average < c.cpuTime || average > c.cpuTime + 1))
+        {
+            printf("  FAILED: average frame time %.2f ms, expected the cpu time %.2f ms\n", average, c.cpuTime);
+            failed = true;
+        }
+        if(c.missAll ? missed < frames * (1 - SCHEDULER_MISS_RATIO) : missed > frames * SCHEDULER_MISS_RATIO)
+        {
+            printf("  FAILED: %d of %d frames missed\n", missed, frames);
+            failed = true;
+        }
+        if(failed)
+            ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// frustum of a pose on the screen of the last frame drawn by model (VR mode)
+///////////////////////////////////////////////////////////////////////////////
+static void solvePose(ModelGL& model, const TrackingPose& pose, f3d::FrustumData& data)
+{
+    StereoFrustum solver;
+    solver.set(Matrix4(model.getViewMatrixElements()), Matrix4(model.getProjectionMatrixElements()),
+               SCREEN_DISTANCE, SCREEN_HEIGHT, PUPIL_DISTANCE, false);
+    solver.solve(pose, data);
+}
+
+static bool isEqual(const f3d::FrustumData& a, const f3d::FrustumData& b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// step the simulated time frame by frame and check that the frustum of each
+// frame is the one of its latched pose, and whether it differs from the
+// frustum of the source pose: the one FSCore returns at that time, or for a
+// replay, the frame drawn at the same recorded time while recording
+///////////////////////////////////////////////////////////////////////////////
+static int pose(int frames)
+{
+    enum Source { SOURCE_FSCORE = 0, SOURCE_RECORD, SOURCE_REPLAY };
+    struct Case
+    {
+        const char* name;
+        PosePredictor::Method prediction;
+        bool filter;            // One-Euro filter of the tracking thread
+        Source source;
+        bool sourceDiffers;     // the latched pose is expected to differ from the source
+    };
+    static const Case cases[] = {
+        { "latched",            PosePredictor::METHOD_NONE,               false, SOURCE_FSCORE, false },
+        { "predicted (holt)",   PosePredictor::METHOD_DOUBLE_EXPONENTIAL, false, SOURCE_FSCORE, true  },
+        { "predicted (kalman)", PosePredictor::METHOD_KALMAN,             false, SOURCE_FSCORE, true  },
+        { "filtered",           PosePredictor::METHOD_NONE,               true,  SOURCE_FSCORE, true  },
+        { "recorded",           PosePredictor::METHOD_NONE,               false, SOURCE_RECORD, false },
+        { "replayed",           PosePredictor::METHOD_NONE,               false, SOURCE_REPLAY, false },
+    };
+
+    f3d::sim::setManualClock(true);
+    mockgl::reset();
+
+    // frames drawn while recording, replayed at the same recorded times
+    std::vector<int64_t> recordedTimes(frames);
+    std::vector<f3d::FrustumData> recordedFrustums(frames);
+
+    printf("%-18s %7s %10s %10s\n", "frame of", "frames", "not-latched", "not-source");
+    int failures = 0;
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const Case& c = cases[i];
+        f3d::sim::setTime(POSE_START_TIME);
+
+        ModelGL model;
+        model.init();
+        model.initShaders();
+        model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+        model.setVRMode(true);
+        model.setPosePrediction(c.prediction);
+        model.setPredictionLookAhead(c.prediction == PosePredictor::METHOD_NONE ? 0 : POSE_LOOK_AHEAD);
+        model.setPoseFilter(c.filter);
+        if(c.source == SOURCE_RECORD && !model.startRecording(POSE_RECORDING))
+        {
+            printf("  FAILED: cannot write %s\n", POSE_RECORDING);
+            return 1;
+        }
+        if(c.source == SOURCE_REPLAY && !model.startReplay(POSE_RECORDING, 0))
+        {
+            printf("  FAILED: cannot read %s\n", POSE_RECORDING);
+            return 1;
+        }
+
+        int notLatched = 0, notSource = 0;
+        for(int j = 0; j < frames; ++j)
+        {
+            if(c.source == SOURCE_REPLAY)
+                model.seekReplay(recordedTimes[j]);     // paused at the recorded time
+            else
+                f3d::sim::setTime(POSE_START_TIME + j * POSE_FRAME_TIME);
+
+            // the 1st publish may be of a pose sampled before the new time
+            uint32_t published = model.getTrackingPublishCount();
+            while(model.getTrackingPublishCount() - published < POSE_POLL_COUNT)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            model.draw();
+
+            const f3d::FrustumData& frustum = model.getLatchedFrustum();
+            f3d::FrustumData latched, source;
+            solvePose(model, model.getLatchedPose(), latched);
+            if(c.source == SOURCE_REPLAY)
+                source = recordedFrustums[j];
+            else
+                solvePose(model, sampleTrackingPose(0), source);
+            if(!isEqual(frustum, latched))
+                ++notLatched;
+            if(!isEqual(frustum, source))
+                ++notSource;
+
+            if(c.source == SOURCE_RECORD)
+            {
+                recordedTimes[j] = model.getLatchedPose().timestamp;
+                recordedFrustums[j] = frustum;
+            }
+        }
+        model.stopRecording();
+        model.stopReplay();
+        model.quit();
+
+        printf("%-18s %7d %10d %10d\n", c.name, frames, notLatched, notSource);
+        if(notLatched > 0)
+        {
+            printf("  FAILED: %d frames are not drawn with their latched pose\n", notLatched);
+            ++failures;
+        }
+        if(c.sourceDiffers ? notSource < frames / 2 : notSource > 0)
+        {
+            printf("  FAILED: %d frames differ from the source pose\n", notSource);
+            ++failures;
+        }
+    }
+    remove(POSE_RECORDING);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// largest difference of 2 frustums, relative to max(1, |value of a|)
+///////////////////////////////////////////////////////////////////////////////
+static double getError(const f3d::FrustumData& a, const f3d::FrustumData& b)
+{
+    const float* x = (const float*)&a;
+    const float* y = (const float*)&b;
+    double error = 0;
+    for(size_t i = 0; i < sizeof(a) / sizeof(float); ++i)
+        error = std::max(error, fabs((double)x[i] - y[i]) / std::max(1.0, fabs((double)x[i])));
+    return error;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the in-tree solver is the only source of the eye matrices: check it against
+// fmModifyFrustum() of the simulator at the same simulated times, solveBatch()
+// against solve(), and that drawMultiView() plans viewer 0 with the frustum
+// drawVR() would use for the same frame
+///////////////////////////////////////////////////////////////////////////////
+static int frustum(int poseCount)
+{
+    f3d::sim::setManualClock(true);
+    f3d::sim::setTime(POSE_START_TIME);
+    mockgl::reset();
+
+    ModelGL model;
+    model.init();
+    model.initShaders();
+    model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    model.setVRMode(true);
+    model.setViewerCount(FRUSTUM_VIEWERS);
+
+    int notViewer0 = 0;
+    for(int i = 0; i < FRUSTUM_FRAMES; ++i)
+    {
+        f3d::sim::setTime(POSE_START_TIME + i * POSE_FRAME_TIME);
+        model.draw();
+        if(model.getMultiViewCount() != FRUSTUM_VIEWERS ||
+           !isEqual(model.getMultiViewFrustum(0), model.getLatchedFrustum()))
+            ++notViewer0;
+    }
+
+    // the screen of the VR frames drawn above
+    Matrix4 view(model.getViewMatrixElements());
+    Matrix4 projection(model.getProjectionMatrixElements());
+    model.quit();
+
+    StereoFrustum solver;
+    solver.set(view, projection, SCREEN_DISTANCE, SCREEN_HEIGHT, PUPIL_DISTANCE, false);
+    f3d::Matrix4 simView, simProjection;
+    memcpy(simView.m, view.get(), sizeof(simView.m));
+    memcpy(simProjection.m, projection.get(), sizeof(simProjection.m));
+
+    std::vector<TrackingPose> poses(poseCount);
+    std::vector<f3d::FrustumData> solved(poseCount), batched(poseCount);
+    double maxError = 0;
+    int outOfTolerance = 0;
+    for(int i = 0; i < poseCount; ++i)
+    {
+        f3d::sim::setTime(POSE_START_TIME + i * FRUSTUM_TIME_STEP);
+        poses[i] = sampleTrackingPose(i);
+
+        f3d::FrustumData sim;
+        fmModifyFrustum(&sim, &simView, &simProjection, SCREEN_DISTANCE, SCREEN_HEIGHT, PUPIL_DISTANCE, false);
+        solver.solve(poses[i], solved[i]);
+        double error = getError(sim, solved[i]);
+        maxError = std::max(maxError, error);
+        if(error > FRUSTUM_TOLERANCE)
+            ++outOfTolerance;
+    }
+
+    // the batch with poses of both branches, glasses and no glasses
+    for(int i = 0; i < poseCount; i += FRUSTUM_NO_GLASSES)
+    {
+        poses[i].glassStatus = 0;
+        solver.solve(poses[i], solved[i]);
+    }
+    solver.solveBatch(&poses[0], poseCount, &batched[0]);
+    int notBatched = 0;
+    for(int i = 0; i < poseCount; ++i)
+    {
+        if(!isEqual(solved[i], batched[i]))
+            ++notBatched;
+    }
+
+    // cost of each
+    f3d::FrustumData sim;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < poseCount; ++i)
+        solver.solve(poses[i], solved[i]);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    solver.solveBatch(&poses[0], poseCount, &batched[0]);
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    for(int i = 0; i < poseCount; ++i)
+        fmModifyFrustum(&sim, &simView, &simProjection, SCREEN_DISTANCE, SCREEN_HEIGHT, PUPIL_DISTANCE, false);
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+
+    printf("%-12s %7s %12s %12s\n", "solver", "poses", "ns/pose", "error");
+    printf("%-12s %7d %12.1f %12.3g\n", "solve", poseCount,
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / poseCount, maxError);
+    printf("%-12s %7d %12.1f %12d\n", "solveBatch", poseCount,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / poseCount, notBatched);
+    printf("%-12s %7d %12.1f %12s\n", "simulator", poseCount,
+           std::chrono::duration<double, std::nano>(t3 - t2).count() / poseCount, "-");
+    printf("%-12s %7d %12s %12d\n", "multi-view", FRUSTUM_FRAMES, "-", notViewer0);
+
+    int failures = 0;
+    if(outOfTolerance > 0)
+    {
+        printf("  FAILED: %d poses differ from the simulator by more than %g\n", outOfTolerance, FRUSTUM_TOLERANCE);
+        ++failures;
+    }
+    if(notBatched > 0)
+    {
+        printf("  FAILED: %d poses of solveBatch() differ from solve()\n", notBatched);
+        ++failures;
+    }
+    if(notViewer0 > 0)
+    {
+        printf("  FAILED: viewer 0 of %d frames is not the frame frustum\n", notViewer0);
+        ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// a pose whose values all come from its sequence, so a torn read is visible
+///////////////////////////////////////////////////////////////////////////////
+static void fillPose(TrackingPose& pose, uint32_t sequence)
+{
+    float v = (float)(sequence & 0xfffff);
+    pose.glassPosition.x = pose.glassPosition.y = pose.glassPosition.z = v;
+    pose.glassRotation.x = pose.glassRotation.y = pose.glassRotation.z = pose.glassRotation.w = v;
+    pose.penPosition.x = pose.penPosition.y = pose.penPosition.z = v;
+    pose.penDirection.x = pose.penDirection.y = pose.penDirection.z = v;
+    pose.penRoll = pose.slantAngle = v;
+    pose.glassStatus = pose.penKey = pose.penStatus = pose.isSleep = (int)sequence;
+    pose.timestamp = sequence;
+    pose.sequence = sequence;
+}
+
+static bool isWhole(const TrackingPose& pose)
+{
+    float v = (float)(pose.sequence & 0xfffff);
+    int s = (int)pose.sequence;
+    return pose.glassPosition.x == v && pose.glassPosition.y == v && pose.glassPosition.z == v &&
+           pose.glassRotation.x == v && pose.glassRotation.y == v && pose.glassRotation.z == v &&
+           pose.glassRotation.w == v && pose.penPosition.x == v && pose.penPosition.y == v &&
+           pose.penPosition.z == v && pose.penDirection.x == v && pose.penDirection.y == v &&
+           pose.penDirection.z == v && pose.penRoll == v && pose.slantAngle == v &&
+           pose.glassStatus == s && pose.penKey == s && pose.penStatus == s && pose.isSleep == s &&
+           pose.timestamp == (int64_t)pose.sequence;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// one writer thread publishes poses as fast as it can, this thread reads them
+// The TripleBuffer of TrackingThread is compared with a mutex around a copy.
+///////////////////////////////////////////////////////////////////////////////
+static int tripleBuffer(int reads)
+{
+    printf("%-14s %10s %8s %10s %6s %12s\n", "reader", "reads", "ns/read", "new", "torn", "out of order");
+    int failures = 0;
+    for(int method = 0; method < 2; ++method)
+    {
+        TripleBuffer<TrackingPose> buffer;
+        std::mutex lock;
+        TrackingPose shared;
+        fillPose(shared, 0);
+        buffer.write(shared);
+
+        std::atomic<bool> loop(true);
+        std::thread writer([&]()
+        {
+            for(uint32_t sequence = 1; loop.load(std::memory_order_relaxed); ++sequence)
+            {
+                if(method == 0)
+                {
+                    fillPose(buffer.getBack(), sequence);
+                    buffer.publish();
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    fillPose(shared, sequence);
+                }
+            }
+        });
+
+        int fresh = 0, torn = 0, outOfOrder = 0;
+        uint32_t last = 0;
+        TrackingPose pose;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int i = 0; i < reads; ++i)
+        {
+            if(method == 0)
+            {
+                buffer.read(pose);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                pose = shared;
+            }
+            if(!isWhole(pose))
+                ++torn;
+            if(pose.sequence < last)
+                ++outOfOrder;
+            if(pose.sequence != last)
+                ++fresh;
+            last = pose.sequence;
+        }
+        double time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        loop = false;
+        writer.join();
+
+        printf("%-14s %10d %8.1f %10d %6d %12d\n", method == 0 ? "TripleBuffer" : "std::mutex",
+               reads, time / reads, fresh, torn, outOfOrder);
+        if(torn > 0 || outOfOrder > 0)
+            ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the main thread is the UI thread of the demo, a 2nd thread draws like
+// ControllerGL::runThread() and resizes the window like a WM_SIZE would
+///////////////////////////////////////////////////////////////////////////////
+static int scene(int commandCount)
+{
+    f3d::sim::setManualClock(true);
+    f3d::sim::setTime(SIM_TIME);
+    mockgl::reset();
+
+    ModelGL model;
+    model.init();
+    model.initShaders();
+    model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    std::atomic<bool> loop(true);
+    std::atomic<bool> stalled(true);
+    std::atomic<int> frames(0);
+    std::thread renderer([&]()
+    {
+        while(loop.load(std::memory_order_relaxed))
+        {
+            if(stalled.load(std::memory_order_relaxed))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            int frame = frames.load(std::memory_order_relaxed);
+            if(frame % SCENE_RESIZE_FRAMES == 0)
+                model.setWindowSize(WINDOW_WIDTH - frame % 64, WINDOW_HEIGHT);
+            model.draw();
+            frames.store(frame + 1, std::memory_order_relaxed);
+        }
+    });
+
+    int minPending = 0, maxPending = 0;
+    for(int i = 0; i < commandCount; ++i)
+    {
+        if(i == commandCount / 2)
+            stalled = false;
+        switch(i % 6)
+        {
+        case 0: model.setCameraX((float)(i % 100) * 0.01f); break;
+        case 1: model.setModelAngleY((float)(i % 360)); break;
+        case 2: model.rotateCamera(i % 7, i % 5); break;
+        case 3: model.setDrawMode(i % 3); break;
+        case 4: model.setVRMode(i % 12 == 4); break;
+        case 5: model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT - i % 32); break;
+        }
+        int pending = model.getPendingCommands();
+        minPending = std::min(minPending, pending);
+        maxPending = std::max(maxPending, pending);
+    }
+    model.setVRMode(true);
+
+    // every posted command is applied by one of the next frames
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+                                                     std::chrono::milliseconds(SCENE_DRAIN_TIMEOUT);
+    while(model.getPendingCommands() != 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+    int pending = model.getPendingCommands();
+
+    loop = false;
+    renderer.join();
+
+    // the frame is drawn with the state of the UI thread
+    model.draw();
+    f3d::FrustumData expected;
+    solvePose(model, model.getLatchedPose(), expected);
+    bool synced = isEqual(model.getLatchedFrustum(), expected);
+    int resyncs = model.getSceneResyncs();
+    model.quit();
+
+    int posted = commandCount - commandCount / 6 + 1;   // setWindowSize() is not a posted command, setVRMode() at the end
+    printf("%-10s %8s %8s %12s %12s %8s %8s\n", "commands", "posted", "frames", "min pending", "max pending", "pending", "resyncs");
+    printf("%-10d %8d %8d %12d %12d %8d %8d\n", commandCount, posted, frames.load(), minPending, maxPending, pending, resyncs);
+
+    int failures = 0;
+    if(minPending < 0 || maxPending > posted)
+    {
+        printf("  FAILED: pending count out of [0, %d]\n", posted);
+        ++failures;
+    }
+    if(pending != 0)
+    {
+        printf("  FAILED: %d commands not applied after %d ms\n", pending, SCENE_DRAIN_TIMEOUT);
+        ++failures;
+    }
+    if(resyncs == 0 && (commandCount / 2) * 5 / 6 > SCENE_QUEUE_CAPACITY)
+    {
+        printf("  FAILED: the queue of %d commands did not overflow while the drawing stalled\n", SCENE_QUEUE_CAPACITY);
+        ++failures;
+    }
+    if(!synced)
+    {
+        printf("  FAILED: the frame is not drawn with the camera of the UI thread\n");
+        ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sink slower than the callers, checks the order of each caller
+// write() is called by one thread at a time, the writer or stop()
+///////////////////////////////////////////////////////////////////////////////
+class SlowSink : public LogSink
+{
+public:
+    SlowSink() : received(0), outOfOrder(0), notes(0), last(LOG_THREADS, -1) {}
+
+    void write(int64_t /*time*/, int /*thread*/, const wchar_t* text, size_t length)
+    {
+        int caller = -1, sequence = -1;
+        wchar_t message[LOG_TEXT_LENGTH];
+        length = std::min(length, (size_t)LOG_TEXT_LENGTH - 1);
+        wmemcpy(message, text, length);
+        message[length] = L'\0';
+        if(swscanf(message, L"%d %d", &caller, &sequence) != 2 || caller < 0 || caller >= LOG_THREADS)
+        {
+            ++notes;                                // drop count of LogQueue
+            return;
+        }
+        if(sequence <= last[caller])
+            ++outOfOrder;
+        last[caller] = sequence;
+        ++received;
+    }
+
+    void endBatch()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_BATCH_SLEEP));
+    }
+
+    int received;
+    int outOfOrder;
+    int notes;
+    std::vector<int> last;
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// threads put numbered messages as fast as they can, into rings that fill up
+// because the sink sleeps after each batch: with the full wait no message may
+// be lost, without it the lost ones must be counted as dropped
+///////////////////////////////////////////////////////////////////////////////
+static int logQueue(int messageCount)
+{
+    printf("%-10s %9s %9s %9s %9s %10s %9s %9s %9s\n", "full wait", "sent", "received", "dropped", "order", "ms",
+           "p50 ns", "p99 ns", "max us");
+    int failures = 0;
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        SlowSink sink;
+        int64_t dropped;
+        std::vector<float> latencies(messageCount * LOG_THREADS);  // ns of each put()
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        {
+            LogQueue queue(&sink);
+            queue.setFullWait(pass == 0 ? LOG_FULL_WAIT : 0);
+            queue.start();
+
+            std::vector<std::thread> callers;
+            for(int i = 0; i < LOG_THREADS; ++i)
+            {
+                callers.push_back(std::thread([&queue, &latencies, i, messageCount]()
+                {
+                    wchar_t text[LOG_TEXT_LENGTH];
+                    float* latency = &latencies[i * messageCount];
+                    for(int j = 0; j < messageCount; ++j)
+                    {
+                        int length = swprintf(text, LOG_TEXT_LENGTH, L"%d %d", i, j);
+                        std::chrono::steady_clock::time_point put = std::chrono::steady_clock::now();
+                        queue.put(text, length > 0 ? length : 0);
+                        latency[j] = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - put).count();
+                    }
+                }));
+            }
+            for(size_t i = 0; i < callers.size(); ++i)
+                callers[i].join();
+
+            queue.stop();
+            dropped = queue.getDroppedCount();
+        }
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // percentiles of all callers together
+        size_t p50 = latencies.size() / 2, p99 = latencies.size() * 99 / 100;
+        std::nth_element(latencies.begin(), latencies.begin() + p50, latencies.end());
+        float latency50 = latencies[p50];
+        std::nth_element(latencies.begin(), latencies.begin() + p99, latencies.end());
+        float latency99 = latencies[p99];
+        float latencyMax = *std::max_element(latencies.begin() + p99, latencies.end());
+
+        int sent = messageCount * LOG_THREADS;
+        char wait[16];
+        snprintf(wait, sizeof(wait), "%d ms", pass == 0 ? LOG_FULL_WAIT : 0);
+        printf("%-10s %9d %9d %9lld %9d %10.1f %9.0f %9.0f %9.0f\n", wait, sent, sink.received,
+               (long long)dropped, sink.outOfOrder, time, latency50, latency99, latencyMax / 1000);
+        if(sink.outOfOrder > 0)
+        {
+            printf("  FAILED: %d messages out of order\n", sink.outOfOrder);
+            ++failures;
+        }
+        if(sink.received + dropped != sent)
+        {
+            printf("  FAILED: %lld messages neither received nor counted as dropped\n",
+                   (long long)(sent - sink.received - dropped));
+            ++failures;
+        }
+        if(pass == 0 && dropped > 0)
+        {
+            printf("  FAILED: %lld messages dropped while waiting for space\n", (long long)dropped);
+            ++failures;
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// symmetric projection of one eye, 90 degrees vertical field of view
+///////////////////////////////////////////////////////////////////////////////
+static Matrix4 eyeProjection(int eyeWidth, int height)
+{
+    float aspect = (float)eyeWidth / height;
+    float n = REPROJECT_NEAR, f = REPROJECT_FAR;
+    float m[16] = { 1 / aspect, 0, 0, 0,
+                    0, 1, 0, 0,
+                    0, 0, -(f + n) / (f - n), -1,
+                    0, 0, -2 * f * n / (f - n), 0 };
+    return Matrix4(m);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// every source pixel has its own color and the depth of a plane in front of
+// the eyes, so the source pixel of each output pixel is known: the same
+// pixel when the matrices are the same, and the pixel MOVE / DEPTH of the
+// half height to the right when the head moved MOVE to the right
+///////////////////////////////////////////////////////////////////////////////
+static int reproject(int warps)
+{
+    const int width = REPROJECT_WIDTH, height = REPROJECT_HEIGHT;
+    const int eyeX[2] = { 0, width / 2 };
+    const int eyeWidth[2] = { width / 2, width - width / 2 };
+
+    StereoReprojector reprojector;
+    reprojector.setSourceSize(width, height);
+
+    // window depth of the plane, the same for both projections
+    float n = REPROJECT_NEAR, f = REPROJECT_FAR, d = REPROJECT_DEPTH;
+    float depth = ((f + n) / (f - n) * d - 2 * f * n / (f - n)) / d * 0.5f + 0.5f;
+    unsigned int* color = reprojector.getSourceColor();
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            color[y * width + x] = 0xff000000 | (y << 12) | x;
+            reprojector.getSourceDepth()[y * width + x] = depth;
+        }
+    }
+
+    Matrix4 view[2], projection[2];
+    for(int eye = 0; eye < 2; ++eye)
+    {
+        view[eye].translate(eye == 0 ? PUPIL_DISTANCE / 2 : -PUPIL_DISTANCE / 2, 0, 0);
+        projection[eye] = eyeProjection(eyeWidth[eye], height);
+        reprojector.setSourceEye(eye, eyeX[eye], eyeWidth[eye], view[eye], projection[eye]);
+    }
+
+    printf("%-10s %6s %10s %8s %8s %8s\n", "warp", "shift", "pixels", "wrong", "ms", "ms/MP");
+    int failures = 0;
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        float move = pass == 0 ? 0 : REPROJECT_MOVE;
+        int shift = (int)std::lround(move / d * height / 2);
+        Matrix4 moved[2];
+        for(int eye = 0; eye < 2; ++eye)
+        {
+            moved[eye] = view[eye];
+            moved[eye].translate(-move, 0, 0);
+        }
+
+        double time = 0;
+        for(int i = 0; i < warps; ++i)
+        {
+            if(!reprojector.warp(moved[0], projection[0], moved[1], projection[1]))
+            {
+                printf("  FAILED: the source is not ready\n");
+                printf("FAILED\n");
+                return 1;
+            }
+            time += reprojector.getLastWarpTime();
+        }
+
+        // columns whose source is in the eye, the others are clamped to its edge
+        const unsigned int* output = reprojector.getOutputColor();
+        int pixels = 0, wrong = 0;
+        for(int eye = 0; eye < 2; ++eye)
+        {
+            for(int y = 0; y < height; ++y)
+            {
+                for(int x = 0; x < eyeWidth[eye] - shift; ++x)
+                {
+                    const int i = y * width + eyeX[eye] + x;
+                    if(output[i] != color[i + shift])
+                        ++wrong;
+                    ++pixels;
+                }
+            }
+        }
+
+        time /= warps;
+        printf("%-10s %6d %10d %8d %8.2f %8.2f\n", pass == 0 ? "identity" : "head move",
+               shift, pixels, wrong, time, time * 1000000.0 / ((double)width * height));
+        if(wrong > 0)
+        {
+            printf("  FAILED: %d pixels are not the source pixel %d to the right\n", wrong, shift);
+            ++failures;
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// all records of a file of TrackingRecorder
+///////////////////////////////////////////////////////////////////////////////
+static bool loadRecording(const char* fileName, std::vector<TrackingPose>& trajectory)
+{
+    TrackingReplay replay;
+    if(!replay.open(fileName))
+        return false;
+
+    trajectory.resize((size_t)replay.getRecordCount());
+    for(int64_t i = 0; i < replay.getRecordCount(); ++i)
+    {
+        if(!replay.getRecord(i, trajectory[(size_t)i]))
+            return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the default trajectory of the simulator sampled at the tracker rate, the
+// timestamps are the sample times
+///////////////////////////////////////////////////////////////////////////////
+static void sampleTrajectory(std::vector<TrackingPose>& trajectory)
+{
+    f3d::sim::ProceduralTrajectory path;
+    double rate = f3d::sim::getConfig().rate;
+    int count = (int)(PREDICT_DURATION * rate);
+
+    trajectory.resize(count);
+    for(int i = 0; i < count; ++i)
+    {
+        double time = i / rate;
+        f3d::sim::Pose p = path.evaluate(time);
+        TrackingPose& pose = trajectory[i];
+        memset(&pose, 0, sizeof(pose));
+        pose.glassPosition = p.glassPosition;
+        pose.glassRotation = p.glassRotation;
+        pose.glassStatus = p.glassVisible ? 1 : 0;
+        pose.penPosition = p.penPosition;
+        pose.penDirection = p.penDirection;
+        pose.penRoll = p.penRoll;
+        pose.penKey = p.penKey;
+        pose.penStatus = p.penVisible ? 1 : 0;
+        pose.timestamp = (int64_t)(time * 1000000);
+        pose.sequence = (uint32_t)i;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// error of each prediction method against the pose at t + look-ahead
+///////////////////////////////////////////////////////////////////////////////
+static int predict(const char* fileName)
+{
+    std::vector<TrackingPose> trajectory;
+    if(fileName)
+    {
+        if(!loadRecording(fileName, trajectory))
+        {
+            printf("FAILED: cannot read %s\n", fileName);
+            return 1;
+        }
+    }
+    else
+    {
+        sampleTrajectory(trajectory);
+    }
+    printf("%s: %d samples, %.1f s\n", fileName ? fileName : "simulator", (int)trajectory.size(),
+           trajectory.empty() ? 0.0 : (trajectory.back().timestamp - trajectory.front().timestamp) * 1e-6);
+
+    static const char* const names[] = { "none", "double exp", "kalman" };
+    std::vector<int64_t> lookAheads(PREDICT_LOOK_AHEADS, PREDICT_LOOK_AHEADS + sizeof(PREDICT_LOOK_AHEADS) / sizeof(PREDICT_LOOK_AHEADS[0]));
+    std::vector<PredictionError> errors[3];
+
+    printf("%-11s %6s %7s %10s %10s %9s %9s %8s\n", "method", "ahead", "count", "mean mm", "max mm",
+           "mean deg", "max deg", "us/call");
+    int failures = 0;
+    for(int method = 0; method < 3; ++method)
+    {
+        errors[method] = evaluatePrediction(trajectory, lookAheads, PosePredictor((PosePredictor::Method)method));
+        for(size_t i = 0; i < errors[method].size(); ++i)
+        {
+            const PredictionError& e = errors[method][i];
+            printf("%-11s %6.0f %7d %10.3f %10.3f %9.3f %9.3f %8.3f\n", names[method], e.lookAhead * 0.001,
+                   e.count, e.meanPosition * 1000, e.maxPosition * 1000, e.meanAngle, e.maxAngle, e.cpuTimePerSample);
+            if(e.count == 0)
+            {
+                printf("  FAILED: no recorded pose %lld us after a sample\n", (long long)e.lookAhead);
+                ++failures;
+            }
+            if(!fileName && method > 0 && e.lookAhead >= PREDICT_MIN_LOOK_AHEAD &&
+               e.meanPosition >= errors[0][i].meanPosition)
+            {
+                printf("  FAILED: mean error is not less than %.3f mm without prediction\n", errors[0][i].meanPosition * 1000);
+                ++failures;
+            }
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// per frame numbers of StrokeRenderer::upload() and draw()
+///////////////////////////////////////////////////////////////////////////////
+struct StrokeFrames
+{
+    int frames;
+    int maxDrawCalls;
+    long long bytes;            // of all frames
+    long long maxBytes;         // of one frame
+    long long largestUpload;    // of one call
+    long long unreported;       // bytes given to GL but not returned by upload()
+    int wrongDrawCalls;         // frames without one draw call per chunk
+    double time;                // ms of upload() and draw()
+};
+
+static void drawStrokes(const StrokePool& pool, StrokeRenderer& renderer, StrokeFrames& stats)
+{
+    mockgl::clearCounters();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int bytes = renderer.upload(pool);
+    renderer.draw(pool);
+    stats.time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ++stats.frames;
+    stats.bytes += bytes;
+    stats.maxBytes = std::max(stats.maxBytes, (long long)bytes);
+    stats.largestUpload = std::max(stats.largestUpload, mockgl::getLargestUpload());
+    stats.unreported += mockgl::getUploadBytes() - bytes;
+    stats.maxDrawCalls = std::max(stats.maxDrawCalls, mockgl::getDrawCalls());
+    if(mockgl::getDrawCalls() != pool.getChunkCount() || renderer.getLastDrawCalls() != pool.getChunkCount())
+        ++stats.wrongDrawCalls;
+}
+
+// a stroke along an arc, every sample 2 cm from the previous one
+static float random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (seed >> 8) / 16777216.0f;
+}
+
+static void addStroke(StrokePool& pool, uint32_t& seed, int samples, float space = STROKE_SPACE,
+                      std::vector<Vector3>* points = 0)
+{
+    float center[3], angle;
+    for(int i = 0; i < 3; ++i)
+        center[i] = (random(seed) - 0.5f) * space;
+    seed = seed * 1664525 + 1013904223;
+    angle = (seed >> 8) / 16777216.0f * 6.2831853f;
+
+    pool.beginStroke((unsigned char)seed, (unsigned char)(seed >> 8), (unsigned char)(seed >> 16));
+    for(int i = 0; i < samples; ++i, angle += STROKE_STEP)
+    {
+        Vector3 point(center[0] + STROKE_RADIUS * cosf(angle), center[1] + STROKE_RADIUS * sinf(angle), center[2]);
+        pool.addPoint(point, Vector3(0, 0, -1));
+        if(points)
+            points->push_back(point);
+    }
+    pool.endStroke();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// fill a pool that never recycles a chunk, drawing a frame every 1000 strokes,
+// then draw frames while one more stroke grows: these frames must upload only
+// its new vertices, never a chunk again
+///////////////////////////////////////////////////////////////////////////////
+static int strokes(int strokeCount)
+{
+    mockgl::reset();
+    StrokePool pool(StrokePool::MAX_CHUNKS);
+    pool.setTolerance(0);
+    StrokeRenderer renderer;
+    if(!renderer.init())
+    {
+        printf("FAILED: no GL_ARB_vertex_buffer_object\n");
+        return 1;
+    }
+
+    StrokeFrames fill, steady;
+    memset(&fill, 0, sizeof(fill));
+    memset(&steady, 0, sizeof(steady));
+    uint32_t seed = 1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < strokeCount; ++i)
+    {
+        addStroke(pool, seed, STROKE_SAMPLES);
+        if((i + 1) % STROKES_PER_FRAME == 0 || i + 1 == strokeCount)
+            drawStrokes(pool, renderer, fill);
+    }
+    double fillTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() - fill.time;
+
+    // one more stroke, 2 samples per frame like a 120 Hz tracker at 60 fps
+    pool.beginStroke(255, 255, 255);
+    for(int i = 0; i < STROKE_STEADY_FRAMES; ++i)
+    {
+        float angle = i * 2 * STROKE_STEP;
+        pool.addPoint(Vector3(STROKE_RADIUS * cosf(angle), STROKE_RADIUS * sinf(angle), 0), Vector3(0, 0, -1));
+        pool.addPoint(Vector3(STROKE_RADIUS * cosf(angle + STROKE_STEP), STROKE_RADIUS * sinf(angle + STROKE_STEP), 0), Vector3(0, 0, -1));
+        drawStrokes(pool, renderer, steady);
+    }
+    pool.endStroke();
+    renderer.release();
+
+    const long long chunkBytes = (long long)StrokePool::CHUNK_VERTICES * sizeof(StrokeVertex);
+    printf("%d strokes, %lld points, %lld vertices, %d chunks, %.1f ns/point to add (%.0f MB)\n",
+           pool.getStrokeCount(), (long long)pool.getPointCount(), (long long)pool.getVertexCount(),
+           pool.getChunkCount(), fillTime * 1000000.0 / std::max(pool.getPointCount(), (int64_t)1),
+           pool.getVertexCount() * sizeof(StrokeVertex) / 1048576.0);
+    printf("%-8s %7s %11s %12s %12s %14s %10s\n", "frames", "count", "draws/frame", "KB/frame", "max KB/frame",
+           "largest upload", "ms/frame");
+    const StrokeFrames* phases[] = { &fill, &steady };
+    for(int i = 0; i < 2; ++i)
+    {
+        const StrokeFrames& s = *phases[i];
+        printf("%-8s %7d %11d %12.1f %12.1f %14lld %10.3f\n", i == 0 ? "fill" : "steady", s.frames, s.maxDrawCalls,
+               s.bytes / 1024.0 / std::max(s.frames, 1), s.maxBytes / 1024.0, s.largestUpload, s.time / std::max(s.frames, 1));
+    }
+
+    int failures = 0;
+    if(pool.getRecycledChunkCount() > 0 || pool.getPointCount() != (int64_t)strokeCount * STROKE_SAMPLES + STROKE_STEADY_FRAMES * 2)
+    {
+        printf("  FAILED: %d chunks recycled, %lld points of %lld samples kept\n", pool.getRecycledChunkCount(),
+               (long long)pool.getPointCount(), (long long)pool.getSampleCount());
+        ++failures;
+    }
+    if(fill.wrongDrawCalls + steady.wrongDrawCalls > 0)
+    {
+        printf("  FAILED: %d frames without one draw call per chunk\n", fill.wrongDrawCalls + steady.wrongDrawCalls);
+        ++failures;
+    }
+    if(fill.unreported + steady.unreported != 0)
+    {
+        printf("  FAILED: %lld bytes uploaded but not reported by upload()\n", fill.unreported + steady.unreported);
+        ++failures;
+    }
+    if(fill.bytes != pool.getVertexCount() * (long long)sizeof(StrokeVertex) - steady.bytes)
+    {
+        printf("  FAILED: %lld bytes uploaded while filling, the vertices are %lld bytes\n", fill.bytes,
+               pool.getVertexCount() * (long long)sizeof(StrokeVertex) - steady.bytes);
+        ++failures;
+    }
+    if(steady.maxBytes >= chunkBytes || steady.largestUpload >= chunkBytes)
+    {
+        printf("  FAILED: a frame of the growing stroke uploads %lld bytes, a chunk is %lld\n",
+               std::max(steady.maxBytes, steady.largestUpload), chunkBytes);
+        ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// nearest stroke of a pick by distance to every segment, as pickStroke() does
+// it with the segments of the grid cells around the pick
+///////////////////////////////////////////////////////////////////////////////
+static float segmentDistance(const Vector3& p, const Vector3& a, const Vector3& b)
+{
+    Vector3 ab = b - a;
+    float length2 = ab.dot(ab);
+    float t = length2 > 0 ? (p - a).dot(ab) / length2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    return (p - (a + ab * t)).length();
+}
+
+static float strokeDistance(const std::vector<Vector3>& points, int stroke, const Vector3& p)
+{
+    float nearest = 1e30f;
+    for(int i = stroke * STROKE_SAMPLES + 1; i < (stroke + 1) * STROKE_SAMPLES; ++i)
+        nearest = std::min(nearest, segmentDistance(p, points[i - 1], points[i]));
+    return nearest;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// strokes with every sample kept, so their segments are known here; picks
+// near random samples are checked against every segment, then timed, then
+// erases are timed and nothing may be left to pick where one erased
+///////////////////////////////////////////////////////////////////////////////
+static int strokeGrid(int strokeCount)
+{
+    StrokePool pool(StrokePool::MAX_CHUNKS);
+    pool.setTolerance(0);
+    std::vector<Vector3> points;
+    points.reserve((size_t)strokeCount * STROKE_SAMPLES);
+
+    uint32_t seed = 1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < strokeCount; ++i)
+        addStroke(pool, seed, STROKE_SAMPLES, GRID_SPACE, &points);
+    double addTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    const StrokeGrid& grid = pool.getGrid();
+    int64_t pointCount = pool.getPointCount();
+    printf("%-8s %9s %10s %10s %10s %9s %10s\n", "strokes", "points", "ns/sample", "vertex B/p", "grid B/p",
+           "cells", "refs/seg");
+    printf("%-8d %9lld %10.1f %10.1f %10.1f %9d %10.2f\n", pool.getStrokeCount(), (long long)pointCount,
+           addTime / std::max(pool.getSampleCount(), (int64_t)1),
+           (double)pool.getVertexCount() * sizeof(StrokeVertex) / pointCount, (double)grid.getMemoryUsage() / pointCount,
+           grid.getCellCount(), (double)grid.getReferenceCount() / (pointCount - pool.getStrokeCount()));
+
+    // the stroke ids are 0 to strokeCount - 1 in the order they were added
+    int failures = 0, hits = 0, wrong = 0;
+    float reach = GRID_PICK_RADIUS + pool.getRibbonWidth() * 0.5f;
+    std::vector<Vector3> picks;
+    for(int i = 0; i < GRID_CHECKED_PICKS + GRID_TIMED_PICKS + GRID_ERASES; ++i)
+    {
+        const Vector3& sample = points[(size_t)(random(seed) * (points.size() - 1))];
+        float x = (random(seed) * 2 - 1) * GRID_PICK_OFFSET;
+        float y = (random(seed) * 2 - 1) * GRID_PICK_OFFSET;
+        float z = (random(seed) * 2 - 1) * GRID_PICK_OFFSET;
+        picks.push_back(sample + Vector3(x, y, z));
+    }
+
+    for(int i = 0; i < GRID_CHECKED_PICKS; ++i)
+    {
+        float distance = 0;
+        int picked = pool.pickStroke(picks[i], GRID_PICK_RADIUS, &distance);
+        int nearest = -1;
+        float nearestDistance = 1e30f;
+        for(int j = 0; j < strokeCount; ++j)
+        {
+            float d = strokeDistance(points, j, picks[i]);
+            if(d < nearestDistance)
+            {
+                nearestDistance = d;
+                nearest = j;
+            }
+        }
+        if(nearestDistance > reach + GRID_TOLERANCE)
+            nearest = -1;
+
+        // a different stroke at the same distance is as good
+        bool same = picked == nearest ||
+                    (picked >= 0 && nearest >= 0 && strokeDistance(points, picked, picks[i]) <= nearestDistance + GRID_TOLERANCE) ||
+                    (picked < 0 && nearestDistance > reach - GRID_TOLERANCE);
+        if(picked >= 0)
+            ++hits;
+        if(!same)
+        {
+            if(wrong < 5)
+                printf("  pick %d at (%g, %g, %g): stroke %d at %g, every segment: stroke %d at %g\n", i,
+                       picks[i].x, picks[i].y, picks[i].z, picked, distance, nearest, nearestDistance);
+            ++wrong;
+        }
+    }
+
+    start = std::chrono::steady_clock::now();
+    int timedHits = 0;
+    for(int i = GRID_CHECKED_PICKS; i < GRID_CHECKED_PICKS + GRID_TIMED_PICKS; ++i)
+    {
+        if(pool.pickStroke(picks[i], GRID_PICK_RADIUS) >= 0)
+            ++timedHits;
+    }
+    double pickTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    int erased = 0, left = 0;
+    double eraseTime = 0;
+    for(int i = GRID_CHECKED_PICKS + GRID_TIMED_PICKS; i < (int)picks.size(); ++i)
+    {
+        start = std::chrono::steady_clock::now();
+        erased += pool.eraseStrokes(picks[i], GRID_PICK_RADIUS);
+        eraseTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if(pool.pickStroke(picks[i], GRID_PICK_RADIUS) >= 0)
+            ++left;
+    }
+
+    printf("%-8s %9s %10s %10s %10s\n", "picks", "hits", "us/pick", "erases", "us/erase");
+    printf("%-8d %9d %10.3f %10d %10.3f  (%d strokes erased)\n", GRID_TIMED_PICKS, timedHits,
+           pickTime / GRID_TIMED_PICKS, GRID_ERASES, eraseTime / GRID_ERASES, erased);
+    printf("%d picks against every segment: %d hits, %d different\n", GRID_CHECKED_PICKS, hits, wrong);
+
+    if(wrong > 0)
+    {
+        printf("  FAILED: %d of %d picks differ from the search of every segment\n", wrong, GRID_CHECKED_PICKS);
+        ++failures;
+    }
+    if(hits == 0 || hits == GRID_CHECKED_PICKS)
+    {
+        printf("  FAILED: %d of %d picks hit a stroke, both hits and misses are needed\n", hits, GRID_CHECKED_PICKS);
+        ++failures;
+    }
+    if(left > 0)
+    {
+        printf("  FAILED: a stroke is left to pick after %d of %d erases\n", left, GRID_ERASES);
+        ++failures;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the simulator trajectory with noise, as the tracking thread sees it: each
+// tracker frame is polled several times, and the tracker stops once
+///////////////////////////////////////////////////////////////////////////////
+static void sampleNoisyTrace(double seconds, std::vector<TrackingPose>& trace)
+{
+    std::vector<TrackingPose> frames;
+    sampleTrajectory(frames);
+    double rate = f3d::sim::getConfig().rate;
+    int count = std::min((int)(seconds * rate), (int)frames.size());
+    int64_t gap = (int64_t)(FILTER_GAP_TIME * 1000000);
+    int64_t poll = (int64_t)(1000000 / rate / FILTER_POLLS);
+
+    uint32_t seed = 1;
+    trace.clear();
+    for(int i = 0; i < count; ++i)
+    {
+        TrackingPose pose = frames[i];
+        if(pose.timestamp >= gap && pose.timestamp < gap + 1000000)
+            continue;
+        pose.glassPosition.x += (random(seed) - 0.5f) * FILTER_NOISE;
+        pose.glassPosition.y += (random(seed) - 0.5f) * FILTER_NOISE;
+        pose.glassPosition.z += (random(seed) - 0.5f) * FILTER_NOISE;
+        pose.penPosition.x += (random(seed) - 0.5f) * FILTER_NOISE;
+        pose.penPosition.y += (random(seed) - 0.5f) * FILTER_NOISE;
+        pose.penPosition.z += (random(seed) - 0.5f) * FILTER_NOISE;
+        for(int j = 0; j < FILTER_POLLS; ++j)
+        {
+            trace.push_back(pose);
+            pose.timestamp += poll;
+        }
+    }
+}
+
+static float getDifference(const TrackingPose& a, const TrackingPose& b)
+{
+    const float values[][2] = {
+        { a.glassPosition.x, b.glassPosition.x }, { a.glassPosition.y, b.glassPosition.y }, { a.glassPosition.z, b.glassPosition.z },
+        { a.glassRotation.x, b.glassRotation.x }, { a.glassRotation.y, b.glassRotation.y }, { a.glassRotation.z, b.glassRotation.z },
+        { a.glassRotation.w, b.glassRotation.w }, { a.penPosition.x, b.penPosition.x }, { a.penPosition.y, b.penPosition.y },
+        { a.penPosition.z, b.penPosition.z }, { a.penDirection.x, b.penDirection.x }, { a.penDirection.y, b.penDirection.y },
+        { a.penDirection.z, b.penDirection.z } };
+    float difference = 0;
+    for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+        difference = std::max(difference, fabsf(values[i][0] - values[i][1]));
+    return difference;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// run the same trace through filterTrace() and through one OneEuroFilter per
+// parameter set, the 4 sets of the SSE path and the 2 of its scalar path
+// must give the output of filter()
+///////////////////////////////////////////////////////////////////////////////
+static int poseFilter(double seconds)
+{
+    std::vector<TrackingPose> trace;
+    sampleNoisyTrace(seconds, trace);
+
+    const int setCount = sizeof(FILTER_SCALES) / sizeof(FILTER_SCALES[0]);
+    std::vector<OneEuroFilter::Settings> sets(setCount, OneEuroFilter::getDefaultSettings());
+    for(int s = 0; s < setCount; ++s)
+        for(int c = 0; c < OneEuroFilter::CHANNEL_COUNT; ++c)
+            sets[s].params[c].minCutoff *= FILTER_SCALES[s];
+
+    std::vector<std::vector<TrackingPose> > outputs;
+    std::vector<OneEuroReport> reports;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    filterTrace(trace, sets, outputs, reports);
+    double traceTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d poses, %.1f s\n", (int)trace.size(), trace.back().timestamp / 1000000.0);
+    printf("%-9s %12s %12s %12s %12s %14s\n", "minCutoff", "lag ms", "jitter", "max diff", "ns/pose", "ns/pose trace");
+    int failures = 0;
+    for(int s = 0; s < setCount; ++s)
+    {
+        OneEuroFilter filter;
+        filter.setSettings(sets[s]);
+        float difference = 0;
+        int differing = 0;
+        start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < trace.size(); ++i)
+        {
+            float d = getDifference(filter.filter(trace[i]), outputs[s][i]);
+            difference = std::max(difference, d);
+            if(d > FILTER_TOLERANCE)
+                ++differing;
+        }
+        double scalarTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        const OneEuroReport& r = reports[s];
+        printf("%-9.3f %12.2f %12.3f %12.2e %12.1f %14.1f\n", sets[s].params[0].minCutoff,
+               r.latency[OneEuroFilter::CHANNEL_GLASS_POSITION] * 1000, r.jitter[OneEuroFilter::CHANNEL_GLASS_POSITION],
+               difference, scalarTime / trace.size(), traceTime / setCount / trace.size());
+        if(differing > 0)
+        {
+            printf("  FAILED: %d poses differ by more than %g from filter()\n", differing, FILTER_TOLERANCE);
+            ++failures;
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// what one reader process of -poseshm measured, printed as one line
+///////////////////////////////////////////////////////////////////////////////
+struct ShmReaderResult
+{
+    long long reads;
+    long long seen;
+    long long retries;
+    long long torn;         // poses whose values are not the ones of their sequence
+    double latencySum;      // microseconds
+    double latency99;
+    double latencyMax;
+};
+
+// poll the ring until its server closes it, like a thread of benchmarkPoseShm()
+static bool readPoseShm(const char* name, double seconds, ShmReaderResult& result)
+{
+    memset(&result, 0, sizeof(result));
+    int64_t deadline = getTrackingTime() + (int64_t)((seconds + SHM_TIMEOUT) * 1000000);
+    PoseClient client;
+    while(!client.open(name))
+    {
+        if(getTrackingTime() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    printf("ready\n");
+    fflush(stdout);
+
+    std::vector<long long> histogram(SHM_LATENCY_BUCKETS, 0);
+    TrackingPose pose;
+    while(client.isProducerRunning())
+    {
+        if((++result.reads & 1023) == 0 && getTrackingTime() > deadline)
+            return false;
+        if(!client.getPose(pose))
+            continue;
+
+        double latency = (double)(getTrackingTime() - pose.timestamp);
+        ++result.seen;
+        if(pose.glassPosition.x != (float)pose.sequence)
+            ++result.torn;
+        result.latencySum += latency;
+        result.latencyMax = std::max(result.latencyMax, latency);
+        ++histogram[std::max(std::min((int)latency, SHM_LATENCY_BUCKETS - 1), 0)];
+    }
+    result.retries = client.getRetryCount();
+
+    long long count = 0;
+    for(int k = 0; k < SHM_LATENCY_BUCKETS && result.seen > 0; ++k)
+    {
+        count += histogram[k];
+        if(count * 100 >= result.seen * 99)
+        {
+            result.latency99 = k + 1;
+            break;
+        }
+    }
+    return true;
+}
+
+// -posereader: the child process of -poseshm
+static int poseReader(const char* name, double seconds)
+{
+    ShmReaderResult r;
+    if(!readPoseShm(name, seconds, r))
+        return 1;
+    printf("%lld %lld %lld %lld %.17g %.17g %.17g\n", r.reads, r.seen, r.retries, r.torn,
+           r.latencySum, r.latency99, r.latencyMax);
+    return 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkPoseShm() with reader processes instead of threads: the readers
+// are this program started with -posereader, and report through a pipe
+// The timestamps are of the steady clock, the same in every process.
+///////////////////////////////////////////////////////////////////////////////
+static bool benchmarkPoseShmProcesses(const char* self, int readers, double seconds, double rate,
+                                      PoseShmBenchmark& result, long long& torn)
+{
+    memset(&result, 0, sizeof(result));
+    result.readers = readers;
+    torn = 0;
+
+    PoseServer server;
+    if(!server.open(SHM_NAME))
+        return false;
+
+    char command[1024];
+    snprintf(command, sizeof(command), "\"%s\" -posereader %s %g", self, SHM_NAME, seconds);
+    std::vector<FILE*> pipes;
+    bool started = true;
+    char line[256];
+    for(int i = 0; i < readers && started; ++i)
+    {
+        FILE* pipe = popen(command, "r");
+        if(pipe)
+            pipes.push_back(pipe);
+        else
+            started = false;
+    }
+    for(size_t i = 0; i < pipes.size() && started; ++i)
+        started = fgets(line, sizeof(line), pipes[i]) && strncmp(line, "ready", 5) == 0;
+
+    // publish from this process, the same way benchmarkPoseShm() does
+    TrackingPose pose;
+    memset(&pose, 0, sizeof(pose));
+    int64_t period = rate > 0 ? (int64_t)(1000000 / rate) : 0;
+    int64_t start = getTrackingTime();
+    int64_t end = start + (int64_t)(seconds * 1000000);
+    int64_t next = start;
+    int64_t now = start;
+    while(started && now < end)
+    {
+        pose.sequence = server.getPublishedCount() + 1;
+        pose.glassPosition.x = (float)pose.sequence;
+        pose.timestamp = getTrackingTime();
+        server.publish(pose);
+
+        if(period > 0)
+        {
+            next += period;
+            std::this_thread::sleep_until(toTimePoint(next));
+        }
+        now = getTrackingTime();
+    }
+    double elapsed = (now - start) * 1e-6;
+    uint32_t published = server.getPublishedCount();
+    server.close();                                 // the readers stop and report
+
+    long long reads = 0, seen = 0, retries = 0;
+    double latencySum = 0;
+    for(size_t i = 0; i < pipes.size(); ++i)
+    {
+        ShmReaderResult r;
+        if(started && fgets(line, sizeof(line), pipes[i]) &&
+           sscanf(line, "%lld %lld %lld %lld %lf %lf %lf", &r.reads, &r.seen, &r.retries, &r.torn,
+                  &r.latencySum, &r.latency99, &r.latencyMax) == 7)
+        {
+            reads += r.reads;
+            seen += r.seen;
+            retries += r.retries;
+            torn += r.torn;
+            latencySum += r.latencySum;
+            result.latency99 = std::max(result.latency99, r.latency99);
+            result.latencyMax = std::max(result.latencyMax, r.latencyMax);
+            if(r.seen == 0)
+                started = false;
+        }
+        else
+        {
+            started = false;
+        }
+        pclose(pipes[i]);
+    }
+    if(!started || elapsed <= 0)
+        return false;
+
+    result.publishRate = published / elapsed;
+    result.readRate = reads / elapsed;
+    result.retryRatio = reads > 0 ? (double)retries / reads : 0;
+    result.latencyAverage = seen > 0 ? latencySum / seen : 0;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// the pose ring read by threads and by processes, at a tracker-like rate and
+// as fast as the server can publish
+// The p99 of the processes is the worst p99 of a reader.
+///////////////////////////////////////////////////////////////////////////////
+static int poseShm(const char* self, int readers, double seconds)
+{
+    printf("%d readers, %.1f s each\n", readers, seconds);
+    printf("%-9s %8s %12s %12s %10s %9s %9s %9s\n", "readers", "rate Hz", "publish/s", "reads/s",
+           "retries", "avg us", "p99 us", "max us");
+    int failures = 0;
+    for(int process = 0; process < 2; ++process)
+    {
+        for(size_t i = 0; i < sizeof(SHM_RATES) / sizeof(SHM_RATES[0]); ++i)
+        {
+            PoseShmBenchmark b;
+            long long torn = 0;
+            bool done = process ? benchmarkPoseShmProcesses(self, readers, seconds, SHM_RATES[i], b, torn)
+                                : benchmarkPoseShm(readers, seconds, SHM_RATES[i], b);
+            char rate[16] = "max";
+            if(SHM_RATES[i] > 0)
+                snprintf(rate, sizeof(rate), "%.0f", SHM_RATES[i]);
+            printf("%-9s %8s %12.0f %12.0f %10.2e %9.1f %9.0f %9.0f\n", process ? "processes" : "threads",
+                   rate, b.publishRate, b.readRate, b.retryRatio, b.latencyAverage, b.latency99, b.latencyMax);
+            if(!done)
+            {
+                printf("  FAILED: the ring could not be created, or a reader did not start or saw no pose\n");
+                ++failures;
+            }
+            if(torn > 0)
+            {
+                printf("  FAILED: %lld poses were read torn\n", torn);
+                ++failures;
+            }
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// cost of a VR frame per viewer count, 1 is drawVR(), more is drawMultiView()
+// The viewers other than the first are spectators beside it, no pose ring is
+// running.
+///////////////////////////////////////////////////////////////////////////////
+static int multiView(int frames)
+{
+    f3d::sim::setManualClock(true);
+    f3d::sim::setTime(SIM_TIME);
+    mockgl::reset();
+
+    ModelGL model;
+    model.init();
+    model.initShaders();
+    model.setWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    model.setVRMode(true);
+
+    printf("%-8s %10s %10s %10s %10s %8s %8s\n", "viewers", "us/frame", "us/viewer", "plan us", "shared us",
+           "draws", "vs 1");
+    int failures = 0;
+    double single = 0;
+    for(int count = 1; count <= MultiViewPlanner::MAX_VIEWERS; ++count)
+    {
+        model.setViewerCount(count);
+        for(int j = 0; j < GLSTATE_WARMUP_FRAMES; ++j)
+            model.draw();
+
+        double time = 0, planTime = 0, sharedTime = 0;
+        int64_t draws = 0;
+        for(int j = 0; j < frames; ++j)
+        {
+            f3d::sim::setTime(SIM_TIME + j * MULTIVIEW_FRAME_TIME);
+            mockgl::clearCounters();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            model.draw();
+            time += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            draws += mockgl::getDrawCalls();
+            if(count > 1)
+            {
+                planTime += model.getMultiViewPlanTime() * 1000;
+                sharedTime += model.getMultiViewSharedTime() * 1000;
+            }
+        }
+        time /= frames;
+        if(count == 1)
+            single = time;
+        printf("%-8d %10.1f %10.1f %10.1f %10.1f %8.1f %8.2f\n", count, time, time / count, planTime / frames,
+               sharedTime / frames, (double)draws / frames, single > 0 ? time / single : 0.0);
+
+        if(draws == 0)
+        {
+            printf("  FAILED: nothing was drawn\n");
+            ++failures;
+        }
+        if(count > 1 && model.getMultiViewCount() != count)
+        {
+            printf("  FAILED: %d viewers were planned\n", model.getMultiViewCount());
+            ++failures;
+        }
+        for(int v = 1; v < count && model.getMultiViewCount() == count; ++v)
+        {
+            if(isEqual(model.getMultiViewFrustum(v), model.getMultiViewFrustum(v - 1)))
+            {
+                printf("  FAILED: viewer %d has the frustum of viewer %d\n", v, v - 1);
+                ++failures;
+            }
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// main
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    if(argc >= 2 && strcmp(argv[1], "-glstate") == 0)
+        return glState(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_GLSTATE_FRAMES);
+    if(argc >= 2 && strcmp(argv[1], "-scheduler") == 0)
+        return scheduler(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_SCHEDULER_FRAMES);
+    if(argc >= 2 && strcmp(argv[1], "-pose") == 0)
+        return pose(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_POSE_FRAMES);
+    if(argc >= 2 && strcmp(argv[1], "-frustum") == 0)
+        return frustum(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_FRUSTUM_POSES);
+    if(argc >= 2 && strcmp(argv[1], "-triplebuffer") == 0)
+        return tripleBuffer(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_TRIPLE_BUFFER_READS);
+    if(argc >= 2 && strcmp(argv[1], "-scene") == 0)
+        return scene(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_SCENE_COMMANDS);
+    if(argc >= 2 && strcmp(argv[1], "-logqueue") == 0)
+        return logQueue(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_LOG_MESSAGES);
+    if(argc >= 2 && strcmp(argv[1], "-reproject") == 0)
+        return reproject(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_REPROJECT_WARPS);
+    if(argc >= 2 && strcmp(argv[1], "-predict") == 0)
+        return predict(argc >= 3 ? argv[2] : 0);
+    if(argc >= 2 && strcmp(argv[1], "-strokes") == 0)
+        return strokes(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_STROKES);
+    if(argc >= 2 && strcmp(argv[1], "-strokegrid") == 0)
+        return strokeGrid(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_GRID_STROKES);
+    if(argc >= 2 && strcmp(argv[1], "-posefilter") == 0)
+        return poseFilter(argc >= 3 ? std::max(atof(argv[2]), 1.0) : DEFAULT_FILTER_SECONDS);
+    if(argc >= 2 && strcmp(argv[1], "-poseshm") == 0)
+        return poseShm(argv[0], argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_SHM_READERS,
+                       argc >= 4 ? std::max(atof(argv[3]), 0.1) : DEFAULT_SHM_SECONDS);
+    if(argc >= 4 && strcmp(argv[1], "-posereader") == 0)
+        return poseReader(argv[2], atof(argv[3]));
+    if(argc >= 2 && strcmp(argv[1], "-multiview") == 0)
+        return multiView(argc >= 3 ? std::max(atoi(argv[2]), 1) : DEFAULT_MULTIVIEW_FRAMES);
+
+    fprintf(stderr, "usage: oglMRCheck -glstate [frames]\n"
+                    "       oglMRCheck -scheduler [frames]\n"
+                    "       oglMRCheck -pose [frames]\n"
+                    "       oglMRCheck -frustum [poses]\n"
+                    "       oglMRCheck -triplebuffer [reads]\n"
+                    "       oglMRCheck -scene [commands]\n"
+                    "       oglMRCheck -logqueue [messages]\n"
+                    "       oglMRCheck -reproject [warps]\n"
+                    "       oglMRCheck -predict [recording]\n"
+                    "       oglMRCheck -strokes [count]\n"
+                    "       oglMRCheck -strokegrid [count]\n"
+                    "       oglMRCheck -posefilter [seconds]\n"
+                    "       oglMRCheck -poseshm [readers] [seconds]\n"
+                    "       oglMRCheck -multiview [frames]\n");
+    return 1;
+}
@@ -12,6 +12,9 @@
 
 #include "procedure.h"
 #include "Controller.h"
+#include "../Common/Trace.h"
+
+static const char* getMessageName(UINT msg);
 
 ///////////////////////////////////////////////////////////////////////////////
 // Window Procedure
@@ -48,6 +51,7 @@ LRESULT CALLBACK Win::windowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
         return ::DefWindowProc(hwnd, msg, wParam, lParam);
 
     // route messages to the associated controller
+    TRACE_ZONE(getMessageName(msg));
     switch(msg)
     {
     case WM_CREATE:
@@ -233,6 +237,7 @@ INT_PTR CALLBACK Win::dialogProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     if(!ctrl)
         return false;
 
+    TRACE_ZONE(getMessageName(msg));
     switch(msg)
     {
     case WM_COMMAND:
@@ -293,3 +298,44 @@ INT_PTR CALLBACK Win::dialogProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
         return false;
     }
 }
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// name of a routed message for the trace, a string literal
+///////////////////////////////////////////////////////////////////////////////
+static const char* getMessageName(UINT msg)
+{
+    switch(msg)
+    {
+    case WM_CREATE:        return "WM_CREATE";
+    case WM_SIZE:          return "WM_SIZE";
+    case WM_ENABLE:        return "WM_ENABLE";
+    case WM_PAINT:         return "WM_PAINT";
+    case WM_COMMAND:       return "WM_COMMAND";
+    case WM_CLOSE:         return "WM_CLOSE";
+    case WM_DESTROY:       return "WM_DESTROY";
+    case WM_SYSCOMMAND:    return "WM_SYSCOMMAND";
+    case WM_CHAR:          return "WM_CHAR";
+    case WM_KEYDOWN:       return "WM_KEYDOWN";
+    case WM_SYSKEYDOWN:    return "WM_SYSKEYDOWN";
+    case WM_KEYUP:         return "WM_KEYUP";
+    case WM_SYSKEYUP:      return "WM_SYSKEYUP";
+    case WM_LBUTTONDOWN:   return "WM_LBUTTONDOWN";
+    case WM_LBUTTONUP:     return "WM_LBUTTONUP";
+    case WM_RBUTTONDOWN:   return "WM_RBUTTONDOWN";
+    case WM_RBUTTONUP:     return "WM_RBUTTONUP";
+    case WM_MBUTTONDOWN:   return "WM_MBUTTONDOWN";
+    case WM_MBUTTONUP:     return "WM_MBUTTONUP";
+    case WM_MOUSEHOVER:    return "WM_MOUSEHOVER";
+    case WM_MOUSELEAVE:    return "WM_MOUSELEAVE";
+    case WM_MOUSEMOVE:     return "WM_MOUSEMOVE";
+    case WM_MOUSEWHEEL:    return "WM_MOUSEWHEEL";
+    case WM_HSCROLL:       return "WM_HSCROLL";
+    case WM_VSCROLL:       return "WM_VSCROLL";
+    case WM_TIMER:         return "WM_TIMER";
+    case WM_NOTIFY:        return "WM_NOTIFY";
+    case WM_CONTEXTMENU:   return "WM_CONTEXTMENU";
+    default:               return "other message";
+    }
+}
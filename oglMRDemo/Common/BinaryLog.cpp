@@ -0,0 +1,586 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// BinaryLog.cpp
+// =============
+// Deferred-formatting log messages: format registry, formatting of recorded
+// arguments, binary log file writer and reader
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "BinaryLog.h"
+#include "wcharUtil.h"
+
+const int FORMAT_BLOCK_SIZE = 256;                  // formats per block of the registry
+const int FORMAT_BLOCK_COUNT = 256;
+const uint32_t MAX_ENTRY_BYTES = 1 << 20;           // larger entries are damage
+const size_t WRITE_BUFFER_RESERVE = 64 * 1024;
+const int NUMBER_LENGTH = 64;
+
+// registered formats in fixed blocks, so a reader never sees a block move
+static std::mutex formatLock;
+static LogFormat* formatBlocks[FORMAT_BLOCK_COUNT];
+static std::atomic<int> formatCount(0);
+
+static void appendCodePoint(std::string& out, uint32_t code);
+static void appendUtf16(std::string& out, const uint16_t* units, size_t count);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// format registry
+///////////////////////////////////////////////////////////////////////////////
+int registerLogFormat(const char* format, const char* file, int line)
+{
+    std::lock_guard<std::mutex> lock(formatLock);
+    int count = formatCount.load(std::memory_order_relaxed);
+    int block = count / FORMAT_BLOCK_SIZE;
+    if(block >= FORMAT_BLOCK_COUNT)
+        return 0;                                   // messages of id 0 are formatted as unknown
+    if(!formatBlocks[block])
+        formatBlocks[block] = new LogFormat[FORMAT_BLOCK_SIZE];
+
+    LogFormat& entry = formatBlocks[block][count % FORMAT_BLOCK_SIZE];
+    entry.format = format ? format : "";
+    entry.file = file ? file : "";
+    entry.line = line;
+    formatCount.store(count + 1, std::memory_order_release);
+    return count + 1;
+}
+
+int registerLogFormat(const wchar_t* format, const char* file, int line)
+{
+    std::string text;
+    if(format)
+        appendUtf8(text, format, wcslen(format));
+    return registerLogFormat(text.c_str(), file, line);
+}
+
+const LogFormat* getLogFormat(int id)
+{
+    if(id < 1 || id > formatCount.load(std::memory_order_acquire))
+        return 0;
+    return &formatBlocks[(id - 1) / FORMAT_BLOCK_SIZE][(id - 1) % FORMAT_BLOCK_SIZE];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// UTF-8 / UTF-16 / wchar_t
+///////////////////////////////////////////////////////////////////////////////
+static void appendCodePoint(std::string& out, uint32_t code)
+{
+    char bytes[4];
+    out.append(bytes, encodeUtf8(code, bytes));
+}
+
+static void appendUtf16(std::string& out, const uint16_t* units, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        uint32_t code = units[i];
+        if(code >= 0xd800 && code < 0xdc00 && i + 1 < count && units[i + 1] >= 0xdc00 && units[i + 1] < 0xe000)
+            code = 0x10000 + ((code - 0xd800) << 10) + (units[++i] - 0xdc00);
+        appendCodePoint(out, code);
+    }
+}
+
+void appendUtf8(std::string& out, const wchar_t* text, size_t length)
+{
+    const wchar_t* end = text + length;
+    while(text < end)
+        appendCodePoint(out, decodeWide(text, end));
+}
+
+void appendWide(std::wstring& out, const char* text, size_t length)
+{
+    const char* end = text + length;
+    while(text < end)
+    {
+        wchar_t units[2];
+        out.append(units, encodeWide(decodeUtf8(text, end), units));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// recorded arguments
+///////////////////////////////////////////////////////////////////////////////
+struct LogArg
+{
+    int type;
+    int64_t i;
+    uint64_t u;
+    double d;
+    std::string s;
+
+    int64_t toInt() const       { return type == LOG_ARG_DOUBLE ? (int64_t)d : (type == LOG_ARG_INT32 || type == LOG_ARG_INT64) ? i : (int64_t)u; }
+    uint64_t toUint() const     { return type == LOG_ARG_DOUBLE ? (uint64_t)d : (type == LOG_ARG_INT32 || type == LOG_ARG_INT64) ? (uint64_t)i : u; }
+    double toDouble() const     { return type == LOG_ARG_DOUBLE ? d : (type == LOG_ARG_INT32 || type == LOG_ARG_INT64) ? (double)i : (double)u; }
+};
+
+class LogArgReader
+{
+public:
+    LogArgReader(const void* data, size_t bytes) : p((const char*)data), end((const char*)data + bytes) {}
+
+    // next argument, false if there is none left or it is cut off
+    bool next(LogArg& arg)
+    {
+        if(p >= end)
+            return false;
+        arg.type = *p++;
+        switch(arg.type)
+        {
+        case LOG_ARG_INT32:
+        {
+            int32_t v;
+            if(!read(&v, sizeof(v)))
+                return false;
+            arg.i = v;
+            return true;
+        }
+        case LOG_ARG_UINT32:
+        {
+            uint32_t v;
+            if(!read(&v, sizeof(v)))
+                return false;
+            arg.u = v;
+            return true;
+        }
+        case LOG_ARG_INT64:
+            return read(&arg.i, sizeof(arg.i));
+        case LOG_ARG_UINT64:
+        case LOG_ARG_POINTER:
+            return read(&arg.u, sizeof(arg.u));
+        case LOG_ARG_DOUBLE:
+            return read(&arg.d, sizeof(arg.d));
+        case LOG_ARG_STRING:
+        case LOG_ARG_WSTRING:
+        {
+            uint16_t length;
+            if(!read(&length, sizeof(length)))
+                return false;
+            size_t bytes = arg.type == LOG_ARG_STRING ? length : length * sizeof(uint16_t);
+            if((size_t)(end - p) < bytes)
+                return false;
+            arg.s.clear();
+            if(arg.type == LOG_ARG_STRING)
+            {
+                arg.s.assign(p, length);
+            }
+            else
+            {
+                std::vector<uint16_t> units(length);
+                if(length)
+                    memcpy(units.data(), p, bytes);
+                appendUtf16(arg.s, units.data(), length);
+            }
+            p += bytes;
+            return true;
+        }
+        default:
+            p = end;                                // unknown tag, the rest cannot be parsed
+            return false;
+        }
+    }
+
+private:
+    bool read(void* value, size_t bytes)
+    {
+        if((size_t)(end - p) < bytes)
+            return false;
+        memcpy(value, p, bytes);
+        p += bytes;
+        return true;
+    }
+
+    const char* p;
+    const char* end;
+};
+
+// snprintf() of one conversion appended to text
+template<typename T>
+static void appendFormatted(std::string& text, const std::string& spec, T value)
+{
+    char buffer[NUMBER_LENGTH];
+    int length = snprintf(buffer, NUMBER_LENGTH, spec.c_str(), value);
+    if(length < 0)
+        return;
+    if(length < NUMBER_LENGTH)
+    {
+        text.append(buffer, length);
+        return;
+    }
+    size_t start = text.size();
+    text.resize(start + length + 1);
+    snprintf(&text[start], length + 1, spec.c_str(), value);
+    text.resize(start + length);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// expand the recorded arguments with the conversions of the format string
+// the value is converted to the type of the conversion, so the length
+// modifiers (l, ll, I64, h...) of the caller's platform do not matter
+///////////////////////////////////////////////////////////////////////////////
+void formatLogMessage(const char* format, const void* args, size_t bytes, std::string& text)
+{
+    LogArgReader reader(args, bytes);
+    LogArg arg;
+    std::string spec;
+    const char* f = format;
+    while(*f)
+    {
+        if(*f != '%')
+        {
+            const char* start = f;
+            while(*f && *f != '%')
+                ++f;
+            text.append(start, f - start);
+            continue;
+        }
+        if(f[1] == '%')
+        {
+            text += '%';
+            f += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        const char* start = f++;
+        spec = "%";
+        while(*f && strchr("-+ #0", *f))
+            spec += *f++;
+        if(*f == '*')
+        {
+            ++f;
+            char number[NUMBER_LENGTH];
+            snprintf(number, NUMBER_LENGTH, "%d", reader.next(arg) ? (int)arg.toInt() : 0);
+            spec += number;
+        }
+        while(*f >= '0' && *f <= '9')
+            spec += *f++;
+        if(*f == '.')
+        {
+            spec += *f++;
+            if(*f == '*')
+            {
+                ++f;
+                char number[NUMBER_LENGTH];
+                snprintf(number, NUMBER_LENGTH, "%d", reader.next(arg) ? (int)arg.toInt() : 0);
+                spec += number;
+            }
+            while(*f >= '0' && *f <= '9')
+                spec += *f++;
+        }
+        while(*f && strchr("hlLqjztwI", *f))
+        {
+            if(f[0] == 'I' && ((f[1] == '6' && f[2] == '4') || (f[1] == '3' && f[2] == '2')))
+                f += 2;
+            ++f;
+        }
+        char conversion = *f;
+        if(!conversion)
+        {
+            text.append(start);
+            break;
+        }
+        ++f;
+
+        if(conversion == 'n')
+            continue;
+        if(!reader.next(arg))
+        {
+            text += "<?>";
+            continue;
+        }
+
+        switch(conversion)
+        {
+        case 'd':
+        case 'i':
+            spec += "lld";
+            appendFormatted(text, spec, (long long)arg.toInt());
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            spec += "ll";
+            spec += conversion;
+            appendFormatted(text, spec, (unsigned long long)arg.toUint());
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec += conversion;
+            appendFormatted(text, spec, arg.toDouble());
+            break;
+        case 'c':
+        case 'C':
+            if(arg.type == LOG_ARG_STRING || arg.type == LOG_ARG_WSTRING)
+                text += arg.s;
+            else
+                appendCodePoint(text, (uint32_t)arg.toInt());
+            break;
+        case 's':
+        case 'S':
+            spec += 's';
+            if(arg.type == LOG_ARG_STRING || arg.type == LOG_ARG_WSTRING)
+            {
+                appendFormatted(text, spec, arg.s.c_str());
+            }
+            else
+            {
+                char number[NUMBER_LENGTH];
+                snprintf(number, NUMBER_LENGTH, "%lld", (long long)arg.toInt());
+                appendFormatted(text, spec, number);
+            }
+            break;
+        case 'p':
+            appendFormatted(text, std::string("0x%llx"), (unsigned long long)arg.toUint());
+            break;
+        default:
+            text.append(start, f - start);          // not a conversion, as written
+            break;
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryLogWriter
+///////////////////////////////////////////////////////////////////////////////
+BinaryLogWriter::BinaryLogWriter() : file(0), bytesWritten(0)
+{
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+    close();
+}
+
+bool BinaryLogWriter::open(const char* fileName, int64_t startTime, int64_t startClock)
+{
+    close();
+    file = fopen(fileName, "wb");
+    if(!file)
+        return false;
+
+    LogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LOG_FILE_MAGIC;
+    header.version = LOG_FILE_VERSION;
+    header.headerSize = sizeof(LogFileHeader);
+    header.entryHeaderSize = sizeof(LogEntryHeader);
+    header.startTime = startTime;
+    header.startClock = startClock;
+    fwrite(&header, sizeof(header), 1, file);
+
+    buffer.reserve(WRITE_BUFFER_RESERVE);
+    formatWritten.clear();
+    bytesWritten = sizeof(header);
+    return true;
+}
+
+void BinaryLogWriter::close()
+{
+    if(!file)
+        return;
+    flush();
+    fclose(file);
+    file = 0;
+}
+
+void BinaryLogWriter::writeMessage(int64_t time, int thread, const void* data, size_t bytes)
+{
+    uint32_t id;
+    if(!file || bytes < sizeof(id))
+        return;
+    memcpy(&id, data, sizeof(id));
+
+    // the format goes into the file before its first message
+    if(id >= formatWritten.size())
+        formatWritten.resize(id + 1, false);
+    if(!formatWritten[id])
+    {
+        formatWritten[id] = true;
+        const LogFormat* format = getLogFormat(id);
+        if(format)
+        {
+            uint32_t line = (uint32_t)format->line;
+            uint16_t fileLength = (uint16_t)std::min<size_t>(format->file.size(), 0xffff);
+            uint16_t formatLength = (uint16_t)std::min<size_t>(format->format.size(), 0xffff);
+            std::string entry;
+            entry.append((const char*)&id, sizeof(id));
+            entry.append((const char*)&line, sizeof(line));
+            entry.append((const char*)&fileLength, sizeof(fileLength));
+            entry.append((const char*)&formatLength, sizeof(formatLength));
+            entry.append(format->file, 0, fileLength);
+            entry.append(format->format, 0, formatLength);
+            writeEntry(LOG_ENTRY_FORMAT, time, 0, entry.data(), entry.size());
+        }
+    }
+
+    writeEntry(LOG_ENTRY_MESSAGE, time, thread, data, bytes);
+}
+
+void BinaryLogWriter::writeText(int64_t time, int thread, const wchar_t* text, size_t length)
+{
+    if(!file)
+        return;
+
+    units.clear();
+    for(size_t i = 0; i < length; ++i)
+    {
+        uint32_t code = (uint32_t)text[i];
+        if(code > 0xffff)
+        {
+            code -= 0x10000;
+            units.push_back((uint16_t)(0xd800 + (code >> 10)));
+            units.push_back((uint16_t)(0xdc00 + (code & 0x3ff)));
+        }
+        else
+        {
+            units.push_back((uint16_t)code);
+        }
+    }
+    writeEntry(LOG_ENTRY_TEXT, time, thread, units.data(), units.size() * sizeof(uint16_t));
+}
+
+void BinaryLogWriter::flush()
+{
+    if(!file || buffer.empty())
+        return;
+    fwrite(buffer.data(), 1, buffer.size(), file);
+    fflush(file);
+    bytesWritten += buffer.size();
+    buffer.clear();
+}
+
+void BinaryLogWriter::writeEntry(int kind, int64_t time, int thread, const void* data, size_t bytes)
+{
+    LogEntryHeader entry;
+    entry.kind = (uint16_t)kind;
+    entry.thread = (uint16_t)thread;
+    entry.bytes = (uint32_t)bytes;
+    entry.time = time;
+    buffer.insert(buffer.end(), (const char*)&entry, (const char*)&entry + sizeof(entry));
+    if(bytes)
+        buffer.insert(buffer.end(), (const char*)data, (const char*)data + bytes);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryLogReader
+///////////////////////////////////////////////////////////////////////////////
+BinaryLogReader::BinaryLogReader() : file(0), messageCount(0)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+BinaryLogReader::~BinaryLogReader()
+{
+    close();
+}
+
+bool BinaryLogReader::open(const char* fileName)
+{
+    close();
+    file = fopen(fileName, "rb");
+    if(!file)
+        return false;
+
+    if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != LOG_FILE_MAGIC ||
+       header.version != LOG_FILE_VERSION || header.headerSize < sizeof(header) ||
+       header.entryHeaderSize != sizeof(LogEntryHeader) || fseek(file, header.headerSize, SEEK_SET) != 0)
+    {
+        close();
+        return false;
+    }
+    formats.clear();
+    messageCount = 0;
+    return true;
+}
+
+void BinaryLogReader::close()
+{
+    if(file)
+        fclose(file);
+    file = 0;
+}
+
+bool BinaryLogReader::readLine(std::string& line)
+{
+    while(file)
+    {
+        LogEntryHeader entry;
+        if(fread(&entry, sizeof(entry), 1, file) != 1 || entry.bytes > MAX_ENTRY_BYTES)
+            return false;
+        payload.resize(entry.bytes);
+        if(entry.bytes && fread(&payload[0], 1, entry.bytes, file) != entry.bytes)
+            return false;
+
+        if(entry.kind == LOG_ENTRY_FORMAT)
+        {
+            uint32_t id, sourceLine;
+            uint16_t fileLength, formatLength;
+            const size_t fixed = sizeof(id) + sizeof(sourceLine) + sizeof(fileLength) + sizeof(formatLength);
+            if(entry.bytes < fixed)
+                return false;
+            memcpy(&id, &payload[0], sizeof(id));
+            memcpy(&fileLength, &payload[8], sizeof(fileLength));
+            memcpy(&formatLength, &payload[10], sizeof(formatLength));
+            if(entry.bytes < fixed + fileLength + formatLength || id > MAX_ENTRY_BYTES)
+                return false;
+            if(id >= formats.size())
+                formats.resize(id + 1);
+            formats[id].assign(&payload[fixed + fileLength], formatLength);
+            continue;
+        }
+        if(entry.kind != LOG_ENTRY_MESSAGE && entry.kind != LOG_ENTRY_TEXT)
+            continue;                               // from a newer writer
+
+        // time of day and thread
+        int64_t clock = header.startClock + (entry.time - header.startTime) / 1000000;
+        int milliseconds = (int)(((clock % 86400000) + 86400000) % 86400000);
+        char stamp[NUMBER_LENGTH];
+        snprintf(stamp, NUMBER_LENGTH, "%d:%02d:%02d.%03d [%d] ", milliseconds / 3600000, milliseconds / 60000 % 60,
+                 milliseconds / 1000 % 60, milliseconds % 1000, entry.thread);
+        line = stamp;
+
+        if(entry.kind == LOG_ENTRY_TEXT)
+        {
+            std::vector<uint16_t> units(entry.bytes / sizeof(uint16_t));
+            if(!units.empty())
+                memcpy(units.data(), payload.data(), units.size() * sizeof(uint16_t));
+            appendUtf16(line, units.data(), units.size());
+        }
+        else
+        {
+            uint32_t id = 0;
+            if(entry.bytes >= sizeof(id))
+                memcpy(&id, payload.data(), sizeof(id));
+            if(id < formats.size() && entry.bytes >= sizeof(id))
+                formatLogMessage(formats[id].c_str(), payload.data() + sizeof(id), entry.bytes - sizeof(id), line);
+            else
+                line += "<unknown format>";
+        }
+        ++messageCount;
+        return true;
+    }
+    return false;
+}
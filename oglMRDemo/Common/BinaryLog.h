@@ -0,0 +1,338 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// BinaryLog.h
+// ===========
+// Deferred-formatting log messages: the caller records the id of the format
+// string and the raw values of the arguments, and the formatting is done
+// later, by the writer thread of the log or by an offline decoder.
+//
+// A format string is registered once per call site (a function-local static
+// in the LOG_DEFERRED macro of Log.h) and gets a small id. A message is the
+// id followed by the arguments, each one a type tag and its value; strings
+// are copied, because the caller's buffer may be gone when the message is
+// formatted. The values are formatted by the conversions of the format
+// string, so "%d" of an int and "%.2f" of a double look the same as with
+// printf(). %s and %ls both take narrow or wide strings.
+//
+// file layout (little endian)
+// ===========
+// [LogFileHeader]
+// [LogEntryHeader][payload] ...
+//
+// Entries are one of
+//  - LOG_ENTRY_FORMAT:  uint32 id, uint32 line, uint16 file length, uint16
+//                       format length, file, format (UTF-8), written before
+//                       the first message of the id
+//  - LOG_ENTRY_MESSAGE: uint32 id, arguments
+//  - LOG_ENTRY_TEXT:    UTF-16 text of a message that was formatted by the
+//                       caller (Win::log())
+// so a file is decoded without the executable that wrote it.
+//
+// USAGE:
+//     static const int id = registerLogFormat("%d draws, %.2f ms", __FILE__, __LINE__);
+//     putLogBinary(queue, id, draws, time);           // any thread
+//
+//     BinaryLogReader reader;                         // offline
+//     reader.open("log.bin");
+//     while(reader.readLine(line)) ...
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <string>
+#include <vector>
+#include "LogQueue.h"
+
+const uint32_t LOG_FILE_MAGIC = 0x4C443346;         // "F3DL"
+const uint32_t LOG_FILE_VERSION = 1;
+const int LOG_BINARY_MAX_BYTES = 1024;              // format id and arguments of a message
+
+enum LogEntryKind
+{
+    LOG_ENTRY_FORMAT = 1,
+    LOG_ENTRY_MESSAGE,
+    LOG_ENTRY_TEXT
+};
+
+enum LogArgType
+{
+    LOG_ARG_INT32 = 1,
+    LOG_ARG_UINT32,
+    LOG_ARG_INT64,
+    LOG_ARG_UINT64,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,                                 // uint16 length, UTF-8
+    LOG_ARG_WSTRING                                 // uint16 length, UTF-16
+};
+
+struct LogFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t entryHeaderSize;
+    int64_t startTime;                              // LogQueue::now() when the file was opened
+    int64_t startClock;                             // local time of day at startTime, millisecond
+};
+
+struct LogEntryHeader
+{
+    uint16_t kind;
+    uint16_t thread;                                // thread number of LogQueue
+    uint32_t bytes;                                 // payload after this header
+    int64_t time;                                   // LogQueue::now()
+};
+
+// a registered format string
+struct LogFormat
+{
+    std::string format;                             // UTF-8
+    std::string file;
+    int line;
+};
+
+// register a format string, once per call site, any thread; ids start at 1
+int registerLogFormat(const char* format, const char* file, int line);
+int registerLogFormat(const wchar_t* format, const char* file, int line);
+const LogFormat* getLogFormat(int id);              // 0 if not registered
+
+// expand the arguments of a message with its format string, UTF-8
+void formatLogMessage(const char* format, const void* args, size_t bytes, std::string& text);
+
+// UTF-8 <-> wchar_t for the formatted text
+void appendUtf8(std::string& out, const wchar_t* text, size_t length);
+void appendWide(std::wstring& out, const char* text, size_t length);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// argument encoding, on the caller thread
+// each encoder writes a tag and the value, false if it does not fit
+///////////////////////////////////////////////////////////////////////////////
+inline bool encodeLogValue(char*& p, char* end, int tag, const void* value, size_t bytes)
+{
+    if((size_t)(end - p) < bytes + 1)
+        return false;
+    *p++ = (char)tag;
+    memcpy(p, value, bytes);
+    p += bytes;
+    return true;
+}
+
+inline bool encodeLogArg(char*& p, char* end, int value)
+{
+    int32_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_INT32, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, unsigned int value)
+{
+    uint32_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_UINT32, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, long value)
+{
+    int64_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_INT64, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, unsigned long value)
+{
+    uint64_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_UINT64, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, long long value)
+{
+    int64_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_INT64, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, unsigned long long value)
+{
+    uint64_t v = value;
+    return encodeLogValue(p, end, LOG_ARG_UINT64, &v, sizeof(v));
+}
+
+inline bool encodeLogArg(char*& p, char* end, double value)
+{
+    return encodeLogValue(p, end, LOG_ARG_DOUBLE, &value, sizeof(value));
+}
+
+inline bool encodeLogArg(char*& p, char* end, const void* value)
+{
+    uint64_t v = (uint64_t)(uintptr_t)value;
+    return encodeLogValue(p, end, LOG_ARG_POINTER, &v, sizeof(v));
+}
+
+// strings are cut to fit, the message still goes out
+inline bool encodeLogArg(char*& p, char* end, const char* value)
+{
+    if(end - p < 3)
+        return false;
+    size_t length = value ? strlen(value) : 0;
+    size_t room = (size_t)(end - p) - 3;
+    if(length > room)
+        length = room;
+    if(length > 0xffff)
+        length = 0xffff;
+    uint16_t n = (uint16_t)length;
+    *p++ = (char)LOG_ARG_STRING;
+    memcpy(p, &n, sizeof(n));
+    memcpy(p + sizeof(n), value, length);
+    p += sizeof(n) + length;
+    return true;
+}
+
+inline bool encodeLogArg(char*& p, char* end, const wchar_t* value)
+{
+    if(end - p < 3)
+        return false;
+    char* start = p;
+    p += 3;
+    size_t count = 0;
+    for(const wchar_t* c = value; c && *c && count < 0xfffe && end - p >= 4; ++c)
+    {
+        uint32_t code = (uint32_t)*c;
+        uint16_t units[2] = { (uint16_t)code, 0 };
+        int unitCount = 1;
+        if(code > 0xffff)
+        {
+            code -= 0x10000;
+            units[0] = (uint16_t)(0xd800 + (code >> 10));
+            units[1] = (uint16_t)(0xdc00 + (code & 0x3ff));
+            unitCount = 2;
+        }
+        memcpy(p, units, unitCount * sizeof(uint16_t));
+        p += unitCount * sizeof(uint16_t);
+        count += unitCount;
+    }
+    uint16_t n = (uint16_t)count;
+    *start = (char)LOG_ARG_WSTRING;
+    memcpy(start + 1, &n, sizeof(n));
+    return true;
+}
+
+inline bool encodeLogArg(char*& p, char* end, bool value)               { return encodeLogArg(p, end, (int)value); }
+inline bool encodeLogArg(char*& p, char* end, char value)               { return encodeLogArg(p, end, (int)value); }
+inline bool encodeLogArg(char*& p, char* end, float value)              { return encodeLogArg(p, end, (double)value); }
+inline bool encodeLogArg(char*& p, char* end, char* value)              { return encodeLogArg(p, end, (const char*)value); }
+inline bool encodeLogArg(char*& p, char* end, wchar_t* value)           { return encodeLogArg(p, end, (const wchar_t*)value); }
+inline bool encodeLogArg(char*& p, char* end, const std::string& value) { return encodeLogArg(p, end, value.c_str()); }
+inline bool encodeLogArg(char*& p, char* end, const std::wstring& value){ return encodeLogArg(p, end, value.c_str()); }
+
+inline bool encodeLogArgs(char*& /*p*/, char* /*end*/)
+{
+    return true;
+}
+
+template<typename T, typename... Rest>
+bool encodeLogArgs(char*& p, char* end, const T& first, const Rest&... rest)
+{
+    return encodeLogArg(p, end, first) && encodeLogArgs(p, end, rest...);
+}
+
+// format a message at once and print it as a line, for builds without a
+// log writer (Log.h outside Windows)
+template<typename... Args>
+void printLogBinary(FILE* file, int id, const Args&... args)
+{
+    char buffer[LOG_BINARY_MAX_BYTES];
+    char* p = buffer;
+    encodeLogArgs(p, buffer + LOG_BINARY_MAX_BYTES - sizeof(uint32_t), args...);   // same cut as putLogBinary()
+    const LogFormat* format = getLogFormat(id);
+    std::string text;
+    if(format)
+        formatLogMessage(format->format.c_str(), buffer, p - buffer, text);
+    else
+        text = "<unknown log format>";
+    fprintf(file, "%s\n", text.c_str());
+}
+
+// queue a binary message, false if the ring of the thread is full
+template<typename... Args>
+bool putLogBinary(LogQueue& queue, int id, const Args&... args)
+{
+    char* buffer = (char*)queue.beginBinary(LOG_BINARY_MAX_BYTES);
+    if(!buffer)
+        return false;
+
+    uint32_t format = (uint32_t)id;
+    memcpy(buffer, &format, sizeof(format));
+    char* p = buffer + sizeof(format);
+    encodeLogArgs(p, buffer + LOG_BINARY_MAX_BYTES, args...);   // the arguments that fit
+    queue.commitBinary(p - buffer);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// binary log file, written on the writer thread of the log
+///////////////////////////////////////////////////////////////////////////////
+class BinaryLogWriter
+{
+public:
+    BinaryLogWriter();
+    ~BinaryLogWriter();                             // close()
+
+    bool open(const char* fileName, int64_t startTime, int64_t startClock);
+    void close();
+    bool isOpen() const                             { return file != 0; }
+
+    // entries are collected and written by flush()
+    void writeMessage(int64_t time, int thread, const void* data, size_t bytes);   // data of putLogBinary()
+    void writeText(int64_t time, int thread, const wchar_t* text, size_t length);
+    void flush();
+
+    int64_t getBytesWritten() const                 { return bytesWritten; }
+
+private:
+    void writeEntry(int kind, int64_t time, int thread, const void* data, size_t bytes);
+
+    FILE* file;
+    std::vector<char> buffer;
+    std::vector<bool> formatWritten;                // by id
+    std::vector<uint16_t> units;                    // UTF-16 text of writeText()
+    int64_t bytesWritten;
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// binary log file back to text
+///////////////////////////////////////////////////////////////////////////////
+class BinaryLogReader
+{
+public:
+    BinaryLogReader();
+    ~BinaryLogReader();                             // close()
+
+    bool open(const char* fileName);
+    void close();
+
+    // next message as "H:MM:SS.mmm [thread] text", UTF-8; false at the end
+    // of the file or at a damaged entry
+    bool readLine(std::string& line);
+
+    int64_t getMessageCount() const                 { return messageCount; }
+    int getFormatCount() const                      { return (int)formats.size(); }
+
+private:
+    FILE* file;
+    LogFileHeader header;
+    std::vector<std::string> formats;               // by id of the file
+    std::vector<char> payload;
+    int64_t messageCount;
+};
+
+#endif
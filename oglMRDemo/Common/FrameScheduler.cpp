@@ -0,0 +1,250 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// FrameScheduler.cpp
+// ==================
+// Frame pacing of the rendering loop.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>                   // for timeBeginPeriod()
+#pragma comment(lib, "winmm.lib")
+#endif
+
+#include <memory>
+#include <thread>
+#include "FrameScheduler.h"
+#include "Trace.h"
+
+// a frame is missed if it took longer than this many periods
+// (in vsync mode, 1.5 periods means at least one vertical blank was skipped)
+const double MISS_TOLERANCE = 1.5;
+
+// the last part of the wait is spun instead of slept, sleep is not accurate enough
+const std::chrono::microseconds SPIN_TIME(2000);
+
+// return milliseconds of the duration
+static double toMs(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+FrameScheduler::FrameScheduler() : requestedMode(MODE_VSYNC), requestedRate(60), modeChanged(true),
+                                   mode(MODE_VSYNC), rate(60), hasLastSwap(false), waitTime(0),
+                                   hasLatchTime(false)
+{
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    lastFrame.waitTime = lastFrame.cpuTime = lastFrame.swapTime = lastFrame.frameTime = lastFrame.latchToSwap = 0;
+    lastFrame.missed = false;
+    resetStats();
+
+#ifdef _WIN32
+    ::timeBeginPeriod(1);               // 1ms resolution of Sleep()
+#endif
+}
+
+FrameScheduler::~FrameScheduler()
+{
+#ifdef _WIN32
+    ::timeEndPeriod(1);
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// request a new mode, it is applied at the next beginFrame()
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::setMode(Mode mode, double rate)
+{
+    if(rate <= 0)
+        rate = 60;
+    requestedRate = rate;
+    requestedMode = mode;
+    modeChanged = true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// switch mode in the rendering thread, where the swap interval can be set
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::applyMode()
+{
+    mode = (Mode)requestedMode.load();
+    rate = requestedRate.load();
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+
+    if(swapIntervalFunction)
+        swapIntervalFunction(mode == MODE_VSYNC ? 1 : 0);
+
+    nextSlot = Clock::now();
+    hasLastSwap = false;                // do not count the mode switch as a missed frame
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// call it before drawing a frame
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::beginFrame()
+{
+    TRACE_ZONE("FrameScheduler::beginFrame");
+    if(modeChanged.exchange(false))
+        applyMode();
+
+    waitTime = 0;
+    if(mode == MODE_FIXED_RATE)
+    {
+        Clock::time_point now = Clock::now();
+        if(nextSlot > now)
+        {
+            waitUntil(nextSlot);
+            waitTime = toMs(Clock::now() - now);
+            nextSlot += period;
+        }
+        else
+        {
+            // too late for this slot, restart the schedule from now instead of
+            // rushing the next frames to catch up
+            nextSlot = now + period;
+        }
+    }
+
+    frameBegin = Clock::now();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// call it after drawing a frame, it presents the frame with the swap function
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::endFrame()
+{
+    Clock::time_point swapBegin = Clock::now();
+    if(swapFunction)
+        swapFunction();
+    Clock::time_point swapEnd = Clock::now();
+
+    lastFrame.waitTime = waitTime;
+    lastFrame.cpuTime = toMs(swapBegin - frameBegin);
+    lastFrame.swapTime = toMs(swapEnd - swapBegin);
+    lastFrame.frameTime = hasLastSwap ? toMs(swapEnd - lastSwap) : 0;
+    lastFrame.latchToSwap = hasLatchTime ? toMs(swapEnd - latchTime) : 0;
+    lastFrame.missed = false;
+
+    // there is no deadline in uncapped mode
+    if(hasLastSwap && mode != MODE_UNCAPPED)
+        lastFrame.missed = lastFrame.frameTime > toMs(period) * MISS_TOLERANCE;
+
+    lastSwap = swapEnd;
+    hasLastSwap = true;
+
+    ++frameCount;
+    if(lastFrame.missed)
+        ++missedCount;
+    sumFrameTime += lastFrame.frameTime;
+    sumCpuTime += lastFrame.cpuTime;
+    if(lastFrame.frameTime > maxFrameTime)
+        maxFrameTime = lastFrame.frameTime;
+
+    if(hasLatchTime)
+    {
+        ++latchCount;
+        sumLatchToSwap += lastFrame.latchToSwap;
+        if(lastFrame.latchToSwap > maxLatchToSwap)
+            maxLatchToSwap = lastFrame.latchToSwap;
+        hasLatchTime = false;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the time the tracking pose of this frame was sampled
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::setLatchTime(std::chrono::steady_clock::time_point time)
+{
+    latchTime = time;
+    hasLatchTime = true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sleep most of the time, then spin until the exact time
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::waitUntil(Clock::time_point time)
+{
+    Clock::time_point now = Clock::now();
+    if(time - now > SPIN_TIME)
+        std::this_thread::sleep_for(time - now - SPIN_TIME);
+
+    while(Clock::now() < time)
+        std::this_thread::yield();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// statistics
+///////////////////////////////////////////////////////////////////////////////
+double FrameScheduler::getAverageFrameTime() const
+{
+    if(frameCount == 0)
+        return 0;
+    return sumFrameTime / frameCount;
+}
+
+double FrameScheduler::getAverageCpuTime() const
+{
+    if(frameCount == 0)
+        return 0;
+    return sumCpuTime / frameCount;
+}
+
+double FrameScheduler::getAverageLatchToSwap() const
+{
+    if(latchCount == 0)
+        return 0;
+    return sumLatchToSwap / latchCount;
+}
+
+void FrameScheduler::resetStats()
+{
+    frameCount = missedCount = latchCount = 0;
+    sumFrameTime = sumCpuTime = maxFrameTime = 0;
+    sumLatchToSwap = maxLatchToSwap = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// simulated display: the swap returns at the next multiple of 1/refreshRate
+// since the first call, like SwapBuffers() with swap interval 1
+///////////////////////////////////////////////////////////////////////////////
+FrameScheduler::SwapFunction FrameScheduler::makeMockSwap(double refreshRate)
+{
+    Clock::duration vblank = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+    std::shared_ptr<Clock::time_point> start = std::make_shared<Clock::time_point>();
+    std::shared_ptr<bool> started = std::make_shared<bool>(false);
+
+    return [vblank, start, started]()
+    {
+        Clock::time_point now = Clock::now();
+        if(!*started)
+        {
+            *start = now;
+            *started = true;
+        }
+        Clock::duration::rep count = (now - *start) / vblank + 1;
+        std::this_thread::sleep_until(*start + vblank * count);
+    };
+}
@@ -0,0 +1,126 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// FrameScheduler.h
+// ================
+// Frame pacing of the rendering loop.
+//
+// modes
+// =====
+// MODE_VSYNC     : swap interval 1, SwapBuffers() blocks until vertical blank
+// MODE_FIXED_RATE: swap interval 0, the scheduler waits for the next frame slot
+//                  of the target rate. It sleeps until close to the slot, then
+//                  spins the rest, because Sleep() is only accurate to ~1ms.
+// MODE_UNCAPPED  : swap interval 0, no waiting (benchmark)
+//
+// USAGE (rendering thread):
+//     scheduler.setSwapFunction(...);         // e.g. ViewGL::swapBuffers()
+//     while(loop)
+//     {
+//         scheduler.beginFrame();
+//         model->draw();
+//         scheduler.endFrame();               // swaps buffers and records timing
+//     }
+//
+// If the frame samples tracking data, pass the sample time to setLatchTime()
+// before endFrame(). The sample-to-swap latency is recorded with the timing.
+//
+// The swap function is injected, so the scheduler can be driven without a
+// GL context. makeMockSwap(60) returns a swap that blocks until the next
+// vertical blank of a simulated 60 Hz display.
+//
+// setMode() may be called from any thread, the mode is applied at the next
+// beginFrame() in the rendering thread.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+class FrameScheduler
+{
+public:
+    enum Mode { MODE_VSYNC = 0, MODE_FIXED_RATE, MODE_UNCAPPED };
+
+    typedef std::function<void()> SwapFunction;                 // present the frame
+    typedef std::function<void(int)> SwapIntervalFunction;      // set swap interval (0 or 1)
+
+    // timing of a frame in millisecond
+    struct FrameTiming
+    {
+        double waitTime;        // sleep + spin before the frame (fixed rate mode)
+        double cpuTime;         // beginFrame() to endFrame()
+        double swapTime;        // time blocked in the swap function
+        double frameTime;       // swap to swap interval
+        double latchToSwap;     // tracking sample to swap done, 0 if no latch time was set
+        bool missed;            // the frame missed its deadline
+    };
+
+    FrameScheduler();
+    ~FrameScheduler();
+
+    void setSwapFunction(const SwapFunction& func)                  { swapFunction = func; }
+    void setSwapIntervalFunction(const SwapIntervalFunction& func)  { swapIntervalFunction = func; }
+
+    void setMode(Mode mode, double rate = 60);  // rate: target rate of fixed mode, refresh rate of vsync mode
+    Mode getMode() const                    { return mode; }
+    double getRate() const                  { return rate; }
+
+    void beginFrame();                          // apply mode change, wait for the frame slot
+    void endFrame();                            // swap and record timing
+    void setLatchTime(std::chrono::steady_clock::time_point time); // tracking sample time of this frame
+
+    // statistics since the last resetStats()
+    const FrameTiming& getLastFrame() const { return lastFrame; }
+    int getFrameCount() const               { return frameCount; }
+    int getMissedCount() const              { return missedCount; }
+    double getAverageFrameTime() const;
+    double getMaxFrameTime() const          { return maxFrameTime; }
+    double getAverageCpuTime() const;
+    double getAverageLatchToSwap() const;
+    double getMaxLatchToSwap() const        { return maxLatchToSwap; }
+    void resetStats();
+
+    // a swap function that blocks until the next vblank of a simulated display
+    static SwapFunction makeMockSwap(double refreshRate);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void applyMode();
+    void waitUntil(Clock::time_point time);     // sleep + spin
+
+    std::atomic<int> requestedMode;             // set by setMode() from any thread
+    std::atomic<double> requestedRate;
+    std::atomic<bool> modeChanged;
+    Mode mode;                                  // used by the rendering thread
+    double rate;
+    Clock::duration period;                     // 1 / rate
+
+    SwapFunction swapFunction;
+    SwapIntervalFunction swapIntervalFunction;
+
+    Clock::time_point nextSlot;                 // start time of next frame in fixed rate mode
+    Clock::time_point frameBegin;
+    Clock::time_point lastSwap;
+    bool hasLastSwap;
+    double waitTime;
+    Clock::time_point latchTime;
+    bool hasLatchTime;
+
+    FrameTiming lastFrame;
+    int frameCount;
+    int missedCount;
+    double sumFrameTime;
+    double sumCpuTime;
+    double maxFrameTime;
+    int latchCount;
+    double sumLatchToSwap;
+    double maxLatchToSwap;
+};
+
+#endif
@@ -10,6 +10,11 @@
 // For example, Win::log(L"My number: %d\n", 123).
 // It is similar to printf() function of C standard libirary.
 //
+// The callers only queue the messages (see LogQueue.h); the file and the
+// dialog are written on the writer thread of the queue. LOG_DEFERRED()
+// messages are formatted there too, or written to log.bin unformatted in
+// LOG_MODE_BINARY.
+//
 // The template of the log dialog window is defined in log.rc and logResource.h
 // You must include both resource file with this source codes.
 // The dialog window cannot be closed by user once it is created. But it will be
@@ -17,7 +22,7 @@
 //
 //  AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
 // CREATED: 2006-07-14
-// UPDATED: 2008-05-07
+// UPDATED: 2026-10-18
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cstdarg>
@@ -26,28 +31,39 @@
 #include <iomanip>
 #include "Log.h"
 #include "logResource.h"                            // for log dialog resource
-#include "wcharUtil.h"
 using namespace Win;
 
 const char* LOG_FILE = "log.txt";
+const char* LOG_BINARY_FILE = "log.bin";
+const size_t LOG_BATCH_RESERVE = 64 * 1024;         // characters, file lines are written per batch
+const int LOG_TIME_LENGTH = 16;
 
 BOOL CALLBACK logDialogProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 ///////////////////////////////////////////////////////////////////////////////
 // constructor
 ///////////////////////////////////////////////////////////////////////////////
-Log::Log() : logMode(LOG_MODE_FILE), dialogHandle(0), listHandle(0)
+Log::Log() : logMode(LOG_MODE_FILE), dialogHandle(0), listHandle(0), startTime(0), startClock(0), queue(this)
 {
+    // local time of day at the start of the message clock
+    SYSTEMTIME sysTime;
+    ::GetLocalTime(&sysTime);
+    startTime = LogQueue::now();
+    startClock = ((sysTime.wHour * 60 + sysTime.wMinute) * 60 + sysTime.wSecond) * 1000LL + sysTime.wMilliseconds;
+    batch.reserve(LOG_BATCH_RESERVE);
+
     // open log file
     logFile.open(LOG_FILE, std::ios::out);
-    if (logFile.fail())
-        return;
+    if (!logFile.fail())
+    {
+        // first put starting date and time
+        logFile << L"===== Log started at "
+            << getDate() << L", "
+            << getTime() << L". =====\n\n"
+            << std::flush;
+    }
 
-    // first put starting date and time
-    logFile << L"===== Log started at "
-        << getDate() << L", "
-        << getTime() << L". =====\n\n"
-        << std::flush;
+    queue.start();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -55,6 +71,9 @@ Log::Log() : logMode(LOG_MODE_FILE), dialogHandle(0), listHandle(0)
 ///////////////////////////////////////////////////////////////////////////////
 Log::~Log()
 {
+    // write the messages still queued
+    queue.stop();
+
     // close opened file
     logFile << L"\n\n===== END OF LOG =====\n";
     logFile.close();
@@ -78,13 +97,54 @@ Log& Log::getInstance()
 
 ///////////////////////////////////////////////////////////////////////////////
 // add message to log
+// the message is only queued, it is written on the writer thread
 ///////////////////////////////////////////////////////////////////////////////
 void Log::put(const std::wstring& message)
 {
-    if (logMode != LOG_MODE_FILE)
+    queue.put(message.c_str(), message.size());
+}
+
+void Log::vput(const wchar_t* format, va_list args)
+{
+    queue.vput(format, args);
+}
+
+void Log::vput(const char* format, va_list args)
+{
+    queue.vput(format, args);
+}
+
+void Log::flush()
+{
+    queue.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write a queued message, called on the writer thread
+// the file lines are collected and written once per batch in endBatch()
+///////////////////////////////////////////////////////////////////////////////
+void Log::write(int64_t time, int thread, const wchar_t* text, size_t length)
+{
+    int mode = logMode.load();
+    if (mode == LOG_MODE_BINARY)
     {
-        std::wstring str;
-        str = getTime() + L": " + message;
+        binaryFile.writeText(time, thread, text, length);
+        return;
+    }
+
+    // time of day of the message
+    int64_t clock = startClock + (time - startTime) / 1000000;
+    int seconds = (int)((clock / 1000) % (24 * 60 * 60));
+    wchar_t stamp[LOG_TIME_LENGTH];
+    int stampLength = swprintf(stamp, LOG_TIME_LENGTH, L"%d:%02d:%02d", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    if (stampLength < 0)
+        stampLength = 0;
+
+    if (mode != LOG_MODE_FILE && listHandle)
+    {
+        std::wstring str(stamp, stampLength);
+        str += L": ";
+        str.append(text, length);
         //long index = ::SendMessage(listHandle, LB_ADDSTRING, 0, (LPARAM)str.c_str());
         //::SendMessage(listHandle, LB_SETTOPINDEX, index, 0);  // set focus to current line
 
@@ -95,14 +155,50 @@ void Log::put(const std::wstring& message)
             ::SendMessageTimeout(listHandle, LB_SETTOPINDEX, index, 0, SMTO_NORMAL, 500, 0);  // set focus to current line
     }
 
-    if (logMode != LOG_MODE_DIALOG)
+    if (mode != LOG_MODE_DIALOG)
     {
         // put time first and append message
-        logFile << getTime() << L"  "
-            << message
-            << L"\n"
-            << std::flush;
+        batch.append(stamp, stampLength);
+        batch += L"  ";
+        batch.append(text, length);
+        batch += L'\n';
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// write a queued LOG_DEFERRED() message, called on the writer thread
+// formatted here into the text log, or written as it is into log.bin
+///////////////////////////////////////////////////////////////////////////////
+void Log::writeBinary(int64_t time, int thread, const void* data, size_t bytes)
+{
+    if (logMode.load() == LOG_MODE_BINARY)
+    {
+        binaryFile.writeMessage(time, thread, data, bytes);
+        return;
     }
+
+    uint32_t id = 0;
+    if (bytes >= sizeof(id))
+        memcpy(&id, data, sizeof(id));
+    const LogFormat* format = getLogFormat(id);
+    binaryText.clear();
+    if (format)
+        formatLogMessage(format->format.c_str(), (const char*)data + sizeof(id), bytes - sizeof(id), binaryText);
+    else
+        binaryText = "<unknown log format>";
+    binaryWideText.clear();
+    appendWide(binaryWideText, binaryText.data(), binaryText.size());
+    write(time, thread, binaryWideText.c_str(), binaryWideText.size());
+}
+
+void Log::endBatch()
+{
+    binaryFile.flush();
+    if (batch.empty())
+        return;
+
+    logFile << batch << std::flush;
+    batch.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -146,18 +242,26 @@ const std::wstring Log::getTime()
 ///////////////////////////////////////////////////////////////////////////////
 void Log::setMode(int mode)
 {
-    if (mode > LOG_MODE_BOTH) return;                // invalid mode number
+    if (mode > LOG_MODE_BINARY) return;              // invalid mode number
 
     if (logMode == LOG_MODE_FILE && mode == LOG_MODE_DIALOG)
     {
-        logFile << getTime() << L"  "
-            << L"Redirect log to dialog box.\n"
-            << std::flush;
+        // into the file before the mode changes
+        put(L"Redirect log to dialog box.");
+        queue.flush();
     }
 
-    logMode = mode;
+    if (logMode != LOG_MODE_BINARY && mode == LOG_MODE_BINARY)
+    {
+        put(L"Redirect log to log.bin.");
+        queue.flush();
+
+        // the writer thread uses it only in binary mode, set below
+        if (!binaryFile.isOpen())
+            binaryFile.open(LOG_BINARY_FILE, startTime, startClock);
+    }
 
-    if (logMode != LOG_MODE_FILE)                    // to dialog
+    if (mode == LOG_MODE_DIALOG || mode == LOG_MODE_BOTH)   // to dialog
     {
         if (!dialogHandle)
         {
@@ -195,6 +299,9 @@ void Log::setMode(int mode)
         if (dialogHandle)
             ::ShowWindow(dialogHandle, SW_MINIMIZE);
     }
+
+    // the writer thread reads it, so the dialog exists before
+    logMode = mode;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -202,28 +309,20 @@ void Log::setMode(int mode)
 ///////////////////////////////////////////////////////////////////////////////
 void Win::log(const wchar_t *format, ...)
 {
-    wchar_t buffer[LOG_MAX_STRING];
-
-    // do the formating
+    // do the formating, in place in the queue
     va_list valist;
     va_start(valist, format);
-    _vsnwprintf(buffer, LOG_MAX_STRING, format, valist);
+    Log::getInstance().vput(format, valist);
     va_end(valist);
-
-    Log::getInstance().put(buffer);
 }
 
 void Win::log(const char *format, ...)
 {
-    char buffer[LOG_MAX_STRING];
-
-    // do the formating
+    // do the formating, in place in the queue
     va_list valist;
     va_start(valist, format);
-    _vsnprintf(buffer, LOG_MAX_STRING, format, valist);
+    Log::getInstance().vput(format, valist);
     va_end(valist);
-
-    Log::getInstance().put(toWchar(buffer));
 }
 
 void Win::log(const std::wstring& str)
@@ -239,6 +338,14 @@ void Win::logMode(int mode)
     Log::getInstance().setMode(mode);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// wait until all messages are written
+///////////////////////////////////////////////////////////////////////////////
+void Win::logFlush()
+{
+    Log::getInstance().flush();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // process log dialog messages
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,30 @@
 // For example, Win::log(L"My number: %d\n", 123).
 // It is similar to printf() function of C standard libirary.
 //
+// Messages are not written by the caller: Log::put() only copies the message
+// into a LogQueue ring of the calling thread, and the writer thread of the
+// queue writes them to the file (one write per batch) or adds them to the
+// dialog. So the render and tracking threads never wait for the disk or for
+// the dialog. Call Win::logFlush() to wait until everything logged so far
+// is written.
+//
+// LOG_DEFERRED(format, ...) does not format at all on the caller thread: it
+// records the id of the format string and the raw arguments (BinaryLog.h).
+// The writer thread formats them into the text log, or, in LOG_MODE_BINARY,
+// writes them as they are into log.bin, to be expanded offline by the
+// LogDecode tool. In LOG_MODE_BINARY, Win::log() messages go to log.bin as
+// text entries, so the file keeps the order of all messages.
+//
+// LOG_INFO(category, format, ...) and the other levels of LogLevel.h are
+// LOG_DEFERRED() messages with a severity, a category (RENDER, TRACKING, UI,
+// GL) and a rate limit per call site; levels below LOG_MIN_LEVEL compile to
+// nothing.
+//
+// Outside Windows there is no Win::Log: LOG_DEFERRED() and LOG_INFO() ~
+// LOG_ERROR() format the message at once and print it to stderr
+// (printLogBinary() of BinaryLog.h), so the model code can log in the
+// console builds of oglMRCheck.
+//
 // The template of the log dialog window is defined in log.rc and logResource.h
 // You must include both resource file with this source codes.
 // The dialog window cannot be closed by user once it is created. But it will be
@@ -17,19 +41,46 @@
 //
 //  AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
 // CREATED: 2006-07-14
-// UPDATED: 2006-07-24
+// UPDATED: 2026-10-18
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifndef WIN_LOG_H
 #define WIN_LOG_H
 
+#include <atomic>
+#include <cstdarg>
 #include <string>
+#include "LogQueue.h"
+#include "BinaryLog.h"
+
+#ifndef _WIN32
+// no log writer, formatted to stderr by the caller
+#define LOG_DEFERRED(format, ...)                                                       \
+    do {                                                                                \
+        static const int logFormatId = registerLogFormat(format, __FILE__, __LINE__);   \
+        printLogBinary(stderr, logFormatId, ##__VA_ARGS__);                             \
+    } while(0)
+#define LOG_EMIT(formatId, ...) printLogBinary(stderr, formatId, ##__VA_ARGS__)
+#include "LogLevel.h"
+
+#else
 #include <fstream>
 #include <windows.h>
 
+// deferred-formatting log message, the format string is registered once per call site
+#define LOG_DEFERRED(format, ...)                                                       \
+    do {                                                                                \
+        static const int logFormatId = registerLogFormat(format, __FILE__, __LINE__);   \
+        Win::logBinary(logFormatId, ##__VA_ARGS__);                                     \
+    } while(0)
+
+// LOG_TRACE() ~ LOG_ERROR() of LogLevel.h go to this log
+#define LOG_EMIT(formatId, ...) Win::logBinary(formatId, ##__VA_ARGS__)
+#include "LogLevel.h"
+
 namespace Win
 {
-    enum { LOG_MODE_FILE = 0, LOG_MODE_DIALOG, LOG_MODE_BOTH }; // log输出模式的选择
+    enum { LOG_MODE_FILE = 0, LOG_MODE_DIALOG, LOG_MODE_BOTH, LOG_MODE_BINARY }; // log输出模式的选择
     enum { LOG_MAX_STRING = 1024 };
 
     // Clients are actually use this functions to send log messages.
@@ -38,9 +89,11 @@ namespace Win
     void log(const wchar_t *format, ...);
     void log(const char *format, ...);
     extern void logMode(int mode);
+    void logFlush();                            // wait until all messages are written
+    template<typename... Args> void logBinary(int formatId, const Args&... args);   // use LOG_DEFERRED()
 
     // singleton class ////////////////////////////////////////////////////////
-    class Log
+    class Log : public LogSink
     {
     public:
         ~Log();
@@ -49,6 +102,17 @@ namespace Win
 
         void setMode(int mode);                 // set log target: file or dialog
         void put(const std::wstring& str);      // print log message
+        void vput(const wchar_t* format, va_list args);
+        void vput(const char* format, va_list args);
+        template<typename... Args>
+        void putBinary(int formatId, const Args&... args) { putLogBinary(queue, formatId, args...); }
+        void flush();                           // wait until all messages are written
+        int64_t getDroppedCount() const         { return queue.getDroppedCount(); }
+
+        // LogSink, called on the writer thread of the queue
+        void write(int64_t time, int thread, const wchar_t* text, size_t length);
+        void writeBinary(int64_t time, int thread, const void* data, size_t bytes);
+        void endBatch();
 
     private:
         Log();                                  // hide it here to prevent instantiating this class
@@ -57,12 +121,26 @@ namespace Win
         const std::wstring getTime();           // return system time as string
         const std::wstring getDate();           // return system date as string
 
-        int logMode;                            // file, dialog or both
+        std::atomic<int> logMode;               // file, dialog or both
         std::wofstream logFile;                 // log file handle
         HWND dialogHandle;                      // handle to dialog window
         HWND listHandle;                        // handle to listbox
+        int64_t startTime;                      // LogQueue::now() when the log started
+        int64_t startClock;                     // local time of day at startTime, millisecond
+        std::wstring batch;                     // file lines of the current batch
+        BinaryLogWriter binaryFile;             // log.bin of LOG_MODE_BINARY
+        std::string binaryText;                 // a binary message formatted on the writer thread
+        std::wstring binaryWideText;
+        LogQueue queue;                         // last, so it stops before the rest is destroyed
     };
     ///////////////////////////////////////////////////////////////////////////
+
+    template<typename... Args>
+    void logBinary(int formatId, const Args&... args)
+    {
+        Log::getInstance().putBinary(formatId, args...);
+    }
 }
 
+#endif // _WIN32
 #endif
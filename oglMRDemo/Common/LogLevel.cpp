@@ -0,0 +1,68 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// LogLevel.cpp
+// ============
+// Severity levels, categories and per-call-site rate limits of the deferred
+// log messages
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LogLevel.h"
+
+const int64_t NANOSECOND_PER_SECOND = 1000000000;
+const int64_t DEFAULT_RATE_INTERVAL = NANOSECOND_PER_SECOND / 10;    // 10 messages per second
+const int64_t DEFAULT_RATE_BURST = DEFAULT_RATE_INTERVAL * 19;       // 20 at once
+
+static const char* LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "OFF" };
+static const char* CATEGORY_NAMES[] = { "RENDER", "TRACKING", "UI", "GL" };
+
+std::atomic<int> logCategoryLevels[LOG_CATEGORY_COUNT] = { {LOG_LEVEL_TRACE}, {LOG_LEVEL_TRACE},
+                                                           {LOG_LEVEL_TRACE}, {LOG_LEVEL_TRACE} };
+std::atomic<int64_t> logRateIntervals[LOG_CATEGORY_COUNT] = { {DEFAULT_RATE_INTERVAL}, {DEFAULT_RATE_INTERVAL},
+                                                              {DEFAULT_RATE_INTERVAL}, {DEFAULT_RATE_INTERVAL} };
+std::atomic<int64_t> logRateBursts[LOG_CATEGORY_COUNT] = { {DEFAULT_RATE_BURST}, {DEFAULT_RATE_BURST},
+                                                           {DEFAULT_RATE_BURST}, {DEFAULT_RATE_BURST} };
+
+
+
+const char* getLogLevelName(int level)
+{
+    return level >= LOG_LEVEL_TRACE && level <= LOG_LEVEL_OFF ? LEVEL_NAMES[level] : "?";
+}
+
+const char* getLogCategoryName(int category)
+{
+    return category >= 0 && category < LOG_CATEGORY_COUNT ? CATEGORY_NAMES[category] : "?";
+}
+
+void setLogCategoryLevel(int category, int level)
+{
+    if(category >= 0 && category < LOG_CATEGORY_COUNT)
+        logCategoryLevels[category].store(level, std::memory_order_relaxed);
+}
+
+int getLogCategoryLevel(int category)
+{
+    return category >= 0 && category < LOG_CATEGORY_COUNT ? logCategoryLevels[category].load(std::memory_order_relaxed) : LOG_LEVEL_OFF;
+}
+
+void setLogRateLimit(int category, double rate, int burst)
+{
+    if(category < 0 || category >= LOG_CATEGORY_COUNT)
+        return;
+
+    int64_t interval = rate > 0 ? (int64_t)(NANOSECOND_PER_SECOND / rate) : 0;
+    if(rate > 0 && interval < 1)
+        interval = 1;
+    if(burst < 1)
+        burst = 1;
+    logRateBursts[category].store(interval * (burst - 1), std::memory_order_relaxed);
+    logRateIntervals[category].store(interval, std::memory_order_relaxed);
+}
+
+int getLogSuppressedFormat()
+{
+    static const int id = registerLogFormat("(%u messages suppressed by the rate limit at %s:%d)", __FILE__, __LINE__);
+    return id;
+}
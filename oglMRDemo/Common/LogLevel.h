@@ -0,0 +1,182 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// LogLevel.h
+// ==========
+// Severity levels, categories and per-call-site rate limits of the deferred
+// log messages (BinaryLog.h):
+//     LOG_WARNING(TRACKING, L"Lost the glasses for %d frames", count);
+//
+// Levels below LOG_MIN_LEVEL are removed at compile time: the macro expands
+// to nothing and its arguments are not evaluated. LOG_MIN_LEVEL defaults to
+// LOG_LEVEL_DEBUG, LOG_LEVEL_INFO with NDEBUG; define it in the project to
+// change it.
+//
+// The levels left are filtered at run time per category with
+// setLogCategoryLevel(), one relaxed load per call.
+//
+// Every call site has its own token bucket, so one noisy per-frame message
+// cannot flood the disk and does not silence the others. The bucket is kept
+// as a single time value (GCRA): a message is allowed while the bucket is not
+// "ahead" of now by more than the burst, and each allowed message moves it
+// ahead by 1 / rate. The rate and burst are per category, see
+// setLogRateLimit(). Suppressed messages are counted, and the count is logged
+// before the next message of the call site that goes out.
+//
+// The macros emit through LOG_EMIT(formatId, ...), defined by the includer
+// (Log.h sends to Win::logBinary()).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOG_LEVEL_H
+#define LOG_LEVEL_H
+
+#include <atomic>
+#include <cstdint>
+#include "BinaryLog.h"
+
+// numbers, so they work in #if
+#define LOG_LEVEL_TRACE     0
+#define LOG_LEVEL_DEBUG     1
+#define LOG_LEVEL_INFO      2
+#define LOG_LEVEL_WARNING   3
+#define LOG_LEVEL_ERROR     4
+#define LOG_LEVEL_OFF       5
+
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+enum LogCategory
+{
+    LOG_CATEGORY_RENDER = 0,
+    LOG_CATEGORY_TRACKING,
+    LOG_CATEGORY_UI,
+    LOG_CATEGORY_GL,
+    LOG_CATEGORY_COUNT
+};
+
+const char* getLogLevelName(int level);
+const char* getLogCategoryName(int category);
+
+// run time filter: messages of category below level are skipped, any thread
+void setLogCategoryLevel(int category, int level);
+int getLogCategoryLevel(int category);
+
+// messages per second and burst of each call site of category, 0 rate for no limit
+void setLogRateLimit(int category, double rate, int burst);
+
+// id of the format of the suppressed-count message: count, file, line
+int getLogSuppressedFormat();
+
+extern std::atomic<int> logCategoryLevels[LOG_CATEGORY_COUNT];
+extern std::atomic<int64_t> logRateIntervals[LOG_CATEGORY_COUNT];   // nanosecond per message
+extern std::atomic<int64_t> logRateBursts[LOG_CATEGORY_COUNT];      // nanosecond the bucket may be ahead
+
+inline bool isLogEnabled(int category, int level)
+{
+    return level >= logCategoryLevels[category].load(std::memory_order_relaxed);
+}
+
+// token bucket of a call site
+class LogRateLimiter
+{
+public:
+    explicit LogRateLimiter(int category) : category(category), bucketTime(0), suppressedCount(0) {}
+
+    // true if a message at time (LogQueue::now()) may go out; suppressed is
+    // then the number of messages dropped since the last one that went out
+    bool acquire(int64_t time, uint32_t& suppressed)
+    {
+        int64_t interval = logRateIntervals[category].load(std::memory_order_relaxed);
+        suppressed = 0;
+        if(interval > 0)
+        {
+            int64_t burst = logRateBursts[category].load(std::memory_order_relaxed);
+            int64_t previous = bucketTime.load(std::memory_order_relaxed);
+            int64_t bucket;
+            do
+            {
+                bucket = previous < time ? time : previous;     // full bucket if behind now
+                if(bucket - time > burst)
+                {
+                    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            while(!bucketTime.compare_exchange_weak(previous, bucket + interval, std::memory_order_relaxed));
+        }
+        if(suppressedCount.load(std::memory_order_relaxed))
+            suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint32_t getSuppressedCount() const             { return suppressedCount.load(std::memory_order_relaxed); }
+
+private:
+    int category;
+    std::atomic<int64_t> bucketTime;                // time the bucket is empty until, ahead of now when used
+    std::atomic<uint32_t> suppressedCount;
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// macros
+// category is the name without LOG_CATEGORY_, e.g. RENDER; the format gets a
+// "[LEVEL][CATEGORY] " prefix, narrow or wide like the format
+///////////////////////////////////////////////////////////////////////////////
+#define LOG_AT(level, levelName, category, format, ...)                                                 \
+    do {                                                                                                \
+        if(isLogEnabled(LOG_CATEGORY_##category, level))                                               \
+        {                                                                                               \
+            static LogRateLimiter logLimiter(LOG_CATEGORY_##category);                                  \
+            static const int logFormatId = registerLogFormat("[" levelName "][" #category "] " format,  \
+                                                             __FILE__, __LINE__);                       \
+            uint32_t logSuppressed;                                                                     \
+            if(logLimiter.acquire(LogQueue::now(), logSuppressed))                                      \
+            {                                                                                           \
+                if(logSuppressed)                                                                       \
+                    LOG_EMIT(getLogSuppressedFormat(), logSuppressed, __FILE__, __LINE__);              \
+                LOG_EMIT(logFormatId, ##__VA_ARGS__);                                                   \
+            }                                                                                           \
+        }                                                                                               \
+    } while(0)
+
+#define LOG_NOTHING() do {} while(0)
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(category, format, ...)    LOG_AT(LOG_LEVEL_TRACE, "TRACE", category, format, ##__VA_ARGS__)
+#else
+#define LOG_TRACE(category, format, ...)    LOG_NOTHING()
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, format, ...)    LOG_AT(LOG_LEVEL_DEBUG, "DEBUG", category, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(category, format, ...)    LOG_NOTHING()
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, format, ...)     LOG_AT(LOG_LEVEL_INFO, "INFO", category, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(category, format, ...)     LOG_NOTHING()
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(category, format, ...)  LOG_AT(LOG_LEVEL_WARNING, "WARNING", category, format, ##__VA_ARGS__)
+#else
+#define LOG_WARNING(category, format, ...)  LOG_NOTHING()
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, format, ...)    LOG_AT(LOG_LEVEL_ERROR, "ERROR", category, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(category, format, ...)    LOG_NOTHING()
+#endif
+
+#endif
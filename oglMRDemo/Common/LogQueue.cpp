@@ -0,0 +1,456 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// LogQueue.cpp
+// ============
+// Asynchronous log messages, per-thread rings drained by a writer thread
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include "LogQueue.h"
+
+const uint64_t RING_MASK = LogQueue::RING_BYTES - 1;
+const uint64_t NO_PENDING = ~0ull;
+const uint64_t WAKE_BYTES = LogQueue::RING_BYTES / 2;  // wake the writer early above it
+const int NOTE_LENGTH = 64;
+const int DEFAULT_FULL_WAIT = 0;                        // ms for a full ring to get space, drop at once
+const int FULL_SPINS = 16;                              // yields before sleeping for space
+
+// tells queues apart, so a thread does not use a ring of a destroyed queue
+static std::atomic<uint64_t> queueSerial(0);
+
+// set on a writer thread, which must not wait for itself
+static thread_local bool isWriterThread = false;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+LogQueue::LogQueue(LogSink* sink, int flushInterval) : sink(sink), flushInterval(flushInterval),
+                                                       fullWait(DEFAULT_FULL_WAIT),
+                                                       serial(++queueSerial), ringsCreated(0), dropped(0),
+                                                       running(false), wakeRequested(false),
+                                                       flushRequested(0), flushDone(0)
+{
+    if(this->flushInterval <= 0)
+        this->flushInterval = 1;
+}
+
+LogQueue::~LogQueue()
+{
+    stop();
+}
+
+LogQueue::Ring::Ring(uint64_t owner, int number) : buffer(RING_BYTES), owner(owner), number(number),
+                                                   head(0), tail(0), pending(NO_PENDING), dropped(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// writer thread control
+///////////////////////////////////////////////////////////////////////////////
+void LogQueue::start()
+{
+    std::lock_guard<std::mutex> lock(wakeLock);
+    if(running.load())
+        return;
+    running.store(true);
+    writer = std::thread(&LogQueue::run, this);
+}
+
+void LogQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeLock);
+        running.store(false);
+    }
+    wakeCondition.notify_all();
+    if(writer.joinable())
+        writer.join();
+
+    // whatever was put after the last pass of the writer
+    drain();
+
+    std::lock_guard<std::mutex> lock(wakeLock);
+    flushDone = flushRequested;
+    flushCondition.notify_all();
+}
+
+void LogQueue::flush()
+{
+    if(!running.load())
+    {
+        drain();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(wakeLock);
+    uint64_t request = ++flushRequested;
+    wakeCondition.notify_one();
+    flushCondition.wait(lock, [&]() { return flushDone >= request; });
+}
+
+int LogQueue::getThreadCount() const
+{
+    std::lock_guard<std::mutex> lock(ringsLock);
+    return (int)rings.size();
+}
+
+int64_t LogQueue::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ring of the calling thread
+// the thread keeps a reference to its ring, so the writer knows a ring is no
+// longer used when the queue holds the only reference
+///////////////////////////////////////////////////////////////////////////////
+LogQueue::Ring* LogQueue::getRing()
+{
+    static thread_local std::shared_ptr<Ring> cached;
+    if(cached && cached->owner == serial)
+        return cached.get();
+
+    std::lock_guard<std::mutex> lock(ringsLock);
+    std::thread::id id = std::this_thread::get_id();
+    for(size_t i = 0; i < rings.size(); ++i)
+    {
+        if(rings[i]->thread == id)
+        {
+            cached = rings[i];
+            return cached.get();
+        }
+    }
+
+    cached = std::make_shared<Ring>(serial, ++ringsCreated);
+    cached->thread = id;
+    rings.push_back(cached);
+    return cached.get();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// text and binary messages
+///////////////////////////////////////////////////////////////////////////////
+wchar_t* LogQueue::begin(size_t maxLength)
+{
+    if(maxLength > MAX_LENGTH)
+        maxLength = MAX_LENGTH;
+    return (wchar_t*)reserve(maxLength * sizeof(wchar_t));
+}
+
+void LogQueue::commit(size_t length)
+{
+    if(length > MAX_LENGTH)
+        length = MAX_LENGTH;
+    publish(length * sizeof(wchar_t), (uint32_t)length);
+}
+
+void* LogQueue::beginBinary(size_t maxBytes)
+{
+    if(maxBytes > MAX_LENGTH * sizeof(wchar_t))
+        maxBytes = MAX_LENGTH * sizeof(wchar_t);
+    return reserve(maxBytes);
+}
+
+void LogQueue::commitBinary(size_t bytes)
+{
+    if(bytes > MAX_LENGTH * sizeof(wchar_t))
+        bytes = MAX_LENGTH * sizeof(wchar_t);
+    publish(bytes, (uint32_t)bytes | BINARY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// reserve a record in the ring of this thread
+///////////////////////////////////////////////////////////////////////////////
+char* LogQueue::reserve(size_t bytes)
+{
+    Ring* ring = getRing();
+    uint64_t size = (sizeof(Record) + bytes + RECORD_ALIGN - 1) & ~(uint64_t)(RECORD_ALIGN - 1);
+
+    // a record never wraps, the end of the ring is skipped with a padding record
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    uint64_t offset = head & RING_MASK;
+    uint64_t padding = offset + size > RING_BYTES ? RING_BYTES - offset : 0;
+    if(head + padding + size - tail > RING_BYTES && !waitForSpace(ring, padding + size))
+    {
+        ring->pending = NO_PENDING;
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    if(padding)
+    {
+        Record* skip = (Record*)&ring->buffer[offset];
+        skip->size = (uint32_t)padding;
+        skip->length = PADDING;
+        skip->time = 0;
+    }
+
+    ring->pending = head + padding;
+    Record* record = (Record*)&ring->buffer[ring->pending & RING_MASK];
+    record->size = (uint32_t)size;
+    record->time = now();
+    return (char*)(record + 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// wake the writer and back off until it has read enough of the ring of this
+// thread: a few yields first, then 1 ms sleeps up to the full wait
+// Nothing can free the space if no writer runs or if this is the writer.
+///////////////////////////////////////////////////////////////////////////////
+bool LogQueue::waitForSpace(Ring* ring, uint64_t bytes)
+{
+    int wait = fullWait.load(std::memory_order_relaxed);
+    if(wait <= 0 || isWriterThread)
+        return false;
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait);
+    for(int i = 0; running.load(std::memory_order_relaxed); ++i)
+    {
+        if(!wakeRequested.exchange(true, std::memory_order_relaxed))
+            wakeCondition.notify_one();
+
+        if(i < FULL_SPINS)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if(head + bytes - ring->tail.load(std::memory_order_acquire) <= RING_BYTES)
+            return true;
+        if(i >= FULL_SPINS && std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// publish the record reserved by reserve(), cut to the reserved size
+///////////////////////////////////////////////////////////////////////////////
+void LogQueue::publish(size_t bytes, uint32_t length)
+{
+    Ring* ring = getRing();
+    if(ring->pending == NO_PENDING)
+        return;
+
+    Record* record = (Record*)&ring->buffer[ring->pending & RING_MASK];
+    size_t capacity = record->size - sizeof(Record);
+    if(bytes > capacity)
+    {
+        bytes = capacity;
+        length = (length & BINARY) ? (uint32_t)bytes | BINARY : (uint32_t)(bytes / sizeof(wchar_t));
+    }
+    record->length = length;
+    record->size = (uint32_t)((sizeof(Record) + bytes + RECORD_ALIGN - 1) & ~(uint64_t)(RECORD_ALIGN - 1));
+
+    uint64_t head = ring->pending + record->size;
+    ring->pending = NO_PENDING;
+    ring->head.store(head, std::memory_order_release);
+
+    if(head - ring->tail.load(std::memory_order_relaxed) > WAKE_BYTES &&
+       !wakeRequested.exchange(true, std::memory_order_relaxed))
+        wakeCondition.notify_one();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// caller side helpers
+///////////////////////////////////////////////////////////////////////////////
+bool LogQueue::put(const wchar_t* text, size_t length)
+{
+    if(length > MAX_LENGTH - 1)
+        length = MAX_LENGTH - 1;
+    wchar_t* buffer = begin(length);
+    if(!buffer)
+        return false;
+    memcpy(buffer, text, length * sizeof(wchar_t));
+    commit(length);
+    return true;
+}
+
+bool LogQueue::put(const wchar_t* text)
+{
+    return put(text, wcslen(text));
+}
+
+bool LogQueue::vput(const wchar_t* format, va_list args)
+{
+    wchar_t* buffer = begin(MAX_LENGTH);
+    if(!buffer)
+        return false;
+
+    // truncated or failed output is not reliably terminated
+    int length = vswprintf(buffer, MAX_LENGTH, format, args);
+    if(length < 0)
+    {
+        buffer[MAX_LENGTH - 1] = L'\0';
+        length = (int)wcslen(buffer);
+    }
+    commit(length);
+    return true;
+}
+
+bool LogQueue::vput(const char* format, va_list args)
+{
+    char text[MAX_LENGTH];
+    if(vsnprintf(text, MAX_LENGTH, format, args) < 0)
+        text[0] = '\0';
+
+    wchar_t* buffer = begin(MAX_LENGTH);
+    if(!buffer)
+        return false;
+    size_t length = mbstowcs(buffer, text, MAX_LENGTH - 1);
+    if(length == (size_t)-1)
+        length = 0;
+    commit(length);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// writer thread: drain every flush interval, earlier if woken
+///////////////////////////////////////////////////////////////////////////////
+void LogQueue::run()
+{
+    isWriterThread = true;
+    std::unique_lock<std::mutex> lock(wakeLock);
+    while(running.load())
+    {
+        wakeCondition.wait_for(lock, std::chrono::milliseconds(flushInterval), [&]()
+        {
+            return !running.load() || wakeRequested.load(std::memory_order_relaxed) || flushRequested != flushDone;
+        });
+        wakeRequested.store(false, std::memory_order_relaxed);
+        uint64_t request = flushRequested;
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+        flushDone = request;
+        flushCondition.notify_all();
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// hand all published records to the sink, merged by time
+// only the records published when the batch starts are taken, so a thread
+// logging continuously cannot keep the writer in one batch forever
+///////////////////////////////////////////////////////////////////////////////
+void LogQueue::drain()
+{
+    std::lock_guard<std::mutex> drainGuard(drainLock);
+    {
+        std::lock_guard<std::mutex> lock(ringsLock);
+
+        // rings of exited threads, once read
+        for(size_t i = 0; i < rings.size();)
+        {
+            Ring& ring = *rings[i];
+            if(rings[i].use_count() == 1 && ring.dropped.load() == 0 &&
+               ring.tail.load(std::memory_order_relaxed) == ring.head.load(std::memory_order_acquire))
+            {
+                rings[i] = rings.back();
+                rings.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        snapshot = rings;
+    }
+    if(snapshot.empty())
+        return;
+
+    bool written = false;
+    int64_t time = now();
+    for(size_t i = 0; i < snapshot.size(); ++i)
+    {
+        uint32_t count = snapshot[i]->dropped.exchange(0, std::memory_order_relaxed);
+        if(count)
+        {
+            wchar_t note[NOTE_LENGTH];
+            int length = swprintf(note, NOTE_LENGTH, L"(%u log messages dropped)", count);
+            sink->write(time, snapshot[i]->number, note, length > 0 ? length : 0);
+            written = true;
+        }
+    }
+
+    positions.resize(snapshot.size());
+    limits.resize(snapshot.size());
+    for(size_t i = 0; i < snapshot.size(); ++i)
+    {
+        positions[i] = snapshot[i]->tail.load(std::memory_order_relaxed);
+        limits[i] = snapshot[i]->head.load(std::memory_order_acquire);
+    }
+
+    while(true)
+    {
+        // oldest record at the front of a ring
+        int best = -1;
+        const Record* bestRecord = 0;
+        for(size_t i = 0; i < snapshot.size(); ++i)
+        {
+            Ring& ring = *snapshot[i];
+            while(positions[i] < limits[i])
+            {
+                const Record* record = (const Record*)&ring.buffer[positions[i] & RING_MASK];
+                if(record->length != PADDING)
+                {
+                    if(!bestRecord || record->time < bestRecord->time)
+                    {
+                        best = (int)i;
+                        bestRecord = record;
+                    }
+                    break;
+                }
+                positions[i] += record->size;
+                ring.tail.store(positions[i], std::memory_order_release);
+            }
+        }
+        if(best < 0)
+            break;
+
+        Ring& ring = *snapshot[best];
+        if(bestRecord->length & BINARY)
+            sink->writeBinary(bestRecord->time, ring.number, bestRecord + 1, bestRecord->length & ~BINARY);
+        else
+            sink->write(bestRecord->time, ring.number, (const wchar_t*)(bestRecord + 1), bestRecord->length);
+        written = true;
+
+        // give the space back as soon as it is read
+        positions[best] += bestRecord->size;
+        ring.tail.store(positions[best], std::memory_order_release);
+    }
+
+    if(written)
+        sink->endBatch();
+    snapshot.clear();
+}
@@ -0,0 +1,169 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// LogQueue.h
+// ==========
+// Asynchronous log messages: callers only copy (or format) a message into a
+// ring of their own thread, and a writer thread hands the messages to a
+// LogSink in batches, so file and dialog writes never block the caller.
+//
+// Each thread gets its own single-producer ring the first time it logs (the
+// only time a lock is taken on the caller side). A message is written in
+// place into the ring and published with one release store: no lock, no
+// allocation and no system call, so the caller's cost does not depend on
+// the sink or on other threads logging at the same time.
+//
+// If the ring of a thread is full, the message is dropped and counted, and
+// the writer reports the count: by default a caller never waits for the
+// sink, so a render or tracking thread keeps its frame time however slow the
+// file or the dialog is. A queue whose callers may block instead opts in
+// with setFullWait(): a caller with a full ring then wakes the writer and
+// backs off (yield, then 1 ms sleeps) until the writer frees enough space,
+// for up to the full wait, and drops the message only then. Even so a
+// message is dropped at once when no writer thread is running (before
+// start() or after stop()) or when the caller is the writer thread itself
+// (a sink that logs).
+//
+// The writer thread wakes every flush interval (or earlier when a ring is
+// getting full), merges the rings by timestamp and writes everything it found
+// in one batch. stop() and the destructor drain all rings before returning,
+// so no message put before them is lost; flush() waits until everything put
+// before it was written.
+//
+// A message is either text or binary. Binary messages are opaque bytes for
+// the sink, e.g. a format id and its raw arguments (see BinaryLog.h), so the
+// caller does not pay for the formatting at all.
+//
+// USAGE:
+//     LogQueue queue(&sink);
+//     queue.start();
+//     queue.put(L"text");                         // any thread
+//     wchar_t* text = queue.begin(256);           // or format in place
+//     if(text)
+//         queue.commit(swprintf(text, 256, L"%d", 1));
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// receives the messages on the writer thread
+class LogSink
+{
+public:
+    virtual ~LogSink() {}
+    virtual void write(int64_t time, int thread, const wchar_t* text, size_t length) = 0;
+    virtual void writeBinary(int64_t /*time*/, int /*thread*/, const void* /*data*/, size_t /*bytes*/) {}
+    virtual void endBatch() {}                      // after the last write() of a batch
+};
+
+class LogQueue
+{
+public:
+    enum { RING_BYTES = 64 * 1024,                  // per thread, power of 2
+           MAX_LENGTH = 1024 };                     // characters of a message, with the null
+
+    explicit LogQueue(LogSink* sink, int flushInterval = 10);   // millisecond
+    ~LogQueue();                                    // stop()
+
+    void start();                                   // start the writer thread
+    void stop();                                    // write everything and stop the writer thread
+    void flush();                                   // wait until all messages put before are written
+
+    // longest wait of a caller for space in a full ring, 0 (default) to drop at once
+    void setFullWait(int millisecond)               { fullWait.store(millisecond < 0 ? 0 : millisecond); }
+    int getFullWait() const                         { return fullWait.load(); }
+
+    // caller side, any thread
+    bool put(const wchar_t* text, size_t length);
+    bool put(const wchar_t* text);
+    bool vput(const wchar_t* format, va_list args); // format in place
+    bool vput(const char* format, va_list args);    // format, then widen in place
+
+    // space for a message of maxLength characters in the ring of this thread,
+    // 0 if full; commit() publishes length of them, nothing is published
+    // until then, and begin() must not be called again before
+    wchar_t* begin(size_t maxLength);
+    void commit(size_t length);
+
+    // same for a binary message of up to maxBytes, MAX_LENGTH * sizeof(wchar_t) at most
+    void* beginBinary(size_t maxBytes);
+    void commitBinary(size_t bytes);
+
+    int64_t getDroppedCount() const                 { return dropped.load(std::memory_order_relaxed); }
+    int getThreadCount() const;                     // rings in use
+
+    // steady clock in nanoseconds, the time of the messages
+    static int64_t now();
+
+private:
+    // fixed part of a message in a ring, the text follows
+    struct Record
+    {
+        uint32_t size;                              // bytes of the record, multiple of RECORD_ALIGN
+        uint32_t length;                            // characters of the text, bytes | BINARY, or PADDING to skip to the start of the ring
+        int64_t time;
+    };
+    enum { RECORD_ALIGN = sizeof(Record) };
+    static const uint32_t PADDING = 0xffffffff;
+    static const uint32_t BINARY = 0x80000000;
+
+    // single-producer single-consumer byte ring
+    struct Ring
+    {
+        Ring(uint64_t owner, int number);
+        std::vector<char> buffer;
+        uint64_t owner;                             // serial of the LogQueue it belongs to
+        std::thread::id thread;
+        int number;                                 // thread number in the log
+        std::atomic<uint64_t> head;                 // written by the producer
+        char padding0[64];
+        std::atomic<uint64_t> tail;                 // written by the consumer
+        char padding1[64];
+        uint64_t pending;                           // producer: position of the reserved record
+        std::atomic<uint32_t> dropped;              // messages dropped since the writer last looked
+    };
+
+    Ring* getRing();                                // ring of the calling thread, registered on the first call
+    char* reserve(size_t bytes);                    // space for a record of up to bytes after the header
+    bool waitForSpace(Ring* ring, uint64_t bytes);  // back off until bytes fit in ring, false after the full wait
+    void publish(size_t bytes, uint32_t length);    // the reserved record with bytes after the header
+    void run();                                     // writer thread
+    void drain();                                   // all published messages to the sink
+
+    LogSink* sink;
+    int flushInterval;
+    std::atomic<int> fullWait;                      // millisecond
+    uint64_t serial;                                // tells this queue from an older one at the same address
+    std::vector<std::shared_ptr<Ring> > rings;      // guarded by ringsLock
+    mutable std::mutex ringsLock;
+    int ringsCreated;                               // guarded by ringsLock
+    std::atomic<int64_t> dropped;
+
+    // writer side, guarded by drainLock
+    std::mutex drainLock;
+    std::vector<std::shared_ptr<Ring> > snapshot;   // copy of rings
+    std::vector<uint64_t> positions;                // read position in each ring
+    std::vector<uint64_t> limits;                   // head of each ring when the batch started
+
+    std::thread writer;
+    std::mutex wakeLock;
+    std::condition_variable wakeCondition;          // writer sleeps on it
+    std::condition_variable flushCondition;         // flush() sleeps on it
+    std::atomic<bool> running;
+    std::atomic<bool> wakeRequested;
+    uint64_t flushRequested;                        // guarded by wakeLock
+    uint64_t flushDone;
+};
+
+#endif
@@ -0,0 +1,183 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MappedFile.cpp
+// ==============
+// Minimal memory-mapped file, Win32 (CreateFileMapping) or POSIX (mmap).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+MappedFile::MappedFile() : file(0), fd(-1), size(0), opened(false), writable(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// open an existing file for reading, or create/truncate a file for writing
+///////////////////////////////////////////////////////////////////////////////
+bool MappedFile::open(const char* fileName, bool write)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE handle = ::CreateFileA(fileName,
+                                  write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                                  FILE_SHARE_READ,
+                                  0,
+                                  write ? CREATE_ALWAYS : OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL,
+                                  0);
+    if(handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if(!::GetFileSizeEx(handle, &fileSize))
+    {
+        ::CloseHandle(handle);
+        return false;
+    }
+    file = handle;
+    size = fileSize.QuadPart;
+#else
+    fd = ::open(fileName, write ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    size = info.st_size;
+#endif
+
+    opened = true;
+    writable = write;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// close the file handle, views mapped before remain valid until unmapped
+///////////////////////////////////////////////////////////////////////////////
+void MappedFile::close()
+{
+    if(!opened)
+        return;
+
+#ifdef _WIN32
+    ::CloseHandle((HANDLE)file);
+    file = 0;
+#else
+    ::close(fd);
+    fd = -1;
+#endif
+    size = 0;
+    opened = false;
+    writable = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the file size, the new part is filled with 0
+///////////////////////////////////////////////////////////////////////////////
+bool MappedFile::resize(int64_t newSize)
+{
+    if(!opened || !writable || newSize < 0)
+        return false;
+
+#ifdef _WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = newSize;
+    if(!::SetFilePointerEx((HANDLE)file, position, 0, FILE_BEGIN) || !::SetEndOfFile((HANDLE)file))
+        return false;
+#else
+    if(::ftruncate(fd, (off_t)newSize) != 0)
+        return false;
+#endif
+
+    size = newSize;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map a view of [offset, offset+size), offset must be aligned to granularity
+///////////////////////////////////////////////////////////////////////////////
+void* MappedFile::map(int64_t offset, size_t viewSize)
+{
+    if(!opened || viewSize == 0 || offset < 0 || offset + (int64_t)viewSize > size)
+        return 0;
+
+#ifdef _WIN32
+    // a mapping object covers the file size at the time it is created, so
+    // create one for each view; the view keeps it alive after CloseHandle()
+    HANDLE mapping = ::CreateFileMappingA((HANDLE)file, 0, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                          (DWORD)(size >> 32), (DWORD)(size & 0xffffffff), 0);
+    if(!mapping)
+        return 0;
+
+    void* view = ::MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                 (DWORD)(offset >> 32), (DWORD)(offset & 0xffffffff), viewSize);
+    ::CloseHandle(mapping);
+    return view;
+#else
+    void* view = ::mmap(0, viewSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, (off_t)offset);
+    return view == MAP_FAILED ? 0 : view;
+#endif
+}
+
+void MappedFile::unmap(void* view, size_t viewSize)
+{
+    if(!view)
+        return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(view);
+    (void)viewSize;
+#else
+    ::munmap(view, viewSize);
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// alignment of view offsets
+///////////////////////////////////////////////////////////////////////////////
+size_t MappedFile::getGranularity()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return (size_t)::sysconf(_SC_PAGESIZE);
+#endif
+}
@@ -0,0 +1,52 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MappedFile.h
+// ============
+// Minimal memory-mapped file, Win32 (CreateFileMapping) or POSIX (mmap).
+// A file is opened for reading or writing, then views of any part of it are
+// mapped with map(). In write mode resize() grows the file first; the views
+// already mapped stay valid when the file grows.
+//
+// Offsets of views must be multiples of getGranularity() (64 KB on Windows).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();                                  // close the file, views must be unmapped before
+
+    bool open(const char* fileName, bool write);    // write mode creates or truncates the file
+    void close();
+    bool isOpen() const                             { return opened; }
+    bool isWritable() const                         { return writable; }
+
+    int64_t getSize() const                         { return size; }
+    bool resize(int64_t size);                      // write mode only
+
+    void* map(int64_t offset, size_t size);         // return NULL if failed
+    void unmap(void* view, size_t size);
+
+    static size_t getGranularity();
+
+private:
+    // not copyable, it owns the file handle
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    void* file;                                     // HANDLE on Windows
+    int fd;                                         // file descriptor on POSIX
+    int64_t size;
+    bool opened;
+    bool writable;
+};
+
+#endif
@@ -0,0 +1,102 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MpscQueue.h
+// ===========
+// Bounded lock-free queue for many producer threads and one consumer thread.
+// Each cell carries a sequence number telling whether it is free for the
+// producer of a position or full for the consumer (D. Vyukov's bounded
+// queue). push() is lock-free, pop() is wait-free, no memory is allocated
+// after construction.
+//
+// push() may be called from any thread, pop() only from one thread.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <class T>
+class MpscQueue
+{
+public:
+    // capacity is rounded up to a power of 2
+    explicit MpscQueue(size_t capacity = 1024) : cells(0), mask(0), enqueuePos(0), dequeuePos(0)
+    {
+        size_t size = 2;
+        while(size < capacity)
+            size <<= 1;
+        cells = new Cell[size];
+        mask = size - 1;
+        for(size_t i = 0; i < size; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ~MpscQueue()                                    { delete [] cells; }
+
+    // return false if the queue is full
+    bool push(const T& value)
+    {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if(diff == 0)
+            {
+                if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(diff < 0)
+            {
+                return false;                       // full
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // return false if the queue is empty, consumer thread only
+    bool pop(T& value)
+    {
+        Cell* cell = &cells[dequeuePos & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if((intptr_t)sequence - (intptr_t)(dequeuePos + 1) < 0)
+            return false;                           // empty, or a producer is still writing it
+        value = cell->value;
+        cell->sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+    size_t getCapacity() const                      { return mask + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    MpscQueue(const MpscQueue&);                    // not copyable
+    MpscQueue& operator=(const MpscQueue&);
+
+    Cell* cells;
+    size_t mask;
+    char pad0[64];                                  // keep producer and consumer positions on different cache lines
+    std::atomic<size_t> enqueuePos;
+    char pad1[64];
+    size_t dequeuePos;                              // owned by the consumer
+};
+
+#endif
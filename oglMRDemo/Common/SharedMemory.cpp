@@ -0,0 +1,200 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// SharedMemory.cpp
+// ================
+// Named shared memory between processes, Win32 or POSIX.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstdint>
+#include "SharedMemory.h"
+
+// POSIX names start with a slash, Windows names are used as given
+static std::string toSystemName(const char* name)
+{
+#ifdef _WIN32
+    return name;
+#else
+    return name[0] == '/' ? std::string(name) : "/" + std::string(name);
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+SharedMemory::SharedMemory() : data(0), size(0), mapping(0), owner(false)
+{
+}
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create a new block, fails if the name exists
+///////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::create(const char* blockName, size_t blockSize)
+{
+    close();
+    if(!blockName || !blockName[0] || blockSize == 0)
+        return false;
+
+    std::string systemName = toSystemName(blockName);
+
+#ifdef _WIN32
+    HANDLE handle = ::CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE,
+                                         (DWORD)((uint64_t)blockSize >> 32), (DWORD)(blockSize & 0xffffffff),
+                                         systemName.c_str());
+    if(!handle)
+        return false;
+    if(::GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        ::CloseHandle(handle);
+        return false;
+    }
+
+    void* view = ::MapViewOfFile(handle, FILE_MAP_WRITE, 0, 0, blockSize);
+    if(!view)
+    {
+        ::CloseHandle(handle);
+        return false;
+    }
+    mapping = handle;
+#else
+    int fd = ::shm_open(systemName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if(fd < 0)
+        return false;
+
+    if(::ftruncate(fd, (off_t)blockSize) != 0)
+    {
+        ::close(fd);
+        ::shm_unlink(systemName.c_str());
+        return false;
+    }
+
+    void* view = ::mmap(0, blockSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);                                    // the mapping keeps the block
+    if(view == MAP_FAILED)
+    {
+        ::shm_unlink(systemName.c_str());
+        return false;
+    }
+#endif
+
+    data = view;
+    size = blockSize;
+    name = systemName;
+    owner = true;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map an existing block, its size is the size given to create()
+///////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::open(const char* blockName, bool write)
+{
+    close();
+    if(!blockName || !blockName[0])
+        return false;
+
+    std::string systemName = toSystemName(blockName);
+
+#ifdef _WIN32
+    HANDLE handle = ::OpenFileMappingA(write ? FILE_MAP_WRITE : FILE_MAP_READ, FALSE, systemName.c_str());
+    if(!handle)
+        return false;
+
+    void* view = ::MapViewOfFile(handle, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if(!view || ::VirtualQuery(view, &info, sizeof(info)) == 0)
+    {
+        if(view)
+            ::UnmapViewOfFile(view);
+        ::CloseHandle(handle);
+        return false;
+    }
+    mapping = handle;
+    size = info.RegionSize;                         // rounded up to pages
+#else
+    int fd = ::shm_open(systemName.c_str(), write ? O_RDWR : O_RDONLY, 0);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(0, (size_t)info.st_size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(view == MAP_FAILED)
+        return false;
+    size = (size_t)info.st_size;
+#endif
+
+    data = view;
+    name = systemName;
+    owner = false;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// remove a name left by a crashed creator, processes that have the block
+// mapped keep it; nothing to do on Windows
+///////////////////////////////////////////////////////////////////////////////
+bool SharedMemory::remove(const char* blockName)
+{
+    if(!blockName || !blockName[0])
+        return false;
+#ifdef _WIN32
+    return true;
+#else
+    return ::shm_unlink(toSystemName(blockName).c_str()) == 0;
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap, the creator also removes the name
+///////////////////////////////////////////////////////////////////////////////
+void SharedMemory::close()
+{
+    if(!data)
+        return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(data);
+    ::CloseHandle((HANDLE)mapping);                 // the block is freed with its last handle
+    mapping = 0;
+#else
+    ::munmap(data, size);
+    if(owner)
+        ::shm_unlink(name.c_str());
+#endif
+
+    data = 0;
+    size = 0;
+    name.clear();
+    owner = false;
+}
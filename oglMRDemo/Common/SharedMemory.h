@@ -0,0 +1,51 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// SharedMemory.h
+// ==============
+// Named shared memory between processes, Win32 (CreateFileMapping on the page
+// file) or POSIX (shm_open + mmap). One process creates the block, any number
+// of processes open it by name and map the whole block.
+//
+// The creator owns the name: on POSIX close() unlinks it, processes that
+// still have it mapped keep their view. create() fails if the name exists.
+// A block left by a crashed creator stays on POSIX until remove(); on Windows
+// it goes away with its last handle.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <cstddef>
+#include <string>
+
+class SharedMemory
+{
+public:
+    SharedMemory();
+    ~SharedMemory();                                // unmap, and remove the name if created
+
+    bool create(const char* name, size_t size);     // filled with 0, read/write
+    bool open(const char* name, bool write = false);
+    static bool remove(const char* name);
+    void close();
+    bool isOpen() const                             { return data != 0; }
+    bool isOwner() const                            { return owner; }
+
+    void* getData() const                           { return data; }
+    size_t getSize() const                          { return size; }
+
+private:
+    // not copyable, it owns the mapping
+    SharedMemory(const SharedMemory&);
+    SharedMemory& operator=(const SharedMemory&);
+
+    void* data;
+    size_t size;
+    void* mapping;                                  // HANDLE on Windows
+    std::string name;                               // as given to the OS
+    bool owner;
+};
+
+#endif
@@ -0,0 +1,242 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// Trace.cpp
+// =========
+// Frame timeline tracing: per-thread event buffers and Chrome trace export
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Trace.h"
+
+const int TRACE_PROCESS_ID = 1;
+const char* TRACE_CATEGORY = "f3d";
+
+// one event, 32 bytes
+struct TraceRecord
+{
+    int64_t time;                                   // LogQueue::now()
+    int64_t data;                                   // duration of a zone, id of a flow, bits of a counter
+    const char* name;
+    int type;
+};
+
+// events of a thread; only the thread writes events and publishes them with
+// count, stopTrace() reads the published ones
+struct TraceBuffer
+{
+    TraceBuffer() : count(0), dropped(0), session(0), thread(0), name(0) {}
+
+    std::unique_ptr<TraceRecord[]> events;          // allocated at the first event of the thread
+    std::atomic<int> count;
+    std::atomic<int> dropped;
+    std::atomic<int> session;                       // trace the events belong to, set after count
+    int thread;                                     // tid in the trace
+    const char* name;                               // guarded by traceLock
+};
+
+std::atomic<bool> traceEnabled(false);
+
+static std::mutex traceLock;                        // buffers, names, start/stop
+static std::vector<std::unique_ptr<TraceBuffer> > traceBuffers;
+static std::atomic<int> traceSession(0);
+static int64_t traceStartTime = 0;
+
+static void writeString(FILE* file, const char* text);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// buffer of the calling thread, emptied at the first event of a new trace
+// Buffers stay registered after their thread exits, so a trace keeps the
+// events of short-lived threads.
+///////////////////////////////////////////////////////////////////////////////
+static TraceBuffer* getTraceBuffer()
+{
+    static thread_local TraceBuffer* buffer = 0;
+    if(!buffer)
+    {
+        std::lock_guard<std::mutex> lock(traceLock);
+        traceBuffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer()));
+        buffer = traceBuffers.back().get();
+        buffer->thread = (int)traceBuffers.size();
+    }
+
+    int session = traceSession.load(std::memory_order_acquire);
+    if(buffer->session.load(std::memory_order_relaxed) != session)
+    {
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+    return buffer;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// record an event to the buffer of the calling thread
+///////////////////////////////////////////////////////////////////////////////
+void traceEvent(int type, const char* name, int64_t time, int64_t data)
+{
+    TraceBuffer* buffer = getTraceBuffer();
+    if(!buffer->events)
+        buffer->events.reset(new TraceRecord[TRACE_BUFFER_EVENTS]);
+    int count = buffer->count.load(std::memory_order_relaxed);
+    if(count >= TRACE_BUFFER_EVENTS)
+    {
+        buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceRecord& record = buffer->events[count];
+    record.time = time;
+    record.data = data;
+    record.name = name;
+    record.type = type;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void traceCounter(const char* name, double value)
+{
+    int64_t data;
+    memcpy(&data, &value, sizeof(data));
+    traceEvent(TRACE_EVENT_COUNTER, name, LogQueue::now(), data);
+}
+
+void setTraceThreadName(const char* name)
+{
+    TraceBuffer* buffer = getTraceBuffer();
+    std::lock_guard<std::mutex> lock(traceLock);
+    buffer->name = name;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// start / stop
+// A new session makes each thread empty its buffer at its next event, so no
+// thread writes to the buffer of another.
+///////////////////////////////////////////////////////////////////////////////
+void startTrace()
+{
+    std::lock_guard<std::mutex> lock(traceLock);
+    traceStartTime = LogQueue::now();
+    traceSession.fetch_add(1, std::memory_order_release);
+    traceEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool stopTrace(const char* fileName, int* events, int* dropped)
+{
+    std::lock_guard<std::mutex> lock(traceLock);
+    traceEnabled.store(false, std::memory_order_relaxed);
+    int session = traceSession.load(std::memory_order_relaxed);
+
+    int eventCount = 0;
+    int droppedCount = 0;
+    FILE* file = fileName ? fopen(fileName, "wb") : 0;
+    if(file)
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    for(size_t i = 0; i < traceBuffers.size(); ++i)
+    {
+        TraceBuffer* buffer = traceBuffers[i].get();
+        int tid = buffer->thread;
+
+        // a thread that has not recorded in this trace still has the events
+        // of an older one; the session is read before the count, the thread
+        // writes them the other way
+        if(buffer->session.load(std::memory_order_acquire) != session)
+            continue;
+        int count = buffer->count.load(std::memory_order_acquire);
+        eventCount += count;
+        droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+        if(!file)
+            continue;
+
+        if(buffer->name)
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                    first ? "" : ",\n", TRACE_PROCESS_ID, tid);
+            writeString(file, buffer->name);
+            fprintf(file, "}}");
+            first = false;
+        }
+
+        for(int j = 0; j < count; ++j)
+        {
+            const TraceRecord& record = buffer->events[j];
+            double ts = (record.time - traceStartTime) / 1000.0;        // microsecond
+            fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+            first = false;
+            writeString(file, record.name);
+            switch(record.type)
+            {
+            case TRACE_EVENT_ZONE:
+                fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                        TRACE_CATEGORY, ts, record.data / 1000.0);
+                break;
+            case TRACE_EVENT_COUNTER:
+                {
+                double value;
+                memcpy(&value, &record.data, sizeof(value));
+                fprintf(file, ",\"ph\":\"C\",\"ts\":%.3f,\"args\":{\"value\":%.6g}", ts, value);
+                break;
+                }
+            case TRACE_EVENT_FLOW_BEGIN:
+                fprintf(file, ",\"cat\":\"%s\",\"ph\":\"s\",\"id\":%lld,\"ts\":%.3f",
+                        TRACE_CATEGORY, (long long)record.data, ts);
+                break;
+            default:
+                fprintf(file, ",\"cat\":\"%s\",\"ph\":\"f\",\"bp\":\"e\",\"id\":%lld,\"ts\":%.3f",
+                        TRACE_CATEGORY, (long long)record.data, ts);
+                break;
+            }
+            fprintf(file, ",\"pid\":%d,\"tid\":%d}", TRACE_PROCESS_ID, tid);
+        }
+    }
+
+    bool result = true;
+    if(file)
+    {
+        fprintf(file, "\n],\"otherData\":{\"droppedEvents\":%d}}\n", droppedCount);
+        result = fclose(file) == 0;
+    }
+    else
+    {
+        result = fileName == 0;
+    }
+
+    if(events)
+        *events = eventCount;
+    if(dropped)
+        *dropped = droppedCount;
+    return result;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// JSON string
+///////////////////////////////////////////////////////////////////////////////
+static void writeString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for(const char* p = text ? text : ""; *p; ++p)
+    {
+        unsigned char c = (unsigned char)*p;
+        if(c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if(c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
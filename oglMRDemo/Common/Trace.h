@@ -0,0 +1,120 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// Trace.h
+// =======
+// Frame timeline tracing: scoped zones, counters and flow events recorded to
+// per-thread buffers, exported as a Chrome trace (JSON) for chrome://tracing
+// or ui.perfetto.dev.
+//
+// USAGE:
+//     startTrace();                                   // any thread
+//     ...
+//     void ModelGL::draw()
+//     {
+//         TRACE_ZONE("ModelGL::draw");                // until the end of the scope
+//         TRACE_COUNTER("strokes", strokeCount);
+//     }
+//     TRACE_FLOW_BEGIN("pose", sequence);             // tracking thread
+//     TRACE_FLOW_END("pose", sequence);               // render thread, arrow from the zone above
+//     ...
+//     stopTrace("trace.json");
+//
+// While tracing is stopped a zone, a counter or a flow costs one relaxed load
+// and a branch that is never taken; the arguments, the name of a zone too,
+// are not evaluated. Define TRACE_ENABLED as 0 to compile them out.
+//
+// Each thread records to its own buffer of TRACE_BUFFER_EVENTS events, so
+// the recording takes no lock. A zone is one event, written when it ends
+// (a Chrome "complete" event). A full buffer drops the newer events of its
+// thread; stopTrace() reports the count. Names must be string literals,
+// only the pointer is recorded.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include "LogQueue.h"
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+const int TRACE_BUFFER_EVENTS = 1 << 16;            // events per thread and trace, 2 MB
+
+enum TraceEventType
+{
+    TRACE_EVENT_ZONE = 1,
+    TRACE_EVENT_COUNTER,
+    TRACE_EVENT_FLOW_BEGIN,
+    TRACE_EVENT_FLOW_END
+};
+
+// start a new trace, the events of the previous one are discarded
+void startTrace();
+
+// stop tracing and write the events to fileName (Chrome trace JSON); false
+// if the file cannot be written. The counts of the trace are returned in
+// events and dropped if given.
+bool stopTrace(const char* fileName, int* events = 0, int* dropped = 0);
+
+// name of the calling thread in the trace, a string literal
+void setTraceThreadName(const char* name);
+
+// the events, called by the macros when tracing
+void traceEvent(int type, const char* name, int64_t time, int64_t data);
+void traceCounter(const char* name, double value);
+
+extern std::atomic<bool> traceEnabled;
+
+inline bool isTraceEnabled()
+{
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+// zone from the ctor to the dtor, no zone if name is 0
+// TRACE_ZONE() gives 0 while tracing is stopped, so the name is not
+// evaluated and the flag is the only test
+class TraceZone
+{
+public:
+    explicit TraceZone(const char* name) : name(name), start(name ? LogQueue::now() : 0) {}
+
+    ~TraceZone()
+    {
+        if(start)
+            traceEvent(TRACE_EVENT_ZONE, name, start, LogQueue::now() - start);
+    }
+
+private:
+    TraceZone(const TraceZone&);
+    TraceZone& operator=(const TraceZone&);
+
+    const char* name;
+    int64_t start;                                  // 0 if there is no zone
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// macros
+///////////////////////////////////////////////////////////////////////////////
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT2(a, b)
+
+#if TRACE_ENABLED
+#define TRACE_ZONE(name)            TraceZone TRACE_CONCAT(traceZone, __LINE__)(isTraceEnabled() ? (name) : (const char*)0)
+#define TRACE_COUNTER(name, value)  do { if(isTraceEnabled()) traceCounter(name, (double)(value)); } while(0)
+#define TRACE_FLOW_BEGIN(name, id)  do { if(isTraceEnabled()) traceEvent(TRACE_EVENT_FLOW_BEGIN, name, LogQueue::now(), (int64_t)(id)); } while(0)
+#define TRACE_FLOW_END(name, id)    do { if(isTraceEnabled()) traceEvent(TRACE_EVENT_FLOW_END, name, LogQueue::now(), (int64_t)(id)); } while(0)
+#else
+#define TRACE_ZONE(name)            do {} while(0)
+#define TRACE_COUNTER(name, value)  do {} while(0)
+#define TRACE_FLOW_BEGIN(name, id)  do {} while(0)
+#define TRACE_FLOW_END(name, id)    do {} while(0)
+#endif
+
+#endif
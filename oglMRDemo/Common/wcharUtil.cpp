@@ -5,40 +5,68 @@
 //
 //  AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
 // CREATED: 2006-07-14
-// UPDATED: 2016-07-21
+// UPDATED: 2026-10-18
 ///////////////////////////////////////////////////////////////////////////////
 
-#pragma warning(disable : 4996)
-#include <cstdlib>
+#include <charconv>
+#include <cstring>
 #include <cwchar>
-#include <sstream>
-#include <string>
-#include <iomanip>
+#include <memory>
 #include "wcharUtil.h"
-using std::stringstream;
-using std::wstringstream;
-using std::string;
-using std::wstring;
-
-// global variables
-const int WCHAR_MAX_COUNT = 16;                                 // max number of string buffers
-const int WCHAR_MAX_LENGTH = 2048;                              // max string length per buffer
-static wchar_t wchar_wideStr[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];// circular buffer for wchar_t*
-static char wchar_str[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];       // circular buffer for char*
-static int wchar_indexWchar = 0;                                // current index of circular buffer
-static int wchar_indexChar = 0;                                 // current index of circular buffer
+
+const int DEFAULT_PRECISION = 6;                                // significant digits as ostream
+
+// circular buffers of a thread, so a conversion never overwrites the result
+// of another thread; allocated at the first conversion of the thread instead
+// of a 96 KB TLS block in every thread of the process
+struct ConversionBuffers
+{
+    wchar_t wideStr[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];         // circular buffer for wchar_t*
+    char str[WCHAR_MAX_COUNT][WCHAR_MAX_LENGTH];                // circular buffer for char*
+    int indexWchar;                                             // current index of circular buffer
+    int indexChar;
+};
+
+static ConversionBuffers& getBuffers()
+{
+    static thread_local std::unique_ptr<ConversionBuffers> buffers;
+    if(!buffers)
+        buffers.reset(new ConversionBuffers());
+    return *buffers;
+}
+
+static wchar_t* nextWideBuffer()
+{
+    ConversionBuffers& buffers = getBuffers();
+    buffers.indexWchar = (buffers.indexWchar + 1) % WCHAR_MAX_COUNT;  // circulate index
+    return buffers.wideStr[buffers.indexWchar];
+}
+
+static char* nextCharBuffer()
+{
+    ConversionBuffers& buffers = getBuffers();
+    buffers.indexChar = (buffers.indexChar + 1) % WCHAR_MAX_COUNT;
+    return buffers.str[buffers.indexChar];
+}
+
+// ASCII digits to wide chars, including the null
+static int widen(wchar_t* buffer, const char* str, int length)
+{
+    for(int i = 0; i <= length; ++i)
+        buffer[i] = (wchar_t)str[i];
+    return length;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // convert char* string to wchar_t* string
 ///////////////////////////////////////////////////////////////////////////////
 const wchar_t* toWchar(const char *src)
 {
-    wchar_indexWchar = (++wchar_indexWchar) % WCHAR_MAX_COUNT;  // circulate index
-
-    mbstowcs(wchar_wideStr[wchar_indexWchar], src, WCHAR_MAX_LENGTH); // copy string as wide char
-    wchar_wideStr[wchar_indexWchar][WCHAR_MAX_LENGTH - 1] = L'\0';      // in case when source exceeded max length
-
-    return wchar_wideStr[wchar_indexWchar];                     // return string as wide char
+    wchar_t* buffer = nextWideBuffer();
+    utf8ToWide(buffer, WCHAR_MAX_LENGTH, src);                  // cut when source exceeded max length
+    return buffer;                                              // return string as wide char
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -46,23 +74,9 @@ const wchar_t* toWchar(const char *src)
 ///////////////////////////////////////////////////////////////////////////////
 const wchar_t* toWchar(double number, int precision)
 {
-    wchar_indexWchar = (++wchar_indexWchar) % WCHAR_MAX_COUNT;  // circulate index
-
-    // convert a number to string
-    wstring wstr;
-    wstringstream wss;
-    if (precision >= 0)
-        wss << std::fixed << std::setprecision(precision);
-
-    wss << number;
-    wstr = wss.str();
-
-    wcscpy(wchar_wideStr[wchar_indexWchar], wstr.c_str());      // copy it to circular buffer
-
-    // unset floating format
-    wss << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
-
-    return wchar_wideStr[wchar_indexWchar];                     // return string as wide char
+    wchar_t* buffer = nextWideBuffer();
+    formatNumber(buffer, WCHAR_MAX_LENGTH, number, precision);
+    return buffer;
 }
 const wchar_t* toWchar(float number, int precision)
 {
@@ -70,17 +84,9 @@ const wchar_t* toWchar(float number, int precision)
 }
 const wchar_t* toWchar(long number)
 {
-    wchar_indexWchar = (++wchar_indexWchar) % WCHAR_MAX_COUNT;  // circulate index
-
-    // convert a number to string
-    wstring wstr;
-    wstringstream wss;
-    wss << number;
-    wstr = wss.str();
-
-    wcscpy(wchar_wideStr[wchar_indexWchar], wstr.c_str());      // copy it to circular buffer
-
-    return wchar_wideStr[wchar_indexWchar];                     // return string as wide char
+    wchar_t* buffer = nextWideBuffer();
+    formatNumber(buffer, WCHAR_MAX_LENGTH, number);
+    return buffer;
 }
 const wchar_t* toWchar(int number)
 {
@@ -92,12 +98,9 @@ const wchar_t* toWchar(int number)
 ///////////////////////////////////////////////////////////////////////////////
 const char* toChar(const wchar_t* src)
 {
-    wchar_indexChar = (++wchar_indexChar) % WCHAR_MAX_COUNT;    // circulate index
-
-    wcstombs(wchar_str[wchar_indexChar], src, WCHAR_MAX_LENGTH);// copy string as char
-    wchar_str[wchar_indexChar][WCHAR_MAX_LENGTH - 1] = '\0';      // in case when source exceeded max length
-
-    return wchar_str[wchar_indexChar];                          // return string as char
+    char* buffer = nextCharBuffer();
+    wideToUtf8(buffer, WCHAR_MAX_LENGTH, src);                  // cut when source exceeded max length
+    return buffer;                                              // return string as char
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -105,43 +108,163 @@ const char* toChar(const wchar_t* src)
 ///////////////////////////////////////////////////////////////////////////////
 const char* toChar(double number, int precision)
 {
-    wchar_indexChar = (++wchar_indexChar) % WCHAR_MAX_COUNT;    // circulate index
+    char* buffer = nextCharBuffer();
+    formatNumber(buffer, WCHAR_MAX_LENGTH, number, precision);
+    return buffer;
+}
+const char* toChar(float number, int precision)
+{
+    return toChar((double)number, precision);
+}
+const char* toChar(long number)
+{
+    char* buffer = nextCharBuffer();
+    formatNumber(buffer, WCHAR_MAX_LENGTH, number);
+    return buffer;
+}
+const char* toChar(int number)
+{
+    return toChar((long)number);
+}
 
-    // convert a number to string
-    string s;
-    stringstream ss;
-    if (precision >= 0)
-        ss << std::fixed << std::setprecision(precision);
 
-    ss << number;
-    s = ss.str();
 
-    strcpy(wchar_str[wchar_indexChar], s.c_str());              // copy to circular buffer
+///////////////////////////////////////////////////////////////////////////////
+// convert a number to the buffer of the caller
+// A fixed number that does not fit (1e300 with 2 decimals) falls back to the
+// default "%g", and to an empty string if even that does not fit.
+///////////////////////////////////////////////////////////////////////////////
+int formatNumber(char* buffer, int size, double number, int precision)
+{
+    if(size <= 0)
+        return 0;
+
+    char* end = buffer + size - 1;                              // room for the null
+    std::to_chars_result result;
+    if(precision >= 0)
+    {
+        result = std::to_chars(buffer, end, number, std::chars_format::fixed, precision);
+        if(result.ec == std::errc())
+        {
+            *result.ptr = '\0';
+            return (int)(result.ptr - buffer);
+        }
+    }
+    result = std::to_chars(buffer, end, number, std::chars_format::general, DEFAULT_PRECISION);
+    if(result.ec != std::errc())
+        result.ptr = buffer;
+    *result.ptr = '\0';
+    return (int)(result.ptr - buffer);
+}
+
+int formatNumber(char* buffer, int size, long number)
+{
+    if(size <= 0)
+        return 0;
 
-    // unset floating format
-    ss << std::resetiosflags(std::ios_base::fixed | std::ios_base::floatfield);
+    std::to_chars_result result = std::to_chars(buffer, buffer + size - 1, number);
+    if(result.ec != std::errc())
+        result.ptr = buffer;
+    *result.ptr = '\0';
+    return (int)(result.ptr - buffer);
+}
 
-    return wchar_str[wchar_indexChar];                          // return string as char
+int formatNumber(wchar_t* buffer, int size, double number, int precision)
+{
+    char str[WCHAR_MAX_LENGTH];
+    int length = formatNumber(str, size < WCHAR_MAX_LENGTH ? size : WCHAR_MAX_LENGTH, number, precision);
+    return size > 0 ? widen(buffer, str, length) : 0;
 }
-const char* toChar(float number, int precision)
+
+int formatNumber(wchar_t* buffer, int size, long number)
 {
-    return toChar((double)number, precision);
+    char str[NUMBER_MAX_LENGTH];
+    int length = formatNumber(str, size < NUMBER_MAX_LENGTH ? size : NUMBER_MAX_LENGTH, number);
+    return size > 0 ? widen(buffer, str, length) : 0;
 }
-const char* toChar(long number)
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// convert UTF-8 and wide strings to the buffer of the caller
+///////////////////////////////////////////////////////////////////////////////
+int utf8ToWide(wchar_t* buffer, int size, const char* str, int length)
 {
-    wchar_indexChar = (++wchar_indexChar) % WCHAR_MAX_COUNT;    // circulate index
+    if(size <= 0)
+        return 0;
 
-    // convert a number to string
-    string s;
-    stringstream ss;
-    ss << number;
-    s = ss.str();
+    const char* p = str;
+    const char* end = str ? str + (length < 0 ? strlen(str) : (size_t)length) : str;
+    int count = 0;
+    while(p < end)
+    {
+        if((unsigned char)*p < 0x80)                            // ASCII
+        {
+            if(count >= size - 1)
+                break;
+            buffer[count++] = (wchar_t)*p++;
+            continue;
+        }
+        uint32_t code = decodeUtf8(p, end);
+        if(count + getWideLength(code) > size - 1)
+            break;
+        count += encodeWide(code, buffer + count);
+    }
+    buffer[count] = L'\0';
+    return count;
+}
 
-    strcpy(wchar_str[wchar_indexChar], s.c_str());              // copy to circular buffer
+int wideToUtf8(char* buffer, int size, const wchar_t* str, int length)
+{
+    if(size <= 0)
+        return 0;
 
-    return wchar_str[wchar_indexChar];                          // return string as char
+    const wchar_t* p = str;
+    const wchar_t* end = str ? str + (length < 0 ? wcslen(str) : (size_t)length) : str;
+    int count = 0;
+    while(p < end)
+    {
+        if((uint32_t)*p < 0x80)
+        {
+            if(count >= size - 1)
+                break;
+            buffer[count++] = (char)*p++;
+            continue;
+        }
+        uint32_t code = decodeWide(p, end);
+        if(count + getUtf8Length(code) > size - 1)
+            break;
+        count += encodeUtf8(code, buffer + count);
+    }
+    buffer[count] = '\0';
+    return count;
 }
-const char* toChar(int number)
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// converted text, in place when short
+// UTF-8 is at most one wchar_t per byte, and wide text at most 4 bytes per
+// wchar_t, so the size is known without a counting pass.
+///////////////////////////////////////////////////////////////////////////////
+WideText::WideText(const char* str, int length) : text(local), count(0)
 {
-    return toChar((long)number);
-}
\ No newline at end of file
+    size_t bytes = str ? (length < 0 ? strlen(str) : (size_t)length) : 0;
+    if(bytes >= SMALL_TEXT_LENGTH)
+    {
+        heap.resize(bytes + 1);
+        text = heap.data();
+    }
+    count = utf8ToWide(text, (int)bytes + 1, str, (int)bytes);
+}
+
+Utf8Text::Utf8Text(const wchar_t* str, int length) : text(local), count(0)
+{
+    size_t units = str ? (length < 0 ? wcslen(str) : (size_t)length) : 0;
+    if(units * 4 >= SMALL_TEXT_LENGTH)
+    {
+        heap.resize(units * 4 + 1);
+        text = heap.data();
+    }
+    count = wideToUtf8(text, (int)(units * 4) + 1, str, (int)units);
+}
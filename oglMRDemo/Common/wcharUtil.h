@@ -5,24 +5,210 @@
 // It also converts any number to char or wchar_t format. For example,
 // toWchar(1) converts the number 1 to a wchar_t string, L"1".
 //
+// Multi-byte strings are UTF-8 and wide strings are UTF-16 (UTF-32 where
+// wchar_t is 32 bits), independent of the locale. Numbers are converted with
+// std::to_chars: the default precision is the shortest of 6 significant
+// digits ("%g"), a precision >= 0 is the number of decimals ("%.*f").
+//
+// All functions are thread-safe and none of them allocates memory per call:
+//  - formatNumber(), utf8ToWide() and wideToUtf8() write to the buffer of the
+//    caller and cut the text to fit; the result is always null-terminated.
+//  - toWchar() and toChar() return a buffer of a ring of WCHAR_MAX_COUNT
+//    buffers per thread, valid until the same thread made WCHAR_MAX_COUNT more
+//    conversions. Strings are cut at WCHAR_MAX_LENGTH - 1 characters.
+//  - WideText and Utf8Text keep the converted text in place up to
+//    SMALL_TEXT_LENGTH characters, and allocate only for longer text.
+//
 //  AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
 // CREATED: 2006-07-14
-// UPDATED: 2016-07-21
+// UPDATED: 2026-10-18
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifndef WCHAR_UTIL_H
 #define WCHAR_UTIL_H
 
-const wchar_t* toWchar(const char *str);                // convert char* to wchar_t*
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int WCHAR_MAX_COUNT = 16;                         // buffers per thread of toWchar() and toChar()
+const int WCHAR_MAX_LENGTH = 2048;                      // max string length per buffer
+const int NUMBER_MAX_LENGTH = 32;                       // enough for any int, and a double in "%g"
+const int SMALL_TEXT_LENGTH = 256;                      // in-place text of WideText and Utf8Text
+
+const wchar_t* toWchar(const char *str);                // convert UTF-8 char* to wchar_t*
 const wchar_t* toWchar(float number, int precision = -1); // convert float to wchar_t*
 const wchar_t* toWchar(double number, int precision = -1);// convert double float to wchar_t*
 const wchar_t* toWchar(int number);                     // convert integer to wchar_t*
 const wchar_t* toWchar(long number);                    // convert long integer to wchar_t*
 
-const char* toChar(const wchar_t *str);                 // convert wchar_t* to char*
+const char* toChar(const wchar_t *str);                 // convert wchar_t* to UTF-8 char*
 const char* toChar(float number, int precision = -1);     // convert float to char*
 const char* toChar(double number, int precision = -1);    // convert double to char*
 const char* toChar(int number);                         // convert integer to char*
 const char* toChar(long number);                        // convert long integer to char*
 
+// number to the buffer of the caller, returns the length without the null
+int formatNumber(char* buffer, int size, double number, int precision = -1);
+int formatNumber(char* buffer, int size, long number);
+int formatNumber(wchar_t* buffer, int size, double number, int precision = -1);
+int formatNumber(wchar_t* buffer, int size, long number);
+inline int formatNumber(char* buffer, int size, float number, int precision = -1)    { return formatNumber(buffer, size, (double)number, precision); }
+inline int formatNumber(char* buffer, int size, int number)                         { return formatNumber(buffer, size, (long)number); }
+inline int formatNumber(wchar_t* buffer, int size, float number, int precision = -1) { return formatNumber(buffer, size, (double)number, precision); }
+inline int formatNumber(wchar_t* buffer, int size, int number)                      { return formatNumber(buffer, size, (long)number); }
+
+// string to the buffer of the caller, length -1 for a null-terminated source;
+// returns the length written without the null, never splits a character
+int utf8ToWide(wchar_t* buffer, int size, const char* str, int length = -1);
+int wideToUtf8(char* buffer, int size, const wchar_t* str, int length = -1);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// converted text, in place when short
+///////////////////////////////////////////////////////////////////////////////
+class WideText
+{
+public:
+    explicit WideText(const char* str, int length = -1);
+    const wchar_t* c_str() const                        { return text; }
+    int size() const                                    { return count; }
+
+private:
+    WideText(const WideText&);                          // text may point to local
+    WideText& operator=(const WideText&);
+
+    wchar_t local[SMALL_TEXT_LENGTH];
+    std::vector<wchar_t> heap;
+    wchar_t* text;
+    int count;
+};
+
+class Utf8Text
+{
+public:
+    explicit Utf8Text(const wchar_t* str, int length = -1);
+    const char* c_str() const                           { return text; }
+    int size() const                                    { return count; }
+
+private:
+    Utf8Text(const Utf8Text&);
+    Utf8Text& operator=(const Utf8Text&);
+
+    char local[SMALL_TEXT_LENGTH];
+    std::vector<char> heap;
+    char* text;
+    int count;
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// code points, shared with the UTF-8 of the binary log
+///////////////////////////////////////////////////////////////////////////////
+const uint32_t REPLACEMENT_CHARACTER = 0xfffd;
+
+// bytes of code in UTF-8, 1 to 4
+inline int getUtf8Length(uint32_t code)
+{
+    return code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+}
+
+// write code to out (getUtf8Length() bytes), invalid code as U+FFFD
+inline int encodeUtf8(uint32_t code, char* out)
+{
+    if(code > 0x10ffff || (code >= 0xd800 && code <= 0xdfff))
+        code = REPLACEMENT_CHARACTER;
+    if(code < 0x80)
+    {
+        out[0] = (char)code;
+        return 1;
+    }
+    if(code < 0x800)
+    {
+        out[0] = (char)(0xc0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3f));
+        return 2;
+    }
+    if(code < 0x10000)
+    {
+        out[0] = (char)(0xe0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (code & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (code & 0x3f));
+    return 4;
+}
+
+// next code point of UTF-8 text, p < end; malformed bytes give U+FFFD
+inline uint32_t decodeUtf8(const char*& p, const char* end)
+{
+    uint32_t code = (unsigned char)*p++;
+    int follow = 0;
+    if(code < 0x80)
+        return code;
+    if(code >= 0xf0 && code < 0xf8)
+    {
+        code &= 0x07;
+        follow = 3;
+    }
+    else if(code >= 0xe0 && code < 0xf0)
+    {
+        code &= 0x0f;
+        follow = 2;
+    }
+    else if(code >= 0xc0 && code < 0xe0)
+    {
+        code &= 0x1f;
+        follow = 1;
+    }
+    else
+    {
+        return REPLACEMENT_CHARACTER;                   // stray continuation byte
+    }
+    for(; follow > 0; --follow)
+    {
+        if(p == end || (*p & 0xc0) != 0x80)
+            return REPLACEMENT_CHARACTER;
+        code = (code << 6) | (*p++ & 0x3f);
+    }
+    return code;
+}
+
+// next code point of wide text, p < end; a surrogate pair is one code point
+inline uint32_t decodeWide(const wchar_t*& p, const wchar_t* end)
+{
+    uint32_t code = (uint32_t)*p++;
+    if(sizeof(wchar_t) == sizeof(uint16_t) && code >= 0xd800 && code < 0xdc00 &&
+       p < end && (uint32_t)*p >= 0xdc00 && (uint32_t)*p < 0xe000)
+        code = 0x10000 + ((code - 0xd800) << 10) + ((uint32_t)*p++ - 0xdc00);
+    return code;
+}
+
+// wchar_t of code in wide text, 1 or 2 (a surrogate pair of UTF-16)
+inline int getWideLength(uint32_t code)
+{
+    return sizeof(wchar_t) == sizeof(uint16_t) && code > 0xffff ? 2 : 1;
+}
+
+inline int encodeWide(uint32_t code, wchar_t* out)
+{
+    if(code > 0x10ffff)
+        code = REPLACEMENT_CHARACTER;
+    if(getWideLength(code) == 2)
+    {
+        code -= 0x10000;
+        out[0] = (wchar_t)(0xd800 + (code >> 10));
+        out[1] = (wchar_t)(0xdc00 + (code & 0x3ff));
+        return 2;
+    }
+    out[0] = (wchar_t)code;
+    return 1;
+}
+
 #endif
@@ -11,12 +11,14 @@
 #include "ControllerFormGL.h"
 #include "../resource.h"
 #include "../Common/Log.h"
-#include "../FCore/FSCore.h"
+#include "../Tracking/TrackingPose.h"
 
 using namespace Win;
 
 INT_PTR CALLBACK aboutDialogProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+const UINT EVENT_TIMER_INTERVAL = 50;               // ms between draining the tracking events
+
 
 typedef  int(WINAPI *GetDpiForMonitor)(HMONITOR, int, UINT*, UINT*);
 struct AllMONITORINFO
@@ -42,6 +44,7 @@ ControllerFormGL::ControllerFormGL(ModelGL* model, ViewFormGL* view) : model(mod
 ///////////////////////////////////////////////////////////////////////////////
 int ControllerFormGL::close()
 {
+    ::KillTimer(handle, IDT_TIMER);
     ::DestroyWindow(handle);                    // close it
     Win::log("Form dialog is destroyed.");
     return 0;
@@ -57,6 +60,9 @@ int ControllerFormGL::create()
     // initialize all controls
     view->initControls(handle);
 
+    // drain the tracking events of the UI thread
+    ::SetTimer(handle, IDT_TIMER, EVENT_TIMER_INTERVAL, 0);
+
     // init the matrices
     model->setViewMatrix(0, 0, 10, 0, 0, 0);
     view->setViewMatrix(0, 0, 10, 0, 0, 0);
@@ -76,7 +82,7 @@ int ControllerFormGL::command(int id, int command, LPARAM msg)
     case IDC_BUTTON_VIEW_VRMODE:
         if (command == BN_CLICKED)
         {
-            model->isVRMode = true;//按下的时候切换到VR模式
+            model->setVRMode(true);//按下的时候切换到VR模式
 
             //设置窗口无边框
             LONG_PTR Style = ::GetWindowLongPtr(mainWinHandle, GWL_STYLE);
@@ -127,7 +133,7 @@ int ControllerFormGL::command(int id, int command, LPARAM msg)
             //把窗口全屏到副显示器上
             ::SetWindowPos(mainWinHandle, HWND_TOPMOST, startx, starty, width, height, SWP_FRAMECHANGED| SWP_SHOWWINDOW);
 
-            fmSetflagVRMode(1);//显示器进入vr模式
+            setTrackingVRMode(1);//显示器进入vr模式
         }
         break;
 
@@ -249,6 +255,7 @@ int ControllerFormGL::timer(WPARAM eventId, LPARAM callback)
     case IDT_TIMER:
         // not needed
         //view->updateMatrices();
+        logTrackingEvents();
         break;
     }
 
@@ -257,6 +264,30 @@ int ControllerFormGL::timer(WPARAM eventId, LPARAM callback)
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// log the pen key and status events queued for the UI thread
+// The time of an event is when the tracker sample was taken, so the delay
+// to this timer does not change it.
+///////////////////////////////////////////////////////////////////////////////
+void ControllerFormGL::logTrackingEvents()
+{
+    TrackingEvent event;
+    while (model->popTrackingEvent(event))
+    {
+        if (event.type == TrackingEvent::KEY_RELEASE || event.type == TrackingEvent::KEY_HOLD)
+            LOG_INFO(TRACKING, L"Tracking event: %ls 0x%02x (%.3f s) at %.3f s", TrackingEvents::getTypeName(event.type),
+                               event.key, event.duration / 1000000.0, event.timestamp / 1000000.0);
+        else if (event.key)
+            LOG_INFO(TRACKING, L"Tracking event: %ls 0x%02x at %.3f s", TrackingEvents::getTypeName(event.type),
+                               event.key, event.timestamp / 1000000.0);
+        else
+            LOG_INFO(TRACKING, L"Tracking event: %ls at %.3f s", TrackingEvents::getTypeName(event.type),
+                               event.timestamp / 1000000.0);
+    }
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // dialog procedure for About window
 ///////////////////////////////////////////////////////////////////////////////
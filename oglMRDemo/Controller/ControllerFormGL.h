@@ -33,6 +33,8 @@ namespace Win
 
         void setMianWinHandle(HWND handle) { mainWinHandle = handle; }
     private:
+        void logTrackingEvents();                   // pen key and status events since the last timer
+
         ModelGL* model;                             // pointer to model component
         ViewFormGL* view;                           // pointer to view component
 
@@ -15,16 +15,19 @@
 
 #include "ControllerGL.h"
 #include "../Common/Log.h"
+#include "../Common/Trace.h"
 
 using namespace Win;
 
+const int FRAME_STATS_INTERVAL = 600;       // print frame timing every N frames
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // default contructor
 ///////////////////////////////////////////////////////////////////////////////
 ControllerGL::ControllerGL(ModelGL* model, ViewGL* view) : model(model), view(view),
-loopFlag(false)
+loopFlag(false), reprojectedFrames(0)
 {
 }
 
@@ -98,6 +101,7 @@ void ControllerGL::runThread()
 {
     // set the current RC in this thread
     ::wglMakeCurrent(view->getDC(), view->getRC());
+    setTraceThreadName("render");
 
     // initialize OpenGL states
     model->init();
@@ -105,9 +109,9 @@ void ControllerGL::runThread()
 
     bool result = model->initShaders();
     if (result)
-        Win::log("GLSL shader objects are initialized.");
+        LOG_INFO(GL, "GLSL shader objects are initialized.");
     else
-        Win::log("[ERROR] Failed to initialize GLSL.");
+        LOG_ERROR(GL, "Failed to initialize GLSL.");
 
     // cofigure projection matrix
     RECT rect;
@@ -115,14 +119,39 @@ void ControllerGL::runThread()
     model->setWindowSize(rect.right, rect.bottom);
     Win::log(L"Initialized OpenGL window size.");
 
+    // frame pacing, the swap interval must be set in this thread with current RC
+    scheduler.setSwapFunction([this]() { view->swapBuffers(); });
+    scheduler.setSwapIntervalFunction([this](int interval)
+    {
+        if (!view->setSwapInterval(interval))
+            LOG_WARNING(GL, L"WGL_EXT_swap_control is not supported, swap interval is not changed.");
+    });
+
     // rendering loop
     Win::log(L"Entering OpenGL rendering thread...");
     while (loopFlag)
     {
-        std::this_thread::yield();      // yield to other processes or threads
-        //std::this_thread::sleep_for(std::chrono::milliseconds(1)); // yield to other processes or threads
-        model->draw();
-        view->swapBuffers();
+        TRACE_ZONE("frame");
+        scheduler.beginFrame();         // wait for the frame slot in fixed rate mode
+        // a missed frame is followed by the last frame warped to a new pose,
+        // it is much cheaper than a full draw and lets the loop catch up
+        if (scheduler.getLastFrame().missed && model->isReprojectionReady())
+        {
+            model->drawReprojected();
+            ++reprojectedFrames;
+        }
+        else
+        {
+            model->draw();
+        }
+        scheduler.setLatchTime(toTimePoint(model->getLatchedPose().timestamp));
+        scheduler.endFrame();           // swap buffers and record frame timing
+        TRACE_COUNTER("frame ms", scheduler.getLastFrame().frameTime);
+        TRACE_COUNTER("cpu ms", scheduler.getLastFrame().cpuTime);
+        TRACE_COUNTER("latch to swap ms", scheduler.getLastFrame().latchToSwap);
+
+        if (scheduler.getFrameCount() >= FRAME_STATS_INTERVAL)
+            logFrameStats();
     }
 
     // close OpenGL Rendering Context (RC)
@@ -134,6 +163,46 @@ void ControllerGL::runThread()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// print average/max frame time and missed deadlines since the last call
+///////////////////////////////////////////////////////////////////////////////
+void ControllerGL::logFrameStats()
+{
+    static const wchar_t* modeNames[] = { L"vsync", L"fixed", L"uncapped" };
+
+    LOG_INFO(RENDER, L"Frame timing (%ls %.0f Hz): avg %.2f ms, max %.2f ms, cpu %.2f ms, missed %d/%d",
+                     modeNames[scheduler.getMode()], scheduler.getRate(),
+                     scheduler.getAverageFrameTime(), scheduler.getMaxFrameTime(), scheduler.getAverageCpuTime(),
+                     scheduler.getMissedCount(), scheduler.getFrameCount());
+    LOG_INFO(RENDER, L"Tracking sample to swap: avg %.2f ms, max %.2f ms",
+                     scheduler.getAverageLatchToSwap(), scheduler.getMaxLatchToSwap());
+    // predict the pose as far ahead as the measured sample-to-swap latency
+    model->setPredictionLookAhead((int64_t)(scheduler.getAverageLatchToSwap() * 1000));
+    if (reprojectedFrames > 0)
+        LOG_INFO(RENDER, L"Reprojected frames %d, last warp %.2f ms (%.2f ms/MP)", reprojectedFrames,
+                         model->getReprojectionTime(), model->getReprojectionTimePerMegapixel());
+    reprojectedFrames = 0;
+    if (model->getPoseFilterLatency(OneEuroFilter::CHANNEL_GLASS_POSITION) > 0)
+        LOG_INFO(RENDER, L"Pose filter lag: glass %.2f ms / %.2f ms (position/rotation), pen %.2f ms / %.2f ms",
+                         model->getPoseFilterLatency(OneEuroFilter::CHANNEL_GLASS_POSITION) * 1000,
+                         model->getPoseFilterLatency(OneEuroFilter::CHANNEL_GLASS_ROTATION) * 1000,
+                         model->getPoseFilterLatency(OneEuroFilter::CHANNEL_PEN_POSITION) * 1000,
+                         model->getPoseFilterLatency(OneEuroFilter::CHANNEL_PEN_DIRECTION) * 1000);
+    if (model->getMultiViewCount() > 1)
+        LOG_INFO(RENDER, L"Multi-view: %d viewers, plan %.3f ms (shared %.3f ms)", model->getMultiViewCount(),
+                         model->getMultiViewPlanTime(), model->getMultiViewSharedTime());
+    if (model->getStrokeCount() > 0)
+        LOG_INFO(RENDER, L"Strokes %d, points %lld of %lld samples, chunks %d, uploaded %.2f MB in total", model->getStrokeCount(),
+                         (long long)model->getStrokePointCount(), (long long)model->getStrokeSampleCount(), model->getStrokeChunkCount(),
+                         model->getStrokeUploadBytes() / (1024.0 * 1024.0));
+    LOG_INFO(RENDER, L"Matrix rebuilds %d of %d requests (%d avoided), frustum cache %d hits %d misses in total",
+                     model->getMatrixRebuilds(), model->getMatrixUpdateRequests(), model->getMatrixRebuildsAvoided(),
+                     model->getFrustumCacheHits(), model->getFrustumCacheMisses());
+    scheduler.resetStats();
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // handle Left mouse down
 ///////////////////////////////////////////////////////////////////////////////
@@ -220,12 +289,41 @@ int ControllerGL::mouseWheel(int state, int delta, int x, int y)
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// handle WM_KEYDOWN
+// F: pose filter on/off, [ and ]: halve or double its cutoff at rest
+///////////////////////////////////////////////////////////////////////////////
+int ControllerGL::keyDown(int key, LPARAM lParam)
+{
+    if (key == 'F')
+    {
+        bool flag = !model->getPoseFilter();
+        model->setPoseFilter(flag);
+        LOG_INFO(TRACKING, L"Pose filter is %ls.", flag ? L"on" : L"off");
+    }
+    else if (key == VK_OEM_4 || key == VK_OEM_6)    // [ or ]
+    {
+        float scale = key == VK_OEM_4 ? 0.5f : 2.0f;
+        for (int i = 0; i < OneEuroFilter::CHANNEL_COUNT; ++i)
+        {
+            OneEuroFilter::Params params = model->getPoseFilterParams(i);
+            model->setPoseFilterParams(i, params.minCutoff * scale, params.beta, params.derivativeCutoff);
+        }
+        LOG_INFO(TRACKING, L"Pose filter cutoff at rest: %.3f Hz position, %.3f Hz rotation",
+                 model->getPoseFilterParams(OneEuroFilter::CHANNEL_GLASS_POSITION).minCutoff,
+                 model->getPoseFilterParams(OneEuroFilter::CHANNEL_GLASS_ROTATION).minCutoff);
+    }
+    return 0;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // handle WM_SIZE
 ///////////////////////////////////////////////////////////////////////////////
 int ControllerGL::size(int w, int h, WPARAM wParam)
 {
     model->setWindowSize(w, h);
-    Win::log(L"Changed OpenGL rendering window size: %dx%d.", w, h);
+    LOG_INFO(UI, L"Changed OpenGL rendering window size: %dx%d.", w, h);
     return 0;
 }
@@ -20,6 +20,7 @@
 #include "../Base/Controller.h"
 #include "../View/ViewGL.h"
 #include "../Model/ModelGL.h"
+#include "../Common/FrameScheduler.h"
 
 
 namespace Win
@@ -40,16 +41,23 @@ namespace Win
         int rButtonUp(WPARAM state, int x, int y);
         int mouseMove(WPARAM state, int x, int y);
         int mouseWheel(int state, int delta, int x, int y); // for WM_MOUSEWHEEL:state, delta, x, y
+        int keyDown(int key, LPARAM lParam);        // for WM_KEYDOWN: F pose filter, [ ] its cutoff
         int size(int w, int h, WPARAM wParam);      // for WM_SIZE: width, height, type(SIZE_MAXIMIZED...)
 
+        // frame pacing: FrameScheduler::MODE_VSYNC, MODE_FIXED_RATE or MODE_UNCAPPED
+        void setFrameMode(FrameScheduler::Mode mode, double rate = 60) { scheduler.setMode(mode, rate); }
+
 
     private:
         void runThread();                           // thread for OpenGL rendering
+        void logFrameStats();                       // print frame timing and reset it
 
         ModelGL* model;                             // pointer to model component
         ViewGL* view;                               // pointer to view component
         std::thread glThread;                       // opengl rendering thread object
         volatile bool loopFlag;                     // rendering loop flag
+        FrameScheduler scheduler;                   // frame pacing of rendering loop
+        int reprojectedFrames;                      // frames presented by reprojection since last stats
     };
 }
 
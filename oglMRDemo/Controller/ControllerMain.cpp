@@ -12,7 +12,7 @@
 #include <commctrl.h>                   // common controls
 #include "ControllerMain.h"
 #include "../Common/Log.h"
-#include "../FCore/FSCore.h"
+#include "../Tracking/TrackingPose.h"
 
 using namespace Win;
 
@@ -29,7 +29,7 @@ int ControllerMain::command(int id, int cmd, LPARAM msg)
 
 int ControllerMain::close()
 {
-    fmSetflagVRMode(0);//切回2d
+    setTrackingVRMode(0);//切回2d
 
     Win::log(""); // blank line
     Win::log("Closing the application...");
@@ -66,7 +66,7 @@ int ControllerMain::size(int width, int height, WPARAM wParam)
 {
     RECT rect;
 
-    if (!model->isVRMode)
+    if (!model->getVRMode())
     {
         // get dim of glDialog
         ::GetWindowRect(formHandle, &rect);
@@ -2,13 +2,20 @@
 #ifndef _F3D_FSCORE_H_
 #    define _F3D_FSCORE_H_
 
-#    if defined FSCORE_EXPORTS
+#    if defined FSCORE_SIMULATOR || !defined _WIN32
+// linked with the simulator (FSCoreSim.cpp) instead of FSCore.dll
+#        define FSCORE_EXPORT
+#    elif defined FSCORE_EXPORTS
 #        define FSCORE_EXPORT __declspec(dllexport)
 #    else
 #        pragma comment(lib, "FSCore.lib")
 #        define FSCORE_EXPORT __declspec(dllimport)
 #    endif
 
+#    if !defined _WIN32 && !defined __stdcall
+#        define __stdcall
+#    endif
+
 namespace f3d {
 
 ///-------------------------------------------------------------------------------------------------
@@ -111,6 +118,36 @@ struct FrustumData
     // 笔的方向向量
     f3d::Vector3 penDirection;
 };
+
+///-------------------------------------------------------------------------------------------------
+/// <summary>
+/// All tracked values read at once by fmGetTrackingSnapshot().
+/// 一次读出的所有跟踪数据.
+/// </summary>
+///
+/// <remarks> Values are the same as the fmGet*() function of the same name. </remarks>
+///-------------------------------------------------------------------------------------------------
+struct TrackingSnapshot
+{
+    int glassStatus;
+    f3d::Vector3 glassPosition;
+    f3d::Quaternion glassRotation;
+    int penStatus;
+    f3d::Vector3 penPosition;
+    f3d::Vector3 penDirection;
+    float penRoll;
+    int penKey;
+    float slantAngle;
+    int isSleep;
+
+    // Time of the read, microseconds of the steady clock (QueryPerformanceCounter).
+    // 读取的时间,微秒.
+    long long timestamp;
+
+    // Incremented by each call, starts at 1.
+    // 每次调用加1.
+    unsigned int sequence;
+};
 } // namespace f3d
 ///-------------------------------------------------------------------------------------------------
 /// <summary>
@@ -549,4 +586,21 @@ extern "C" FSCORE_EXPORT int __stdcall fmModifyFrustumDebug2(f3d::FrustumData* f
                                                              int kProjX, int kProjY, int kProjZ,
                                                              int kPenX, int kPenY, int kPenZ);
 
+///-------------------------------------------------------------------------------------------------
+/// <summary>
+/// Read all tracked values with one call, instead of one fmGet*() call per value.
+/// 一次调用读出所有跟踪数据.
+/// </summary>
+///
+/// <remarks>
+/// Not exported by FSCore.dll: FSCoreSnapshot.cpp implements it on top of the
+/// fmGet*() functions of the DLL, FSCoreSim.cpp reads the simulator once.
+/// </remarks>
+///
+/// <param name="snapshot"> [out]Output result. 输出结果. </param>
+///
+/// <returns> 0 if success, -1 if snapshot is NULL. </returns>
+///-------------------------------------------------------------------------------------------------
+extern "C" int __stdcall fmGetTrackingSnapshot(f3d::TrackingSnapshot* snapshot);
+
 #endif
\ No newline at end of file
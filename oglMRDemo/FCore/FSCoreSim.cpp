@@ -0,0 +1,821 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// FSCoreSim.cpp
+// =============
+// Simulator of FSCore.dll, compiled only with FSCORE_SIMULATOR.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef FSCORE_SIMULATOR
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include "FSCoreSim.h"
+#include "../Math/Matrices.h"
+
+using namespace f3d::sim;
+
+namespace {
+
+const float DEG2RAD = 3.141593f / 180;
+const double ACTIVE_USER_TIMEOUT = 10.0;            // tracker sleeps without fmSetActiveUser(), seconds
+const int MAX_DROPPED_FRAMES = 1000;                // stop looking back for a delivered frame
+
+// whole simulator state, guarded by mutex
+struct State
+{
+    std::mutex mutex;
+    std::shared_ptr<const Trajectory> trajectory;
+    Config config;
+    bool initialized;
+    bool manualClock;
+    double manualTime;
+    std::chrono::steady_clock::time_point startTime;
+    double lastActiveUser;
+    int errorCamera;
+    int errorPen;
+    int errorMainControl;
+    int errorProcess;
+    int penShakeCount;
+    int vrModeFlag;
+    int vrModeOtherFlag;
+    int dualScreenMode;
+    unsigned int snapshotSequence;
+
+    State() : trajectory(std::make_shared<ProceduralTrajectory>()), initialized(false),
+              manualClock(false), manualTime(0), startTime(std::chrono::steady_clock::now()),
+              lastActiveUser(-ACTIVE_USER_TIMEOUT), errorCamera(0), errorPen(0), errorMainControl(0),
+              errorProcess(0), penShakeCount(0), vrModeFlag(0), vrModeOtherFlag(0), dualScreenMode(1),
+              snapshotSequence(0) {}
+};
+
+State& getState()
+{
+    static State state;
+    return state;
+}
+
+// time in seconds since fmInit(), the mutex must be locked
+double currentTime(const State& s)
+{
+    if(s.manualClock)
+        return s.manualTime;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - s.startTime).count();
+}
+
+// uniform random [0,1) from seed and frame number (splitmix64)
+double hashRandom(unsigned int seed, long long frame, int channel)
+{
+    unsigned long long x = ((unsigned long long)seed << 32) ^ (unsigned long long)frame ^ ((unsigned long long)channel << 56);
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// capture time of tracker frame n
+double captureTime(const Config& c, long long frame)
+{
+    double time = frame / c.rate;
+    if(c.jitter > 0)
+        time += (hashRandom(c.seed, frame, 0) * 2 - 1) * c.jitter;
+    return time;
+}
+
+bool isDropped(const Config& c, long long frame)
+{
+    return c.dropout > 0 && hashRandom(c.seed, frame, 1) < c.dropout;
+}
+
+// last frame delivered at time, -1 if none yet
+long long deliveredFrame(const Config& c, double time)
+{
+    if(c.rate <= 0)
+        return -1;
+
+    double captured = time - c.latency;
+    if(captured < 0)
+        return -1;
+
+    // jitter may move frame n+1 before or n after the capture time
+    long long frame = (long long)floor(captured * c.rate) + 1;
+    while(frame >= 0 && captureTime(c, frame) > captured)
+        --frame;
+
+    for(int i = 0; frame >= 0 && i < MAX_DROPPED_FRAMES && isDropped(c, frame); ++i)
+        --frame;
+    return frame;
+}
+
+// pose the application sees now, the mutex must be locked
+Pose currentPose(State& s, long long* frameNumber = 0)
+{
+    Pose pose;
+    memset(&pose, 0, sizeof(pose));
+    pose.glassRotation.w = 1;
+    pose.penDirection.z = 1;
+
+    double time = currentTime(s);
+    bool sleeping = time - s.lastActiveUser > ACTIVE_USER_TIMEOUT;
+    long long frame = deliveredFrame(s.config, time);
+    if(frameNumber)
+        *frameNumber = frame;
+    if(!s.initialized || sleeping || frame < 0 || !s.trajectory || s.errorCamera != 0)
+        return pose;
+
+    pose = s.trajectory->evaluate(captureTime(s.config, frame));
+    if(s.errorPen != 0)
+        pose.penVisible = false;
+    return pose;
+}
+
+f3d::Vector3 rotate(const f3d::Quaternion& q, const f3d::Vector3& v)
+{
+    // v + 2w(u x v) + 2u x (u x v)
+    float cx = q.y * v.z - q.z * v.y;
+    float cy = q.z * v.x - q.x * v.z;
+    float cz = q.x * v.y - q.y * v.x;
+    f3d::Vector3 r;
+    r.x = v.x + 2 * (q.w * cx + q.y * cz - q.z * cy);
+    r.y = v.y + 2 * (q.w * cy + q.z * cx - q.x * cz);
+    r.z = v.z + 2 * (q.w * cz + q.x * cy - q.y * cx);
+    return r;
+}
+
+// left (-1) or right (+1) eye position from the glasses
+f3d::Vector3 eyePosition(const Pose& pose, float pupilDistance, float side)
+{
+    f3d::Vector3 offset = { side * pupilDistance * 0.5f, 0, 0 };
+    offset = rotate(pose.glassRotation, offset);
+    f3d::Vector3 eye = { pose.glassPosition.x + offset.x, pose.glassPosition.y + offset.y, pose.glassPosition.z + offset.z };
+    return eye;
+}
+
+// glFrustum() matrix, column-major
+void setFrustum(float* m, float l, float r, float b, float t, float n, float f)
+{
+    memset(m, 0, sizeof(float) * 16);
+    m[0]  = 2 * n / (r - l);
+    m[5]  = 2 * n / (t - b);
+    m[8]  = (r + l) / (r - l);
+    m[9]  = (t + b) / (t - b);
+    m[10] = -(f + n) / (f - n);
+    m[11] = -1;
+    m[14] = -(2 * f * n) / (f - n);
+}
+
+// off-axis projection of an eye looking at a screen rectangle in the plane
+// z = 0 of the screen space, the eye is at z < 0
+void setScreenFrustum(float* m, const f3d::Vector3& eye, float halfWidth, float halfHeight,
+                      float scale, float n, float f)
+{
+    float distance = -eye.z * scale;
+    if(distance < 1e-4f)
+        distance = 1e-4f;
+    float ratio = n / distance;
+    setFrustum(m, (-halfWidth - eye.x * scale) * ratio, (halfWidth - eye.x * scale) * ratio,
+                  (-halfHeight - eye.y * scale) * ratio, (halfHeight - eye.y * scale) * ratio, n, f);
+}
+
+// fmModifyFrustum(): per eye view and projection for the imaginary screen in
+// front of the original camera
+int modifyFrustum(f3d::FrustumData* fd, const f3d::Matrix4* matView, const f3d::Matrix4* matProjection,
+                  float screenDistance, float screenHeight, float pupilDistance, bool isLeftHanded)
+{
+    if(!fd || !matView || !matProjection || screenHeight <= 0)
+        return -1;
+
+    State& s = getState();
+    Pose pose;
+    float physicalHeight;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        pose = currentPose(s);
+        physicalHeight = s.config.screenHeight;
+    }
+    if(!pose.glassVisible)
+    {
+        // no glasses, look from the default position in front of the screen
+        pose.glassPosition.x = pose.glassPosition.y = 0;
+        pose.glassPosition.z = -0.5f;
+        pose.glassRotation.x = pose.glassRotation.y = pose.glassRotation.z = 0;
+        pose.glassRotation.w = 1;
+    }
+
+    // near/far and aspect of the original perspective projection
+    const float* p = matProjection->m;
+    float n = p[14] / (p[10] - 1);
+    float f = p[14] / (p[10] + 1);
+    if(isLeftHanded)
+    {
+        n = -n;
+        f = -f;
+    }
+    float aspect = p[0] != 0 ? p[5] / p[0] : 1;
+    float halfHeight = screenHeight * 0.5f;
+    float halfWidth = halfHeight * aspect;
+    float scale = screenHeight / physicalHeight;     // world unit per meter
+    float depth = fabsf(screenDistance);             // imaginary screen center is (0,0,-depth) in camera space
+    float zSign = isLeftHanded ? 1.0f : -1.0f;       // direction into the screen in camera space
+
+    ::Matrix4 view(matView->m);
+    ::Matrix4 inverseView = view;
+    inverseView.invert();
+
+    f3d::Vector3 eyes[2] = { eyePosition(pose, pupilDistance, -1), eyePosition(pose, pupilDistance, 1) };
+    f3d::Matrix4* views[2] = { &fd->matViewL, &fd->matViewR };
+    f3d::Matrix4* projections[2] = { &fd->matProjectionL, &fd->matProjectionR };
+    for(int i = 0; i < 2; ++i)
+    {
+        // eye in camera space, the screen plane is z = zSign * depth
+        float ex = eyes[i].x * scale;
+        float ey = eyes[i].y * scale;
+        float ez = zSign * (depth + eyes[i].z * scale);
+
+        ::Matrix4 eyeView = view;
+        eyeView.translate(-ex, -ey, -ez);
+        memcpy(views[i]->m, eyeView.get(), sizeof(float) * 16);
+
+        setScreenFrustum(projections[i]->m, eyes[i], halfWidth, halfHeight, scale, n, f);
+        if(isLeftHanded)
+        {
+            for(int j = 8; j < 12; ++j)
+                projections[i]->m[j] = -projections[i]->m[j];
+        }
+    }
+
+    // pen from screen space to world space
+    ::Vector3 penCamera(pose.penPosition.x * scale, pose.penPosition.y * scale,
+                        zSign * (depth + pose.penPosition.z * scale));
+    ::Vector3 penWorld = inverseView * penCamera;
+    ::Vector3 dirCamera(pose.penDirection.x, pose.penDirection.y, zSign * -pose.penDirection.z);
+    ::Vector3 dirWorld = inverseView.getRotationMatrix() * dirCamera;
+    fd->penPosition.x = penWorld.x;
+    fd->penPosition.y = penWorld.y;
+    fd->penPosition.z = penWorld.z;
+    fd->penDirection.x = dirWorld.x;
+    fd->penDirection.y = dirWorld.y;
+    fd->penDirection.z = dirWorld.z;
+    return 0;
+}
+
+
+} // namespace
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// KeyframeTrajectory
+///////////////////////////////////////////////////////////////////////////////
+void KeyframeTrajectory::addKeyframe(double time, const Pose& pose)
+{
+    times.push_back(time);
+    poses.push_back(pose);
+}
+
+Pose KeyframeTrajectory::evaluate(double time) const
+{
+    Pose pose;
+    if(times.empty())
+    {
+        memset(&pose, 0, sizeof(pose));
+        pose.glassRotation.w = 1;
+        pose.penDirection.z = 1;
+        return pose;
+    }
+
+    if(loop && times.size() > 1 && getDuration() > 0)
+    {
+        double duration = getDuration();
+        time = times.front() + fmod(time - times.front(), duration);
+        if(time < times.front())
+            time += duration;
+    }
+    if(time <= times.front())
+        return poses.front();
+    if(time >= times.back())
+        return poses.back();
+
+    // binary search the keyframe after time
+    size_t lo = 0, hi = times.size() - 1;
+    while(lo + 1 < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if(times[mid] <= time)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const Pose& a = poses[lo];
+    const Pose& b = poses[hi];
+    float t = (float)((time - times[lo]) / (times[hi] - times[lo]));
+
+    pose = a;
+    pose.glassPosition.x += (b.glassPosition.x - a.glassPosition.x) * t;
+    pose.glassPosition.y += (b.glassPosition.y - a.glassPosition.y) * t;
+    pose.glassPosition.z += (b.glassPosition.z - a.glassPosition.z) * t;
+    pose.penPosition.x += (b.penPosition.x - a.penPosition.x) * t;
+    pose.penPosition.y += (b.penPosition.y - a.penPosition.y) * t;
+    pose.penPosition.z += (b.penPosition.z - a.penPosition.z) * t;
+    pose.penDirection.x += (b.penDirection.x - a.penDirection.x) * t;
+    pose.penDirection.y += (b.penDirection.y - a.penDirection.y) * t;
+    pose.penDirection.z += (b.penDirection.z - a.penDirection.z) * t;
+    pose.penRoll += (b.penRoll - a.penRoll) * t;
+
+    const f3d::Quaternion& qa = a.glassRotation;
+    const f3d::Quaternion& qb = b.glassRotation;
+    float sign = qa.x * qb.x + qa.y * qb.y + qa.z * qb.z + qa.w * qb.w < 0 ? -1.0f : 1.0f;
+    f3d::Quaternion& q = pose.glassRotation;
+    q.x += (sign * qb.x - qa.x) * t;
+    q.y += (sign * qb.y - qa.y) * t;
+    q.z += (sign * qb.z - qa.z) * t;
+    q.w += (sign * qb.w - qa.w) * t;
+    float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if(length > 0)
+    {
+        q.x /= length; q.y /= length; q.z /= length; q.w /= length;
+    }
+
+    f3d::Vector3& d = pose.penDirection;
+    length = sqrtf(d.x * d.x + d.y * d.y + d.z * d.z);
+    if(length > 0)
+    {
+        d.x /= length; d.y /= length; d.z /= length;
+    }
+    return pose;
+}
+
+bool KeyframeTrajectory::load(const char* fileName)
+{
+    FILE* file = fopen(fileName, "r");
+    if(!file)
+        return false;
+
+    clear();
+    char line[512];
+    while(fgets(line, sizeof(line), file))
+    {
+        char* comment = strchr(line, '#');
+        if(comment)
+            *comment = '\0';
+
+        double time;
+        Pose pose;
+        int glassVisible = 1, penVisible = 1;
+        int count = sscanf(line, "%lf %f %f %f %f %f %f %f %f %f %f %f %f %f %f %d %d %d", &time,
+                           &pose.glassPosition.x, &pose.glassPosition.y, &pose.glassPosition.z,
+                           &pose.glassRotation.x, &pose.glassRotation.y, &pose.glassRotation.z, &pose.glassRotation.w,
+                           &pose.penPosition.x, &pose.penPosition.y, &pose.penPosition.z,
+                           &pose.penDirection.x, &pose.penDirection.y, &pose.penDirection.z,
+                           &pose.penRoll, &pose.penKey, &glassVisible, &penVisible);
+        if(count <= 0)
+            continue;               // empty or comment line
+        if(count < 16)
+        {
+            fclose(file);
+            return false;
+        }
+        pose.glassVisible = glassVisible != 0;
+        pose.penVisible = penVisible != 0;
+        addKeyframe(time, pose);
+    }
+    fclose(file);
+    return true;
+}
+
+bool KeyframeTrajectory::save(const char* fileName) const
+{
+    FILE* file = fopen(fileName, "w");
+    if(!file)
+        return false;
+
+    fprintf(file, "# time gx gy gz qx qy qz qw px py pz dx dy dz roll key glassVisible penVisible\n");
+    for(size_t i = 0; i < times.size(); ++i)
+    {
+        const Pose& p = poses[i];
+        fprintf(file, "%.6f %g %g %g %g %g %g %g %g %g %g %g %g %g %g %d %d %d\n", times[i],
+                p.glassPosition.x, p.glassPosition.y, p.glassPosition.z,
+                p.glassRotation.x, p.glassRotation.y, p.glassRotation.z, p.glassRotation.w,
+                p.penPosition.x, p.penPosition.y, p.penPosition.z,
+                p.penDirection.x, p.penDirection.y, p.penDirection.z,
+                p.penRoll, p.penKey, p.glassVisible ? 1 : 0, p.penVisible ? 1 : 0);
+    }
+    fclose(file);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ProceduralTrajectory
+///////////////////////////////////////////////////////////////////////////////
+ProceduralTrajectory::ProceduralTrajectory()
+{
+    // a user 55 cm in front of the screen, pen 15 cm in front of it
+    f3d::Vector3 headCenter = { 0, 0.05f, -0.55f };
+    f3d::Vector3 headAmplitude = { 0.08f, 0.03f, 0.05f };
+    f3d::Vector3 penCenter = { 0, 0, -0.15f };
+    params.headCenter = headCenter;
+    params.headAmplitude = headAmplitude;
+    params.headFrequency = 0.25f;
+    params.headYawAmplitude = 10;
+    params.penCenter = penCenter;
+    params.penRadius = 0.06f;
+    params.penFrequency = 0.5f;
+    params.keyPeriod = 4;
+}
+
+Pose ProceduralTrajectory::evaluate(double time) const
+{
+    const float TWO_PI = 6.283185f;
+    float head = (float)(TWO_PI * params.headFrequency * time);
+    float pen = (float)(TWO_PI * params.penFrequency * time);
+
+    Pose pose;
+    // Lissajous figure, so x and y do not move in lockstep
+    pose.glassPosition.x = params.headCenter.x + params.headAmplitude.x * sinf(head);
+    pose.glassPosition.y = params.headCenter.y + params.headAmplitude.y * sinf(head * 2);
+    pose.glassPosition.z = params.headCenter.z + params.headAmplitude.z * sinf(head * 0.5f);
+
+    float yaw = params.headYawAmplitude * DEG2RAD * sinf(head) * 0.5f;
+    pose.glassRotation.x = 0;
+    pose.glassRotation.y = sinf(yaw);
+    pose.glassRotation.z = 0;
+    pose.glassRotation.w = cosf(yaw);
+
+    pose.penPosition.x = params.penCenter.x + params.penRadius * cosf(pen);
+    pose.penPosition.y = params.penCenter.y + params.penRadius * sinf(pen);
+    pose.penPosition.z = params.penCenter.z;
+
+    // pointing into the screen, tilted toward the circle center
+    float dx = -0.3f * cosf(pen), dy = -0.3f * sinf(pen), dz = 1;
+    float length = sqrtf(dx * dx + dy * dy + dz * dz);
+    pose.penDirection.x = dx / length;
+    pose.penDirection.y = dy / length;
+    pose.penDirection.z = dz / length;
+    pose.penRoll = (float)fmod(pen, TWO_PI);
+
+    pose.penKey = 0;
+    if(params.keyPeriod > 0 && fmod(time, params.keyPeriod) < 0.5)
+        pose.penKey = 0x01;
+    pose.glassVisible = true;
+    pose.penVisible = true;
+    return pose;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// simulator control
+///////////////////////////////////////////////////////////////////////////////
+void f3d::sim::setTrajectory(std::shared_ptr<const Trajectory> trajectory)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.trajectory = trajectory;
+}
+
+void f3d::sim::setConfig(const Config& config)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.config = config;
+}
+
+Config f3d::sim::getConfig()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.config;
+}
+
+void f3d::sim::setErrorCodes(int camera, int pen, int mainControl, int process)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.errorCamera = camera;
+    s.errorPen = pen;
+    s.errorMainControl = mainControl;
+    s.errorProcess = process;
+}
+
+void f3d::sim::setManualClock(bool flag)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if(flag && !s.manualClock)
+        s.manualTime = currentTime(s);
+    else if(!flag && s.manualClock)
+        s.startTime = std::chrono::steady_clock::now() -
+                      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(s.manualTime));
+    s.manualClock = flag;
+}
+
+void f3d::sim::setTime(double time)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.manualTime = time;
+}
+
+void f3d::sim::advanceTime(double time)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.manualTime += time;
+}
+
+double f3d::sim::getTime()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentTime(s);
+}
+
+int f3d::sim::getPenShakeCount()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.penShakeCount;
+}
+
+int f3d::sim::getVRModeFlag()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.vrModeFlag;
+}
+
+int f3d::sim::getFrameNumber()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return (int)deliveredFrame(s.config, currentTime(s));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FSCore API
+///////////////////////////////////////////////////////////////////////////////
+extern "C" int __stdcall fmInit(bool /*isStartServer*/)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if(!s.initialized)
+    {
+        s.startTime = std::chrono::steady_clock::now();
+        s.lastActiveUser = currentTime(s);
+        s.initialized = true;
+    }
+    return 0;
+}
+
+extern "C" void __stdcall fmClose()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.initialized = false;
+}
+
+extern "C" int __stdcall fmGetGlassStatus()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    long long frame;
+    Pose pose = currentPose(s, &frame);
+    return s.initialized && frame >= 0 && pose.glassVisible ? 1 : 0;
+}
+
+extern "C" f3d::Vector3 __stdcall fmGetGlassPosition()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentPose(s).glassPosition;
+}
+
+extern "C" f3d::Quaternion __stdcall fmGetGlassRotation()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentPose(s).glassRotation;
+}
+
+extern "C" int __stdcall fmGetPenStatus()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    long long frame;
+    Pose pose = currentPose(s, &frame);
+    return s.initialized && frame >= 0 && pose.penVisible ? 1 : 0;
+}
+
+extern "C" f3d::Vector3 __stdcall fmGetPenPosition()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentPose(s).penPosition;
+}
+
+extern "C" f3d::Vector3 __stdcall fmGetPenDirection()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentPose(s).penDirection;
+}
+
+extern "C" float __stdcall fmGetPenRoll()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return currentPose(s).penRoll;
+}
+
+extern "C" int __stdcall fmGetPenKey()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Pose pose = currentPose(s);
+    return pose.penVisible ? pose.penKey : 0;
+}
+
+extern "C" float __stdcall fmGetSlantAngle()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.config.slantAngle;
+}
+
+extern "C" void __stdcall fmSetPenShake(int /*mode*/)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    ++s.penShakeCount;
+}
+
+extern "C" void __stdcall fmSetActiveUser()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.lastActiveUser = currentTime(s);
+}
+
+extern "C" void __stdcall fmSetflagVRMode(int flag)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.vrModeFlag = flag;
+}
+
+extern "C" void __stdcall fmSetflagVRModeOther(int flag)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.vrModeOtherFlag = flag;
+}
+
+extern "C" void __stdcall fmSetflagDualScreenMode(int flag)
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.dualScreenMode = flag;
+}
+
+extern "C" int __stdcall fmGetCurDualScreenStatus()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.dualScreenMode;
+}
+
+extern "C" int __stdcall fmGetIsSleep()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.initialized && currentTime(s) - s.lastActiveUser > ACTIVE_USER_TIMEOUT ? 1 : 0;
+}
+
+extern "C" int __stdcall fmGetWorkStatus()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if(!s.initialized)
+        return 0;
+    return currentTime(s) - s.lastActiveUser > ACTIVE_USER_TIMEOUT ? 2 : 1;
+}
+
+extern "C" float __stdcall fmGetFps()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return (float)(s.config.rate * (1 - s.config.dropout));
+}
+
+extern "C" int __stdcall fmGetCameraDevErrorCode()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.errorCamera;
+}
+
+extern "C" int __stdcall fmGetPenDevErrorCode()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.errorPen;
+}
+
+extern "C" int __stdcall fmGetMCDevErrorCode()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.errorMainControl;
+}
+
+extern "C" int __stdcall fmGetProcErrorCode()
+{
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.errorProcess;
+}
+
+extern "C" int __stdcall fmGetMCDevID()
+{
+    return 0x5157;                  // any fixed id
+}
+
+extern "C" int __stdcall fmGetFrustumLR(f3d::Matrix4* matL, f3d::Matrix4* matR, float disNear, float disFar, float pupilDistance, float aspectRatio)
+{
+    if(!matL || !matR || disNear <= 0 || disFar <= disNear)
+        return -1;
+
+    State& s = getState();
+    Pose pose;
+    float halfHeight;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        pose = currentPose(s);
+        halfHeight = s.config.screenHeight * 0.5f;
+    }
+    float halfWidth = halfHeight * aspectRatio;
+
+    // physical screen in meters, eyes from the glasses
+    setScreenFrustum(matL->m, eyePosition(pose, pupilDistance, -1), halfWidth, halfHeight, 1, disNear, disFar);
+    setScreenFrustum(matR->m, eyePosition(pose, pupilDistance, 1), halfWidth, halfHeight, 1, disNear, disFar);
+    return 0;
+}
+
+extern "C" int __stdcall fmGetFrustumLR2(f3d::Matrix4* matL, f3d::Matrix4* matR, float disNear, float disFar, float pupilDistance, float aspectRatio)
+{
+    return fmGetFrustumLR(matL, matR, disNear, disFar, pupilDistance, aspectRatio);
+}
+
+extern "C" int __stdcall fmModifyFrustum(f3d::FrustumData* frustumData, f3d::Matrix4* matView, f3d::Matrix4* matProjection,
+                                         float screenDistance, float screenHeight, float pupilDistance, bool isLeftHanded)
+{
+    return modifyFrustum(frustumData, matView, matProjection, screenDistance, screenHeight, pupilDistance, isLeftHanded);
+}
+
+extern "C" int __stdcall fmModifyFrustumDebug2(f3d::FrustumData* frustumData, f3d::Matrix4* matView, f3d::Matrix4* matProjection,
+                                               float screenDistance, float screenHeight, float pupilDistance, bool isLeftHanded,
+                                               int /*kProjX*/, int /*kProjY*/, int /*kProjZ*/,
+                                               int /*kPenX*/, int /*kPenY*/, int /*kPenZ*/)
+{
+    // the debug factors only tune the device implementation
+    return modifyFrustum(frustumData, matView, matProjection, screenDistance, screenHeight, pupilDistance, isLeftHanded);
+}
+
+extern "C" int __stdcall fmGetTrackingSnapshot(f3d::TrackingSnapshot* snapshot)
+{
+    if(!snapshot)
+        return -1;
+
+    // one lock and one trajectory evaluation for all values
+    State& s = getState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    long long frame;
+    Pose pose = currentPose(s, &frame);
+    bool tracking = s.initialized && frame >= 0;
+
+    snapshot->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    snapshot->glassStatus = tracking && pose.glassVisible ? 1 : 0;
+    snapshot->glassPosition = pose.glassPosition;
+    snapshot->glassRotation = pose.glassRotation;
+    snapshot->penStatus = tracking && pose.penVisible ? 1 : 0;
+    snapshot->penPosition = pose.penPosition;
+    snapshot->penDirection = pose.penDirection;
+    snapshot->penRoll = pose.penRoll;
+    snapshot->penKey = pose.penVisible ? pose.penKey : 0;
+    snapshot->slantAngle = s.config.slantAngle;
+    snapshot->isSleep = s.initialized && currentTime(s) - s.lastActiveUser > ACTIVE_USER_TIMEOUT ? 1 : 0;
+    snapshot->sequence = ++s.snapshotSequence;
+    return 0;
+}
+
+#endif // FSCORE_SIMULATOR
@@ -0,0 +1,142 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// FSCoreSim.h
+// ===========
+// Simulator of FSCore.dll. FSCoreSim.cpp implements every fm*() function of
+// FSCore.h, so tracking code can run on machines without the device, e.g.
+// Linux build machines. Build with FSCORE_SIMULATOR defined and link
+// FSCoreSim.cpp instead of FSCore.lib; without the define the file is empty.
+//
+// The glasses and pen follow a Trajectory:
+// KeyframeTrajectory:   scripted or recorded keyframes, interpolated
+// ProceduralTrajectory: head sway and pen circling, endless
+//
+// The simulated tracker samples the trajectory at Config::rate with jitter on
+// the capture time, drops frames with Config::dropout probability (the last
+// frame stays), and delivers each frame Config::latency seconds after it was
+// captured. All random values are hashed from the seed and the frame number,
+// so the same time always returns the same pose (deterministic and thread
+// safe). With setManualClock(true) the time only moves by setTime() or
+// advanceTime(), otherwise it is the real time since fmInit().
+//
+// As the real service, the tracker sleeps when fmSetActiveUser() was not
+// called for 10 seconds.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FSCORE_SIM_H
+#define FSCORE_SIM_H
+
+#include <memory>
+#include <vector>
+#include "FSCore.h"
+
+namespace f3d {
+namespace sim {
+
+// pose of glasses and pen in FSCore coordinates (meters, screen center origin,
+// x right, y up, z into the screen)
+struct Pose
+{
+    f3d::Vector3 glassPosition;
+    f3d::Quaternion glassRotation;
+    f3d::Vector3 penPosition;
+    f3d::Vector3 penDirection;
+    float penRoll;
+    int penKey;                     // 0x01 middle, 0x02 left, 0x04 right
+    bool glassVisible;
+    bool penVisible;
+};
+
+class Trajectory
+{
+public:
+    virtual ~Trajectory() {}
+    virtual Pose evaluate(double time) const = 0;  // time in seconds
+};
+
+// poses at given times, linear between keyframes (nlerp for rotation), keys
+// and visibility are taken from the previous keyframe
+class KeyframeTrajectory : public Trajectory
+{
+public:
+    KeyframeTrajectory() : loop(false) {}
+
+    void addKeyframe(double time, const Pose& pose); // keep times increasing
+    void clear()                                    { times.clear(); poses.clear(); }
+    int getKeyframeCount() const                    { return (int)times.size(); }
+    double getDuration() const                      { return times.empty() ? 0 : times.back() - times.front(); }
+    void setLoop(bool flag)                         { loop = flag; }
+
+    // text file, one keyframe per line, '#' starts a comment:
+    // time gx gy gz qx qy qz qw px py pz dx dy dz roll key [glassVisible penVisible]
+    bool load(const char* fileName);
+    bool save(const char* fileName) const;
+
+    Pose evaluate(double time) const;
+
+private:
+    std::vector<double> times;
+    std::vector<Pose> poses;
+    bool loop;
+};
+
+// head swaying in front of the screen, pen drawing a circle
+class ProceduralTrajectory : public Trajectory
+{
+public:
+    struct Params
+    {
+        f3d::Vector3 headCenter;    // meters
+        f3d::Vector3 headAmplitude;
+        float headFrequency;        // Hz
+        float headYawAmplitude;     // degree
+        f3d::Vector3 penCenter;
+        float penRadius;
+        float penFrequency;
+        float keyPeriod;            // middle key is down for 0.5 s every keyPeriod seconds, 0: never
+    };
+
+    ProceduralTrajectory();
+    explicit ProceduralTrajectory(const Params& params) : params(params) {}
+
+    Params& getParams()                             { return params; }
+    Pose evaluate(double time) const;
+
+private:
+    Params params;
+};
+
+struct Config
+{
+    double rate;                    // tracker frame rate, Hz
+    double jitter;                  // max capture time jitter, seconds
+    double dropout;                 // probability of a lost frame [0,1]
+    double latency;                 // capture to delivery delay, seconds
+    unsigned int seed;
+    float screenWidth;              // physical screen size, meters
+    float screenHeight;
+    float slantAngle;               // fmGetSlantAngle()
+
+    Config() : rate(60), jitter(0), dropout(0), latency(0), seed(1),
+               screenWidth(0.527f), screenHeight(0.296f), slantAngle(0) {}
+};
+
+// simulator control, all functions are thread safe
+void setTrajectory(std::shared_ptr<const Trajectory> trajectory);
+void setConfig(const Config& config);
+Config getConfig();
+void setErrorCodes(int camera, int pen, int mainControl, int process);
+void setManualClock(bool flag);                     // time moves only by setTime()/advanceTime()
+void setTime(double time);                          // seconds
+void advanceTime(double time);
+double getTime();
+int getPenShakeCount();                             // number of fmSetPenShake() calls
+int getVRModeFlag();                                // last fmSetflagVRMode() value
+int getFrameNumber();                               // tracker frame delivered at current time
+
+} // namespace sim
+} // namespace f3d
+
+#endif
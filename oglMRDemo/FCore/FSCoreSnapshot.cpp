@@ -0,0 +1,47 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// FSCoreSnapshot.cpp
+// ==================
+// fmGetTrackingSnapshot() for FSCore.dll, which has no batched call. The
+// values are read back to back with the single value functions, so callers
+// only cross into this wrapper once per sample. The simulator implements it
+// in FSCoreSim.cpp.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FSCORE_SIMULATOR
+
+#include <atomic>
+#include <chrono>
+#include "FSCore.h"
+
+static std::atomic<unsigned int> snapshotSequence(0);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// read everything the tracker reports, glasses first, then pen
+///////////////////////////////////////////////////////////////////////////////
+extern "C" int __stdcall fmGetTrackingSnapshot(f3d::TrackingSnapshot* snapshot)
+{
+    if(!snapshot)
+        return -1;
+
+    snapshot->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    snapshot->glassStatus = fmGetGlassStatus();
+    snapshot->glassPosition = fmGetGlassPosition();
+    snapshot->glassRotation = fmGetGlassRotation();
+    snapshot->penStatus = fmGetPenStatus();
+    snapshot->penPosition = fmGetPenPosition();
+    snapshot->penDirection = fmGetPenDirection();
+    snapshot->penRoll = fmGetPenRoll();
+    snapshot->penKey = fmGetPenKey();
+    snapshot->slantAngle = fmGetSlantAngle();
+    snapshot->isSleep = fmGetIsSleep();
+    snapshot->sequence = snapshotSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    return 0;
+}
+
+#endif
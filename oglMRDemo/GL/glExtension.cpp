@@ -10,12 +10,14 @@
 // ==========
 // GL_ARB_framebuffer_object
 // GL_ARB_debug_output
+// GL_ARB_draw_instanced
 // GL_ARB_direct_state_access
 // GL_ARB_multisample
 // GL_ARB_multitexture
 // GL_ARB_pixel_buffer_objects, GL_ARB_vertex_buffer_object
 // GL_ARB_shader_objects, GL_ARB_vertex_program, GL_ARB_fragment_program, GL_ARB_vertex_shader, GL_ARB_fragment_shader
 // GL_ARB_sync
+// GL_ARB_uniform_buffer_object
 // GL_ARB_vertex_array_object
 // WGL_ARB_extensions_string
 // WGL_ARB_pixel_format
@@ -168,6 +170,16 @@ PFNGLDELETEVERTEXARRAYSPROC pglDeleteVertexArrays = 0;  // VAO deletion procedur
 PFNGLBINDVERTEXARRAYPROC    pglBindVertexArray = 0;     // VAO bind procedure
 PFNGLISVERTEXARRAYPROC      pglIsVertexArray = 0;       // VBO query procedure
 
+// GL_ARB_draw_instanced
+PFNGLDRAWARRAYSINSTANCEDARBPROC     pglDrawArraysInstancedARB = 0;      // draw arrays N times, gl_InstanceIDARB in shader
+PFNGLDRAWELEMENTSINSTANCEDARBPROC   pglDrawElementsInstancedARB = 0;    // draw elements N times, gl_InstanceIDARB in shader
+
+// GL_ARB_uniform_buffer_object
+PFNGLGETUNIFORMBLOCKINDEXPROC   pglGetUniformBlockIndex = 0;    // get index of uniform block
+PFNGLUNIFORMBLOCKBINDINGPROC    pglUniformBlockBinding = 0;     // assign binding point to uniform block
+PFNGLBINDBUFFERBASEPROC         pglBindBufferBase = 0;          // bind buffer to indexed binding point
+PFNGLBINDBUFFERRANGEPROC        pglBindBufferRange = 0;         // bind buffer range to indexed binding point
+
 
 // GL_ARB_vertex_shader and GL_ARB_fragment_shader extensions
 PFNGLBINDATTRIBLOCATIONARBPROC  pglBindAttribLocationARB = 0;       // bind vertex attrib var with index
@@ -697,6 +709,18 @@ void glExtension::getFunctionPointers()
             glBindVertexArray       = (PFNGLBINDVERTEXARRAYPROC)wglGetProcAddress("glBindVertexArray");
             glIsVertexArray         = (PFNGLISVERTEXARRAYPROC)wglGetProcAddress("glIsVertexArray");
         }
+        else if(extensions[i] == "GL_ARB_draw_instanced")
+        {
+            glDrawArraysInstancedARB    = (PFNGLDRAWARRAYSINSTANCEDARBPROC)wglGetProcAddress("glDrawArraysInstancedARB");
+            glDrawElementsInstancedARB  = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)wglGetProcAddress("glDrawElementsInstancedARB");
+        }
+        else if(extensions[i] == "GL_ARB_uniform_buffer_object")
+        {
+            glGetUniformBlockIndex  = (PFNGLGETUNIFORMBLOCKINDEXPROC)wglGetProcAddress("glGetUniformBlockIndex");
+            glUniformBlockBinding   = (PFNGLUNIFORMBLOCKBINDINGPROC)wglGetProcAddress("glUniformBlockBinding");
+            glBindBufferBase        = (PFNGLBINDBUFFERBASEPROC)wglGetProcAddress("glBindBufferBase");
+            glBindBufferRange       = (PFNGLBINDBUFFERRANGEPROC)wglGetProcAddress("glBindBufferRange");
+        }
         else if(extensions[i] == "GL_ARB_vertex_shader") // also GL_ARB_fragment_shader
         {
             glBindAttribLocationARB = (PFNGLBINDATTRIBLOCATIONARBPROC)wglGetProcAddress("glBindAttribLocationARB");
@@ -10,12 +10,14 @@
 // ==========
 // GL_ARB_framebuffer_object
 // GL_ARB_debug_output
+// GL_ARB_draw_instanced
 // GL_ARB_direct_state_access
 // GL_ARB_multisample
 // GL_ARB_multitexture
 // GL_ARB_pixel_buffer_objects, GL_ARB_vertex_buffer_object
 // GL_ARB_shader_objects, GL_ARB_vertex_program, GL_ARB_fragment_program, GL_ARB_vertex_shader, GL_ARB_fragment_shader
 // GL_ARB_sync
+// GL_ARB_uniform_buffer_object
 // GL_ARB_vertex_array_object
 // WGL_ARB_extensions_string
 // WGL_ARB_pixel_format
@@ -334,6 +336,22 @@ extern PFNGLISVERTEXARRAYPROC       pglIsVertexArray;       // VBO query procedu
 #define glBindVertexArray           pglBindVertexArray
 #define glIsVertexArray             pglIsVertexArray
 
+// GL_ARB_draw_instanced
+extern PFNGLDRAWARRAYSINSTANCEDARBPROC      pglDrawArraysInstancedARB;      // draw arrays N times, gl_InstanceIDARB in shader
+extern PFNGLDRAWELEMENTSINSTANCEDARBPROC    pglDrawElementsInstancedARB;    // draw elements N times, gl_InstanceIDARB in shader
+#define glDrawArraysInstancedARB            pglDrawArraysInstancedARB
+#define glDrawElementsInstancedARB          pglDrawElementsInstancedARB
+
+// GL_ARB_uniform_buffer_object
+extern PFNGLGETUNIFORMBLOCKINDEXPROC    pglGetUniformBlockIndex;    // get index of uniform block
+extern PFNGLUNIFORMBLOCKBINDINGPROC     pglUniformBlockBinding;     // assign binding point to uniform block
+extern PFNGLBINDBUFFERBASEPROC          pglBindBufferBase;          // bind buffer to indexed binding point
+extern PFNGLBINDBUFFERRANGEPROC         pglBindBufferRange;         // bind buffer range to indexed binding point
+#define glGetUniformBlockIndex          pglGetUniformBlockIndex
+#define glUniformBlockBinding           pglUniformBlockBinding
+#define glBindBufferBase                pglBindBufferBase
+#define glBindBufferRange               pglBindBufferRange
+
 // GL_ARB_vertex_shader and GL_ARB_fragment_shader extensions
 extern PFNGLBINDATTRIBLOCATIONARBPROC   pglBindAttribLocationARB;   // bind vertex attrib var with index
 extern PFNGLGETACTIVEATTRIBARBPROC      pglGetActiveAttribARB;      // get attrib value
@@ -0,0 +1,235 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// glStateCache.cpp
+// ================
+// Shadowed OpenGL state that sits between ModelGL and GL.
+// Redundant state changes are filtered out and counted.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "glStateCache.h"
+#include "glExtension.h"                // for glUseProgram()
+
+// capabilities shadowed by the cache, others are passed through to GL
+static const GLenum CACHED_CAPS[] = { GL_LIGHTING, GL_COLOR_MATERIAL, GL_DEPTH_TEST, GL_CULL_FACE,
+                                      GL_BLEND, GL_TEXTURE_2D, GL_SCISSOR_TEST, GL_LIGHT0 };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+glStateCache::glStateCache() : depthFuncValue(GL_LESS), lineWidthValue(1), pointSizeValue(1),
+                               blendSrc(GL_ONE), blendDst(GL_ZERO), polygonModeValue(GL_FILL), program(0),
+                               issued(0), filtered(0), lastIssued(0), lastFiltered(0)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        clearColorValue[i] = 0;
+        viewportValue[i] = scissorValue[i] = 0;
+    }
+    invalidate();
+}
+
+glStateCache::~glStateCache()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// forget all shadowed values, so the next call of each state goes to GL
+///////////////////////////////////////////////////////////////////////////////
+void glStateCache::invalidate()
+{
+    for(int i = 0; i < CAP_COUNT; ++i)
+        caps[i] = STATE_UNKNOWN;
+
+    for(int i = 0; i < SLOT_COUNT; ++i)
+        valid[i] = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// move the counters of current frame to the previous frame
+///////////////////////////////////////////////////////////////////////////////
+void glStateCache::beginFrame()
+{
+    lastIssued = issued;
+    lastFiltered = filtered;
+    issued = filtered = 0;
+}
+
+float glStateCache::getLastFrameFilteredRatio() const
+{
+    int total = lastIssued + lastFiltered;
+    if(total == 0)
+        return 0;
+    return (float)lastFiltered / total;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// glEnable() / glDisable()
+///////////////////////////////////////////////////////////////////////////////
+void glStateCache::enable(GLenum cap)
+{
+    setCap(cap, STATE_ON);
+}
+
+void glStateCache::disable(GLenum cap)
+{
+    setCap(cap, STATE_OFF);
+}
+
+void glStateCache::setCap(GLenum cap, int state)
+{
+    int index = findCap(cap);
+    if(index >= 0)
+    {
+        if(caps[index] == state)
+        {
+            ++filtered;
+            return;
+        }
+        caps[index] = state;
+    }
+
+    if(state == STATE_ON)
+        glEnable(cap);
+    else
+        glDisable(cap);
+    ++issued;
+}
+
+int glStateCache::findCap(GLenum cap) const
+{
+    for(int i = 0; i < CAP_COUNT; ++i)
+    {
+        if(CACHED_CAPS[i] == cap)
+            return i;
+    }
+    return -1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return true if the call must be issued, and update counters
+///////////////////////////////////////////////////////////////////////////////
+bool glStateCache::check(int slot, bool same)
+{
+    if(valid[slot] && same)
+    {
+        ++filtered;
+        return false;
+    }
+    valid[slot] = true;
+    ++issued;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// other states
+///////////////////////////////////////////////////////////////////////////////
+void glStateCache::depthFunc(GLenum func)
+{
+    if(check(SLOT_DEPTH_FUNC, depthFuncValue == func))
+    {
+        depthFuncValue = func;
+        glDepthFunc(func);
+    }
+}
+
+void glStateCache::lineWidth(GLfloat width)
+{
+    if(check(SLOT_LINE_WIDTH, lineWidthValue == width))
+    {
+        lineWidthValue = width;
+        glLineWidth(width);
+    }
+}
+
+void glStateCache::pointSize(GLfloat size)
+{
+    if(check(SLOT_POINT_SIZE, pointSizeValue == size))
+    {
+        pointSizeValue = size;
+        glPointSize(size);
+    }
+}
+
+void glStateCache::blendFunc(GLenum src, GLenum dst)
+{
+    if(check(SLOT_BLEND_FUNC, blendSrc == src && blendDst == dst))
+    {
+        blendSrc = src;
+        blendDst = dst;
+        glBlendFunc(src, dst);
+    }
+}
+
+void glStateCache::polygonMode(GLenum mode)
+{
+    if(check(SLOT_POLYGON_MODE, polygonModeValue == mode))
+    {
+        polygonModeValue = mode;
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+void glStateCache::useProgram(GLuint id)
+{
+    if(check(SLOT_PROGRAM, program == id))
+    {
+        program = id;
+        glUseProgram(id);
+    }
+}
+
+void glStateCache::clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    bool same = clearColorValue[0] == r && clearColorValue[1] == g &&
+                clearColorValue[2] == b && clearColorValue[3] == a;
+    if(check(SLOT_CLEAR_COLOR, same))
+    {
+        clearColorValue[0] = r;
+        clearColorValue[1] = g;
+        clearColorValue[2] = b;
+        clearColorValue[3] = a;
+        glClearColor(r, g, b, a);
+    }
+}
+
+void glStateCache::viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    bool same = viewportValue[0] == x && viewportValue[1] == y &&
+                viewportValue[2] == w && viewportValue[3] == h;
+    if(check(SLOT_VIEWPORT, same))
+    {
+        viewportValue[0] = x;
+        viewportValue[1] = y;
+        viewportValue[2] = w;
+        viewportValue[3] = h;
+        glViewport(x, y, w, h);
+    }
+}
+
+void glStateCache::scissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    bool same = scissorValue[0] == x && scissorValue[1] == y &&
+                scissorValue[2] == w && scissorValue[3] == h;
+    if(check(SLOT_SCISSOR, same))
+    {
+        scissorValue[0] = x;
+        scissorValue[1] = y;
+        scissorValue[2] = w;
+        scissorValue[3] = h;
+        glScissor(x, y, w, h);
+    }
+}
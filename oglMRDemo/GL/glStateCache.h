@@ -0,0 +1,92 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// glStateCache.h
+// ==============
+// Shadowed OpenGL state that sits between ModelGL and GL.
+// Every state call goes through this class. It remembers the last value sent
+// to GL and drops calls that would not change anything, e.g. glDisable(GL_LIGHTING)
+// while lighting is already disabled.
+//
+// It also counts how many state calls were issued to GL and how many were
+// filtered out. Call beginFrame() once per frame, then getLastFrameIssued()
+// and getLastFrameFiltered() return the counters of the previous frame.
+//
+// NOTE: The shadow is only valid while nobody else touches the same states.
+// Call invalidate() after any code that changes GL state behind its back.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+class glStateCache
+{
+public:
+    glStateCache();
+    ~glStateCache();
+
+    void invalidate();                                  // forget all shadowed values
+    void beginFrame();                                  // store counters of prev frame and reset
+
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void depthFunc(GLenum func);
+    void lineWidth(GLfloat width);
+    void pointSize(GLfloat size);
+    void blendFunc(GLenum src, GLenum dst);
+    void polygonMode(GLenum mode);                      // for GL_FRONT_AND_BACK only
+    void useProgram(GLuint program);
+    void clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+    void scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+
+    // counters of current frame
+    int getIssued() const                   { return issued; }
+    int getFiltered() const                 { return filtered; }
+
+    // counters of previous frame (updated by beginFrame())
+    int getLastFrameIssued() const          { return lastIssued; }
+    int getLastFrameFiltered() const        { return lastFiltered; }
+    float getLastFrameFilteredRatio() const;
+
+private:
+    enum { CAP_COUNT = 8 };
+    enum { STATE_UNKNOWN = -1, STATE_OFF = 0, STATE_ON = 1 };
+    enum { SLOT_DEPTH_FUNC = 0, SLOT_LINE_WIDTH, SLOT_POINT_SIZE, SLOT_BLEND_FUNC, SLOT_POLYGON_MODE,
+           SLOT_PROGRAM, SLOT_CLEAR_COLOR, SLOT_VIEWPORT, SLOT_SCISSOR, SLOT_COUNT };
+
+    int  findCap(GLenum cap) const;                     // return slot index of cap, -1 if not shadowed
+    void setCap(GLenum cap, int state);
+    bool check(int slot, bool same);                    // true if the call must be issued to GL
+
+    int caps[CAP_COUNT];                                // shadowed enable flags
+    GLenum depthFuncValue;
+    GLfloat lineWidthValue;
+    GLfloat pointSizeValue;
+    GLenum blendSrc;
+    GLenum blendDst;
+    GLenum polygonModeValue;
+    GLuint program;
+    GLfloat clearColorValue[4];
+    GLint viewportValue[4];
+    GLint scissorValue[4];
+    bool valid[SLOT_COUNT];                             // validity of non-cap shadows
+
+    int issued;
+    int filtered;
+    int lastIssued;
+    int lastFiltered;
+};
+
+#endif
@@ -20,20 +20,69 @@
 #endif
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 #include "ModelGL.h"
+#include "../Common/Trace.h"
 #include "../Res/teapot.h"             // 3D mesh of teapot
 #include "../Res/cameraSimple.h"       // 3D mesh of camera
 
 #include "../FCore/FSCore.h"
 
+#include "../Common/Log.h"             // LOG_ERROR() of GLSL link errors
+
 // constants
 const float DEG2RAD = 3.141593f / 180;
 const float FOV_Y = 60.0f;              // vertical FOV in degree
 const float NEAR_PLANE = 1.0f;
 const float FAR_PLANE = 100.0f;
-const float CAMERA_ANGLE_X = 45.0f;     // pitch in degree
-const float CAMERA_ANGLE_Y = -45.0f;    // heading in degree
-const float CAMERA_DISTANCE = 25.0f;    // camera distance
+const float DEBUG_NEAR_PLANE = 1.0f;    // clip planes of drawSub1()
+const float DEBUG_FAR_PLANE = 30.0f;
+const size_t SCENE_COMMAND_CAPACITY = 4096;     // commands posted between 2 frames
+const uint64_t WINDOW_SIZE_REQUESTED = 1ull << 63; // flag of ModelGL::windowSizeRequest
+const unsigned char STROKE_COLORS[][3] = { { 255, 220, 40 }, { 40, 200, 255 }, { 255, 90, 90 },
+                                           { 120, 255, 120 }, { 230, 120, 255 }, { 255, 255, 255 } };
+const int STROKE_COLOR_COUNT = sizeof(STROKE_COLORS) / sizeof(STROKE_COLORS[0]);
+const int STROKE_KEY = 1;               // fmGetPenKey() bit that draws
+const int ERASE_KEY = 2;                // fmGetPenKey() bit that erases
+const float PICK_RADIUS = 0.1f;         // hover and erase reach of the nib, world space
+const int VIEWER_PROBE_FRAMES = 60;     // frames between 2 attempts to open the pose rings of viewers
+const float SPECTATOR_SPACING = 0.15f;  // meters between simulated viewers
+const float SPECTATOR_DISTANCE = 0.5f;  // meters in front of the screen, if viewer 0 has no glasses
+const float TEAPOT_MIN[3] = { -3.0f, 0.0f, -2.0f };     // bounding box of teapot.h
+const float TEAPOT_MAX[3] = { 3.434f, 3.15f, 2.0f };
+
+// what drawMultiView() draws, kind and state of MultiViewPlanner::Item
+enum { VIEW_ITEM_SCREEN = 0, VIEW_ITEM_GRID, VIEW_ITEM_PEN, VIEW_ITEM_AXIS, VIEW_ITEM_STROKES, VIEW_ITEM_TEAPOT };
+enum { VIEW_STATE_LINES = 0, VIEW_STATE_STROKES, VIEW_STATE_LIT };
+
+// GL states of each kind of draw, set by useDrawState() before the draw
+// Nothing is restored after a draw. The next draw declares what it needs and
+// glStateCache drops the calls that would not change anything.
+enum { DRAW_LINES = 0, DRAW_AXIS, DRAW_STROKES, DRAW_FRUSTUM, DRAW_MESH, DRAW_MESH_SHADED, DRAW_PIXELS };
+struct DrawState
+{
+    bool lighting;
+    bool colorMaterial;     // off for GLSL, glColor() would overwrite gl_FrontMaterial
+    bool cullFace;          // culls only in fill mode
+    bool depthTest;
+    bool blend;
+    bool texture;
+    GLenum depthFunc;
+    float lineWidth;
+    float pointSize;
+};
+const DrawState DRAW_STATES[] = {
+    //  light  colmat cull   depth  blend  tex    depthFunc  line point
+    { false, true,  true,  true,  true,  true,  GL_LEQUAL, 1,   1 },     // DRAW_LINES
+    { false, true,  true,  true,  true,  true,  GL_ALWAYS, 3,   5 },     // DRAW_AXIS, over the grid lines
+    { false, true,  false, true,  true,  true,  GL_LEQUAL, 1,   1 },     // DRAW_STROKES, ribbons seen from both sides
+    { false, true,  false, true,  true,  true,  GL_LEQUAL, 1,   1 },     // DRAW_FRUSTUM, translucent planes
+    { true,  true,  true,  true,  true,  true,  GL_LEQUAL, 1,   1 },     // DRAW_MESH, fixed function
+    { true,  false, true,  true,  true,  true,  GL_LEQUAL, 1,   1 },     // DRAW_MESH_SHADED, progId2 or progIdStereo2
+    { false, true,  true,  false, false, false, GL_LEQUAL, 1,   1 },     // DRAW_PIXELS, glDrawPixels() of drawReprojected()
+};
 
 //整个系统的放大比例
 float k = 30;
@@ -93,21 +142,75 @@ void main()
 )";
 
 
+// instanced single-pass stereo ===========================
+// Both eyes are drawn by one call with 2 instances, gl_InstanceIDARB selects
+// the eye. The vertex is moved into the left or right half of a full-window
+// viewport and clipped at the middle, so the eyes cannot bleed into each other.
+// The fragment shaders above are reused with this version line in front.
+const char* vsStereoHeader = R"(#version 130
+#extension GL_ARB_draw_instanced : require
+#extension GL_ARB_uniform_buffer_object : require
+layout(std140) uniform StereoMatrices
+{
+    mat4 stereoView[2];             // 0: left eye, 1: right eye
+    mat4 stereoProjection[2];
+};
+vec4 toEyeViewport(vec4 clip, int eye)
+{
+    float side = float(eye) * 2.0 - 1.0;    // -1: left half, +1: right half
+    gl_ClipDistance[0] = clip.w + side * clip.x;
+    clip.x = clip.x * 0.5 + side * 0.5 * clip.w;
+    return clip;
+}
+)";
+const char* fsStereoHeader = "#version 130\n";
+
+// flat shading, gl_ModelViewMatrix holds the model matrix only
+const char* vsStereo1 = R"(
+void main()
+{
+    int eye = gl_InstanceIDARB;
+    gl_FrontColor = gl_Color;
+    gl_Position = toEyeViewport(stereoProjection[eye] * stereoView[eye] * gl_ModelViewMatrix * gl_Vertex, eye);
+}
+)";
+
+// blinn specular shading, same varyings as vsSource2
+// NOTE: view matrices of StereoFrustum are rigid, so its upper 3x3 is used for normals
+const char* vsStereo2 = R"(
+varying vec3 esVertex, esNormal;
+void main()
+{
+    int eye = gl_InstanceIDARB;
+    vec4 position = stereoView[eye] * gl_ModelViewMatrix * gl_Vertex;
+    esVertex = vec3(position);
+    esNormal = mat3(stereoView[eye]) * gl_NormalMatrix * gl_Normal;
+    gl_FrontColor = gl_Color;
+    gl_Position = toEyeViewport(stereoProjection[eye] * position, eye);
+}
+)";
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // default ctor
 ///////////////////////////////////////////////////////////////////////////////
 ModelGL::ModelGL() : windowWidth(0), windowHeight(0), povWidth(0),
-                     drawModeChanged(false), drawMode(0),
-                     cameraAngleX(CAMERA_ANGLE_X), cameraAngleY(CAMERA_ANGLE_Y),
-                     cameraDistance(CAMERA_DISTANCE), windowSizeChanged(false),
-                     glslSupported(false), glslReady(false), progId1(0), progId2(0), isVRMode(false)
-{
-    cameraPosition[0] = cameraPosition[1] = cameraPosition[2] = 0;
-    cameraAngle[0] = cameraAngle[1] = cameraAngle[2] = 0;
-    modelPosition[0] = modelPosition[1] = modelPosition[2] = 0;
-    modelAngle[0] = modelAngle[1] = modelAngle[2] = 0;
+                     windowSizeChanged(false), drawModeChanged(false),
+                     commands(SCENE_COMMAND_CAPACITY), postedCommands(0), appliedCommands(0), windowSizeRequest(0),
+                     resyncRequested(false), sceneResyncs(0),
+                     viewDirty(false), modelDirty(false), matrixUpdateRequests(0), matrixRebuilds(0),
+                     reprojectionEnabled(false),
+                     glslSupported(false), glslReady(false), progId1(0), progId2(0),
+                     stereoInstancedReady(false), stereoInstanced(true),
+                     progIdStereo1(0), progIdStereo2(0), uboStereo(0),
+                     latchSequence(0), predictionLookAhead(0),
+                     penKeysDown(0), hoveredStroke(-1), viewerProbeFrames(0)
+{
     bgColor[0] = bgColor[1] = bgColor[2] = bgColor[3] = 0;
+    memset(&latchedPose, 0, sizeof(latchedPose));
+    memset(&latchedFrustum, 0, sizeof(latchedFrustum));
+    memset(viewerPoses, 0, sizeof(viewerPoses));
 
     matrixView.identity();
     matrixModel.identity();
@@ -134,30 +237,41 @@ ModelGL::~ModelGL()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::init()
 {
+    // GL states are unknown in a new context
+    stateCache.invalidate();
+
+    // FSCore is polled by its own thread from now on
+    tracking.start();
+
     glShadeModel(GL_SMOOTH);                        // shading mathod: GL_SMOOTH or GL_FLAT
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);          // 4-byte pixel alignment
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
 
     // enable/disable features
     glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
     //glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
     //glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glEnable(GL_SCISSOR_TEST);
+    stateCache.enable(GL_DEPTH_TEST);
+    stateCache.enable(GL_LIGHTING);
+    stateCache.enable(GL_TEXTURE_2D);
+    stateCache.enable(GL_CULL_FACE);
+    stateCache.enable(GL_BLEND);
+    stateCache.enable(GL_SCISSOR_TEST);
 
      // track material ambient and diffuse from surface color, call it before glEnable(GL_COLOR_MATERIAL)
     glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
-    glEnable(GL_COLOR_MATERIAL);
+    stateCache.enable(GL_COLOR_MATERIAL);
 
-    glClearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);   // background color
+    stateCache.clearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);   // background color
+    stateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);           // translucent planes of drawFrustum()
     glClearStencil(0);                              // clear stencil buffer
     glClearDepth(1.0f);                             // 0 is near, 1 is far
-    glDepthFunc(GL_LEQUAL);
+    stateCache.depthFunc(GL_LEQUAL);
 
     initLights();
+
+    // strokes are drawn from vertex buffers if possible
+    strokeRenderer.init();
 }
 
 
@@ -175,6 +289,15 @@ bool ModelGL::initShaders()
         glslSupported = extension.isSupported("GL_ARB_shader_objects");
         if(glslSupported)
             glslReady = createShaderPrograms();
+
+        // instanced stereo needs GLSL 1.30 on top of these, otherwise drawVR() draws 2 passes
+        if(glslReady &&
+           extension.isSupported("GL_ARB_draw_instanced") &&
+           extension.isSupported("GL_ARB_uniform_buffer_object") &&
+           extension.isSupported("GL_ARB_vertex_buffer_object"))
+        {
+            stereoInstancedReady = createStereoPrograms();
+        }
     }
     return glslReady;
 }
@@ -186,6 +309,83 @@ bool ModelGL::initShaders()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::quit()
 {
+    tracking.stop();
+    strokeRenderer.release();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// parameters of the jitter filter, used by the tracking thread from its next pose
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::setPoseFilterParams(int channel, float minCutoff, float beta, float derivativeCutoff)
+{
+    OneEuroFilter::Params params = { minCutoff, beta, derivativeCutoff };
+    tracking.setFilterParams(channel, params);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// record the poses of the tracking thread into a file
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::startRecording(const char* fileName)
+{
+    stopRecording();
+    if(!recorder.open(fileName))
+        return false;
+
+    tracking.setRecorder(&recorder);
+    return true;
+}
+
+void ModelGL::stopRecording()
+{
+    tracking.setRecorder(0);                        // waits until the thread is done with it
+    recorder.close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// replace FSCore by a recording, it plays from the start at the given speed
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::startReplay(const char* fileName, double speed)
+{
+    stopReplay();
+    if(!replay.open(fileName))
+        return false;
+
+    replay.setSpeed(speed);
+    tracking.setReplay(&replay);
+    return true;
+}
+
+void ModelGL::stopReplay()
+{
+    tracking.setReplay(0);
+    replay.close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// share the poses of the tracking thread with other processes (PoseClient)
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::startPoseServer(const char* name)
+{
+    stopPoseServer();
+    if(!poseServer.open(name))
+        return false;
+
+    tracking.setServer(&poseServer);
+    return true;
+}
+
+void ModelGL::stopPoseServer()
+{
+    tracking.setServer(0);                          // waits until the thread is done with it
+    poseServer.close();
 }
 
 
@@ -207,7 +407,7 @@ void ModelGL::initLights()
     float lightPos[4] = {0, 1, 1, 0};               // directional light
     glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
 
-    glEnable(GL_LIGHT0);                            // MUST enable each light source after configuration
+    stateCache.enable(GL_LIGHT0);                   // MUST enable each light source after configuration
 }
 
 
@@ -272,10 +472,42 @@ void ModelGL::setCamera(float posX, float posY, float posZ, float targetX, float
 // set rendering window size
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setWindowSize(int width, int height)
+{
+    // called from both UI and rendering threads, so the UI copy is not updated
+    // and the size is not queued, the latest one is applied by the next frame
+    uint64_t request = WINDOW_SIZE_REQUESTED | ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+    windowSizeRequest.store(request, std::memory_order_release);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// projection of latchPose() for the latest window size and the UI copy of the
+// VR mode, so it is not read from the rendering thread
+///////////////////////////////////////////////////////////////////////////////
+const float* ModelGL::getProjectionMatrixElements()
+{
+    uint64_t size = windowSizeRequest.load(std::memory_order_acquire);
+    int width = (int)((size >> 32) & 0x7fffffff);
+    int height = (int)(size & 0xffffffff);
+    float aspectRatio = height > 0 ? (float)width / height : 1.0f;
+    if (uiScene.vrMode)
+        uiMatrixProjection = setFrustum(FOV_Y, aspectRatio, NEAR_PLANE, FAR_PLANE);
+    else
+        uiMatrixProjection = setFrustum(FOV_Y, aspectRatio, DEBUG_NEAR_PLANE, DEBUG_FAR_PLANE);
+    return uiMatrixProjection.get();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// apply new window size of the scene, rendering thread
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::updateWindowSize()
 {
     // assign the width/height of viewport
-    windowWidth = width;
-    windowHeight = height;
+    windowWidth = scene.windowWidth;
+    windowHeight = scene.windowHeight;
 
     // compute dim for point of view screen
     povWidth = windowWidth / 2;
@@ -296,14 +528,14 @@ void ModelGL::setWindowSize(int width, int height)
 void ModelGL::setViewport(int x, int y, int w, int h)
 {
     // set viewport to be the entire window
-    glViewport((GLsizei)x, (GLsizei)y, (GLsizei)w, (GLsizei)h);
+    stateCache.viewport(x, y, w, h);
 
     // set perspective viewing frustum
-    Matrix4 matrix = setFrustum(FOV_Y, (float)(w)/h, NEAR_PLANE, FAR_PLANE); // FOV, AspectRatio, NearClip, FarClip
+    matrixProjection = setFrustum(FOV_Y, (float)(w)/h, NEAR_PLANE, FAR_PLANE); // FOV, AspectRatio, NearClip, FarClip
 
     // copy projection matrix to OpenGL
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(matrix.get());
+    glLoadMatrixf(matrixProjection.get());
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 }
@@ -316,15 +548,15 @@ void ModelGL::setViewport(int x, int y, int w, int h)
 void ModelGL::setViewportSub(int x, int y, int width, int height, float nearPlane, float farPlane)
 {
     // set viewport
-    glViewport(x, y, width, height);
-    glScissor(x, y, width, height);
+    stateCache.viewport(x, y, width, height);
+    stateCache.scissor(x, y, width, height);
 
-    // set perspective viewing frustum
-    Matrix4 matrix = setFrustum(FOV_Y, (float)(width)/height, nearPlane, farPlane); // FOV, AspectRatio, NearClip, FarClip
+    // set perspective viewing frustum, keep it on CPU side to avoid reading it back from GL
+    matrixProjection = setFrustum(FOV_Y, (float)(width)/height, nearPlane, farPlane); // FOV, AspectRatio, NearClip, FarClip
 
     // copy projection matrix to OpenGL
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(matrix.get());
+    glLoadMatrixf(matrixProjection.get());
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 }
@@ -334,19 +566,102 @@ void ModelGL::setViewportSub(int x, int y, int width, int height, float nearPlan
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::draw()
 {
-    fmSetActiveUser();//标记活动用户
+    TRACE_ZONE("ModelGL::draw");
+    stateCache.beginFrame();
+
+    // take the changes made by the UI thread since the last frame
+    applyCommands();
+    applyTrackingEvents();
 
-    if (!isVRMode)
+    // rebuild the matrices changed since the last frame, only once
+    updateMatrices();
+
+    // late latch: all CPU work that does not need the pose is done above,
+    // nothing below reads FSCore again in this frame
+    latchPose();
+
+    // only the points added since the last frame
+    strokeRenderer.upload(strokes);
+
+    if (!scene.vrMode)
     {
         drawDebug();//画普通的调试场景(这个全是一般的openGL绘制,可以不管)
+        reprojector.invalidateSource();
+    }
+    else if (scene.viewerCount > 1)
+    {
+        drawMultiView();//多人观看，每人一个区域
+        reprojector.invalidateSource();             // reprojection warps one viewer only
     }
     else
     {
         drawVR();//vr模式下的绘制
+        if (reprojectionEnabled)
+            captureFrame();
     }
 }
 
 
+
+///////////////////////////////////////////////////////////////////////////////
+// present the last VR frame reprojected to the current pose
+// Used instead of draw() when the previous frame missed its deadline. Only
+// the pose is sampled again, the scene is not drawn, and the warped image is
+// written to the back buffer with glDrawPixels().
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawReprojected()
+{
+    TRACE_ZONE("ModelGL::drawReprojected");
+    if (!isReprojectionReady())
+    {
+        draw();
+        return;
+    }
+
+    stateCache.beginFrame();
+    updateMatrices();
+    latchPose();
+
+    const f3d::FrustumData& fd = latchedFrustum;
+    reprojector.warp(Matrix4(fd.matViewL.m), Matrix4(fd.matProjectionL.m),
+                     Matrix4(fd.matViewR.m), Matrix4(fd.matProjectionR.m));
+
+    stateCache.viewport(0, 0, windowWidth, windowHeight);
+    stateCache.scissor(0, 0, windowWidth, windowHeight);
+    useDrawState(DRAW_PIXELS);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glRasterPos2f(-1, -1);
+    glDrawPixels(reprojector.getWidth(), reprojector.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, reprojector.getOutputColor());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// read back color and depth of the VR frame with its eye matrices
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::captureFrame()
+{
+    TRACE_ZONE("ModelGL::captureFrame");
+    const f3d::FrustumData& fd = latchedFrustum;
+
+    reprojector.setSourceSize(windowWidth, windowHeight);
+    if (windowWidth <= 0 || windowHeight <= 0)
+        return;
+
+    glReadPixels(0, 0, windowWidth, windowHeight, GL_RGBA, GL_UNSIGNED_BYTE, reprojector.getSourceColor());
+    glReadPixels(0, 0, windowWidth, windowHeight, GL_DEPTH_COMPONENT, GL_FLOAT, reprojector.getSourceDepth());
+
+    reprojector.setSourceEye(StereoReprojector::EYE_LEFT, 0, windowWidth / 2,
+                             Matrix4(fd.matViewL.m), Matrix4(fd.matProjectionL.m));
+    reprojector.setSourceEye(StereoReprojector::EYE_RIGHT, windowWidth / 2, windowWidth - windowWidth / 2,
+                             Matrix4(fd.matViewR.m), Matrix4(fd.matProjectionR.m));
+}
+
+
 void ModelGL::drawDebug()
 {
     drawSub1();//左边图像
@@ -359,140 +674,434 @@ void ModelGL::drawDebug()
         windowSizeChanged = false;
     }
 
+    // face culling follows the draw mode in useDrawState()
     if (drawModeChanged)
     {
-        if (drawMode == 0)           // fill mode
-        {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-            glEnable(GL_DEPTH_TEST);
-            glEnable(GL_CULL_FACE);
-        }
-        else if (drawMode == 1)      // wireframe mode
-        {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-            //glDisable(GL_DEPTH_TEST);
-            glDisable(GL_CULL_FACE);
-        }
-        else if (drawMode == 2)      // point mode
-        {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-            //glDisable(GL_DEPTH_TEST);
-            glDisable(GL_CULL_FACE);
-        }
+        if (scene.drawMode == 0)           // fill mode
+            stateCache.polygonMode(GL_FILL);
+        else if (scene.drawMode == 1)      // wireframe mode
+            stateCache.polygonMode(GL_LINE);
+        else if (scene.drawMode == 2)      // point mode
+            stateCache.polygonMode(GL_POINT);
         drawModeChanged = false;
     }
 }
 
-//这个是fmModifyFrustum()函数的思路:
+//这个是StereoFrustum（代替fmModifyFrustum()）的思路:
 // 首先要根据当前的观察位置去确定一个假想一体机屏幕的位置。
 // 在这个例子中我们设计假想屏幕位置就是世界的中心，这样的观察效果比较好，比较能看到茶壶。
 // 原来我们有一个普通的固定观察相机在（0,0,10），现在就是要在当前观察相机的基础上向正前方推进10，然后设置屏幕高度为10，
 // 这样假想中心就到了我们想设置的位置。
 void ModelGL::drawVR()
 {
+    TRACE_ZONE("ModelGL::drawVR");
     //设置一个常规的渲染视口
     setViewportSub(0, 0, windowWidth, windowHeight, NEAR_PLANE, FAR_PLANE);
 
-    f3d::FrustumData fd;//变换结果结构体，结果中有View矩阵和Projection矩阵
-    f3d::Matrix4 proj;
-    glGetFloatv(GL_PROJECTION_MATRIX, proj.m);//得到当前投影矩阵
-    fmModifyFrustum(&fd, (f3d::Matrix4*)&matrixView, &proj, -10, 10, 0.066, false);//屏幕坐标向前推移10，屏幕高度10
+    //变换结果结构体，结果中有View矩阵和Projection矩阵，在latchPose()里用本帧的姿态算好
+    const f3d::FrustumData& fd = latchedFrustum;
+
+    //单pass绘制两只眼睛
+    if (stereoInstanced && stereoInstancedReady)
+    {
+        drawVRInstanced(fd);
+        return;
+    }
 
     //画左半边图像
-    glViewport(0, 0, windowWidth/2, windowHeight);
-    glScissor(0, 0, windowWidth/2, windowHeight);
+    drawVREye(0, 0, windowWidth / 2, fd.matProjectionL.m, fd.matViewL.m);
+
+    //画右半边图像，奇数宽度时多出的一列归右眼，与captureFrame()一致
+    drawVREye(1, windowWidth / 2, windowWidth - windowWidth / 2, fd.matProjectionR.m, fd.matViewR.m);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// one eye of drawVR() in the columns [x, x + width) of the window
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawVREye(int eye, int x, int width, const float* projection, const float* view)
+{
+    static const char* const zoneNames[] = { "ModelGL::drawVR left eye", "ModelGL::drawVR right eye" };
+    TRACE_ZONE(zoneNames[eye]);
+
+    const f3d::FrustumData& fd = latchedFrustum;
+    stateCache.viewport(x, 0, width, windowHeight);
+    stateCache.scissor(x, 0, width, windowHeight);
 
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(fd.matProjectionL.m);//设置左眼投影
+    glLoadMatrixf(projection);//设置这只眼的投影
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    glClearColor(0.2f, 0.2f, 0.2f, 1);
+    stateCache.clearColor(0.2f, 0.2f, 0.2f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     glPushMatrix();
 
-    glLoadMatrixf(fd.matViewL.m);//设置左眼View矩阵，为了画线
+    glLoadMatrixf(view);//设置这只眼的View矩阵，为了画线
 
     drawScreen();
     drawGrid(10, 1);
 
     //画线
-    glDisable(GL_LIGHTING);
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
     glColor3f(0.9f, 0.9f, 0.9f);
     glVertex3f(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);
     glColor3f(0.0f, 0.0f, 0.0f);
     glVertex3f(fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y, fd.penPosition.z + fd.penDirection.z);
     glEnd();
-    glEnable(GL_LIGHTING);
+
+    drawStrokes();//画笔迹
 
     Matrix4 mat;
-    mat.set(fd.matViewL.m);//画茶壶
+    mat.set(view);//画茶壶
     Matrix4 matMV = mat * matrixModel;
     glLoadMatrixf(matMV.get());
     drawAxis(4);
     if (glslReady)
-    {
-        glUseProgram(progId2);
-        glDisable(GL_COLOR_MATERIAL);
-        drawTeapot();
-        glEnable(GL_COLOR_MATERIAL);
-        glUseProgram(0);
-    }
+        useDrawState(DRAW_MESH_SHADED, progId2);
     else
-    {
-        drawTeapot();
-    }
+        useDrawState(DRAW_MESH);
+    drawTeapot();
     glPopMatrix();
+}
 
-    //画右半边图像
-    glViewport(windowWidth / 2, 0, windowWidth / 2, windowHeight);
-    glScissor(windowWidth / 2, 0, windowWidth / 2, windowHeight);
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(fd.matProjectionR.m);//设置右眼投影
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
 
-    glClearColor(0.2f, 0.2f, 0.2f, 1);
+///////////////////////////////////////////////////////////////////////////////
+// draw both eyes in a single pass
+// Every mesh is drawn once with 2 instances instead of once per eye. The view
+// and projection of each eye are in uboStereo, and the shaders route instance
+// 0 to the left half and instance 1 to the right half of the window.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawVRInstanced(const f3d::FrustumData& fd)
+{
+    TRACE_ZONE("ModelGL::drawVRInstanced");
+    // upload per-eye matrices, same layout as the StereoMatrices block (std140)
+    float stereoMatrices[64];
+    memcpy(stereoMatrices,      fd.matViewL.m,       sizeof(float) * 16);
+    memcpy(stereoMatrices + 16, fd.matViewR.m,       sizeof(float) * 16);
+    memcpy(stereoMatrices + 32, fd.matProjectionL.m, sizeof(float) * 16);
+    memcpy(stereoMatrices + 48, fd.matProjectionR.m, sizeof(float) * 16);
+    glBindBufferARB(GL_UNIFORM_BUFFER, uboStereo);
+    glBufferSubDataARB(GL_UNIFORM_BUFFER, 0, sizeof(stereoMatrices), stereoMatrices);
+    glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+
+    // one viewport and one clear for both eyes
+    stateCache.viewport(0, 0, windowWidth, windowHeight);
+    stateCache.scissor(0, 0, windowWidth, windowHeight);
+    stateCache.clearColor(0.2f, 0.2f, 0.2f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
+    stateCache.enable(GL_CLIP_DISTANCE0);           // split the viewport in the middle
+    glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
+    glLoadIdentity();                               // lines are in world space
 
-    glLoadMatrixf(fd.matViewR.m);//设置右眼View矩阵，为了画线
-
-    drawScreen();
-    drawGrid(10, 1);
+    // screen and grid
+    useDrawState(DRAW_LINES, progIdStereo1);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(float) * 6, &stereoLines[0]);
+    glColorPointer(3, GL_FLOAT, sizeof(float) * 6, &stereoLines[3]);
+    glDrawArraysInstancedARB(GL_LINES, 0, (GLsizei)stereoLines.size() / 6, 2);
 
     //画线
-    glDisable(GL_LIGHTING);
-    glBegin(GL_LINES);
-    glColor3f(0.9f, 0.9f, 0.9f);
-    glVertex3f(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);
-    glColor3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y, fd.penPosition.z + fd.penDirection.z);
-    glEnd();
-    glEnable(GL_LIGHTING);
+    float penLine[12] = { fd.penPosition.x, fd.penPosition.y, fd.penPosition.z, 0.9f, 0.9f, 0.9f,
+                          fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y,
+                          fd.penPosition.z + fd.penDirection.z, 0.0f, 0.0f, 0.0f };
+    glVertexPointer(3, GL_FLOAT, sizeof(float) * 6, &penLine[0]);
+    glColorPointer(3, GL_FLOAT, sizeof(float) * 6, &penLine[3]);
+    glDrawArraysInstancedARB(GL_LINES, 0, 2, 2);
+
+    // local axis of the model, see drawAxis()
+    const float size = 4;
+    const float axis[36] = { 0, 0, 0, 1, 0, 0,   size, 0, 0, 1, 0, 0,
+                             0, 0, 0, 0, 1, 0,   0, size, 0, 0, 1, 0,
+                             0, 0, 0, 0, 0, 1,   0, 0, size, 0, 0, 1 };
+    glLoadMatrixf(matrixModel.get());
+    useDrawState(DRAW_AXIS, progIdStereo1);
+    glVertexPointer(3, GL_FLOAT, sizeof(float) * 6, &axis[0]);
+    glColorPointer(3, GL_FLOAT, sizeof(float) * 6, &axis[3]);
+    glDrawArraysInstancedARB(GL_LINES, 0, 6, 2);
+    glVertexPointer(3, GL_FLOAT, sizeof(float) * 12, &axis[6]);     // end points only
+    glColorPointer(3, GL_FLOAT, sizeof(float) * 12, &axis[9]);
+    glDrawArraysInstancedARB(GL_POINTS, 0, 3, 2);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    //画笔迹
+    glLoadIdentity();
+    useDrawState(DRAW_STROKES, progIdStereo1);
+    strokeRenderer.draw(strokes, 2);
 
-    mat.set(fd.matViewR.m);//画茶壶
-    matMV = mat * matrixModel;
-    glLoadMatrixf(matMV.get());
-    drawAxis(4);
-    if (glslReady)
+    //画茶壶
+    useDrawState(DRAW_MESH_SHADED, progIdStereo2);
+    drawTeapotInstanced(2);
+
+    glPopMatrix();
+    stateCache.disable(GL_CLIP_DISTANCE0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// poses of the other viewers, read without waiting like latchPose()
+// A viewer without a running pose ring is a spectator beside viewer 0, so the
+// views can be seen without more trackers.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::latchViewers()
+{
+    int count = scene.viewerCount < MultiViewPlanner::MAX_VIEWERS ? scene.viewerCount : MultiViewPlanner::MAX_VIEWERS;
+    viewerPoses[0] = latchedPose;
+
+    // opening a ring is a few syscalls, so it is not tried every frame
+    bool probe = --viewerProbeFrames <= 0;
+    if (probe)
+        viewerProbeFrames = VIEWER_PROBE_FRAMES;
+
+    for (int i = 1; i < count; ++i)
     {
-        glUseProgram(progId2);
-        glDisable(GL_COLOR_MATERIAL);
-        drawTeapot();
-        glEnable(GL_COLOR_MATERIAL);
-        glUseProgram(0);
+        PoseClient& client = viewerClients[i];
+        if (client.isOpen() && !client.isProducerRunning())
+            client.close();
+        if (!client.isOpen() && probe)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "%s%d", POSE_SHM_NAME, i);
+            client.open(name);
+        }
+
+        TrackingPose& pose = viewerPoses[i];
+        if (client.isOpen() && client.getPublishedCount() > 0)
+        {
+            client.getPose(pose);                   // keeps the previous pose if the ring is being written
+            continue;
+        }
+
+        // spectators alternate left and right of viewer 0
+        pose = latchedPose;
+        if (!pose.glassStatus)
+        {
+            pose.glassPosition.x = pose.glassPosition.y = 0;
+            pose.glassPosition.z = -SPECTATOR_DISTANCE;
+            pose.glassRotation.x = pose.glassRotation.y = pose.glassRotation.z = 0;
+            pose.glassRotation.w = 1;
+            pose.glassStatus = 1;
+        }
+        pose.glassPosition.x += ((i & 1) ? -1 : 1) * ((i + 1) / 2) * SPECTATOR_SPACING;
     }
-    else
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// bounding spheres of the scene for MultiViewPlanner, rebuilt every frame
+// because strokes grow and the model moves
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::buildViewItems()
+{
+    viewItems.clear();
+    MultiViewPlanner::Item item = { { 0, 0, 0 }, 0, 0, VIEW_ITEM_SCREEN, 0, VIEW_STATE_LINES, 1 };
+
+    item.radius = sqrtf(0.27f * 0.27f + 0.15f * 0.15f) * k;        // see drawScreen()
+    viewItems.push_back(item);
+
+    item.kind = VIEW_ITEM_GRID;
+    item.radius = sqrtf(200.0f);                                    // drawGrid(10, 1)
+    viewItems.push_back(item);
+
+    const f3d::FrustumData& fd = latchedFrustum;
+    item.kind = VIEW_ITEM_PEN;
+    item.center[0] = fd.penPosition.x + fd.penDirection.x * 0.5f;
+    item.center[1] = fd.penPosition.y + fd.penDirection.y * 0.5f;
+    item.center[2] = fd.penPosition.z + fd.penDirection.z * 0.5f;
+    item.radius = Vector3(fd.penDirection.x, fd.penDirection.y, fd.penDirection.z).length() * 0.5f;
+    viewItems.push_back(item);
+
+    // strokes, one item per chunk
+    item.kind = VIEW_ITEM_STROKES;
+    item.state = VIEW_STATE_STROKES;
+    for (int i = 0; i < strokes.getChunkCount(); ++i)
     {
-        drawTeapot();
+        const StrokePool::Chunk& chunk = strokes.getChunk(i);
+        if (chunk.vertices.size() < 3)
+            continue;
+        Vector3 minimum(chunk.boundsMin[0], chunk.boundsMin[1], chunk.boundsMin[2]);
+        Vector3 maximum(chunk.boundsMax[0], chunk.boundsMax[1], chunk.boundsMax[2]);
+        Vector3 center = (minimum + maximum) * 0.5f;
+        item.center[0] = center.x;
+        item.center[1] = center.y;
+        item.center[2] = center.z;
+        item.radius = (maximum - center).length();
+        item.index = i;
+        viewItems.push_back(item);
     }
-    glPopMatrix();
 
+    // model space items, after the grid for the depth test of drawAxis()
+    item.matrix = matrixModel.get();
+    item.kind = VIEW_ITEM_AXIS;
+    item.state = VIEW_STATE_LINES;
+    item.index = 0;
+    item.center[0] = item.center[1] = item.center[2] = 2;
+    item.radius = sqrtf(12.0f);                                     // drawAxis(4)
+    viewItems.push_back(item);
+
+    // 0: shaded with progId2, 1: fixed function, 2: bounding box
+    item.kind = VIEW_ITEM_TEAPOT;
+    item.state = VIEW_STATE_LIT;
+    item.lodCount = 3;
+    Vector3 minimum(TEAPOT_MIN[0], TEAPOT_MIN[1], TEAPOT_MIN[2]);
+    Vector3 maximum(TEAPOT_MAX[0], TEAPOT_MAX[1], TEAPOT_MAX[2]);
+    Vector3 center = (minimum + maximum) * 0.5f;
+    item.center[0] = center.x;
+    item.center[1] = center.y;
+    item.center[2] = center.z;
+    item.radius = (maximum - center).length();
+    viewItems.push_back(item);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw several tracked viewers, each in its own region of the window
+// The regions are a grid, first viewer on the top left, and each region is
+// split into a left and a right eye like drawVR(). All eyes look at the same
+// screen rectangle, so an eye holds the whole screen as in drawVR() whatever
+// the shape of its region. MultiViewPlanner culls, selects LODs and computes
+// the matrices on worker threads; only the GL calls are made here.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawMultiView()
+{
+    TRACE_ZONE("ModelGL::drawMultiView");
+    setViewportSub(0, 0, windowWidth, windowHeight, NEAR_PLANE, FAR_PLANE);
+
+    latchViewers();
+    buildViewItems();
+
+    // same solver as the eyes of drawVR(), set by latchPose() for this frame
+    int count = scene.viewerCount < MultiViewPlanner::MAX_VIEWERS ? scene.viewerCount : MultiViewPlanner::MAX_VIEWERS;
+    if (!planner.plan(frustumCacheVR.getSolver(), viewerPoses, count, &viewItems[0], (int)viewItems.size()))
+        return;
+
+    int columns = (int)ceilf(sqrtf((float)count));
+    int rows = (count + columns - 1) / columns;
+    for (int v = 0; v < count; ++v)
+    {
+        int x0 = windowWidth * (v % columns) / columns;
+        int x1 = windowWidth * (v % columns + 1) / columns;
+        int y0 = windowHeight - windowHeight * (v / columns + 1) / rows;
+        int y1 = windowHeight - windowHeight * (v / columns) / rows;
+        const f3d::FrustumData& fd = planner.getFrustum(v);
+        const float* projections[2] = { fd.matProjectionL.m, fd.matProjectionR.m };
+
+        for (int eye = 0; eye < 2; ++eye)
+        {
+            TRACE_ZONE("ModelGL::drawMultiView eye");
+            int left = eye == 0 ? x0 : (x0 + x1) / 2;
+            int right = eye == 0 ? (x0 + x1) / 2 : x1;
+            stateCache.viewport(left, y0, right - left, y1 - y0);
+            stateCache.scissor(left, y0, right - left, y1 - y0);
+
+            glMatrixMode(GL_PROJECTION);
+            glLoadMatrixf(projections[eye]);
+            glMatrixMode(GL_MODELVIEW);
+
+            stateCache.clearColor(0.2f, 0.2f, 0.2f, 1);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            glPushMatrix();
+            const std::vector<MultiViewPlanner::Draw>& list = planner.getDrawList(v * 2 + eye);
+            for (size_t i = 0; i < list.size(); ++i)
+            {
+                const MultiViewPlanner::Command& command = planner.getCommand(list[i].command);
+                glLoadMatrixf(list[i].modelView);
+                drawViewItem(planner.getItem(command.item), command.lod);
+            }
+            glPopMatrix();
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// one item of drawMultiView() with the current matrices
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawViewItem(const MultiViewPlanner::Item& item, int lod)
+{
+    const f3d::FrustumData& fd = latchedFrustum;
+    switch (item.kind)
+    {
+    case VIEW_ITEM_SCREEN:
+        drawScreen();
+        break;
+
+    case VIEW_ITEM_GRID:
+        drawGrid(10, 1);
+        break;
+
+    case VIEW_ITEM_PEN:
+        useDrawState(DRAW_LINES);
+        glBegin(GL_LINES);
+        glColor3f(0.9f, 0.9f, 0.9f);
+        glVertex3f(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);
+        glColor3f(0.0f, 0.0f, 0.0f);
+        glVertex3f(fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y, fd.penPosition.z + fd.penDirection.z);
+        glEnd();
+        break;
+
+    case VIEW_ITEM_STROKES:
+        useDrawState(DRAW_STROKES);
+        strokeRenderer.drawChunk(strokes, item.index);
+        break;
+
+    case VIEW_ITEM_AXIS:
+        drawAxis(4);
+        break;
+
+    case VIEW_ITEM_TEAPOT:
+        if (lod == 0 && glslReady)
+        {
+            useDrawState(DRAW_MESH_SHADED, progId2);
+            drawTeapot();
+        }
+        else if (lod <= 1)
+        {
+            useDrawState(DRAW_MESH);
+            drawTeapot();
+        }
+        else
+        {
+            drawBox(TEAPOT_MIN, TEAPOT_MAX);
+        }
+        break;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// 12 edges of a box, the lowest LOD of a mesh
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawBox(const float* minimum, const float* maximum)
+{
+    useDrawState(DRAW_LINES);
+    glBegin(GL_LINES);
+    glColor3f(0.929524f, 0.796542f, 0.178823f);     // teapot color
+    for (int i = 0; i < 4; ++i)
+    {
+        float x = (i & 1) ? maximum[0] : minimum[0];
+        float y0 = (i & 1) ? maximum[1] : minimum[1];
+        float y1 = (i & 2) ? maximum[1] : minimum[1];
+        float z = (i & 2) ? maximum[2] : minimum[2];
+        glVertex3f(x, y1, minimum[2]);  glVertex3f(x, y1, maximum[2]);   // along z
+        glVertex3f(minimum[0], y0, z);  glVertex3f(maximum[0], y0, z);   // along x
+        glVertex3f(x, minimum[1], z);   glVertex3f(x, maximum[1], z);    // along y
+    }
+    glEnd();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -500,8 +1109,9 @@ void ModelGL::drawVR()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawSub1()
 {
-    setViewportSub(0, 0, windowWidth, windowHeight, 1, 30);
-    glClearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);
+    TRACE_ZONE("ModelGL::drawSub1");
+    setViewportSub(0, 0, windowWidth, windowHeight, DEBUG_NEAR_PLANE, DEBUG_FAR_PLANE);
+    stateCache.clearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     int x, y, w, h;
@@ -514,14 +1124,12 @@ void ModelGL::drawSub1()
         x = (povWidth - windowHeight) / 2; y = 0; w = windowHeight; h = windowHeight;
     }
 
-    glViewport(x, y, w, h);
-    glScissor(x, y, w, h);
+    stateCache.viewport(x, y, w, h);
+    stateCache.scissor(x, y, w, h);
 
 
-    f3d::FrustumData fd;//变换结果结构体
-    f3d::Matrix4 proj;
-    glGetFloatv(GL_PROJECTION_MATRIX, proj.m);//得到当前原来的老程序投影矩阵
-    fmModifyFrustum(&fd, (f3d::Matrix4*)&matrixView, &proj, -10, 10, 0.066, false);//屏幕坐标向前推移10，屏幕高度10
+    //变换结果结构体，投影矩阵和setViewportSub()里原来的老程序投影矩阵相同，在latchPose()里算好
+    const f3d::FrustumData& fd = latchedFrustum;
 
     glMatrixMode(GL_PROJECTION);
     glLoadMatrixf(fd.matProjectionL.m);//设置左眼的非标准投影
@@ -530,14 +1138,13 @@ void ModelGL::drawSub1()
     glLoadMatrixf(fd.matViewL.m);//设置左眼的GL_MODELVIEW，等于当前在世界空间，此时下面接画笔的射线代码
 
     //画笔的射线
-    glDisable(GL_LIGHTING);
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
     glColor3f(0.9f, 0.9f, 0.9f);
     glVertex3f(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);//笔尖坐标
     glColor3f(0.0f, 0.0f, 0.0f);
     glVertex3f(fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y, fd.penPosition.z + fd.penDirection.z);
     glEnd();
-    glEnable(GL_LIGHTING);
 
 
 
@@ -545,7 +1152,7 @@ void ModelGL::drawSub1()
     //glLoadIdentity();
 
     // clear buffer (square area)
-    glClearColor(0.2f, 0.2f, 0.2f, 1);
+    stateCache.clearColor(0.2f, 0.2f, 0.2f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     glPushMatrix();
@@ -566,14 +1173,15 @@ void ModelGL::drawSub1()
 
     drawScreen();
 
-    glDisable(GL_LIGHTING);
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
     glColor3f(0.9f, 0.9f, 0.9f);
     glVertex3f(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);
     glColor3f(0.0f, 0.0f, 0.0f);
     glVertex3f(fd.penPosition.x + fd.penDirection.x, fd.penPosition.y + fd.penDirection.y, fd.penPosition.z + fd.penDirection.z);
     glEnd();
-    glEnable(GL_LIGHTING);
+
+    drawStrokes();
 
     // transform objects ======================================================
     // From now, all transform will be for modeling matrix only.
@@ -600,19 +1208,10 @@ void ModelGL::drawSub1()
     drawAxis(4);
 
     if(glslReady)
-    {
-        // use GLSL
-        glUseProgram(progId2);
-        glDisable(GL_COLOR_MATERIAL);
-        drawTeapot();
-        glEnable(GL_COLOR_MATERIAL);
-        glUseProgram(0);
-    }
+        useDrawState(DRAW_MESH_SHADED, progId2);    // use GLSL
     else
-    {
-        // use fixed pipeline
-        drawTeapot();
-    }
+        useDrawState(DRAW_MESH);                    // use fixed pipeline
+    drawTeapot();
 
     glPopMatrix();
 }
@@ -624,6 +1223,7 @@ void ModelGL::drawSub1()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawSub2()
 {
+    TRACE_ZONE("ModelGL::drawSub2");
     // set right viewport
     setViewportSub(povWidth, 0, windowWidth-povWidth, windowHeight, NEAR_PLANE, FAR_PLANE);
 
@@ -636,9 +1236,9 @@ void ModelGL::drawSub2()
     //第三人称的相机控制
     Matrix4 matView, matModel, matModelView;
     matView.identity();
-    matView.rotateY(cameraAngleY);
-    matView.rotateX(cameraAngleX);
-    matView.translate(0, 0, -cameraDistance);
+    matView.rotateY(scene.cameraAngleY);
+    matView.rotateX(scene.cameraAngleX);
+    matView.translate(0, 0, -scene.cameraDistance);
     glLoadMatrixf(matView.get());
     // equivalent OpenGL calls
     //glTranslatef(0, 0, -cameraDistance);
@@ -652,10 +1252,10 @@ void ModelGL::drawSub2()
     drawPen();//画笔
 
     // transform teapot
-    matModel.rotateZ(modelAngle[2]);
-    matModel.rotateY(modelAngle[1]);
-    matModel.rotateX(modelAngle[0]);
-    matModel.translate(modelPosition[0], modelPosition[1], modelPosition[2]);
+    matModel.rotateZ(scene.modelAngle[2]);
+    matModel.rotateY(scene.modelAngle[1]);
+    matModel.rotateX(scene.modelAngle[0]);
+    matModel.translate(scene.modelPosition[0], scene.modelPosition[1], scene.modelPosition[2]);
     matModelView = matView * matModel;
     glLoadMatrixf(matModelView.get());
     // equivalent OpenGL calls
@@ -668,35 +1268,28 @@ void ModelGL::drawSub2()
     drawAxis(4);
 
     if(glslReady)
-    {
-        glUseProgram(progId2);
-        glDisable(GL_COLOR_MATERIAL);
-        drawTeapot();
-        glEnable(GL_COLOR_MATERIAL);
-        glUseProgram(0);
-    }
+        useDrawState(DRAW_MESH_SHADED, progId2);
     else
-    {
-        drawTeapot();
-    }
+        useDrawState(DRAW_MESH);
+    drawTeapot();
 
     // draw camera axis
     matModel.identity();
     matModel.rotateY(180);  // facing to -Z axis
-    matModel.rotateZ(-cameraAngle[2]);
-    matModel.rotateY(cameraAngle[1]);
-    matModel.rotateX(-cameraAngle[0]);
-    matModel.translate(cameraPosition[0], cameraPosition[1], cameraPosition[2]);
+    matModel.rotateZ(-scene.cameraAngle[2]);
+    matModel.rotateY(scene.cameraAngle[1]);
+    matModel.rotateX(-scene.cameraAngle[0]);
+    matModel.translate(scene.cameraPosition[0], scene.cameraPosition[1], scene.cameraPosition[2]);
     matModelView = matView * matModel;
     glLoadMatrixf(matModelView.get());
     drawAxis(0.75f);
 
     // transform camera object
     matModel.identity();
-    matModel.rotateZ(-cameraAngle[2]);
-    matModel.rotateY(cameraAngle[1]);
-    matModel.rotateX(-cameraAngle[0]);
-    matModel.translate(cameraPosition[0], cameraPosition[1], cameraPosition[2]);
+    matModel.rotateZ(-scene.cameraAngle[2]);
+    matModel.rotateY(scene.cameraAngle[1]);
+    matModel.rotateX(-scene.cameraAngle[0]);
+    matModel.translate(scene.cameraPosition[0], scene.cameraPosition[1], scene.cameraPosition[2]);
     matModelView = matView * matModel;
     glLoadMatrixf(matModelView.get());
     // equivalent OpenGL calls
@@ -706,12 +1299,78 @@ void ModelGL::drawSub2()
     //glRotatef(-cameraAngle[2], 0, 0, 1);
 
     // draw the camera
+    useDrawState(DRAW_MESH);
     drawCamera();
     drawFrustum(FOV_Y, 1, 1, 100);
 
     glPopMatrix();
 }
 
+///-------------------------------------------------------------------------------------------------
+/// <summary> 采样一次跟踪姿态，并用它计算双眼矩阵和笔的射线. </summary>
+///
+/// <remarks>
+/// Called once per frame as late as possible, after the scene matrices are
+/// updated and right before anything is drawn. The pose is the newest one
+/// published by the tracking thread, reading it never waits for FSCore.
+/// The eye matrices and the pen ray are a pure function of latchedPose, the
+/// view and the projection (StereoFrustum), FSCore is not read again.
+/// The projection is the same as setViewportSub() of drawVR() or drawSub1().
+/// </remarks>
+///-------------------------------------------------------------------------------------------------
+void ModelGL::latchPose()
+{
+    TRACE_ZONE("ModelGL::latchPose");
+    // the tracker is slower than the render loop, the predictor extrapolates
+    // from its newest tracker sample to the time this frame will be displayed
+    TrackingPose sample;
+    if (tracking.isRunning())
+    {
+        tracking.getPose(sample);//跟踪线程发布的最新姿态，fmSetActiveUser()也由它定时调用
+        if (sample.sequence != latchedPose.sequence)
+            TRACE_FLOW_END("pose", sample.sequence);    // from TrackingThread::samplePose()
+    }
+    else
+        sample = sampleTrackingPose(++latchSequence);
+    predictor.addSample(sample);
+    latchedPose = predictor.predict(sample.timestamp + predictionLookAhead);
+    latchedPose.glassStatus = sample.glassStatus;
+    latchedPose.penRoll = sample.penRoll;
+    latchedPose.penKey = sample.penKey;
+    latchedPose.penStatus = sample.penStatus;
+    latchedPose.slantAngle = sample.slantAngle;
+    latchedPose.isSleep = sample.isSleep;
+    latchedPose.timestamp = sample.timestamp;
+    latchedPose.sequence = sample.sequence;
+
+    float aspectRatio = windowHeight > 0 ? (float)windowWidth / windowHeight : 1.0f;
+    Matrix4 projection;
+    if (scene.vrMode)
+    {
+        projection = setFrustum(FOV_Y, aspectRatio, NEAR_PLANE, FAR_PLANE);
+        latchedFrustum = frustumCacheVR.get(matrixView, projection, -10, 10, 0.066f, false, latchedPose);//屏幕坐标向前推移10，屏幕高度10
+    }
+    else
+    {
+        projection = setFrustum(FOV_Y, aspectRatio, DEBUG_NEAR_PLANE, DEBUG_FAR_PLANE);
+        latchedFrustum = frustumCacheDebug.get(matrixView, projection, -10, 10, 0.066f, false, latchedPose);
+    }
+
+    // the nib in world space, same as the pen ray
+    hoveredStroke = -1;
+    if (latchedPose.penStatus)
+    {
+        const f3d::FrustumData& fd = latchedFrustum;
+        Vector3 nib(fd.penPosition.x, fd.penPosition.y, fd.penPosition.z);
+        if (strokes.isStroking())
+            strokes.addPoint(nib, Vector3(fd.penDirection.x, fd.penDirection.y, fd.penDirection.z));
+        else if (penKeysDown & ERASE_KEY)
+            strokes.eraseStrokes(nib, PICK_RADIUS);
+        else
+            hoveredStroke = strokes.pickStroke(nib, PICK_RADIUS);
+    }
+}
+
 ///-------------------------------------------------------------------------------------------------
 /// <summary> 设置3d的VR相机的坐标. </summary>
 ///
@@ -719,16 +1378,18 @@ void ModelGL::drawSub2()
 ///-------------------------------------------------------------------------------------------------
 void ModelGL::setVRCamera()
 {
-    f3d::Vector3 pos = fmGetGlassPosition();//眼镜是非标准投影，只需要坐标即可
+    f3d::Vector3 pos = latchedPose.glassPosition;//眼镜是非标准投影，只需要坐标即可
     //调整坐标系
     //pos.z = -pos.z;//z轴反过来
     //
     Vector3 v3Pos(pos.x, pos.y, pos.z);//换成这个V3好计算
     v3Pos = v3Pos * k;//整个坐标系放大30倍
 
-    setCameraX(v3Pos.x);
-    setCameraY(v3Pos.y);
-    setCameraZ(v3Pos.z);
+    // rendering thread, so it changes the scene directly
+    scene.cameraPosition[0] = v3Pos.x;
+    scene.cameraPosition[1] = v3Pos.y;
+    scene.cameraPosition[2] = v3Pos.z;
+    invalidateView();
 
     //这里就设置了View矩阵
 }
@@ -740,8 +1401,8 @@ void ModelGL::setVRCamera()
 ///-------------------------------------------------------------------------------------------------
 void ModelGL::drawPen()
 {
-    f3d::Vector3 pos = fmGetPenPosition();
-    f3d::Vector3 dir = fmGetPenDirection();
+    f3d::Vector3 pos = latchedPose.penPosition;//和眼睛用同一帧的姿态
+    f3d::Vector3 dir = latchedPose.penDirection;
 
     //调整坐标系
     pos.z = -pos.z;//z轴反过来
@@ -753,27 +1414,38 @@ void ModelGL::drawPen()
     v3Pos = v3Pos * k;//整个坐标系放大30倍
     v3Dir = v3Dir * k;
 
-    // disable lighting
-    glDisable(GL_LIGHTING);
-
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
 
-    glColor3f(0.9f, 0.9f, 0.9f);
+    if (penKeysDown)
+        glColor3f(0.9f, 0.9f, 0.1f);//按下按键时笔是黄色
+    else if (hoveredStroke >= 0)
+        glColor3f(0.1f, 0.9f, 0.9f);//笔尖靠近笔迹时是青色
+    else
+        glColor3f(0.9f, 0.9f, 0.9f);
     glVertex3f(v3Pos.x, v3Pos.y, v3Pos.z);
     glVertex3f(v3Pos.x + v3Dir.x, v3Pos.y + v3Dir.y, v3Pos.z + v3Dir.z);
 
     glEnd();
+}
 
-    // enable lighting back
-    glEnable(GL_LIGHTING);
+///-------------------------------------------------------------------------------------------------
+/// <summary> 画笔迹. </summary>
+///
+/// <remarks>
+/// The vertices are in the world space of the pen ray, so the modelview
+/// matrix must hold the view matrix only. Ribbons are seen from both sides.
+/// </remarks>
+///-------------------------------------------------------------------------------------------------
+void ModelGL::drawStrokes()
+{
+    useDrawState(DRAW_STROKES);
+    strokeRenderer.draw(strokes);
 }
 
 void ModelGL::drawScreen()
 {
-
-    // disable lighting
-    glDisable(GL_LIGHTING);
-
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
 
     glColor3f(0.9f, 0.1f, 0.1f);
@@ -791,20 +1463,41 @@ void ModelGL::drawScreen()
     glVertex3f(-0.27f*k, 0.15f*k, 0);
 
     glEnd();
+}
 
-    // enable lighting back
-    glEnable(GL_LIGHTING);
-
+///////////////////////////////////////////////////////////////////////////////
+// set the GL states declared for a kind of draw, see DRAW_STATES
+// Every draw calls it first with the program it uses, 0 for fixed function.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::useDrawState(int state, GLuint program)
+{
+    const DrawState& s = DRAW_STATES[state];
+    if(s.lighting)      stateCache.enable(GL_LIGHTING);
+    else                stateCache.disable(GL_LIGHTING);
+    if(s.colorMaterial) stateCache.enable(GL_COLOR_MATERIAL);
+    else                stateCache.disable(GL_COLOR_MATERIAL);
+    if(s.cullFace && scene.drawMode == 0) stateCache.enable(GL_CULL_FACE);
+    else                stateCache.disable(GL_CULL_FACE);
+    if(s.depthTest)     stateCache.enable(GL_DEPTH_TEST);
+    else                stateCache.disable(GL_DEPTH_TEST);
+    if(s.blend)         stateCache.enable(GL_BLEND);
+    else                stateCache.disable(GL_BLEND);
+    if(s.texture)       stateCache.enable(GL_TEXTURE_2D);
+    else                stateCache.disable(GL_TEXTURE_2D);
+    stateCache.depthFunc(s.depthFunc);
+    stateCache.lineWidth(s.lineWidth);
+    stateCache.pointSize(s.pointSize);
+    stateCache.useProgram(program);
 }
 
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // draw a grid on the xz plane
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawGrid(float size, float step)
 {
-    // disable lighting
-    glDisable(GL_LIGHTING);
-
+    useDrawState(DRAW_LINES);
     glBegin(GL_LINES);
 
     glColor3f(0.3f, 0.3f, 0.3f);
@@ -832,9 +1525,6 @@ void ModelGL::drawGrid(float size, float step)
     glVertex3f(0, 0,  size);
 
     glEnd();
-
-    // enable lighting back
-    glEnable(GL_LIGHTING);
 }
 
 
@@ -844,14 +1534,12 @@ void ModelGL::drawGrid(float size, float step)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawAxis(float size)
 {
-    glDepthFunc(GL_ALWAYS);     // to avoid visual artifacts with grid lines
-    glDisable(GL_LIGHTING);
+    useDrawState(DRAW_AXIS);    // wide lines and points over the grid lines
     glPushMatrix();             //NOTE: There is a bug on Mac misbehaviours of
                                 //      the light position when you draw GL_LINES
                                 //      and GL_POINTS. remember the matrix.
 
     // draw axis
-    glLineWidth(3);
     glBegin(GL_LINES);
         glColor3f(1, 0, 0);
         glVertex3f(0, 0, 0);
@@ -863,10 +1551,8 @@ void ModelGL::drawAxis(float size)
         glVertex3f(0, 0, 0);
         glVertex3f(0, 0, size);
     glEnd();
-    glLineWidth(1);
 
     // draw arrows(actually big square dots)
-    glPointSize(5);
     glBegin(GL_POINTS);
         glColor3f(1, 0, 0);
         glVertex3f(size, 0, 0);
@@ -875,12 +1561,8 @@ void ModelGL::drawAxis(float size)
         glColor3f(0, 0, 1);
         glVertex3f(0, 0, size);
     glEnd();
-    glPointSize(1);
 
-    // restore default settings
     glPopMatrix();
-    glEnable(GL_LIGHTING);
-    glDepthFunc(GL_LEQUAL);
 }
 
 
@@ -919,9 +1601,7 @@ void ModelGL::drawFrustum(float fovY, float aspectRatio, float nearPlane, float
     float colorLine2[4] = { 0.2f, 0.2f, 0.2f, 0.7f };
     float colorPlane[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
 
-    glDisable(GL_LIGHTING);
-    glDisable(GL_CULL_FACE);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    useDrawState(DRAW_FRUSTUM);
 
     // draw the edges around frustum
     glBegin(GL_LINES);
@@ -974,9 +1654,6 @@ void ModelGL::drawFrustum(float fovY, float aspectRatio, float nearPlane, float
     glVertex3fv(vertices[6]);
     glVertex3fv(vertices[7]);
     glEnd();
-
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_LIGHTING);
 }
 
 
@@ -986,14 +1663,7 @@ void ModelGL::drawFrustum(float fovY, float aspectRatio, float nearPlane, float
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setViewMatrix(float x, float y, float z, float pitch, float heading, float roll)
 {
-    cameraPosition[0] = x;
-    cameraPosition[1] = y;
-    cameraPosition[2] = z;
-    cameraAngle[0] = pitch;
-    cameraAngle[1] = heading;
-    cameraAngle[2] = roll;
-
-    updateViewMatrix();
+    postCommand(SceneCommand::VIEW_MATRIX, 0, x, y, z, pitch, heading, roll);
 }
 
 
@@ -1003,65 +1673,192 @@ void ModelGL::setViewMatrix(float x, float y, float z, float pitch, float headin
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setModelMatrix(float x, float y, float z, float rx, float ry, float rz)
 {
-    modelPosition[0] = x;
-    modelPosition[1] = y;
-    modelPosition[2] = z;
-    modelAngle[0] = rx;
-    modelAngle[1] = ry;
-    modelAngle[2] = rz;
+    postCommand(SceneCommand::MODEL_MATRIX, 0, x, y, z, rx, ry, rz);
+}
+
 
-    updateModelMatrix();
+
+///////////////////////////////////////////////////////////////////////////////
+// apply a command to the UI copy of the scene and send it to the rendering
+// thread, call it from the UI thread only
+// The queue is drained every frame, it is full only if the rendering thread
+// stalls. Then wait, a dropped command would make the 2 copies differ.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::postCommand(int type, int index, float v0, float v1, float v2, float v3, float v4, float v5)
+{
+    SceneCommand command = { type, index, { v0, v1, v2, v3, v4, v5 } };
+    uiScene.apply(command);
+    ++postedCommands;
+
+    // the queue is full, the rendering thread is stalled or far behind: do not
+    // wait for it, send the whole state instead, and keep sending it until the
+    // rendering thread took it, so no command can be queued after a newer state
+    if (resyncRequested.load(std::memory_order_acquire))
+    {
+        postResync();
+    }
+    else if (!commands.push(command))
+    {
+        ++sceneResyncs;
+        postResync();
+    }
 }
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// update matrix，当改变了相机状态的时候就会进入这个函数来重新设置矩阵。
+// publish a copy of uiScene with the commands it includes, UI thread
 ///////////////////////////////////////////////////////////////////////////////
-void ModelGL::updateViewMatrix()
+void ModelGL::postResync()
 {
-    // transform the camera (viewing matrix) from world space to eye space
-    // Notice translation nd heading values are negated,
-    // because we move the whole scene with the inverse of camera transform
-    // ORDER: translation -> rotZ -> rotY ->rotX
-    matrixView.identity();
-    matrixView.translate(-cameraPosition[0], -cameraPosition[1], -cameraPosition[2]);
-    matrixView.rotateZ(cameraAngle[2]);     // roll
-    matrixView.rotateY(-cameraAngle[1]);    // heading
-    matrixView.rotateX(cameraAngle[0]);     // pitch
+    SceneResync& back = resync.getBack();
+    back.scene = uiScene;
+    back.postedCommands = postedCommands;
+    resync.publish();
+    resyncRequested.store(true, std::memory_order_release);
+}
 
-    matrixModelView = matrixView * matrixModel;
 
-    //左眼就是相机坐标减去瞳距的一半,瞳距是6.6cm
-    matrixViewL.identity();
-    matrixViewL.translate(-(cameraPosition[0] - 0.066 / 2 * k), -cameraPosition[1], -cameraPosition[2]);
-    matrixViewL.rotateZ(cameraAngle[2]);     // roll
-    matrixViewL.rotateY(-cameraAngle[1]);    // heading
-    matrixView.rotateX(cameraAngle[0]);     // pitch
 
+///////////////////////////////////////////////////////////////////////////////
+// apply the commands posted since the last frame, rendering thread
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::applyCommands()
+{
+    SceneCommand command;
+    uint32_t applied = 0;
+    while (commands.pop(command))
+    {
+        ++applied;
+        int changes = scene.apply(command);
+        if (changes & SceneState::CHANGED_VIEW)
+            invalidateView();
+        if (changes & SceneState::CHANGED_MODEL)
+            invalidateModel();
+        if (changes & SceneState::CHANGED_DRAW_MODE)
+            drawModeChanged = true;
+        if ((changes & SceneState::CHANGED_STROKE_CAPTURE) && !scene.strokeCapture)
+            strokes.endStroke();
+        if (changes & SceneState::CHANGED_CLEAR_STROKES)
+            strokes.clear();
+    }
+    applied += appliedCommands.load(std::memory_order_relaxed);
+
+    // the whole UI state, newer than every command of the queue
+    if (resyncRequested.exchange(false, std::memory_order_acq_rel))
+    {
+        resync.update();
+        const SceneResync& latest = resync.getFront();
+        int width = scene.windowWidth;      // the UI copy keeps no size
+        int height = scene.windowHeight;
+        bool cleared = latest.scene.strokeClears != scene.strokeClears;
+        scene = latest.scene;
+        scene.windowWidth = width;
+        scene.windowHeight = height;
+
+        invalidateView();
+        invalidateModel();
+        drawModeChanged = true;
+        if (!scene.strokeCapture)
+            strokes.endStroke();
+        if (cleared)
+            strokes.clear();
+        applied = latest.postedCommands;
+    }
+    appliedCommands.store(applied, std::memory_order_release);
+
+    // the latest window size, see setWindowSize()
+    uint64_t request = windowSizeRequest.fetch_and(~WINDOW_SIZE_REQUESTED, std::memory_order_acquire);
+    if (request & WINDOW_SIZE_REQUESTED)
+    {
+        int width = (int)((request >> 32) & 0x7fffffff);
+        int height = (int)(request & 0xffffffff);
+        SceneCommand command = { SceneCommand::WINDOW_SIZE, 0, { (float)width, (float)height } };
+        scene.apply(command);
+        updateWindowSize();
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// follow the pen keys with the events of the tracking thread, rendering thread
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::applyTrackingEvents()
+{
+    TrackingEvent event;
+    while (tracking.popEvent(TrackingEvents::CONSUMER_RENDER, event))
+    {
+        if (event.type == TrackingEvent::KEY_PRESS)
+            penKeysDown |= event.key;
+        else if (event.type == TrackingEvent::KEY_RELEASE)
+            penKeysDown &= ~event.key;
+        else if (event.type == TrackingEvent::PEN_DISCONNECT)
+            penKeysDown = 0;
+
+        // a stroke lasts as long as the stroke key is down
+        if ((penKeysDown & STROKE_KEY) && !strokes.isStroking() && scene.strokeCapture)
+        {
+            const unsigned char* color = STROKE_COLORS[strokes.getStrokeCount() % STROKE_COLOR_COUNT];
+            strokes.beginStroke(color[0], color[1], color[2]);
+        }
+        else if (!(penKeysDown & STROKE_KEY) && strokes.isStroking())
+        {
+            strokes.endStroke();
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// rebuild the matrices marked dirty by the setters
+// Many setter calls between 2 frames end up in a single rebuild here.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::updateMatrices()
+{
+    if(!viewDirty && !modelDirty)
+        return;
+
+    if(viewDirty)
+    {
+        updateViewMatrix();
+        ++matrixRebuilds;
+    }
+    if(modelDirty)
+    {
+        updateModelMatrix();
+        ++matrixRebuilds;
+    }
+    viewDirty = modelDirty = false;
+
+    matrixModelView = matrixView * matrixModel;
     matrixModelViewL = matrixViewL * matrixModel;
+    matrixModelViewR = matrixViewR * matrixModel;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// update matrix，当改变了相机状态的时候就会进入这个函数来重新设置矩阵。
+// model-view products are computed in updateMatrices()
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::updateViewMatrix()
+{
+    // transform the camera (viewing matrix) from world space to eye space
+    matrixView = scene.getViewMatrix();
 
     //左眼就是相机坐标减去瞳距的一半,瞳距是6.6cm
-    matrixViewR.identity();
-    matrixViewR.translate(-(cameraPosition[0] + 0.066 / 2 * k), -cameraPosition[1], -cameraPosition[2]);
-    matrixViewR.rotateZ(cameraAngle[2]);     // roll
-    matrixViewR.rotateY(-cameraAngle[1]);    // heading
-    matrixViewR.rotateX(cameraAngle[0]);     // pitch
+    matrixViewL = scene.getViewMatrix(-0.066f / 2 * k);
 
-    matrixModelViewR = matrixViewR * matrixModel;
+    //右眼就是相机坐标加上瞳距的一半,瞳距是6.6cm
+    matrixViewR = scene.getViewMatrix(0.066f / 2 * k);
 }
 
 void ModelGL::updateModelMatrix()
 {
     // transform objects from object space to world space
-    // ORDER: rotZ -> rotY -> rotX -> translation
-    matrixModel.identity();
-    matrixModel.rotateZ(modelAngle[2]);
-    matrixModel.rotateY(modelAngle[1]);
-    matrixModel.rotateX(modelAngle[0]);
-    matrixModel.translate(modelPosition[0], modelPosition[1], modelPosition[2]);
-
-    matrixModelView = matrixView * matrixModel;
+    matrixModel = scene.getModelMatrix();
 }
 
 
@@ -1071,10 +1868,7 @@ void ModelGL::updateModelMatrix()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::rotateCamera(int x, int y)
 {
-    cameraAngleY += (x - mouseX);
-    cameraAngleX += (y - mouseY);
-    mouseX = x;
-    mouseY = y;
+    postCommand(SceneCommand::ROTATE_CAMERA, 0, (float)x, (float)y);
 }
 
 
@@ -1084,12 +1878,11 @@ void ModelGL::rotateCamera(int x, int y)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::zoomCamera(int y)
 {
-    cameraDistance -= (y - mouseY) * 0.1f;
-    mouseY = y;
+    postCommand(SceneCommand::ZOOM_CAMERA, 0, (float)y);
 }
 void ModelGL::zoomCameraDelta(float delta)
 {
-    cameraDistance -= delta;
+    postCommand(SceneCommand::ZOOM_CAMERA_DELTA, 0, delta);
 }
 
 
@@ -1099,11 +1892,7 @@ void ModelGL::zoomCameraDelta(float delta)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setDrawMode(int mode)
 {
-    if(drawMode != mode)
-    {
-        drawModeChanged = true;
-        drawMode = mode;
-    }
+    postCommand(SceneCommand::DRAW_MODE, 0, (float)mode);
 }
 
 
@@ -1219,14 +2008,124 @@ bool ModelGL::createShaderPrograms()
     }
     else
     {
-        std::cout << "=== GLSL LOG 1 ===\n" << getProgramStatus(progId1) << std::endl;
-        std::cout << "=== GLSL LOG 2 ===\n" << getProgramStatus(progId2) << std::endl;
+        LOG_ERROR(GL, "Failed to link GLSL program 1: %s", getProgramStatus(progId1));
+        LOG_ERROR(GL, "Failed to link GLSL program 2: %s", getProgramStatus(progId2));
         return false;
     }
 }
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// create glsl programs and uniform buffer for instanced single-pass stereo
+// The vertex shaders share vsStereoHeader, and the fragment shaders are the
+// same as progId1 and progId2 with "#version 130" in front.
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::createStereoPrograms()
+{
+    const char* vsSources1[] = { vsStereoHeader, vsStereo1 };
+    const char* fsSources1[] = { fsStereoHeader, fsSource1 };
+    const char* vsSources2[] = { vsStereoHeader, vsStereo2 };
+    const char* fsSources2[] = { fsStereoHeader, fsSource2 };
+
+    // create 1st shader and program: flat shader
+    GLuint vsId1 = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fsId1 = glCreateShader(GL_FRAGMENT_SHADER);
+    progIdStereo1 = glCreateProgram();
+    glShaderSource(vsId1, 2, vsSources1, 0);
+    glShaderSource(fsId1, 2, fsSources1, 0);
+    glCompileShader(vsId1);
+    glCompileShader(fsId1);
+    glAttachShader(progIdStereo1, vsId1);
+    glAttachShader(progIdStereo1, fsId1);
+    glLinkProgram(progIdStereo1);
+
+    // create 2nd shader and program: blinn specular shader
+    GLuint vsId2 = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fsId2 = glCreateShader(GL_FRAGMENT_SHADER);
+    progIdStereo2 = glCreateProgram();
+    glShaderSource(vsId2, 2, vsSources2, 0);
+    glShaderSource(fsId2, 2, fsSources2, 0);
+    glCompileShader(vsId2);
+    glCompileShader(fsId2);
+    glAttachShader(progIdStereo2, vsId2);
+    glAttachShader(progIdStereo2, fsId2);
+    glLinkProgram(progIdStereo2);
+
+    // check status
+    GLint linkStatus1, linkStatus2;
+    glGetProgramiv(progIdStereo1, GL_LINK_STATUS, &linkStatus1);
+    glGetProgramiv(progIdStereo2, GL_LINK_STATUS, &linkStatus2);
+    if(linkStatus1 != GL_TRUE || linkStatus2 != GL_TRUE)
+    {
+        LOG_ERROR(GL, "Failed to link GLSL stereo program 1: %s", getProgramStatus(progIdStereo1));
+        LOG_ERROR(GL, "Failed to link GLSL stereo program 2: %s", getProgramStatus(progIdStereo2));
+        return false;
+    }
+
+    // both programs read the matrices from binding point 0
+    GLuint blockIndex1 = glGetUniformBlockIndex(progIdStereo1, "StereoMatrices");
+    GLuint blockIndex2 = glGetUniformBlockIndex(progIdStereo2, "StereoMatrices");
+    if(blockIndex1 == GL_INVALID_INDEX || blockIndex2 == GL_INVALID_INDEX)
+    {
+        LOG_ERROR(GL, "No StereoMatrices uniform block in the GLSL stereo programs.");
+        return false;
+    }
+    glUniformBlockBinding(progIdStereo1, blockIndex1, 0);
+    glUniformBlockBinding(progIdStereo2, blockIndex2, 0);
+
+    // 4 matrices: view L/R, projection L/R
+    glGenBuffersARB(1, &uboStereo);
+    glBindBufferARB(GL_UNIFORM_BUFFER, uboStereo);
+    glBufferDataARB(GL_UNIFORM_BUFFER, sizeof(float) * 64, 0, GL_DYNAMIC_DRAW_ARB);
+    glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, uboStereo);
+
+    buildStereoLines();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build the lines of drawScreen() and drawGrid(10, 1) for drawVRInstanced()
+// They never change, so they are built once and drawn with a single call.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::buildStereoLines()
+{
+    const float size = 10;
+    const float step = 1;
+    const float w = 0.27f * k;
+    const float h = 0.15f * k;
+
+    stereoLines.clear();
+
+    // screen rectangle
+    const float screen[8][2] = { {-w, h}, {w, h}, {w, h}, {w, -h}, {w, -h}, {-w, -h}, {-w, -h}, {-w, h} };
+    for(int i = 0; i < 8; ++i)
+    {
+        const float v[6] = { screen[i][0], screen[i][1], 0, 0.9f, 0.1f, 0.1f };
+        stereoLines.insert(stereoLines.end(), v, v + 6);
+    }
+
+    // grid on xz plane
+    for(float i = step; i <= size; i += step)
+    {
+        const float v[48] = { -size, 0,  i, 0.3f, 0.3f, 0.3f,    size, 0,  i, 0.3f, 0.3f, 0.3f,
+                              -size, 0, -i, 0.3f, 0.3f, 0.3f,    size, 0, -i, 0.3f, 0.3f, 0.3f,
+                               i, 0, -size, 0.3f, 0.3f, 0.3f,    i, 0,  size, 0.3f, 0.3f, 0.3f,
+                              -i, 0, -size, 0.3f, 0.3f, 0.3f,   -i, 0,  size, 0.3f, 0.3f, 0.3f };
+        stereoLines.insert(stereoLines.end(), v, v + 48);
+    }
+
+    // x-axis and z-axis
+    const float axis[24] = { -size, 0, 0, 0.5f, 0, 0,    size, 0, 0, 0.5f, 0, 0,
+                             0, 0, -size, 0, 0, 0.5f,    0, 0,  size, 0, 0, 0.5f };
+    stereoLines.insert(stereoLines.end(), axis, axis + 24);
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // return error message of shader compile status
 // if no errors, it returns empty string
@@ -22,10 +22,27 @@
 #include <GL/gl.h>
 #endif
 
+#include <atomic>
 #include <string>
+#include <vector>
 #include "../Math/Matrices.h"
 #include "../GL/glext.h"
 #include "../GL/glExtension.h"
+#include "../GL/glStateCache.h"
+#include "../Common/MpscQueue.h"
+#include "../FCore/FSCore.h"
+#include "MultiViewPlanner.h"
+#include "SceneState.h"
+#include "StereoFrustum.h"
+#include "StereoFrustumCache.h"
+#include "StereoReprojector.h"
+#include "StrokePool.h"
+#include "StrokeRenderer.h"
+#include "../Tracking/PoseClient.h"
+#include "../Tracking/TrackingPose.h"
+#include "../Tracking/PosePredictor.h"
+#include "../Tracking/TrackingThread.h"
+#include "../Tracking/TripleBuffer.h"
 
 class ModelGL
 {
@@ -38,44 +55,61 @@ public:
     void quit();                                    // clean up OpenGL objects
     void setCamera(float posX, float posY, float posZ, float targetX, float targetY, float targetZ);
     void draw();
+    void drawReprojected();                         // present the last VR frame warped to a new pose
 
-    void setMousePosition(int x, int y) { mouseX = x; mouseY = y; };
+    // scene setters are for the UI thread, the change is drawn from the next frame
+    void setMousePosition(int x, int y) { postCommand(SceneCommand::MOUSE_POSITION, 0, (float)x, (float)y); }
     void setDrawMode(int mode);
     void setWindowSize(int width, int height);
     void setViewMatrix(float x, float y, float z, float pitch, float heading, float roll);
     void setModelMatrix(float x, float y, float z, float rx, float ry, float rz);
 
-    void setCameraX(float x)        { cameraPosition[0] = x; updateViewMatrix(); }
-    void setCameraY(float y)        { cameraPosition[1] = y; updateViewMatrix(); }
-    void setCameraZ(float z)        { cameraPosition[2] = z; updateViewMatrix(); }
-    void setCameraAngleX(float p)   { cameraAngle[0] = p; updateViewMatrix(); }
-    void setCameraAngleY(float h)   { cameraAngle[1] = h; updateViewMatrix(); }
-    void setCameraAngleZ(float r)   { cameraAngle[2] = r; updateViewMatrix(); }
-    float getCameraX()              { return cameraPosition[0]; }
-    float getCameraY()              { return cameraPosition[1]; }
-    float getCameraZ()              { return cameraPosition[2]; }
-    float getCameraAngleX()         { return cameraAngle[0]; }
-    float getCameraAngleY()         { return cameraAngle[1]; }
-    float getCameraAngleZ()         { return cameraAngle[2]; }
-
-    void setModelX(float x)         { modelPosition[0] = x; updateModelMatrix(); }
-    void setModelY(float y)         { modelPosition[1] = y; updateModelMatrix(); }
-    void setModelZ(float z)         { modelPosition[2] = z; updateModelMatrix(); }
-    void setModelAngleX(float a)    { modelAngle[0] = a; updateModelMatrix(); }
-    void setModelAngleY(float a)    { modelAngle[1] = a; updateModelMatrix(); }
-    void setModelAngleZ(float a)    { modelAngle[2] = a; updateModelMatrix(); }
-    float getModelX()               { return modelPosition[0]; }
-    float getModelY()               { return modelPosition[1]; }
-    float getModelZ()               { return modelPosition[2]; }
-    float getModelAngleX()          { return modelAngle[0]; }
-    float getModelAngleY()          { return modelAngle[1]; }
-    float getModelAngleZ()          { return modelAngle[2]; }
-
-    // return 16 elements of  target matrix
-    const float* getViewMatrixElements()        { return matrixView.get(); }
-    const float* getModelMatrixElements()       { return matrixModel.get(); }
-    const float* getModelViewMatrixElements()   { return matrixModelView.get(); }
-    const float* getProjectionMatrixElements()  { return matrixProjection.get(); }
+    // the rendering thread applies them to its own copy and rebuilds the matrices once at draw()
+    // getters return the UI copy, which already has all changes posted by the UI
+    void setCameraX(float x)        { postCommand(SceneCommand::CAMERA_POSITION, 0, x); }
+    void setCameraY(float y)        { postCommand(SceneCommand::CAMERA_POSITION, 1, y); }
+    void setCameraZ(float z)        { postCommand(SceneCommand::CAMERA_POSITION, 2, z); }
+    void setCameraAngleX(float p)   { postCommand(SceneCommand::CAMERA_ANGLE, 0, p); }
+    void setCameraAngleY(float h)   { postCommand(SceneCommand::CAMERA_ANGLE, 1, h); }
+    void setCameraAngleZ(float r)   { postCommand(SceneCommand::CAMERA_ANGLE, 2, r); }
+    float getCameraX()              { return uiScene.cameraPosition[0]; }
+    float getCameraY()              { return uiScene.cameraPosition[1]; }
+    float getCameraZ()              { return uiScene.cameraPosition[2]; }
+    float getCameraAngleX()         { return uiScene.cameraAngle[0]; }
+    float getCameraAngleY()         { return uiScene.cameraAngle[1]; }
+    float getCameraAngleZ()         { return uiScene.cameraAngle[2]; }
+
+    void setModelX(float x)         { postCommand(SceneCommand::MODEL_POSITION, 0, x); }
+    void setModelY(float y)         { postCommand(SceneCommand::MODEL_POSITION, 1, y); }
+    void setModelZ(float z)         { postCommand(SceneCommand::MODEL_POSITION, 2, z); }
+    void setModelAngleX(float a)    { postCommand(SceneCommand::MODEL_ANGLE, 0, a); }
+    void setModelAngleY(float a)    { postCommand(SceneCommand::MODEL_ANGLE, 1, a); }
+    void setModelAngleZ(float a)    { postCommand(SceneCommand::MODEL_ANGLE, 2, a); }
+    float getModelX()               { return uiScene.modelPosition[0]; }
+    float getModelY()               { return uiScene.modelPosition[1]; }
+    float getModelZ()               { return uiScene.modelPosition[2]; }
+    float getModelAngleX()          { return uiScene.modelAngle[0]; }
+    float getModelAngleY()          { return uiScene.modelAngle[1]; }
+    float getModelAngleZ()          { return uiScene.modelAngle[2]; }
+
+    void setVRMode(bool flag)       { postCommand(SceneCommand::VR_MODE, 0, flag ? 1.0f : 0.0f); }
+    bool getVRMode()                { return uiScene.vrMode; }
+
+    // 3D strokes drawn with the pen while its 1st key is down, erased with its 2nd key, see StrokePool
+    void setStrokeCapture(bool flag) { postCommand(SceneCommand::STROKE_CAPTURE, 0, flag ? 1.0f : 0.0f); }
+    bool getStrokeCapture()         { return uiScene.strokeCapture; }
+    void clearStrokes()             { postCommand(SceneCommand::CLEAR_STROKES, 0); }
+
+    // number of posted commands not yet applied by the rendering thread
+    int getPendingCommands() const  { return (int)(postedCommands - appliedCommands.load(std::memory_order_acquire)); }
+    int getSceneResyncs() const     { return sceneResyncs; }   // times the queue was full, the whole state was sent instead
+
+    // return 16 elements of  target matrix, computed from the UI copy
+    // the projection is the one of VR frames at the latest window size
+    const float* getViewMatrixElements()        { uiMatrixView = uiScene.getViewMatrix(); return uiMatrixView.get(); }
+    const float* getModelMatrixElements()       { uiMatrixModel = uiScene.getModelMatrix(); return uiMatrixModel.get(); }
+    const float* getModelViewMatrixElements()   { uiMatrixModelView = uiScene.getViewMatrix() * uiScene.getModelMatrix(); return uiMatrixModelView.get(); }
+    const float* getProjectionMatrixElements();
 
     void rotateCamera(int x, int y);
     void zoomCamera(int dist);
@@ -83,6 +117,92 @@ public:
 
     bool isShaderSupported() { return glslSupported; }
 
+    // single-pass stereo: draw both eyes with one instanced call per mesh
+    bool isStereoInstancedSupported()       { return stereoInstancedReady; }
+    void setStereoInstanced(bool flag)      { stereoInstanced = flag; }
+    bool getStereoInstanced()               { return stereoInstanced; }
+
+    // state calls issued to GL and filtered by the state cache in the previous frame
+    int getStateCallsIssued() const         { return stateCache.getLastFrameIssued(); }
+    int getStateCallsFiltered() const       { return stateCache.getLastFrameFiltered(); }
+    float getStateCallsFilteredRatio() const { return stateCache.getLastFrameFilteredRatio(); }
+
+    // reprojection of missed VR frames, every VR frame is read back while it is enabled
+    void setReprojection(bool flag)         { reprojectionEnabled = flag; reprojector.invalidateSource(); }
+    bool getReprojection() const            { return reprojectionEnabled; }
+    bool isReprojectionReady() const        { return reprojectionEnabled && scene.vrMode && reprojector.isSourceReady(); }
+    double getReprojectionTime() const      { return reprojector.getLastWarpTime(); }
+    double getReprojectionTimePerMegapixel() const { return reprojector.getWarpTimePerMegapixel(); }
+
+    // predict the latched pose forward by look-ahead (microseconds), METHOD_NONE by default
+    void setPosePrediction(PosePredictor::Method method) { predictor.setMethod(method); }
+    PosePredictor::Method getPosePrediction() const { return predictor.getMethod(); }
+    void setPredictionLookAhead(int64_t time) { predictionLookAhead = time > 0 ? time : 0; }
+    int64_t getPredictionLookAhead() const  { return predictionLookAhead; }
+
+    // One-Euro jitter filter on the tracking thread, off by default
+    // channel is OneEuroFilter::CHANNEL_*, the latency is the lag it adds in second
+    void setPoseFilter(bool flag)           { tracking.setFilterEnabled(flag); }
+    bool getPoseFilter()                    { return tracking.isFilterEnabled(); }
+    void setPoseFilterParams(int channel, float minCutoff, float beta, float derivativeCutoff);
+    OneEuroFilter::Params getPoseFilterParams(int channel) { return tracking.getFilterParams(channel); }
+    float getPoseFilterLatency(int channel) const { return tracking.getFilterLatency(channel); }
+
+    // record every tracking pose to a file, or feed the tracking thread from a
+    // recording instead of FSCore; time of seekReplay() is the recorded timestamp
+    bool startRecording(const char* fileName);
+    void stopRecording();
+    bool isRecording() const                { return recorder.isOpen(); }
+    bool startReplay(const char* fileName, double speed = 1);
+    void stopReplay();
+    bool isReplaying() const                { return replay.isOpen(); }
+    bool isReplayFinished() const           { return replay.isFinished(); }
+    void setReplaySpeed(double speed)       { replay.setSpeed(speed); }
+    void seekReplay(int64_t time)           { replay.seek(time); }
+
+    // publish every tracking pose into shared memory for other processes, off until started
+    bool startPoseServer(const char* name = POSE_SHM_NAME);
+    void stopPoseServer();
+    bool isPoseServerRunning() const        { return poseServer.isOpen(); }
+
+    // pen key and device status events for the UI thread, see TrackingEvents
+    bool popTrackingEvent(TrackingEvent& event) { return tracking.popEvent(TrackingEvents::CONSUMER_UI, event); }
+
+    // tracking snapshot used by the last frame, its timestamp is the sample time
+    const TrackingPose& getLatchedPose() const { return latchedPose; }
+    const f3d::FrustumData& getLatchedFrustum() const { return latchedFrustum; } // eye matrices and pen ray of it
+    uint32_t getTrackingPublishCount() const { return tracking.getPublishCount(); } // poses published so far
+
+    // matrix updates requested by setters and actually rebuilt, the difference is avoided
+    int getMatrixUpdateRequests() const     { return matrixUpdateRequests; }
+    int getMatrixRebuilds() const           { return matrixRebuilds; }
+    int getMatrixRebuildsAvoided() const    { return matrixUpdateRequests - matrixRebuilds; }
+
+    // StereoFrustum::solve() calls skipped/done by the frustum caches
+    int getFrustumCacheHits() const         { return frustumCacheDebug.getHitCount() + frustumCacheVR.getHitCount(); }
+    int getFrustumCacheMisses() const       { return frustumCacheDebug.getMissCount() + frustumCacheVR.getMissCount(); }
+
+    // several tracked heads in VR mode, each viewer drawn in its own region of the window
+    // Viewer 0 is the tracker of this process. Viewer i reads the pose ring
+    // named POSE_SHM_NAME followed by i ("fmTrackingPoses1", ...) published by
+    // another process; without it, it is a spectator next to viewer 0.
+    void setViewerCount(int count)          { postCommand(SceneCommand::VIEWER_COUNT, 0, (float)count); }
+    int getViewerCount()                    { return uiScene.viewerCount; }
+
+    // multi-view stats of the last frame, for the rendering thread, time in millisecond
+    int getMultiViewCount() const           { return planner.getViewerCount(); }
+    double getMultiViewPlanTime() const     { return planner.getLastPlanTime(); }
+    double getMultiViewSharedTime() const   { return planner.getLastSharedTime(); }
+    const f3d::FrustumData& getMultiViewFrustum(int viewer) const { return planner.getFrustum(viewer); }
+
+    // strokes, for the rendering thread
+    int getStrokeCount() const              { return strokes.getStrokeCount(); }
+    int64_t getStrokePointCount() const     { return strokes.getPointCount(); }
+    int64_t getStrokeSampleCount() const    { return strokes.getSampleCount(); }
+    int getHoveredStroke() const            { return hoveredStroke; }
+    int getStrokeChunkCount() const         { return strokes.getChunkCount(); }
+    int64_t getStrokeUploadBytes() const    { return strokeRenderer.getTotalUploadBytes(); }
+
 protected:
 
 private:
@@ -97,12 +217,23 @@ private:
     void drawSub2();
     void drawVR();
     void drawFrustum(float fovy, float aspect, float near, float far);
+    void useDrawState(int state, GLuint program = 0); // GL states of the next draw, DRAW_* in ModelGL.cpp
     Matrix4 setFrustum(float l, float r, float b, float t, float n, float f);
     Matrix4 setFrustum(float fovy, float ratio, float n, float f);
     Matrix4 setOrthoFrustum(float l, float r, float b, float t, float n = -1, float f = 1);
+    void invalidateView()                   { viewDirty = true; ++matrixUpdateRequests; }
+    void invalidateModel()                  { modelDirty = true; ++matrixUpdateRequests; }
+    void postCommand(int type, int index, float v0 = 0, float v1 = 0, float v2 = 0, float v3 = 0, float v4 = 0, float v5 = 0);
+    void postResync();                              // hand uiScene over to the rendering thread
+    void applyCommands();                           // apply posted commands to the scene, once per frame
+    void applyTrackingEvents();                     // pen key changes since the last frame
+    void updateWindowSize();
+    void updateMatrices();                          // rebuild dirty matrices and model-view products
     void updateModelMatrix();
     void updateViewMatrix();
     bool createShaderPrograms();
+    bool createStereoPrograms();                    // shaders and uniform buffer for instanced stereo
+    void buildStereoLines();                        // static line geometry for instanced stereo
     std::string getShaderStatus(GLuint shader);     // return GLSL compile error log
     std::string getProgramStatus(GLuint program);   // return GLSL link error log
 
@@ -112,25 +243,48 @@ private:
     int povWidth;           // width for point of view screen (left)
     bool windowSizeChanged;
     bool drawModeChanged;
-    int drawMode;
-    int mouseX;
-    int mouseY;
-    float cameraPosition[3];
-    float cameraAngle[3];
-    float modelPosition[3];
-    float modelAngle[3];
-
-    // these are for 3rd person view
-    float cameraAngleX;
-    float cameraAngleY;
-    float cameraDistance;
     float bgColor[4];
 
+    // camera, model and display settings
+    SceneState scene;                   // rendering thread copy, drawn by draw()
+    SceneState uiScene;                 // UI thread copy, read by the getters
+    MpscQueue<SceneCommand> commands;   // UI -> rendering thread
+    uint32_t postedCommands;            // number of postCommand() calls, UI thread
+    std::atomic<uint32_t> appliedCommands; // of them applied by the rendering thread
+    std::atomic<uint64_t> windowSizeRequest; // latest setWindowSize(), width << 32 | height | flag
+    struct SceneResync
+    {
+        SceneState scene;
+        uint32_t postedCommands;        // commands included in scene
+    };
+    TripleBuffer<SceneResync> resync;   // copy of uiScene when the queue was full
+    std::atomic<bool> resyncRequested;  // set by the UI thread, cleared by the rendering thread
+    int sceneResyncs;                   // number of full queues, UI thread
+    Matrix4 uiMatrixView;               // UI side matrices returned by getters
+    Matrix4 uiMatrixModel;
+    Matrix4 uiMatrixModelView;
+    Matrix4 uiMatrixProjection;
+
     // 4x4 transform matrices
     Matrix4 matrixView;
     Matrix4 matrixModel;
     Matrix4 matrixModelView;
-    Matrix4 matrixProjection;
+    Matrix4 matrixProjection;   // projection of the last setViewport() or setViewportSub(), CPU side copy of GL
+    bool viewDirty;             // camera changed, view matrices must be rebuilt
+    bool modelDirty;            // model changed, model matrix must be rebuilt
+    int matrixUpdateRequests;   // number of setter calls that changed a matrix
+    int matrixRebuilds;         // number of view/model matrix rebuilds actually done
+
+    // shadowed GL states, all state changes go through it
+    glStateCache stateCache;
+
+    // last StereoFrustum::solve() results of drawSub1() and drawVR()
+    StereoFrustumCache frustumCacheDebug;
+    StereoFrustumCache frustumCacheVR;  // its solver is also used by drawMultiView()
+
+    // CPU timewarp of the last VR frame
+    StereoReprojector reprojector;
+    bool reprojectionEnabled;
 
     // glsl extension
     bool glslSupported;
@@ -138,6 +292,14 @@ private:
     GLuint progId1;             // shader program with color
     GLuint progId2;             // shader program with color + lighting
 
+    // instanced single-pass stereo
+    bool stereoInstancedReady;  // extensions, programs and UBO are ready
+    bool stereoInstanced;       // use it if ready, otherwise draw 2 passes
+    GLuint progIdStereo1;       // instanced program with color
+    GLuint progIdStereo2;       // instanced program with color + lighting
+    GLuint uboStereo;           // per-eye view and projection matrices
+    std::vector<float> stereoLines; // screen and grid lines, interleaved xyz + rgb
+
     //mr demo
 private:
 
@@ -148,11 +310,40 @@ private:
     Matrix4 matrixViewR;
     Matrix4 matrixModelViewR;
 
+    //每帧只采样一次的跟踪数据，双眼和笔都用这一份
+    TrackingPose latchedPose;
+    f3d::FrustumData latchedFrustum;    // eye matrices and pen ray of latchedPose
+    uint32_t latchSequence;
+    TrackingRecorder recorder;          // used by the tracking thread, so declared before it
+    TrackingReplay replay;
+    PoseServer poseServer;
+    TrackingThread tracking;            // polls FSCore, latchPose() reads its newest pose
+    PosePredictor predictor;            // extrapolates latched poses to the display time
+    int64_t predictionLookAhead;        // latch to display time in microseconds
+    int penKeysDown;                    // fmGetPenKey() bits, kept by the events of the rendering thread
+    StrokePool strokes;                 // captured in latchPose() while the stroke key is down
+    int hoveredStroke;                  // stroke id near the nib in the latched pose, -1 if none
+    StrokeRenderer strokeRenderer;
+
+    // multi-view, see setViewerCount()
+    MultiViewPlanner planner;
+    std::vector<MultiViewPlanner::Item> viewItems;
+    TrackingPose viewerPoses[MultiViewPlanner::MAX_VIEWERS];
+    PoseClient viewerClients[MultiViewPlanner::MAX_VIEWERS];   // index 0 is unused
+    int viewerProbeFrames;                                      // frames until closed clients are opened again
+
+    void latchPose();                               // sample tracking once and compute eye matrices
+    void captureFrame();                            // read back color and depth of drawVR() for reprojection
     void drawPen();
+    void drawStrokes();                             // strokes in world space with the current matrices
+    void drawVRInstanced(const f3d::FrustumData& fd);
+    void drawVREye(int eye, int x, int width, const float* projection, const float* view);
+    void latchViewers();                            // poses of viewer 1 and up for drawMultiView()
+    void buildViewItems();                          // bounds of everything drawMultiView() draws
+    void drawMultiView();
+    void drawViewItem(const MultiViewPlanner::Item& item, int lod);
+    void drawBox(const float* minimum, const float* maximum);
     void drawScreen();
     void setVRCamera();
-
-public:
-    bool isVRMode;//是否当前进入了VR模式;
 };
 #endif
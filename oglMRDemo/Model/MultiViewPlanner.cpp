@@ -0,0 +1,237 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MultiViewPlanner.cpp
+// ====================
+// CPU side of multi-viewer stereo: shared culling, LOD and command list once,
+// per-eye culling and matrices on worker threads.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "MultiViewPlanner.h"
+
+const int MIN_PARALLEL_TESTS = 512;     // sphere tests of all eyes below which a thread costs more than it saves
+const float DEFAULT_LOD_THRESHOLDS[] = { 0, 0.05f, 0.015f, 0.005f };
+
+// commands of the same state together, then by LOD; item order is kept otherwise
+struct CommandOrder
+{
+    const std::vector<MultiViewPlanner::Item>* items;
+    bool operator()(const MultiViewPlanner::Command& a, const MultiViewPlanner::Command& b) const
+    {
+        int sa = (*items)[a.item].state;
+        int sb = (*items)[b.item].state;
+        return sa < sb || (sa == sb && a.lod < b.lod);
+    }
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+MultiViewPlanner::MultiViewPlanner() : threadCount(0), viewerCount(0), lastPlanTime(0), lastSharedTime(0),
+                                       unionCulled(0), viewCulled(0)
+{
+    setThreadCount(0);
+    for(int i = 0; i < MAX_LODS; ++i)
+        lodThresholds[i] = DEFAULT_LOD_THRESHOLDS[i];
+    memset(frusta, 0, sizeof(frusta));
+}
+
+void MultiViewPlanner::setThreadCount(int count)
+{
+    if(count <= 0)
+        count = (int)std::thread::hardware_concurrency();
+    threadCount = count > 0 ? count : 1;
+}
+
+void MultiViewPlanner::setLodThreshold(int level, float size)
+{
+    if(level > 0 && level < MAX_LODS)
+        lodThresholds[level] = size > 0 ? size : 0;
+}
+
+float MultiViewPlanner::getLodThreshold(int level) const
+{
+    return level > 0 && level < MAX_LODS ? lodThresholds[level] : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// shared work once, then the per-view work of all eyes on worker threads
+///////////////////////////////////////////////////////////////////////////////
+bool MultiViewPlanner::plan(const StereoFrustum& solver, const TrackingPose* poses, int count,
+                            const Item* items, int itemCount)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    viewerCount = 0;
+    commands.clear();
+    unionCulled = viewCulled = 0;
+    if(count <= 0 || !solver.solveBatch(poses, count < MAX_VIEWERS ? count : MAX_VIEWERS, frusta))
+        return false;
+    viewerCount = count < MAX_VIEWERS ? count : MAX_VIEWERS;
+
+    // planes of every eye and the box around all of them
+    // NOTE: planes are the rows of P * V (Gribb & Hartmann), GL clip space z in [-w, w]
+    static const float ndc[2] = { -1, 1 };
+    Vector3 boxMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 boxMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for(int v = 0; v < viewerCount; ++v)
+    {
+        const f3d::FrustumData& fd = frusta[v];
+        const float* eyeViews[EYE_COUNT] = { fd.matViewL.m, fd.matViewR.m };
+        const float* eyeProjections[EYE_COUNT] = { fd.matProjectionL.m, fd.matProjectionR.m };
+        for(int e = 0; e < EYE_COUNT; ++e)
+        {
+            View& view = views[v * EYE_COUNT + e];
+            view.view.set(eyeViews[e]);
+            Matrix4 clip = Matrix4(eyeProjections[e]) * view.view;
+            const float* m = clip.get();
+            for(int i = 0; i < 6; ++i)
+            {
+                int row = i / 2;
+                float sign = (i & 1) ? -1.0f : 1.0f;
+                float a = m[3]  + sign * m[row];
+                float b = m[7]  + sign * m[row + 4];
+                float c = m[11] + sign * m[row + 8];
+                float d = m[15] + sign * m[row + 12];
+                float length = sqrtf(a * a + b * b + c * c);
+                float invLength = length > 0 ? 1 / length : 0;
+                view.planes[i][0] = a * invLength;
+                view.planes[i][1] = b * invLength;
+                view.planes[i][2] = c * invLength;
+                view.planes[i][3] = d * invLength;
+            }
+
+            Matrix4 inverse = view.view;
+            inverse.invertAffine();
+            view.position.set(inverse[12], inverse[13], inverse[14]);
+
+            inverse = clip;
+            inverse.invertGeneral();
+            for(int i = 0; i < 8; ++i)
+            {
+                Vector4 corner = inverse * Vector4(ndc[i & 1], ndc[(i >> 1) & 1], ndc[i >> 2], 1);
+                if(corner.w == 0)
+                    continue;
+                Vector3 p(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w);
+                boxMin.set(std::min(boxMin.x, p.x), std::min(boxMin.y, p.y), std::min(boxMin.z, p.z));
+                boxMax.set(std::max(boxMax.x, p.x), std::max(boxMax.y, p.y), std::max(boxMax.z, p.z));
+            }
+        }
+    }
+    const int viewCount = viewerCount * EYE_COUNT;
+
+    // union culling, LOD and the command list, once for all eyes
+    this->items.assign(items, items + itemCount);
+    centers.resize(itemCount);
+    for(int i = 0; i < itemCount; ++i)
+    {
+        const Item& item = items[i];
+        Vector3 center(item.center[0], item.center[1], item.center[2]);
+        if(item.matrix)
+            center = Matrix4(item.matrix) * center;
+        centers[i] = center;
+
+        // distance from the box, 0 inside
+        float dx = std::max(std::max(boxMin.x - center.x, center.x - boxMax.x), 0.0f);
+        float dy = std::max(std::max(boxMin.y - center.y, center.y - boxMax.y), 0.0f);
+        float dz = std::max(std::max(boxMin.z - center.z, center.z - boxMax.z), 0.0f);
+        if(dx * dx + dy * dy + dz * dz > item.radius * item.radius)
+        {
+            ++unionCulled;
+            continue;
+        }
+
+        float nearest = FLT_MAX;
+        for(int v = 0; v < viewCount; ++v)
+            nearest = std::min(nearest, (center - views[v].position).length());
+        float size = nearest > item.radius ? item.radius / nearest : FLT_MAX;
+        int lod = 0;
+        while(lod + 1 < item.lodCount && lod + 1 < MAX_LODS && size < lodThresholds[lod + 1])
+            ++lod;
+
+        Command command = { i, lod };
+        commands.push_back(command);
+    }
+    CommandOrder order = { &this->items };
+    std::stable_sort(commands.begin(), commands.end(), order);
+
+    std::chrono::steady_clock::time_point shared = std::chrono::steady_clock::now();
+    lastSharedTime = std::chrono::duration<double, std::milli>(shared - start).count();
+
+    // per-view work, one eye per work item
+    std::atomic<int> nextView(0);
+    auto worker = [&]()
+    {
+        int view;
+        while((view = nextView.fetch_add(1)) < viewCount)
+            planView(view);
+    };
+
+    int threads = threadCount < viewCount ? threadCount : viewCount;
+    if((int)commands.size() * viewCount < MIN_PARALLEL_TESTS)
+        threads = 1;
+    std::vector<std::thread> workers;
+    for(int i = 1; i < threads; ++i)
+        workers.push_back(std::thread(worker));
+    worker();
+    for(size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    for(int v = 0; v < viewCount; ++v)
+        viewCulled += views[v].culled;
+
+    lastPlanTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// cull the command list against one eye and compute the modelview matrices
+// of the visible commands; only views[view] and drawLists[view] are written
+///////////////////////////////////////////////////////////////////////////////
+void MultiViewPlanner::planView(int view)
+{
+    View& v = views[view];
+    std::vector<Draw>& list = drawLists[view];
+    list.clear();
+    int culled = 0;
+
+    for(size_t i = 0; i < commands.size(); ++i)
+    {
+        const Item& item = items[commands[i].item];
+        const Vector3& c = centers[commands[i].item];
+        bool inside = true;
+        for(int k = 0; k < 6 && inside; ++k)
+        {
+            const float* p = v.planes[k];
+            inside = p[0] * c.x + p[1] * c.y + p[2] * c.z + p[3] >= -item.radius;
+        }
+        if(!inside)
+        {
+            ++culled;
+            continue;
+        }
+
+        Draw draw;
+        draw.command = (int)i;
+        if(item.matrix)
+            memcpy(draw.modelView, (v.view * Matrix4(item.matrix)).get(), sizeof(draw.modelView));
+        else
+            memcpy(draw.modelView, v.view.get(), sizeof(draw.modelView));
+        list.push_back(draw);
+    }
+    v.culled = culled;
+}
@@ -0,0 +1,127 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// MultiViewPlanner.h
+// ==================
+// CPU side of multi-viewer stereo: several tracked heads look at the same
+// scene through the same screen, each with its own pair of asymmetric
+// frusta, and each viewer is drawn into its own region of the window.
+//
+// plan() splits the work of a frame in 2 parts.
+// Shared, done once for all views:
+//  - the eye matrices of all viewers are solved together with
+//    StereoFrustum::solveBatch(),
+//  - the items are culled against the bounding box of the union of all eye
+//    frusta,
+//  - a LOD is selected per item from its angular size seen by the nearest
+//    eye, so all views draw the same mesh,
+//  - the surviving items are recorded into one command list sorted by state.
+// Per view (one eye of one viewer), spread over worker threads:
+//  - the command list is culled against the 6 planes of the eye,
+//  - the modelview matrices of the visible items are computed.
+// Each eye writes only its own draw list, so the workers share nothing but
+// the index of the next eye.
+//
+// The caller issues the GL calls by walking getDrawList() of each eye in its
+// region: there is one GL context, so draw calls stay on its thread. No GL
+// call is made here.
+//
+// Eye e of viewer v is view v * 2 + e, e = 0 for the left eye.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MULTI_VIEW_PLANNER_H
+#define MULTI_VIEW_PLANNER_H
+
+#include <vector>
+#include "../Math/Matrices.h"
+#include "../FCore/FSCore.h"
+#include "../Tracking/TrackingPose.h"
+#include "StereoFrustum.h"
+
+class MultiViewPlanner
+{
+public:
+    enum { MAX_VIEWERS = 8, EYE_COUNT = 2, MAX_LODS = 4 };
+
+    // something to draw, bounded by a sphere
+    struct Item
+    {
+        float center[3];                            // in model space of matrix
+        float radius;
+        const float* matrix;                        // rigid model matrix (16 floats), 0 for world space
+        int kind;                                   // what to draw, defined by the caller
+        int index;                                  // which one of its kind, defined by the caller
+        int state;                                  // commands are sorted by it, e.g. shader program
+        int lodCount;                               // 1 if the item has a single LOD
+    };
+
+    // an item that survived the shared culling, with its LOD
+    struct Command
+    {
+        int item;
+        int lod;
+    };
+
+    // a command visible in an eye
+    struct Draw
+    {
+        int command;
+        float modelView[16];
+    };
+
+    MultiViewPlanner();
+
+    void setThreadCount(int count);                 // 0: hardware concurrency
+    int getThreadCount() const                      { return threadCount; }
+
+    // angular radius (radius / distance) below which LOD level is used, level 1 ~ MAX_LODS - 1
+    void setLodThreshold(int level, float size);
+    float getLodThreshold(int level) const;
+
+    // solve the eyes of count viewers and build the draw lists of all eyes
+    // the matrices of the items must stay valid until plan() returns
+    bool plan(const StereoFrustum& solver, const TrackingPose* poses, int count, const Item* items, int itemCount);
+
+    // results of the last plan()
+    int getViewerCount() const                      { return viewerCount; }
+    int getViewCount() const                        { return viewerCount * EYE_COUNT; }
+    const f3d::FrustumData& getFrustum(int viewer) const { return frusta[viewer]; }
+    const std::vector<Draw>& getDrawList(int view) const { return drawLists[view]; }
+    const Command& getCommand(int index) const      { return commands[index]; }
+    const Item& getItem(int index) const            { return items[index]; }
+    int getCommandCount() const                     { return (int)commands.size(); }
+
+    // stats of the last plan(), time in millisecond
+    double getLastPlanTime() const                  { return lastPlanTime; }
+    double getLastSharedTime() const                { return lastSharedTime; }
+    int getUnionCulledCount() const                 { return unionCulled; }    // items out of all eyes
+    int getViewCulledCount() const                  { return viewCulled; }     // commands out of one eye, all eyes
+
+private:
+    struct View
+    {
+        float planes[6][4];                         // normalized, inside if dot(plane, p) + d >= 0
+        Matrix4 view;
+        Vector3 position;                           // eye in world space
+        int culled;                                 // commands culled by this eye
+    };
+
+    void planView(int view);                        // per-view work of one eye
+
+    int threadCount;
+    float lodThresholds[MAX_LODS];
+    int viewerCount;
+    f3d::FrustumData frusta[MAX_VIEWERS];
+    View views[MAX_VIEWERS * EYE_COUNT];
+    std::vector<Item> items;
+    std::vector<Vector3> centers;                   // item centers in world space
+    std::vector<Command> commands;
+    std::vector<Draw> drawLists[MAX_VIEWERS * EYE_COUNT];
+    double lastPlanTime;
+    double lastSharedTime;
+    int unionCulled;
+    int viewCulled;
+};
+
+#endif
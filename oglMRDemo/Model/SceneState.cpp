@@ -0,0 +1,182 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// SceneState.cpp
+// ==============
+// Camera, model and display settings of the scene, changed only by commands.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneState.h"
+
+// 3rd person view
+const float CAMERA_ANGLE_X = 45.0f;     // pitch in degree
+const float CAMERA_ANGLE_Y = -45.0f;    // heading in degree
+const float CAMERA_DISTANCE = 25.0f;    // camera distance
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// default ctor
+///////////////////////////////////////////////////////////////////////////////
+SceneState::SceneState() : cameraAngleX(CAMERA_ANGLE_X), cameraAngleY(CAMERA_ANGLE_Y),
+                           cameraDistance(CAMERA_DISTANCE), mouseX(0), mouseY(0), drawMode(0),
+                           windowWidth(0), windowHeight(0), vrMode(false), strokeCapture(true), strokeClears(0),
+                           viewerCount(1)
+{
+    cameraPosition[0] = cameraPosition[1] = cameraPosition[2] = 0;
+    cameraAngle[0] = cameraAngle[1] = cameraAngle[2] = 0;
+    modelPosition[0] = modelPosition[1] = modelPosition[2] = 0;
+    modelAngle[0] = modelAngle[1] = modelAngle[2] = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// apply one command
+///////////////////////////////////////////////////////////////////////////////
+int SceneState::apply(const SceneCommand& command)
+{
+    const float* v = command.values;
+    int index = command.index >= 0 && command.index < 3 ? command.index : 0;
+    int changes = 0;
+
+    switch(command.type)
+    {
+    case SceneCommand::CAMERA_POSITION:
+        cameraPosition[index] = v[0];
+        changes = CHANGED_VIEW;
+        break;
+
+    case SceneCommand::CAMERA_ANGLE:
+        cameraAngle[index] = v[0];
+        changes = CHANGED_VIEW;
+        break;
+
+    case SceneCommand::MODEL_POSITION:
+        modelPosition[index] = v[0];
+        changes = CHANGED_MODEL;
+        break;
+
+    case SceneCommand::MODEL_ANGLE:
+        modelAngle[index] = v[0];
+        changes = CHANGED_MODEL;
+        break;
+
+    case SceneCommand::VIEW_MATRIX:
+        cameraPosition[0] = v[0];
+        cameraPosition[1] = v[1];
+        cameraPosition[2] = v[2];
+        cameraAngle[0] = v[3];
+        cameraAngle[1] = v[4];
+        cameraAngle[2] = v[5];
+        changes = CHANGED_VIEW;
+        break;
+
+    case SceneCommand::MODEL_MATRIX:
+        modelPosition[0] = v[0];
+        modelPosition[1] = v[1];
+        modelPosition[2] = v[2];
+        modelAngle[0] = v[3];
+        modelAngle[1] = v[4];
+        modelAngle[2] = v[5];
+        changes = CHANGED_MODEL;
+        break;
+
+    case SceneCommand::MOUSE_POSITION:
+        mouseX = (int)v[0];
+        mouseY = (int)v[1];
+        break;
+
+    case SceneCommand::ROTATE_CAMERA:
+        cameraAngleY += ((int)v[0] - mouseX);
+        cameraAngleX += ((int)v[1] - mouseY);
+        mouseX = (int)v[0];
+        mouseY = (int)v[1];
+        break;
+
+    case SceneCommand::ZOOM_CAMERA:
+        cameraDistance -= ((int)v[0] - mouseY) * 0.1f;
+        mouseY = (int)v[0];
+        break;
+
+    case SceneCommand::ZOOM_CAMERA_DELTA:
+        cameraDistance -= v[0];
+        break;
+
+    case SceneCommand::DRAW_MODE:
+        if(drawMode != (int)v[0])
+        {
+            drawMode = (int)v[0];
+            changes = CHANGED_DRAW_MODE;
+        }
+        break;
+
+    case SceneCommand::WINDOW_SIZE:
+        windowWidth = (int)v[0];
+        windowHeight = (int)v[1];
+        changes = CHANGED_WINDOW_SIZE;
+        break;
+
+    case SceneCommand::VR_MODE:
+        if(vrMode != (v[0] != 0))
+        {
+            vrMode = v[0] != 0;
+            changes = CHANGED_VR_MODE;
+        }
+        break;
+
+    case SceneCommand::STROKE_CAPTURE:
+        if(strokeCapture != (v[0] != 0))
+        {
+            strokeCapture = v[0] != 0;
+            changes = CHANGED_STROKE_CAPTURE;
+        }
+        break;
+
+    case SceneCommand::CLEAR_STROKES:
+        ++strokeClears;
+        changes = CHANGED_CLEAR_STROKES;
+        break;
+
+    case SceneCommand::VIEWER_COUNT:
+        viewerCount = (int)v[0] > 1 ? (int)v[0] : 1;
+        break;
+    }
+
+    return changes;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// transform the camera (viewing matrix) from world space to eye space
+// Notice translation and heading values are negated,
+// because we move the whole scene with the inverse of camera transform
+// ORDER: translation -> rotZ -> rotY ->rotX
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 SceneState::getViewMatrix(float eyeOffset) const
+{
+    Matrix4 matrix;
+    matrix.translate(-(cameraPosition[0] + eyeOffset), -cameraPosition[1], -cameraPosition[2]);
+    matrix.rotateZ(cameraAngle[2]);     // roll
+    matrix.rotateY(-cameraAngle[1]);    // heading
+    matrix.rotateX(cameraAngle[0]);     // pitch
+    return matrix;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// transform objects from object space to world space
+// ORDER: rotZ -> rotY -> rotX -> translation
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 SceneState::getModelMatrix() const
+{
+    Matrix4 matrix;
+    matrix.rotateZ(modelAngle[2]);
+    matrix.rotateY(modelAngle[1]);
+    matrix.rotateX(modelAngle[0]);
+    matrix.translate(modelPosition[0], modelPosition[1], modelPosition[2]);
+    return matrix;
+}
@@ -0,0 +1,93 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// SceneState.h
+// ============
+// Camera, model and display settings of the scene, changed only by commands.
+// The UI thread never writes the state the render thread draws with. Every
+// setter of ModelGL makes a SceneCommand, applies it to the UI copy of the
+// state (so the form shows the new values at once), and posts it to the
+// render thread through a lock-free queue. The render thread applies the
+// queued commands to its own copy once per frame, before drawing. Both copies
+// see the same commands in the same order, so they end up identical. The one
+// exception is WINDOW_SIZE, which is not queued: ModelGL::setWindowSize() is
+// also called from the rendering thread, which cannot wait for room in a
+// queue only it drains. ModelGL keeps the latest size and applies it as a
+// WINDOW_SIZE command to the render copy only; the UI copy keeps no size.
+// If the queue is full, the UI thread does not wait for the render thread:
+// it drops the commands and hands over a copy of its whole state instead
+// (ModelGL::postCommand()), which is why CLEAR_STROKES is also counted.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCENE_STATE_H
+#define SCENE_STATE_H
+
+#include <cstdint>
+#include "../Math/Matrices.h"
+
+struct SceneCommand
+{
+    enum Type
+    {
+        CAMERA_POSITION = 0,        // index, value
+        CAMERA_ANGLE,               // index, value
+        MODEL_POSITION,             // index, value
+        MODEL_ANGLE,                // index, value
+        VIEW_MATRIX,                // x, y, z, pitch, heading, roll
+        MODEL_MATRIX,               // x, y, z, rx, ry, rz
+        MOUSE_POSITION,             // x, y
+        ROTATE_CAMERA,              // x, y
+        ZOOM_CAMERA,                // y
+        ZOOM_CAMERA_DELTA,          // delta
+        DRAW_MODE,                  // mode
+        WINDOW_SIZE,                // width, height
+        VR_MODE,                    // flag
+        STROKE_CAPTURE,             // flag
+        CLEAR_STROKES,              // none
+        VIEWER_COUNT                // count
+    };
+
+    int type;
+    int index;
+    float values[6];
+};
+
+class SceneState
+{
+public:
+    // what apply() changed
+    enum { CHANGED_VIEW = 1, CHANGED_MODEL = 2, CHANGED_DRAW_MODE = 4, CHANGED_WINDOW_SIZE = 8, CHANGED_VR_MODE = 16,
+           CHANGED_STROKE_CAPTURE = 32, CHANGED_CLEAR_STROKES = 64 };
+
+    SceneState();
+
+    int apply(const SceneCommand& command);         // return CHANGED_* flags
+
+    // transform matrices of the current values
+    // eyeOffset moves the camera along its x-axis (for left/right eye)
+    Matrix4 getViewMatrix(float eyeOffset = 0) const;
+    Matrix4 getModelMatrix() const;
+
+    float cameraPosition[3];
+    float cameraAngle[3];
+    float modelPosition[3];
+    float modelAngle[3];
+
+    // these are for 3rd person view
+    float cameraAngleX;
+    float cameraAngleY;
+    float cameraDistance;
+
+    int mouseX;
+    int mouseY;
+    int drawMode;
+    int windowWidth;
+    int windowHeight;
+    bool vrMode;
+    bool strokeCapture;             // pen keys draw strokes
+    uint32_t strokeClears;          // number of CLEAR_STROKES applied
+    int viewerCount;                // tracked heads drawn in VR mode, 1 or more
+};
+
+#endif
@@ -0,0 +1,316 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoFrustum.cpp
+// =================
+// In-tree version of fmModifyFrustum().
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "StereoFrustum.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define STEREO_FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+const float DEFAULT_PHYSICAL_HEIGHT = 0.296f;       // meters, 24" 16:9 screen
+const float DEFAULT_EYE_DISTANCE = 0.5f;            // meters in front of the screen, without glasses
+const float MIN_EYE_DISTANCE = 1e-4f;               // an eye on the screen plane still gets a frustum
+
+// glFrustum() matrix, column-major
+static void setFrustum(float* m, float l, float r, float b, float t, float n, float f)
+{
+    memset(m, 0, sizeof(float) * 16);
+    m[0]  = 2 * n / (r - l);
+    m[5]  = 2 * n / (t - b);
+    m[8]  = (r + l) / (r - l);
+    m[9]  = (t + b) / (t - b);
+    m[10] = -(f + n) / (f - n);
+    m[11] = -1;
+    m[14] = -(2 * f * n) / (f - n);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+StereoFrustum::StereoFrustum() : nearPlane(0), farPlane(0), halfWidth(0), halfHeight(0), depth(0), zSign(-1),
+                                 pupilDistance(0), physicalHeight(DEFAULT_PHYSICAL_HEIGHT), scale(1),
+                                 isLeftHanded(false), valid(false)
+{
+}
+
+void StereoFrustum::setPhysicalScreenHeight(float height)
+{
+    if(height > 0)
+        physicalHeight = height;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// screen, eyes and camera for the next solves
+// near/far and aspect are taken from the original perspective projection.
+///////////////////////////////////////////////////////////////////////////////
+bool StereoFrustum::set(const Matrix4& view, const Matrix4& projection,
+                        float screenDistance, float screenHeight, float pupilDistance, bool isLeftHanded)
+{
+    const float* p = projection.get();
+    if(screenHeight <= 0 || p[0] == 0 || p[10] == 1 || p[10] == -1)
+    {
+        valid = false;
+        return false;
+    }
+
+    nearPlane = p[14] / (p[10] - 1);
+    farPlane = p[14] / (p[10] + 1);
+    if(isLeftHanded)
+    {
+        nearPlane = -nearPlane;
+        farPlane = -farPlane;
+    }
+    halfHeight = screenHeight * 0.5f;
+    halfWidth = halfHeight * (p[5] / p[0]);
+    scale = screenHeight / physicalHeight;
+    depth = screenDistance < 0 ? -screenDistance : screenDistance;
+    zSign = isLeftHanded ? 1.0f : -1.0f;
+    this->pupilDistance = pupilDistance;
+    this->isLeftHanded = isLeftHanded;
+
+    this->view = view;
+    inverseView = view;
+    inverseView.invert();
+    inverseRotation = inverseView.getRotationMatrix();
+    valid = true;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scalar reference
+///////////////////////////////////////////////////////////////////////////////
+bool StereoFrustum::solve(const TrackingPose& pose, f3d::FrustumData& data) const
+{
+    if(!valid)
+        return false;
+
+    Vector3 glass(pose.glassPosition.x, pose.glassPosition.y, pose.glassPosition.z);
+    f3d::Quaternion q = pose.glassRotation;
+    if(!pose.glassStatus)
+    {
+        glass.set(0, 0, -DEFAULT_EYE_DISTANCE);
+        q.x = q.y = q.z = 0;
+        q.w = 1;
+    }
+
+    // x axis of the glasses, the eyes are on it
+    Vector3 axis(1 - 2 * (q.y * q.y + q.z * q.z), 2 * (q.x * q.y + q.w * q.z), 2 * (q.x * q.z - q.w * q.y));
+    const float sides[2] = { -0.5f * pupilDistance, 0.5f * pupilDistance };
+    f3d::Matrix4* views[2] = { &data.matViewL, &data.matViewR };
+    f3d::Matrix4* projections[2] = { &data.matProjectionL, &data.matProjectionR };
+
+    for(int i = 0; i < 2; ++i)
+    {
+        Vector3 eye = glass + axis * sides[i];
+
+        // eye in camera space, the screen plane is z = zSign * depth
+        float ex = eye.x * scale;
+        float ey = eye.y * scale;
+        float ez = zSign * (depth + eye.z * scale);
+        Matrix4 eyeView = view;
+        eyeView.translate(-ex, -ey, -ez);
+        memcpy(views[i]->m, eyeView.get(), sizeof(float) * 16);
+
+        // screen rectangle seen from the eye, scaled to the near plane
+        float distance = -eye.z * scale;
+        if(distance < MIN_EYE_DISTANCE)
+            distance = MIN_EYE_DISTANCE;
+        float ratio = nearPlane / distance;
+        float* m = projections[i]->m;
+        setFrustum(m, (-halfWidth - ex) * ratio, (halfWidth - ex) * ratio,
+                      (-halfHeight - ey) * ratio, (halfHeight - ey) * ratio, nearPlane, farPlane);
+        if(isLeftHanded)
+        {
+            for(int j = 8; j < 12; ++j)
+                m[j] = -m[j];
+        }
+    }
+
+    // pen from screen space to world space
+    Vector3 penCamera(pose.penPosition.x * scale, pose.penPosition.y * scale,
+                      zSign * (depth + pose.penPosition.z * scale));
+    Vector3 penWorld = inverseView * penCamera;
+    Vector3 directionCamera(pose.penDirection.x, pose.penDirection.y, zSign * -pose.penDirection.z);
+    Vector3 directionWorld = inverseRotation * directionCamera;
+    data.penPosition.x = penWorld.x;
+    data.penPosition.y = penWorld.y;
+    data.penPosition.z = penWorld.z;
+    data.penDirection.x = directionWorld.x;
+    data.penDirection.y = directionWorld.y;
+    data.penDirection.z = directionWorld.z;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// count poses at once, 4 per SSE pass, the rest with solve()
+///////////////////////////////////////////////////////////////////////////////
+bool StereoFrustum::solveBatch(const TrackingPose* poses, int count, f3d::FrustumData* results) const
+{
+    if(!valid)
+        return false;
+
+    int i = 0;
+#ifdef STEREO_FRUSTUM_SSE
+    const float* v = view.get();
+    const float* w = inverseView.get();
+    const float* r = inverseRotation.get();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 k = _mm_set1_ps(scale);
+    const __m128 d = _mm_set1_ps(depth);
+    const __m128 s = _mm_set1_ps(zSign);
+    const __m128 n = _mm_set1_ps(nearPlane);
+    const __m128 n2 = _mm_set1_ps(2 * nearPlane);
+    const __m128 hw = _mm_set1_ps(halfWidth);
+    const __m128 hh = _mm_set1_ps(halfHeight);
+    const __m128 minDistance = _mm_set1_ps(MIN_EYE_DISTANCE);
+    const __m128 sides[2] = { _mm_set1_ps(-0.5f * pupilDistance), _mm_set1_ps(0.5f * pupilDistance) };
+    const __m128 flip = isLeftHanded ? signBit : zero;
+
+    // the parts of the matrices that do not depend on the pose
+    float projection[16];
+    setFrustum(projection, -1, 1, -1, 1, nearPlane, farPlane);
+    if(isLeftHanded)
+    {
+        for(int j = 8; j < 12; ++j)
+            projection[j] = -projection[j];
+    }
+
+    for(; i + 4 <= count; i += 4)
+    {
+        const TrackingPose* p = poses + i;
+#define GATHER(field) _mm_setr_ps(p[0].field, p[1].field, p[2].field, p[3].field)
+        __m128 visible = _mm_cmpneq_ps(_mm_setr_ps((float)p[0].glassStatus, (float)p[1].glassStatus,
+                                                   (float)p[2].glassStatus, (float)p[3].glassStatus), zero);
+        __m128 gx = _mm_and_ps(visible, GATHER(glassPosition.x));
+        __m128 gy = _mm_and_ps(visible, GATHER(glassPosition.y));
+        __m128 gz = _mm_or_ps(_mm_and_ps(visible, GATHER(glassPosition.z)),
+                              _mm_andnot_ps(visible, _mm_set1_ps(-DEFAULT_EYE_DISTANCE)));
+        __m128 qx = _mm_and_ps(visible, GATHER(glassRotation.x));
+        __m128 qy = _mm_and_ps(visible, GATHER(glassRotation.y));
+        __m128 qz = _mm_and_ps(visible, GATHER(glassRotation.z));
+        __m128 qw = _mm_or_ps(_mm_and_ps(visible, GATHER(glassRotation.w)), _mm_andnot_ps(visible, one));
+        __m128 px = GATHER(penPosition.x);
+        __m128 py = GATHER(penPosition.y);
+        __m128 pz = GATHER(penPosition.z);
+        __m128 dx = GATHER(penDirection.x);
+        __m128 dy = GATHER(penDirection.y);
+        __m128 dz = GATHER(penDirection.z);
+#undef GATHER
+
+        __m128 ax = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(qy, qy), _mm_mul_ps(qz, qz))));
+        __m128 ay = _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(qx, qy), _mm_mul_ps(qw, qz)));
+        __m128 az = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qx, qz), _mm_mul_ps(qw, qy)));
+
+        f3d::FrustumData* out = results + i;
+        for(int e = 0; e < 2; ++e)
+        {
+            __m128 eyeX = _mm_add_ps(gx, _mm_mul_ps(ax, sides[e]));
+            __m128 eyeY = _mm_add_ps(gy, _mm_mul_ps(ay, sides[e]));
+            __m128 eyeZ = _mm_add_ps(gz, _mm_mul_ps(az, sides[e]));
+
+            // view, the rows 0-2 of each column are moved by the eye
+            __m128 ex = _mm_mul_ps(eyeX, k);
+            __m128 ey = _mm_mul_ps(eyeY, k);
+            __m128 ez = _mm_mul_ps(s, _mm_add_ps(d, _mm_mul_ps(eyeZ, k)));
+            __m128 t0 = _mm_xor_ps(ex, signBit);
+            __m128 t1 = _mm_xor_ps(ey, signBit);
+            __m128 t2 = _mm_xor_ps(ez, signBit);
+            for(int c = 0; c < 4; ++c)
+            {
+                __m128 bottom = _mm_set1_ps(v[c * 4 + 3]);
+                __m128 x = _mm_add_ps(_mm_set1_ps(v[c * 4 + 0]), _mm_mul_ps(bottom, t0));
+                __m128 y = _mm_add_ps(_mm_set1_ps(v[c * 4 + 1]), _mm_mul_ps(bottom, t1));
+                __m128 z = _mm_add_ps(_mm_set1_ps(v[c * 4 + 2]), _mm_mul_ps(bottom, t2));
+                __m128 wv = bottom;
+                _MM_TRANSPOSE4_PS(x, y, z, wv);     // one column per pose
+                _mm_storeu_ps((e ? out[0].matViewR.m : out[0].matViewL.m) + c * 4, x);
+                _mm_storeu_ps((e ? out[1].matViewR.m : out[1].matViewL.m) + c * 4, y);
+                _mm_storeu_ps((e ? out[2].matViewR.m : out[2].matViewL.m) + c * 4, z);
+                _mm_storeu_ps((e ? out[3].matViewR.m : out[3].matViewL.m) + c * 4, wv);
+            }
+
+            // projection, only m0 m5 m8 m9 depend on the eye
+            __m128 distance = _mm_max_ps(_mm_mul_ps(_mm_xor_ps(eyeZ, signBit), k), minDistance);
+            __m128 ratio = _mm_div_ps(n, distance);
+            __m128 l = _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(hw, signBit), ex), ratio);
+            __m128 rr = _mm_mul_ps(_mm_sub_ps(hw, ex), ratio);
+            __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(hh, signBit), ey), ratio);
+            __m128 tt = _mm_mul_ps(_mm_sub_ps(hh, ey), ratio);
+            __m128 width = _mm_sub_ps(rr, l);
+            __m128 height = _mm_sub_ps(tt, b);
+            __m128 m0 = _mm_div_ps(n2, width);
+            __m128 m5 = _mm_div_ps(n2, height);
+            __m128 m8 = _mm_xor_ps(_mm_div_ps(_mm_add_ps(rr, l), width), flip);
+            __m128 m9 = _mm_xor_ps(_mm_div_ps(_mm_add_ps(tt, b), height), flip);
+            __m128 m10 = _mm_set1_ps(projection[10]);
+            __m128 m11 = _mm_set1_ps(projection[11]);
+            _MM_TRANSPOSE4_PS(m8, m9, m10, m11);
+            float m0s[4], m5s[4];
+            _mm_storeu_ps(m0s, m0);
+            _mm_storeu_ps(m5s, m5);
+            __m128 columns[4] = { m8, m9, m10, m11 };
+            for(int lane = 0; lane < 4; ++lane)
+            {
+                float* m = e ? out[lane].matProjectionR.m : out[lane].matProjectionL.m;
+                memcpy(m, projection, sizeof(projection));
+                m[0] = m0s[lane];
+                m[5] = m5s[lane];
+                _mm_storeu_ps(m + 8, columns[lane]);
+            }
+        }
+
+        // pen
+        __m128 cx = _mm_mul_ps(px, k);
+        __m128 cy = _mm_mul_ps(py, k);
+        __m128 cz = _mm_mul_ps(s, _mm_add_ps(d, _mm_mul_ps(pz, k)));
+        __m128 ux = dx;
+        __m128 uy = dy;
+        __m128 uz = _mm_mul_ps(s, _mm_xor_ps(dz, signBit));
+        float pen[6][4];
+        for(int row = 0; row < 3; ++row)
+        {
+            __m128 position = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(w[row]), cx),
+                                                               _mm_mul_ps(_mm_set1_ps(w[4 + row]), cy)),
+                                                    _mm_mul_ps(_mm_set1_ps(w[8 + row]), cz)),
+                                         _mm_set1_ps(w[12 + row]));
+            __m128 direction = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[row]), ux),
+                                                     _mm_mul_ps(_mm_set1_ps(r[3 + row]), uy)),
+                                          _mm_mul_ps(_mm_set1_ps(r[6 + row]), uz));
+            _mm_storeu_ps(pen[row], position);
+            _mm_storeu_ps(pen[3 + row], direction);
+        }
+        for(int lane = 0; lane < 4; ++lane)
+        {
+            out[lane].penPosition.x = pen[0][lane];
+            out[lane].penPosition.y = pen[1][lane];
+            out[lane].penPosition.z = pen[2][lane];
+            out[lane].penDirection.x = pen[3][lane];
+            out[lane].penDirection.y = pen[4][lane];
+            out[lane].penDirection.z = pen[5][lane];
+        }
+    }
+#endif
+
+    for(; i < count; ++i)
+        solve(poses[i], results[i]);
+    return true;
+}
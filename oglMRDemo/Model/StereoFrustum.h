@@ -0,0 +1,70 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoFrustum.h
+// ===============
+// In-tree version of fmModifyFrustum(): eye view matrices, asymmetric
+// (off-axis) projections and the pen ray for a tracked pose, computed with
+// Math/Matrices.h instead of the binary-only DLL. Unlike the DLL, it uses the
+// pose it is given (latched, predicted or filtered) instead of reading
+// FSCore again, and it can be profiled and vectorized.
+//
+// The imaginary screen is a rectangle of screenHeight x (screenHeight *
+// aspect) in camera space, centered screenDistance in front of the original
+// camera; aspect, near and far come from the original projection. The
+// physical screen of the device (meters) is mapped onto it with the k-scale
+// k = screenHeight / physicalHeight, for the eyes and for the pen. Each eye
+// is the glasses position moved half the pupil distance along the glasses x
+// axis; without glasses the eyes are 0.5 m in front of the screen center.
+// Left-handed cameras (isLeftHanded) look down +z.
+//
+// solve() is the scalar reference. solveBatch() solves N poses at once (N
+// viewers or N candidate poses of one viewer) on the same screen, 4 poses
+// per SSE pass, with the same operations in the same order.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STEREO_FRUSTUM_H
+#define STEREO_FRUSTUM_H
+
+#include "../Math/Matrices.h"
+#include "../FCore/FSCore.h"
+#include "../Tracking/TrackingPose.h"
+
+class StereoFrustum
+{
+public:
+    StereoFrustum();
+
+    // same inputs as fmModifyFrustum(), false if the projection is not a perspective one
+    bool set(const Matrix4& view, const Matrix4& projection,
+             float screenDistance, float screenHeight, float pupilDistance, bool isLeftHanded);
+    bool isValid() const                            { return valid; }
+
+    // height of the device screen in meters, used from the next set()
+    void setPhysicalScreenHeight(float height);
+    float getPhysicalScreenHeight() const           { return physicalHeight; }
+    float getScale() const                          { return scale; }   // k, world unit per meter
+
+    // glasses and pen of pose -> eye matrices and pen ray, false if set() failed
+    bool solve(const TrackingPose& pose, f3d::FrustumData& data) const;
+    bool solveBatch(const TrackingPose* poses, int count, f3d::FrustumData* results) const;
+
+private:
+    Matrix4 view;
+    Matrix4 inverseView;
+    Matrix3 inverseRotation;
+    float nearPlane;
+    float farPlane;
+    float halfWidth;
+    float halfHeight;
+    float depth;                                    // screen distance in camera space
+    float zSign;                                    // direction into the screen in camera space
+    float pupilDistance;
+    float physicalHeight;
+    float scale;
+    bool isLeftHanded;
+    bool valid;
+};
+
+#endif
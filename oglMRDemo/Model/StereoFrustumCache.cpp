@@ -0,0 +1,105 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoFrustumCache.cpp
+// ======================
+// Cache of the last StereoFrustum::solve() result.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "StereoFrustumCache.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+StereoFrustumCache::StereoFrustumCache() : screenDistance(0), screenHeight(0), pupilDistance(0),
+                                           isLeftHanded(false), solverValid(false), valid(false),
+                                           hitCount(0), missCount(0)
+{
+    memset(&sample, 0, sizeof(sample));
+    memset(&data, 0, sizeof(data));
+}
+
+StereoFrustumCache::~StereoFrustumCache()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return cached frustum data if all inputs are same as the last call,
+// otherwise solve the pose again, with the solver set again if needed
+///////////////////////////////////////////////////////////////////////////////
+const f3d::FrustumData& StereoFrustumCache::get(const Matrix4& view, const Matrix4& projection,
+                                                float screenDistance, float screenHeight,
+                                                float pupilDistance, bool isLeftHanded,
+                                                const TrackingPose& pose)
+{
+    if(!solverValid ||
+       this->view != view || this->projection != projection ||
+       this->screenDistance != screenDistance || this->screenHeight != screenHeight ||
+       this->pupilDistance != pupilDistance || this->isLeftHanded != isLeftHanded)
+    {
+        this->view = view;
+        this->projection = projection;
+        this->screenDistance = screenDistance;
+        this->screenHeight = screenHeight;
+        this->pupilDistance = pupilDistance;
+        this->isLeftHanded = isLeftHanded;
+        solver.set(view, projection, screenDistance, screenHeight, pupilDistance, isLeftHanded);
+        solverValid = true;
+        valid = false;
+    }
+
+    TrackingSample sample = getTrackingSample(pose);
+    if(valid && isEqual(this->sample, sample))
+    {
+        ++hitCount;
+        return data;
+    }
+
+    this->sample = sample;
+    if(!solver.solve(pose, data))
+        memset(&data, 0, sizeof(data));     // not a perspective projection
+
+    valid = true;
+    ++missCount;
+    return data;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy the pose values used by StereoFrustum::solve()
+///////////////////////////////////////////////////////////////////////////////
+StereoFrustumCache::TrackingSample StereoFrustumCache::getTrackingSample(const TrackingPose& pose)
+{
+    TrackingSample sample;
+    sample.glassPosition = pose.glassPosition;
+    sample.glassRotation = pose.glassRotation;
+    sample.penPosition = pose.penPosition;
+    sample.penDirection = pose.penDirection;
+    sample.glassStatus = pose.glassStatus != 0;
+    return sample;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// exact compare, no epsilon
+///////////////////////////////////////////////////////////////////////////////
+bool StereoFrustumCache::isEqual(const TrackingSample& a, const TrackingSample& b)
+{
+    return a.glassPosition.x == b.glassPosition.x && a.glassPosition.y == b.glassPosition.y &&
+           a.glassPosition.z == b.glassPosition.z &&
+           a.glassRotation.x == b.glassRotation.x && a.glassRotation.y == b.glassRotation.y &&
+           a.glassRotation.z == b.glassRotation.z && a.glassRotation.w == b.glassRotation.w &&
+           a.penPosition.x == b.penPosition.x && a.penPosition.y == b.penPosition.y &&
+           a.penPosition.z == b.penPosition.z &&
+           a.penDirection.x == b.penDirection.x && a.penDirection.y == b.penDirection.y &&
+           a.penDirection.z == b.penDirection.z &&
+           a.glassStatus == b.glassStatus;
+}
@@ -0,0 +1,80 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoFrustumCache.h
+// ====================
+// Cache of the last StereoFrustum::solve() result.
+// The solver is set again only when one of its inputs changed: the view and
+// projection matrices, screen distance/height, pupil distance or handedness.
+// The pose is solved again only when the solver changed or when one of the
+// pose values solve() reads changed: glasses pose and status, pen position
+// and direction. Otherwise the cached f3d::FrustumData is returned as is.
+//
+// The result is a pure function of the inputs of get(). Nothing is read back
+// from GL and nothing is read from FSCore, so a predicted, filtered or
+// replayed pose gives exactly the eye matrices and pen ray of that pose.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STEREO_FRUSTUM_CACHE_H
+#define STEREO_FRUSTUM_CACHE_H
+
+#include "../Math/Matrices.h"
+#include "../FCore/FSCore.h"
+#include "../Tracking/TrackingPose.h"
+#include "StereoFrustum.h"
+
+class StereoFrustumCache
+{
+public:
+    StereoFrustumCache();
+    ~StereoFrustumCache();
+
+    // return the frustum data of the inputs and the pose
+    const f3d::FrustumData& get(const Matrix4& view, const Matrix4& projection,
+                                float screenDistance, float screenHeight,
+                                float pupilDistance, bool isLeftHanded,
+                                const TrackingPose& pose);
+
+    void invalidate()                       { valid = false; solverValid = false; }
+
+    // solver of the last get(), for the other poses of the same screen
+    const StereoFrustum& getSolver() const  { return solver; }
+
+    int getHitCount() const                 { return hitCount; }
+    int getMissCount() const                { return missCount; }
+
+private:
+    // pose values read by StereoFrustum::solve()
+    struct TrackingSample
+    {
+        f3d::Vector3 glassPosition;
+        f3d::Quaternion glassRotation;
+        f3d::Vector3 penPosition;
+        f3d::Vector3 penDirection;
+        bool glassStatus;
+    };
+
+    static TrackingSample getTrackingSample(const TrackingPose& pose);
+    static bool isEqual(const TrackingSample& a, const TrackingSample& b);
+
+    // key of the solver
+    Matrix4 view;
+    Matrix4 projection;
+    float screenDistance;
+    float screenHeight;
+    float pupilDistance;
+    bool isLeftHanded;
+    bool solverValid;
+    StereoFrustum solver;
+
+    // key of cached data
+    TrackingSample sample;
+    bool valid;
+    f3d::FrustumData data;
+
+    int hitCount;
+    int missCount;
+};
+
+#endif
@@ -0,0 +1,273 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoReprojector.cpp
+// =====================
+// CPU reprojection (timewarp) of the last stereo frame to a newer pose.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "StereoReprojector.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define REPROJECT_SSE2
+#include <emmintrin.h>
+#endif
+
+const int TILE_ROWS = 16;               // rows per work item of a thread
+const int ITERATIONS = 3;               // fixed-point iterations to find the source pixel
+const float MIN_W = 1e-5f;              // avoid division by 0 behind the eye
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+StereoReprojector::StereoReprojector() : width(0), height(0), threadCount(0), sourceReady(false), lastWarpTime(0)
+{
+    setThreadCount(0);
+    for(int i = 0; i < EYE_COUNT; ++i)
+    {
+        eyes[i].x = eyes[i].width = 0;
+        eyes[i].sourceClip.identity();
+        eyes[i].warp.identity();
+    }
+}
+
+StereoReprojector::~StereoReprojector()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// number of threads for warp(), including the calling thread
+///////////////////////////////////////////////////////////////////////////////
+void StereoReprojector::setThreadCount(int count)
+{
+    if(count <= 0)
+        count = (int)std::thread::hardware_concurrency();
+    threadCount = count > 0 ? count : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// allocate source and output buffers
+///////////////////////////////////////////////////////////////////////////////
+void StereoReprojector::setSourceSize(int width, int height)
+{
+    if(width < 0) width = 0;
+    if(height < 0) height = 0;
+    if(this->width != width || this->height != height)
+    {
+        this->width = width;
+        this->height = height;
+        sourceColor.assign((size_t)width * height, 0);
+        sourceDepth.assign((size_t)width * height, 1.0f);
+        outputColor.assign((size_t)width * height, 0);
+    }
+    sourceReady = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set eye rect and matrices the source frame was rendered with
+// The source is ready once the right eye is set.
+///////////////////////////////////////////////////////////////////////////////
+void StereoReprojector::setSourceEye(int eye, int x, int eyeWidth, const Matrix4& view, const Matrix4& projection)
+{
+    if(eye < 0 || eye >= EYE_COUNT)
+        return;
+
+    eyes[eye].x = x;
+    eyes[eye].width = eyeWidth;
+    eyes[eye].sourceClip = projection * view;
+    sourceReady = (eye == EYE_RIGHT) && width > 0 && height > 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// warp both eyes to the new matrices
+// Rows of both eyes are split into tiles, and the threads take tiles until
+// all are done.
+///////////////////////////////////////////////////////////////////////////////
+bool StereoReprojector::warp(const Matrix4& viewL, const Matrix4& projectionL,
+                             const Matrix4& viewR, const Matrix4& projectionR)
+{
+    if(!sourceReady)
+        return false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // W = (P' * V') * inverse(P * V), maps source NDC to target clip space
+    Matrix4 inverseL = eyes[EYE_LEFT].sourceClip;
+    Matrix4 inverseR = eyes[EYE_RIGHT].sourceClip;
+    eyes[EYE_LEFT].warp = projectionL * viewL * inverseL.invertGeneral();
+    eyes[EYE_RIGHT].warp = projectionR * viewR * inverseR.invertGeneral();
+
+    int tilesPerEye = (height + TILE_ROWS - 1) / TILE_ROWS;
+    int tileCount = tilesPerEye * EYE_COUNT;
+    std::atomic<int> nextTile(0);
+
+    auto worker = [&]()
+    {
+        int tile;
+        while((tile = nextTile.fetch_add(1)) < tileCount)
+        {
+            int eye = tile / tilesPerEye;
+            int y0 = (tile % tilesPerEye) * TILE_ROWS;
+            int y1 = y0 + TILE_ROWS < height ? y0 + TILE_ROWS : height;
+            warpRows(eye, y0, y1);
+        }
+    };
+
+    int count = threadCount < tileCount ? threadCount : tileCount;
+    std::vector<std::thread> threads;
+    for(int i = 1; i < count; ++i)
+        threads.push_back(std::thread(worker));
+    worker();
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    lastWarpTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// warp time of the last frame per 1M pixels
+///////////////////////////////////////////////////////////////////////////////
+double StereoReprojector::getWarpTimePerMegapixel() const
+{
+    double pixels = (double)(eyes[EYE_LEFT].width + eyes[EYE_RIGHT].width) * height;
+    if(pixels <= 0)
+        return 0;
+    return lastWarpTime * 1000000.0 / pixels;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// reprojection kernel
+// For output pixel t, find source pixel s with warp(s, depth(s)) == t:
+//     s0 = t
+//     s' = s + (t - project(W * (s, depth(s), 1)))
+// Pixels outside of the eye rect are clamped to its edge.
+///////////////////////////////////////////////////////////////////////////////
+void StereoReprojector::warpRows(int eye, int y0, int y1)
+{
+    const Eye& e = eyes[eye];
+    if(e.width <= 0)
+        return;
+
+    const float* w = e.warp.get();              // column-major
+    const float toNdcX = 2.0f / e.width;
+    const float toNdcY = 2.0f / height;
+    const float toPixelX = e.width * 0.5f;
+    const float toPixelY = height * 0.5f;
+    const int maxX = e.width - 1;
+    const int maxY = height - 1;
+    const float* depth = &sourceDepth[0];
+    const unsigned int* color = &sourceColor[0];
+
+    for(int y = y0; y < y1; ++y)
+    {
+        unsigned int* out = &outputColor[(size_t)y * width + e.x];
+        float ty = (y + 0.5f) * toNdcY - 1.0f;
+        int x = 0;
+
+#ifdef REPROJECT_SSE2
+        const __m128 w0 = _mm_set1_ps(w[0]),  w1 = _mm_set1_ps(w[1]),  w3 = _mm_set1_ps(w[3]);
+        const __m128 w4 = _mm_set1_ps(w[4]),  w5 = _mm_set1_ps(w[5]),  w7 = _mm_set1_ps(w[7]);
+        const __m128 w8 = _mm_set1_ps(w[8]),  w9 = _mm_set1_ps(w[9]),  w11 = _mm_set1_ps(w[11]);
+        const __m128 w12 = _mm_set1_ps(w[12]), w13 = _mm_set1_ps(w[13]), w15 = _mm_set1_ps(w[15]);
+        const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), minW = _mm_set1_ps(MIN_W);
+        const __m128 pixX = _mm_set1_ps(toPixelX), pixY = _mm_set1_ps(toPixelY);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i limX = _mm_set1_epi32(maxX), limY = _mm_set1_epi32(maxY);
+        const __m128 tyv = _mm_set1_ps(ty);
+        int idx[4], px[4], py[4];
+
+        for(; x + 4 <= e.width; x += 4)
+        {
+            __m128 txv = _mm_setr_ps(x + 0.5f, x + 1.5f, x + 2.5f, x + 3.5f);
+            txv = _mm_sub_ps(_mm_mul_ps(txv, _mm_set1_ps(toNdcX)), one);
+            __m128 sx = txv, sy = tyv;
+            __m128i ix, iy;
+
+            for(int i = 0; i <= ITERATIONS; ++i)
+            {
+                // nearest source pixel, clamped to the eye rect
+                ix = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(sx, one), pixX));
+                iy = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(sy, one), pixY));
+                ix = _mm_and_si128(ix, _mm_cmpgt_epi32(ix, zero));          // max(ix, 0)
+                iy = _mm_and_si128(iy, _mm_cmpgt_epi32(iy, zero));
+                __m128i gx = _mm_cmpgt_epi32(ix, limX);                     // min(ix, maxX)
+                __m128i gy = _mm_cmpgt_epi32(iy, limY);
+                ix = _mm_or_si128(_mm_andnot_si128(gx, ix), _mm_and_si128(gx, limX));
+                iy = _mm_or_si128(_mm_andnot_si128(gy, iy), _mm_and_si128(gy, limY));
+                if(i == ITERATIONS)
+                    break;
+
+                // gather depth, window depth [0,1] -> NDC [-1,1]
+                _mm_storeu_si128((__m128i*)px, ix);
+                _mm_storeu_si128((__m128i*)py, iy);
+                for(int j = 0; j < 4; ++j)
+                    idx[j] = py[j] * width + e.x + px[j];
+                __m128 sz = _mm_setr_ps(depth[idx[0]], depth[idx[1]], depth[idx[2]], depth[idx[3]]);
+                sz = _mm_sub_ps(_mm_mul_ps(sz, two), one);
+
+                // project with W
+                __m128 qx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, sx), _mm_mul_ps(w4, sy)), _mm_add_ps(_mm_mul_ps(w8, sz), w12));
+                __m128 qy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w1, sx), _mm_mul_ps(w5, sy)), _mm_add_ps(_mm_mul_ps(w9, sz), w13));
+                __m128 qw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w3, sx), _mm_mul_ps(w7, sy)), _mm_add_ps(_mm_mul_ps(w11, sz), w15));
+                __m128 invW = _mm_div_ps(one, _mm_max_ps(qw, minW));
+
+                // move the source by the error in the target
+                sx = _mm_add_ps(sx, _mm_sub_ps(txv, _mm_mul_ps(qx, invW)));
+                sy = _mm_add_ps(sy, _mm_sub_ps(tyv, _mm_mul_ps(qy, invW)));
+            }
+
+            _mm_storeu_si128((__m128i*)px, ix);
+            _mm_storeu_si128((__m128i*)py, iy);
+            for(int j = 0; j < 4; ++j)
+                out[x + j] = color[py[j] * width + e.x + px[j]];
+        }
+#endif
+
+        // scalar path for the rest of the row
+        for(; x < e.width; ++x)
+        {
+            float tx = (x + 0.5f) * toNdcX - 1.0f;
+            float sx = tx, sy = ty;
+            int ix = 0, iy = 0;
+
+            for(int i = 0; i <= ITERATIONS; ++i)
+            {
+                ix = (int)((sx + 1.0f) * toPixelX);
+                iy = (int)((sy + 1.0f) * toPixelY);
+                ix = ix < 0 ? 0 : (ix > maxX ? maxX : ix);
+                iy = iy < 0 ? 0 : (iy > maxY ? maxY : iy);
+                if(i == ITERATIONS)
+                    break;
+
+                float sz = depth[iy * width + e.x + ix] * 2.0f - 1.0f;
+                float qx = w[0] * sx + w[4] * sy + w[8] * sz + w[12];
+                float qy = w[1] * sx + w[5] * sy + w[9] * sz + w[13];
+                float qw = w[3] * sx + w[7] * sy + w[11] * sz + w[15];
+                float invW = 1.0f / (qw > MIN_W ? qw : MIN_W);
+                sx += tx - qx * invW;
+                sy += ty - qy * invW;
+            }
+
+            out[x] = color[iy * width + e.x + ix];
+        }
+    }
+}
@@ -0,0 +1,81 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StereoReprojector.h
+// ===================
+// CPU reprojection (timewarp) of the last stereo frame to a newer pose.
+// When a frame misses its deadline, the last rendered left/right images are
+// warped to the eye matrices of a fresher tracking pose and presented instead
+// of stale parallax.
+//
+// The source is a whole side-by-side frame (RGBA8 color and window depth in
+// [0,1], bottom-up rows as glReadPixels() returns) with the view/projection
+// it was rendered with. For each output pixel, the source pixel is found by a
+// few fixed-point iterations through the depth buffer (backward warp), so each
+// output pixel is written once and rows can be warped in parallel. 4 pixels
+// are processed at a time with SSE2 where available.
+//
+// It only works on memory buffers, no GL call is made here, so it runs and
+// can be checked without a GPU.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STEREO_REPROJECTOR_H
+#define STEREO_REPROJECTOR_H
+
+#include <vector>
+#include "../Math/Matrices.h"
+
+class StereoReprojector
+{
+public:
+    enum { EYE_LEFT = 0, EYE_RIGHT = 1, EYE_COUNT = 2 };
+
+    StereoReprojector();
+    ~StereoReprojector();
+
+    void setThreadCount(int count);                 // 0: hardware concurrency
+    int getThreadCount() const                      { return threadCount; }
+
+    // source frame, call setSourceSize() first then fill the buffers
+    void setSourceSize(int width, int height);      // reallocate buffers if the size changed
+    int getWidth() const                            { return width; }
+    int getHeight() const                           { return height; }
+    unsigned int* getSourceColor()                  { return sourceColor.empty() ? 0 : &sourceColor[0]; }
+    float* getSourceDepth()                         { return sourceDepth.empty() ? 0 : &sourceDepth[0]; }
+    void setSourceEye(int eye, int x, int eyeWidth, const Matrix4& view, const Matrix4& projection);
+    bool isSourceReady() const                      { return sourceReady; }
+    void invalidateSource()                         { sourceReady = false; }
+
+    // warp the source frame to the new eye matrices, the result is in getOutputColor()
+    bool warp(const Matrix4& viewL, const Matrix4& projectionL,
+              const Matrix4& viewR, const Matrix4& projectionR);
+    const unsigned int* getOutputColor() const      { return outputColor.empty() ? 0 : &outputColor[0]; }
+
+    // time of the last warp() in millisecond, and normalized per megapixel
+    double getLastWarpTime() const                  { return lastWarpTime; }
+    double getWarpTimePerMegapixel() const;
+
+private:
+    struct Eye
+    {
+        int x;                                      // left of eye rect in the frame
+        int width;
+        Matrix4 sourceClip;                         // projection * view of the source
+        Matrix4 warp;                               // source NDC -> target clip
+    };
+
+    void warpRows(int eye, int y0, int y1);         // kernel, warp rows [y0, y1) of one eye
+
+    int width;
+    int height;
+    int threadCount;
+    bool sourceReady;
+    std::vector<unsigned int> sourceColor;
+    std::vector<float> sourceDepth;
+    std::vector<unsigned int> outputColor;
+    Eye eyes[EYE_COUNT];
+    double lastWarpTime;
+};
+
+#endif
@@ -0,0 +1,170 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokeGrid.cpp
+// ==============
+// Hash grid of line segments for picking and erasing strokes.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include "StrokeGrid.h"
+
+const float MIN_CELL_SIZE = 0.0001f;
+const int CELL_MASK = 0x1FFFFF;                     // 21 bits per axis in a key
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+StrokeGrid::StrokeGrid(float cellSize) : references(0)
+{
+    setCellSize(cellSize);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// cells of a different size hold different items, so they are dropped
+///////////////////////////////////////////////////////////////////////////////
+void StrokeGrid::setCellSize(float size)
+{
+    cellSize = size > MIN_CELL_SIZE ? size : MIN_CELL_SIZE;
+    invCellSize = 1.0f / cellSize;
+    clear();
+}
+
+void StrokeGrid::clear()
+{
+    cells.clear();
+    references = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add an item to the cells along a-b
+///////////////////////////////////////////////////////////////////////////////
+void StrokeGrid::insert(const Vector3& a, const Vector3& b, uint32_t item)
+{
+    walk(a, b, [this, item](uint64_t key)
+    {
+        std::vector<uint32_t>& items = cells[key];
+        if(items.empty() || items.back() != item)   // already added by the previous step
+        {
+            items.push_back(item);
+            ++references;
+        }
+    });
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// remove an item inserted with the same end points, empty cells are freed
+///////////////////////////////////////////////////////////////////////////////
+void StrokeGrid::remove(const Vector3& a, const Vector3& b, uint32_t item)
+{
+    walk(a, b, [this, item](uint64_t key)
+    {
+        CellMap::iterator it = cells.find(key);
+        if(it == cells.end())
+            return;
+
+        std::vector<uint32_t>& items = it->second;
+        std::vector<uint32_t>::iterator found = std::find(items.begin(), items.end(), item);
+        if(found == items.end())
+            return;
+
+        *found = items.back();                      // order does not matter
+        items.pop_back();
+        --references;
+        if(items.empty())
+            cells.erase(it);
+    });
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// items of all cells overlapping the box
+///////////////////////////////////////////////////////////////////////////////
+void StrokeGrid::query(const Vector3& min, const Vector3& max, std::vector<uint32_t>& items) const
+{
+    int x0 = toCell(min.x), x1 = toCell(max.x);
+    int y0 = toCell(min.y), y1 = toCell(max.y);
+    int z0 = toCell(min.z), z1 = toCell(max.z);
+
+    for(int x = x0; x <= x1; ++x)
+    {
+        for(int y = y0; y <= y1; ++y)
+        {
+            for(int z = z0; z <= z1; ++z)
+            {
+                CellMap::const_iterator it = cells.find(toKey(x, y, z));
+                if(it != cells.end())
+                    items.insert(items.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// buckets, nodes and item arrays of the map
+///////////////////////////////////////////////////////////////////////////////
+size_t StrokeGrid::getMemoryUsage() const
+{
+    size_t bytes = cells.bucket_count() * sizeof(void*);
+    bytes += cells.size() * (sizeof(CellMap::value_type) + sizeof(void*) * 2);
+    for(CellMap::const_iterator it = cells.begin(); it != cells.end(); ++it)
+        bytes += it->second.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// visit the keys of the cells along a-b
+// The segment is cut into steps no longer than a cell, and the cells of the
+// bounding box of each step are visited, at most 8 per step. A cell may be
+// visited by 2 consecutive steps.
+///////////////////////////////////////////////////////////////////////////////
+template<class Visit>
+void StrokeGrid::walk(const Vector3& a, const Vector3& b, Visit visit)
+{
+    Vector3 delta = b - a;
+    int steps = (int)(delta.length() * invCellSize) + 1;
+    Vector3 step = delta / (float)steps;
+
+    Vector3 start = a;
+    for(int i = 0; i < steps; ++i)
+    {
+        Vector3 end = (i == steps - 1) ? b : start + step;
+        int x0 = toCell(std::min(start.x, end.x)), x1 = toCell(std::max(start.x, end.x));
+        int y0 = toCell(std::min(start.y, end.y)), y1 = toCell(std::max(start.y, end.y));
+        int z0 = toCell(std::min(start.z, end.z)), z1 = toCell(std::max(start.z, end.z));
+
+        for(int x = x0; x <= x1; ++x)
+            for(int y = y0; y <= y1; ++y)
+                for(int z = z0; z <= z1; ++z)
+                    visit(toKey(x, y, z));
+
+        start = end;
+    }
+}
+
+
+
+int StrokeGrid::toCell(float value) const
+{
+    return (int)floorf(value * invCellSize);
+}
+
+uint64_t StrokeGrid::toKey(int x, int y, int z)
+{
+    return ((uint64_t)(x & CELL_MASK) << 42) | ((uint64_t)(y & CELL_MASK) << 21) | (uint64_t)(z & CELL_MASK);
+}
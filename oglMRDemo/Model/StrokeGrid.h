@@ -0,0 +1,57 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokeGrid.h
+// ============
+// Hash grid of line segments for picking and erasing strokes.
+//
+// Space is cut into cubes of cellSize. Only cubes holding something exist,
+// they are found by hashing their integer coordinates, so the grid has no
+// bounds and costs nothing where nothing is drawn. A segment is stored as a
+// 32-bit item in every cube it passes through. The grid does not keep the
+// geometry: insert() and remove() need the same end points, and query()
+// returns the items of the cubes overlapping a box, which the caller tests
+// exactly. An item may be returned more than once.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STROKE_GRID_H
+#define STROKE_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "../Math/Vectors.h"
+
+class StrokeGrid
+{
+public:
+    explicit StrokeGrid(float cellSize = 0.2f);
+
+    void setCellSize(float size);                   // also removes all items
+    float getCellSize() const                       { return cellSize; }
+    void clear();
+
+    void insert(const Vector3& a, const Vector3& b, uint32_t item);
+    void remove(const Vector3& a, const Vector3& b, uint32_t item);
+    void query(const Vector3& min, const Vector3& max, std::vector<uint32_t>& items) const;  // appended to items
+
+    // stats
+    int getCellCount() const                        { return (int)cells.size(); }
+    int64_t getReferenceCount() const               { return references; }
+    size_t getMemoryUsage() const;                  // approximate heap bytes
+
+private:
+    typedef std::unordered_map<uint64_t, std::vector<uint32_t> > CellMap;
+
+    template<class Visit> void walk(const Vector3& a, const Vector3& b, Visit visit);
+    int toCell(float value) const;
+    static uint64_t toKey(int x, int y, int z);
+
+    CellMap cells;
+    float cellSize;
+    float invCellSize;
+    int64_t references;                             // items in all cells
+};
+
+#endif
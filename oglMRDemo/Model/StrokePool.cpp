@@ -0,0 +1,540 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokePool.cpp
+// ==============
+// 3D strokes drawn with the pen, stored as ribbon vertices ready for GL.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include "StrokePool.h"
+
+const float DEFAULT_RIBBON_WIDTH = 0.1f;
+const float DEFAULT_MIN_DISTANCE = 0.01f;
+const float DEFAULT_TOLERANCE = 0.005f;
+const float DEFAULT_CELL_SIZE = 0.2f;            // 2 ribbon widths
+const float EPSILON = 0.000001f;
+
+// squared distance from p to the segment a-b
+static float segmentDistance2(const Vector3& p, const Vector3& a, const Vector3& b)
+{
+    Vector3 ab = b - a;
+    float length2 = ab.dot(ab);
+    float t = length2 > 0 ? (p - a).dot(ab) / length2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    Vector3 d = p - (a + ab * t);
+    return d.dot(d);
+}
+
+// piece of a stroke in a chunk, pieces are sorted by stroke id
+static bool pieceLess(const StrokePool::Piece& piece, int stroke)
+{
+    return piece.stroke < stroke;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+StrokePool::StrokePool(int maxChunks) : current(-1), grid(DEFAULT_CELL_SIZE),
+                                        stroking(false), strokeId(-1), strokePoints(0), hasSide(false),
+                                        ribbonWidth(DEFAULT_RIBBON_WIDTH), minDistance(DEFAULT_MIN_DISTANCE),
+                                        tolerance(DEFAULT_TOLERANCE), nextStrokeId(0),
+                                        strokeCount(0), pointCount(0), sampleCount(0), recycledChunks(0)
+{
+    setMaxChunks(maxChunks);
+    color[0] = color[1] = color[2] = color[3] = 255;
+    window.reserve(SIMPLIFY_WINDOW);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// remove all strokes, the chunks are kept to be refilled
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::clear()
+{
+    for(size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].vertices.clear();
+        chunks[i].pieces.clear();
+        chunks[i].strokesStarted = 0;
+        ++chunks[i].generation;
+    }
+    grid.clear();
+    window.clear();
+    current = chunks.empty() ? -1 : 0;
+    stroking = false;
+    strokeCount = 0;
+    pointCount = 0;
+    sampleCount = 0;
+}
+
+void StrokePool::setMaxChunks(int count)
+{
+    maxChunks = count > 0 ? (count < MAX_CHUNKS ? count : MAX_CHUNKS) : 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// new cell size, all segments are put in the grid again
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::setCellSize(float size)
+{
+    grid.setCellSize(size);
+    for(int i = 0; i < (int)chunks.size(); ++i)
+    {
+        for(size_t j = 0; j < chunks[i].pieces.size(); ++j)
+        {
+            if(!chunks[i].pieces[j].erased)
+                indexPiece(i, chunks[i].pieces[j], true);
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// start a stroke, it gets vertices from its 2nd point on
+///////////////////////////////////////////////////////////////////////////////
+int StrokePool::beginStroke(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+{
+    if(stroking)
+        endStroke();
+
+    stroking = true;
+    strokeId = nextStrokeId++;
+    strokePoints = 0;
+    hasSide = false;
+    window.clear();
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+    color[3] = a;
+    return strokeId;
+}
+
+void StrokePool::endStroke()
+{
+    // the pending sample ends the stroke
+    if(stroking && !window.empty())
+        commitPoint(window.back(), pendingDirection);
+    window.clear();
+    stroking = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a nib sample to the current stroke
+// The last sample of the window is pending: it becomes a point of the stroke
+// only when a later sample cannot be reached by a straight segment that
+// passes within tolerance of all samples since the last point.
+///////////////////////////////////////////////////////////////////////////////
+bool StrokePool::addPoint(const Vector3& position, const Vector3& penDirection)
+{
+    if(!stroking)
+        return false;
+    ++sampleCount;
+
+    if(strokePoints == 0)
+    {
+        commitPoint(position, penDirection);
+        return true;
+    }
+
+    // radial distance
+    const Vector3& last = window.empty() ? lastPoint : window.back();
+    if((position - last).length() < minDistance)
+        return false;
+
+    if(tolerance <= 0)
+    {
+        commitPoint(position, penDirection);
+        return true;
+    }
+
+    if(!window.empty())
+    {
+        float tolerance2 = tolerance * tolerance;
+        bool fits = (int)window.size() < SIMPLIFY_WINDOW;
+        for(size_t i = 0; fits && i < window.size(); ++i)
+            fits = segmentDistance2(window[i], lastPoint, position) <= tolerance2;
+
+        if(!fits)
+        {
+            commitPoint(window.back(), pendingDirection);
+            window.clear();
+        }
+    }
+
+    window.push_back(position);
+    pendingDirection = penDirection;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a point to the ribbon
+// The ribbon direction of a point comes from the segment ending at it, so
+// the first point waits for the second one.
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::commitPoint(const Vector3& position, const Vector3& penDirection)
+{
+    if(strokePoints == 0)
+    {
+        lastPoint = position;
+        strokePoints = 1;
+        ++pointCount;
+        return;
+    }
+
+    Vector3 tangent = position - lastPoint;
+    if(tangent.length() <= EPSILON)
+        return;
+
+    Vector3 side = tangent.cross(penDirection);
+    float length = side.length();
+    if(length > EPSILON)
+    {
+        side /= length;
+    }
+    else if(hasSide)
+    {
+        side = lastSide;                            // drawing along the pen, keep the last side
+    }
+    else
+    {
+        // any direction perpendicular to the stroke
+        side = tangent.cross(fabs(tangent.y) < fabs(tangent.x) ? Vector3(0, 1, 0) : Vector3(1, 0, 0));
+        side.normalize();
+    }
+
+    Vector3 offset = side * (ribbonWidth * 0.5f);
+    if(strokePoints == 1)
+    {
+        appendPair(lastPoint - offset, lastPoint + offset, true);
+        ++strokeCount;
+    }
+    appendPair(position - offset, position + offset, false);
+
+    // the segment ends at the pair just added, the previous pair is in the same chunk
+    const Chunk& chunk = chunks[current];
+    int vertex = (int)chunk.vertices.size() - 2;
+    grid.insert(getCenter(chunk, vertex - 2), getCenter(chunk, vertex), toItem(current, vertex));
+
+    lastPoint = position;
+    lastSide = side;
+    hasSide = true;
+    ++strokePoints;
+    ++pointCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// append 2 vertices to the strip of the current chunk
+// The first pair of a stroke is joined to the previous stroke with 2
+// degenerate vertices. A stroke that does not fit continues in a new chunk
+// with its last pair repeated.
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::appendPair(const Vector3& left, const Vector3& right, bool firstPair)
+{
+    Chunk* chunk = current >= 0 ? &chunks[current] : 0;
+    size_t needed = firstPair && chunk && !chunk->vertices.empty() ? 4 : 2;
+    bool newPiece = firstPair;
+    bool continuing = false;
+
+    if(!chunk || chunk->vertices.size() + needed > (size_t)CHUNK_VERTICES)
+    {
+        StrokeVertex previous[2];
+        continuing = !firstPair && chunk && chunk->vertices.size() >= 2;
+        if(continuing)
+        {
+            previous[0] = chunk->vertices[chunk->vertices.size() - 2];
+            previous[1] = chunk->vertices[chunk->vertices.size() - 1];
+        }
+
+        chunk = &nextChunk();
+        if(continuing)
+        {
+            Piece piece = { strokeId, 0, 0, true, false };
+            chunk->pieces.push_back(piece);
+            chunk->vertices.push_back(previous[0]);
+            growBounds(*chunk, previous[0].position);
+            chunk->vertices.push_back(previous[1]);
+            growBounds(*chunk, previous[1].position);
+            newPiece = false;
+        }
+    }
+    else if(firstPair && !chunk->vertices.empty())
+    {
+        chunk->vertices.push_back(chunk->vertices.back());
+        pushVertex(*chunk, left);
+    }
+
+    if(newPiece)
+    {
+        Piece piece = { strokeId, (int)chunk->vertices.size(), 0, false, false };
+        chunk->pieces.push_back(piece);
+        ++chunk->strokesStarted;
+    }
+
+    pushVertex(*chunk, left);
+    pushVertex(*chunk, right);
+
+    Piece& piece = chunk->pieces.back();
+    piece.count = (int)chunk->vertices.size() - piece.first;
+}
+
+void StrokePool::pushVertex(Chunk& chunk, const Vector3& position)
+{
+    StrokeVertex vertex;
+    vertex.position[0] = position.x;
+    vertex.position[1] = position.y;
+    vertex.position[2] = position.z;
+    vertex.color[0] = color[0];
+    vertex.color[1] = color[1];
+    vertex.color[2] = color[2];
+    vertex.color[3] = color[3];
+    chunk.vertices.push_back(vertex);
+    growBounds(chunk, vertex.position);
+}
+
+void StrokePool::growBounds(Chunk& chunk, const float* position)
+{
+    for(int i = 0; i < 3; ++i)
+    {
+        if(chunk.vertices.size() == 1 || position[i] < chunk.boundsMin[i])
+            chunk.boundsMin[i] = position[i];
+        if(chunk.vertices.size() == 1 || position[i] > chunk.boundsMax[i])
+            chunk.boundsMax[i] = position[i];
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// next chunk of the ring, allocated until maxChunks, then the oldest is reused
+///////////////////////////////////////////////////////////////////////////////
+StrokePool::Chunk& StrokePool::nextChunk()
+{
+    int next = current + 1;
+    if(next >= maxChunks)
+    {
+        next = 0;
+
+        // maxChunks was lowered, drop the chunks past it
+        while((int)chunks.size() > maxChunks)
+        {
+            recycleChunk((int)chunks.size() - 1);
+            chunks.pop_back();
+        }
+    }
+
+    if(next >= (int)chunks.size())
+    {
+        // grow, the vertices of a chunk are never reallocated, its reserve is never exceeded
+        chunks.resize(next + 1);
+        Chunk& chunk = chunks[next];
+        chunk.vertices.reserve(CHUNK_VERTICES);
+        chunk.generation = 0;
+        chunk.strokesStarted = 0;
+    }
+    else if(!chunks[next].vertices.empty())
+    {
+        recycleChunk(next);
+    }
+
+    current = next;
+    return chunks[current];
+}
+
+void StrokePool::recycleChunk(int index)
+{
+    Chunk& chunk = chunks[index];
+    for(size_t i = 0; i < chunk.pieces.size(); ++i)
+    {
+        if(!chunk.pieces[i].erased)
+            indexPiece(index, chunk.pieces[i], false);
+    }
+
+    strokeCount -= chunk.strokesStarted;
+    chunk.vertices.clear();
+    chunk.pieces.clear();
+    chunk.strokesStarted = 0;
+    ++chunk.generation;
+    ++recycledChunks;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// nearest stroke within radius of the ribbon edge
+///////////////////////////////////////////////////////////////////////////////
+int StrokePool::pickStroke(const Vector3& position, float radius, float* distance)
+{
+    float reach = radius + ribbonWidth * 0.5f;
+    Vector3 extent(reach, reach, reach);
+
+    found.clear();
+    grid.query(position - extent, position + extent, found);
+
+    int nearestChunk = -1, nearestVertex = 0;
+    float nearest = reach * reach;
+    for(size_t i = 0; i < found.size(); ++i)
+    {
+        int index = (int)(found[i] >> 16);
+        int vertex = (int)(found[i] & 0xFFFF);
+        const Chunk& chunk = chunks[index];
+        float d = segmentDistance2(position, getCenter(chunk, vertex - 2), getCenter(chunk, vertex));
+        if(d <= nearest)
+        {
+            nearest = d;
+            nearestChunk = index;
+            nearestVertex = vertex;
+        }
+    }
+    if(nearestChunk < 0)
+        return -1;
+
+    // the piece holding the vertex is the last one starting at or before it
+    const std::vector<Piece>& pieces = chunks[nearestChunk].pieces;
+    std::vector<Piece>::const_iterator it = std::upper_bound(pieces.begin(), pieces.end(), nearestVertex,
+                                                             [](int vertex, const Piece& piece) { return vertex < piece.first; });
+    if(it == pieces.begin())
+        return -1;
+
+    if(distance)
+        *distance = sqrtf(nearest);
+    return (it - 1)->stroke;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// erase all strokes within radius of the ribbon edge
+///////////////////////////////////////////////////////////////////////////////
+int StrokePool::eraseStrokes(const Vector3& position, float radius)
+{
+    int count = 0;
+    int stroke;
+    while((stroke = pickStroke(position, radius)) >= 0)
+    {
+        if(!eraseStroke(stroke))
+            break;
+        ++count;
+    }
+    return count;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// erase every piece of a stroke, false if it is not in the pool
+///////////////////////////////////////////////////////////////////////////////
+bool StrokePool::eraseStroke(int id)
+{
+    bool erased = false;
+    for(int i = 0; i < (int)chunks.size(); ++i)
+    {
+        std::vector<Piece>& pieces = chunks[i].pieces;
+        std::vector<Piece>::iterator it = std::lower_bound(pieces.begin(), pieces.end(), id, pieceLess);
+        if(it == pieces.end() || it->stroke != id || it->erased)
+            continue;
+
+        erasePiece(i, *it);
+        if(!it->continued)
+        {
+            --chunks[i].strokesStarted;
+            --strokeCount;
+        }
+        erased = true;
+    }
+
+    // the stroke being drawn stops, the key has to be pressed again
+    if(erased && stroking && id == strokeId)
+    {
+        window.clear();
+        stroking = false;
+    }
+    return erased;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// collapse the vertices of a piece to one point, so its triangles and the
+// triangles joining it to its neighbors have no area
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::erasePiece(int index, Piece& piece)
+{
+    indexPiece(index, piece, false);
+
+    Chunk& chunk = chunks[index];
+    int first = piece.first;
+    int last = std::min(piece.first + piece.count + 1, (int)chunk.vertices.size());  // with the join to the next stroke
+    if(first > 0)
+        --first;                                    // the join from the previous stroke
+
+    const StrokeVertex& anchor = chunk.vertices[first > 0 ? first - 1 : 0];
+    float point[3] = { anchor.position[0], anchor.position[1], anchor.position[2] };
+    for(int i = first; i < last; ++i)
+    {
+        chunk.vertices[i].position[0] = point[0];
+        chunk.vertices[i].position[1] = point[1];
+        chunk.vertices[i].position[2] = point[2];
+    }
+
+    piece.erased = true;
+    ++chunk.generation;                             // uploaded vertices changed
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add or remove the segments of a piece to/from the grid
+///////////////////////////////////////////////////////////////////////////////
+void StrokePool::indexPiece(int index, const Piece& piece, bool insert)
+{
+    const Chunk& chunk = chunks[index];
+    for(int vertex = piece.first + 2; vertex < piece.first + piece.count; vertex += 2)
+    {
+        Vector3 a = getCenter(chunk, vertex - 2);
+        Vector3 b = getCenter(chunk, vertex);
+        if(insert)
+            grid.insert(a, b, toItem(index, vertex));
+        else
+            grid.remove(a, b, toItem(index, vertex));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// middle of the pair of vertices starting at vertex
+///////////////////////////////////////////////////////////////////////////////
+Vector3 StrokePool::getCenter(const Chunk& chunk, int vertex) const
+{
+    const float* left = chunk.vertices[vertex].position;
+    const float* right = chunk.vertices[vertex + 1].position;
+    return Vector3((left[0] + right[0]) * 0.5f, (left[1] + right[1]) * 0.5f, (left[2] + right[2]) * 0.5f);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// vertices in all chunks, including the joins between strokes
+///////////////////////////////////////////////////////////////////////////////
+int64_t StrokePool::getVertexCount() const
+{
+    int64_t count = 0;
+    for(size_t i = 0; i < chunks.size(); ++i)
+        count += chunks[i].vertices.size();
+    return count;
+}
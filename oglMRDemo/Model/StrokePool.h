@@ -0,0 +1,161 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokePool.h
+// ============
+// 3D strokes drawn with the pen, stored as ribbon vertices ready for GL.
+//
+// Each point of a stroke adds 2 vertices, the nib position moved half the
+// ribbon width to both sides. The side is perpendicular to the stroke and to
+// the pen direction, so the ribbon lies flat like the tip of a flat brush.
+//
+// The tracker delivers far more samples than a stroke needs, so they are
+// simplified while they arrive. Samples closer than minDistance to the last
+// one are dropped (radial distance). The others extend the current segment as
+// long as all samples since its start stay within tolerance of it, otherwise
+// the previous sample becomes a point of the stroke and starts a new segment
+// (streaming Douglas-Peucker with a window of at most SIMPLIFY_WINDOW samples).
+// The newest segment is therefore not drawn until it is finished or the
+// stroke ends.
+//
+// Vertices live in fixed-size chunks (CHUNK_VERTICES). All strokes of a chunk
+// form one GL_TRIANGLE_STRIP: consecutive strokes are joined by repeating the
+// last vertex of one and the first vertex of the next (degenerate triangles),
+// so a chunk is drawn with a single call no matter how many strokes it has.
+// A stroke reaching the end of a chunk continues in the next one, which
+// starts with its last 2 vertices again.
+//
+// The chunks are a ring of at most maxChunks. When all are full, the oldest
+// chunk is cleared and reused, and the strokes drawn in it disappear. Vertices
+// are only appended, never moved, so a renderer uploads just the vertices
+// added since its last upload (see getChunk() and Chunk::generation). Each
+// chunk also keeps the box of its vertices, so a renderer can cull it; an
+// erase does not shrink the box.
+//
+// Every segment is also put in a StrokeGrid, so pickStroke() and
+// eraseStrokes() only look at the segments near the nib. An erased stroke
+// keeps its place in the chunk, its vertices are collapsed to one point.
+//
+// Owned by one thread (the rendering thread).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STROKE_POOL_H
+#define STROKE_POOL_H
+
+#include <cstdint>
+#include <vector>
+#include "../Math/Vectors.h"
+#include "StrokeGrid.h"
+
+// 16 bytes, position and RGBA color
+struct StrokeVertex
+{
+    float position[3];
+    unsigned char color[4];
+};
+
+class StrokePool
+{
+public:
+    static const int CHUNK_VERTICES = 65536;        // 1 MB of vertices
+    static const int MAX_CHUNKS = 65536;            // chunk index must fit in 16 bits of a grid item
+    static const int SIMPLIFY_WINDOW = 64;          // samples tested against a segment at most
+
+    // the vertices of a stroke in a chunk
+    struct Piece
+    {
+        int stroke;                                 // stroke id
+        int first;                                  // first vertex of its first pair
+        int count;                                  // vertices from first, 2 per point
+        bool continued;                             // started in the previous chunk
+        bool erased;
+    };
+
+    struct Chunk
+    {
+        std::vector<StrokeVertex> vertices;         // one triangle strip
+        std::vector<Piece> pieces;                  // in stroke id order
+        uint32_t generation;                        // incremented each time written vertices change (reuse, erase)
+        int strokesStarted;                         // strokes whose first point is in this chunk, not erased
+        float boundsMin[3];                         // box of the vertices, valid if not empty
+        float boundsMax[3];
+    };
+
+    explicit StrokePool(int maxChunks = 128);
+
+    // capture
+    int beginStroke(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255);  // return stroke id
+    bool addPoint(const Vector3& position, const Vector3& penDirection);    // false if the sample is dropped
+    void endStroke();
+    bool isStroking() const                         { return stroking; }
+    void clear();
+
+    // picking, radius is added to half the ribbon width
+    int pickStroke(const Vector3& position, float radius, float* distance = 0);  // nearest stroke id, -1 if none
+    int eraseStrokes(const Vector3& position, float radius);                    // return the number erased
+    bool eraseStroke(int id);
+
+    // settings, used by the next points
+    void setRibbonWidth(float width)                { ribbonWidth = width; }
+    float getRibbonWidth() const                    { return ribbonWidth; }
+    void setMinDistance(float distance)             { minDistance = distance; }
+    void setTolerance(float distance)               { tolerance = distance; }   // 0 keeps every sample
+    float getTolerance() const                      { return tolerance; }
+    void setMaxChunks(int count);                   // applied when the ring wraps
+    void setCellSize(float size);                   // of the grid, rebuilds it
+
+    // chunks for rendering, in ring order (not oldest first)
+    int getChunkCount() const                       { return (int)chunks.size(); }
+    const Chunk& getChunk(int index) const          { return chunks[index]; }
+
+    // stats
+    int getStrokeCount() const                      { return strokeCount; }
+    int64_t getPointCount() const                   { return pointCount; }      // kept by simplification
+    int64_t getSampleCount() const                  { return sampleCount; }     // given to addPoint()
+    int64_t getVertexCount() const;
+    int getRecycledChunkCount() const               { return recycledChunks; }
+    const StrokeGrid& getGrid() const               { return grid; }
+
+private:
+    void commitPoint(const Vector3& position, const Vector3& penDirection);
+    void appendPair(const Vector3& left, const Vector3& right, bool firstPair);
+    void pushVertex(Chunk& chunk, const Vector3& position);
+    static void growBounds(Chunk& chunk, const float* position);    // after a vertex is appended
+    Chunk& nextChunk();                             // move to a new or recycled chunk
+    void recycleChunk(int index);
+    void erasePiece(int index, Piece& piece);
+    void indexPiece(int index, const Piece& piece, bool insert);
+    Vector3 getCenter(const Chunk& chunk, int vertex) const;   // nib position of the pair at vertex
+    static uint32_t toItem(int chunk, int vertex)   { return ((uint32_t)chunk << 16) | (uint32_t)vertex; }
+
+    std::vector<Chunk> chunks;
+    int current;                                    // chunk being written, -1 if none
+    int maxChunks;
+    StrokeGrid grid;                                // one item per segment, the pair ending it
+    std::vector<uint32_t> found;                    // grid query results, kept to avoid allocations
+
+    // stroke being captured
+    bool stroking;
+    int strokeId;
+    int strokePoints;                               // committed points
+    Vector3 lastPoint;                              // last committed point
+    Vector3 lastSide;
+    bool hasSide;
+    unsigned char color[4];
+
+    // simplification of the stroke being captured
+    std::vector<Vector3> window;                    // samples after lastPoint, the last one is pending
+    Vector3 pendingDirection;
+
+    float ribbonWidth;
+    float minDistance;
+    float tolerance;
+    int nextStrokeId;
+    int strokeCount;
+    int64_t pointCount;
+    int64_t sampleCount;
+    int recycledChunks;
+};
+
+#endif
@@ -0,0 +1,189 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokeRenderer.cpp
+// ==================
+// Draws the chunks of a StrokePool with one vertex buffer per chunk.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StrokeRenderer.h"
+
+const GLsizeiptrARB CHUNK_BYTES = StrokePool::CHUNK_VERTICES * sizeof(StrokeVertex);
+const GLsizei VERTEX_STRIDE = sizeof(StrokeVertex);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+StrokeRenderer::StrokeRenderer() : vboEnabled(false), lastUploadBytes(0), totalUploadBytes(0), lastDrawCalls(0)
+{
+}
+
+StrokeRenderer::~StrokeRenderer()
+{
+    // GL objects are deleted by release(), the context may be gone already
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// use vertex buffers if the driver has them
+///////////////////////////////////////////////////////////////////////////////
+bool StrokeRenderer::init()
+{
+    vboEnabled = glExtension::getInstance().isSupported("GL_ARB_vertex_buffer_object");
+    return vboEnabled;
+}
+
+void StrokeRenderer::release()
+{
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        if(buffers[i].id)
+            glDeleteBuffersARB(1, &buffers[i].id);
+    }
+    buffers.clear();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// send the vertices added since the last upload
+///////////////////////////////////////////////////////////////////////////////
+int StrokeRenderer::upload(const StrokePool& pool)
+{
+    lastUploadBytes = 0;
+    if(!vboEnabled)
+        return 0;
+
+    int count = pool.getChunkCount();
+
+    // the pool dropped chunks (setMaxChunks)
+    while((int)buffers.size() > count)
+    {
+        if(buffers.back().id)
+            glDeleteBuffersARB(1, &buffers.back().id);
+        buffers.pop_back();
+    }
+
+    for(int i = 0; i < count; ++i)
+    {
+        const StrokePool::Chunk& chunk = pool.getChunk(i);
+        int size = (int)chunk.vertices.size();
+
+        if(i >= (int)buffers.size())
+        {
+            // full-size storage once, later uploads only fill it
+            Buffer buffer = { 0, chunk.generation, 0 };
+            glGenBuffersARB(1, &buffer.id);
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer.id);
+            glBufferDataARB(GL_ARRAY_BUFFER_ARB, CHUNK_BYTES, 0, GL_DYNAMIC_DRAW_ARB);
+            buffers.push_back(buffer);
+        }
+
+        Buffer& buffer = buffers[i];
+        if(buffer.generation != chunk.generation)
+        {
+            // reused chunk, orphan the old storage so frames still drawing it do not stall us
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer.id);
+            glBufferDataARB(GL_ARRAY_BUFFER_ARB, CHUNK_BYTES, 0, GL_DYNAMIC_DRAW_ARB);
+            buffer.generation = chunk.generation;
+            buffer.uploaded = 0;
+        }
+
+        if(size > buffer.uploaded)
+        {
+            GLintptrARB offset = (GLintptrARB)buffer.uploaded * VERTEX_STRIDE;
+            GLsizeiptrARB bytes = (GLsizeiptrARB)(size - buffer.uploaded) * VERTEX_STRIDE;
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer.id);
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, offset, bytes, &chunk.vertices[buffer.uploaded]);
+            buffer.uploaded = size;
+            lastUploadBytes += (int)bytes;
+        }
+    }
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+    totalUploadBytes += lastUploadBytes;
+    return lastUploadBytes;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw every chunk as one triangle strip, with the current matrices and program
+// instances > 1 needs GL_ARB_draw_instanced
+///////////////////////////////////////////////////////////////////////////////
+void StrokeRenderer::draw(const StrokePool& pool, int instances)
+{
+    lastDrawCalls = 0;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    int count = pool.getChunkCount();
+    for(int i = 0; i < count; ++i)
+    {
+        if(submitChunk(pool, i, instances))
+            ++lastDrawCalls;
+    }
+
+    if(vboEnabled)
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void StrokeRenderer::drawChunk(const StrokePool& pool, int index, int instances)
+{
+    if(index < 0 || index >= pool.getChunkCount())
+        return;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    submitChunk(pool, index, instances);
+    if(vboEnabled)
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the arrays of one chunk and draw it, client states must be enabled
+///////////////////////////////////////////////////////////////////////////////
+bool StrokeRenderer::submitChunk(const StrokePool& pool, int index, int instances)
+{
+    const StrokePool::Chunk& chunk = pool.getChunk(index);
+    GLsizei size;
+    if(vboEnabled)
+    {
+        // only what is in the buffer, upload() may not have run for this frame
+        if(index >= (int)buffers.size() || buffers[index].generation != chunk.generation)
+            return false;
+        size = buffers[index].uploaded;
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffers[index].id);
+        glVertexPointer(3, GL_FLOAT, VERTEX_STRIDE, (const GLvoid*)0);
+        glColorPointer(4, GL_UNSIGNED_BYTE, VERTEX_STRIDE, (const GLvoid*)(sizeof(float) * 3));
+    }
+    else
+    {
+        size = (GLsizei)chunk.vertices.size();
+        if(size > 0)
+        {
+            glVertexPointer(3, GL_FLOAT, VERTEX_STRIDE, chunk.vertices[0].position);
+            glColorPointer(4, GL_UNSIGNED_BYTE, VERTEX_STRIDE, chunk.vertices[0].color);
+        }
+    }
+
+    if(size < 3)
+        return false;
+
+    if(instances > 1)
+        glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, size, instances);
+    else
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, size);
+    return true;
+}
@@ -0,0 +1,75 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// StrokeRenderer.h
+// ================
+// Draws the chunks of a StrokePool with one vertex buffer per chunk.
+//
+// upload() copies only the vertices appended to each chunk since the previous
+// upload with glBufferSubDataARB(), so a frame costs as much as the points
+// drawn in it, not as much as all strokes. A chunk reused by the pool (its
+// generation changed) is orphaned and refilled from the start. Every chunk is
+// drawn with a single glDrawArrays(GL_TRIANGLE_STRIP) call, or one
+// glDrawArraysInstancedARB() call for instanced stereo.
+//
+// Without GL_ARB_vertex_buffer_object the chunks are drawn from client memory.
+// All calls must be made by the thread owning the GL context.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STROKE_RENDERER_H
+#define STROKE_RENDERER_H
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+#include "../GL/glext.h"
+#include "../GL/glExtension.h"
+#include "StrokePool.h"
+
+class StrokeRenderer
+{
+public:
+    StrokeRenderer();
+    ~StrokeRenderer();
+
+    bool init();                                    // check VBO support, false if client arrays are used
+    void release();                                 // delete the buffers, GL context must be current
+
+    int upload(const StrokePool& pool);             // return bytes sent to GL
+    void draw(const StrokePool& pool, int instances = 1);
+    void drawChunk(const StrokePool& pool, int index, int instances = 1);   // one chunk, for callers culling chunks
+
+    // stats
+    int getLastUploadBytes() const                  { return lastUploadBytes; }
+    int64_t getTotalUploadBytes() const             { return totalUploadBytes; }
+    int getLastDrawCalls() const                    { return lastDrawCalls; }
+    bool isVboEnabled() const                       { return vboEnabled; }
+
+private:
+    bool submitChunk(const StrokePool& pool, int index, int instances);     // false if nothing to draw
+
+    struct Buffer
+    {
+        GLuint id;
+        uint32_t generation;                        // generation of the chunk in the buffer
+        int uploaded;                               // vertices of the chunk already in the buffer
+    };
+
+    std::vector<Buffer> buffers;                    // same index as the chunks of the pool
+    bool vboEnabled;
+    int lastUploadBytes;
+    int64_t totalUploadBytes;
+    int lastDrawCalls;
+};
+
+#endif
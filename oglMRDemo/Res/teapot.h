@@ -14,6 +14,7 @@
 //
 // drawTeapot()   : render it with VA
 // drawTeapotVBO(): render it with VBO
+// drawTeapotInstanced(): render it with VA, N instances per draw call
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifndef TEAPOT_H
@@ -3726,9 +3727,69 @@ GLushort teapotIndices[] = {
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// draw teapot using absolute pointers to indexed vertex array.
+// strips of teapotIndices: primitive, index count and first index
 ///////////////////////////////////////////////////////////////////////////////
-void drawTeapot()
+struct TeapotStrip
+{
+	GLenum mode;
+	GLsizei count;
+	int first;
+};
+
+const TeapotStrip teapotStrips[] = {
+	{GL_TRIANGLE_STRIP, 12, 0}, {GL_TRIANGLE_STRIP, 78, 12}, {GL_TRIANGLE_STRIP, 35, 90}, {GL_TRIANGLE_STRIP, 70, 125},
+	{GL_TRIANGLE_STRIP, 65, 195}, {GL_TRIANGLE_STRIP, 37, 260}, {GL_TRIANGLE_STRIP, 35, 297}, {GL_TRIANGLE_STRIP, 32, 332},
+	{GL_TRIANGLE_STRIP, 56, 364}, {GL_TRIANGLE_STRIP, 45, 420}, {GL_TRIANGLE_STRIP, 41, 465}, {GL_TRIANGLE_STRIP, 37, 506},
+	{GL_TRIANGLE_STRIP, 33, 543}, {GL_TRIANGLE_STRIP, 29, 576}, {GL_TRIANGLE_STRIP, 25, 605}, {GL_TRIANGLE_STRIP, 21, 630},
+	{GL_TRIANGLE_STRIP, 17, 651}, {GL_TRIANGLE_STRIP, 13, 668}, {GL_TRIANGLE_STRIP, 9, 681}, {GL_TRIANGLE_STRIP, 27, 690},
+	{GL_TRIANGLE_STRIP, 16, 717}, {GL_TRIANGLE_STRIP, 22, 733}, {GL_TRIANGLE_STRIP, 50, 755}, {GL_TRIANGLE_STRIP, 42, 805},
+	{GL_TRIANGLE_STRIP, 43, 847}, {GL_TRIANGLE_STRIP, 4, 890}, {GL_TRIANGLE_STRIP, 143, 894}, {GL_TRIANGLE_STRIP, 234, 1037},
+	{GL_TRIANGLE_STRIP, 224, 1271}, {GL_TRIANGLE_STRIP, 71, 1495}, {GL_TRIANGLE_STRIP, 69, 1566}, {GL_TRIANGLE_STRIP, 67, 1635},
+	{GL_TRIANGLE_STRIP, 65, 1702}, {GL_TRIANGLE_STRIP, 63, 1767}, {GL_TRIANGLE_STRIP, 61, 1830}, {GL_TRIANGLE_STRIP, 59, 1891},
+	{GL_TRIANGLE_STRIP, 57, 1950}, {GL_TRIANGLE_STRIP, 55, 2007}, {GL_TRIANGLE_STRIP, 53, 2062}, {GL_TRIANGLE_STRIP, 51, 2115},
+	{GL_TRIANGLES, 3, 2166}, {GL_TRIANGLE_STRIP, 50, 2169}, {GL_TRIANGLE_STRIP, 48, 2219}, {GL_TRIANGLE_STRIP, 46, 2267},
+	{GL_TRIANGLE_STRIP, 44, 2313}, {GL_TRIANGLE_STRIP, 42, 2357}, {GL_TRIANGLE_STRIP, 40, 2399}, {GL_TRIANGLE_STRIP, 38, 2439},
+	{GL_TRIANGLE_STRIP, 36, 2477}, {GL_TRIANGLE_STRIP, 34, 2513}, {GL_TRIANGLE_STRIP, 32, 2547}, {GL_TRIANGLE_STRIP, 30, 2579},
+	{GL_TRIANGLE_STRIP, 28, 2609}, {GL_TRIANGLE_STRIP, 26, 2637}, {GL_TRIANGLE_STRIP, 24, 2663}, {GL_TRIANGLE_STRIP, 22, 2687},
+	{GL_TRIANGLE_STRIP, 20, 2709}, {GL_TRIANGLE_STRIP, 18, 2729}, {GL_TRIANGLE_STRIP, 16, 2747}, {GL_TRIANGLE_STRIP, 14, 2763},
+	{GL_TRIANGLE_STRIP, 12, 2777}, {GL_TRIANGLE_STRIP, 10, 2789}, {GL_TRIANGLE_STRIP, 8, 2799}, {GL_TRIANGLE_STRIP, 6, 2807},
+	{GL_TRIANGLES, 3, 2813}, {GL_TRIANGLES, 3, 2816}, {GL_TRIANGLE_STRIP, 200, 2819}, {GL_TRIANGLES, 3, 3019},
+	{GL_TRIANGLE_STRIP, 66, 3022}, {GL_TRIANGLES, 3, 3088}, {GL_TRIANGLE_STRIP, 209, 3091}, {GL_TRIANGLES, 3, 3300},
+	{GL_TRIANGLES, 3, 3303}, {GL_TRIANGLES, 3, 3306}, {GL_TRIANGLE_STRIP, 38, 3309}, {GL_TRIANGLE_STRIP, 15, 3347},
+	{GL_TRIANGLES, 3, 3362}, {GL_TRIANGLE_STRIP, 26, 3365}, {GL_TRIANGLE_STRIP, 9, 3391}, {GL_TRIANGLES, 3, 3400},
+	{GL_TRIANGLE_STRIP, 14, 3403}, {GL_TRIANGLES, 3, 3417}, {GL_TRIANGLE_STRIP, 115, 3420}, {GL_TRIANGLES, 3, 3535},
+	{GL_TRIANGLES, 3, 3538}, {GL_TRIANGLE_STRIP, 39, 3541}, {GL_TRIANGLES, 3, 3580}, {GL_TRIANGLE_STRIP, 91, 3583},
+	{GL_TRIANGLES, 3, 3674}, {GL_TRIANGLES, 3, 3677}, {GL_TRIANGLE_STRIP, 31, 3680}, {GL_TRIANGLES, 3, 3711},
+	{GL_TRIANGLE_STRIP, 67, 3714}, {GL_TRIANGLES, 3, 3781}, {GL_TRIANGLES, 3, 3784}, {GL_TRIANGLE_STRIP, 23, 3787},
+	{GL_TRIANGLES, 3, 3810}, {GL_TRIANGLE_STRIP, 45, 3813}, {GL_TRIANGLES, 3, 3858}, {GL_TRIANGLES, 3, 3861},
+	{GL_TRIANGLES, 3, 3864}, {GL_TRIANGLE_STRIP, 32, 3867}, {GL_TRIANGLE_STRIP, 38, 3899}, {GL_TRIANGLE_STRIP, 15, 3937},
+	{GL_TRIANGLES, 3, 3952}, {GL_TRIANGLE_STRIP, 26, 3955}, {GL_TRIANGLE_STRIP, 9, 3981}, {GL_TRIANGLES, 3, 3990},
+	{GL_TRIANGLE_STRIP, 14, 3993}, {GL_TRIANGLES, 3, 4007}, {GL_TRIANGLE_STRIP, 135, 4010}, {GL_TRIANGLES, 3, 4145},
+	{GL_TRIANGLE_STRIP, 76, 4148}, {GL_TRIANGLES, 3, 4224}, {GL_TRIANGLE_STRIP, 60, 4227}, {GL_TRIANGLES, 3, 4287},
+	{GL_TRIANGLE_STRIP, 23, 4290}, {GL_TRIANGLES, 3, 4313}, {GL_TRIANGLE_STRIP, 26, 4316}, {GL_TRIANGLES, 3, 4342},
+	{GL_TRIANGLE_STRIP, 6, 4345}, {GL_TRIANGLE_STRIP, 947, 4351}, {GL_TRIANGLE_STRIP, 35, 5298}, {GL_TRIANGLE_STRIP, 31, 5333},
+	{GL_TRIANGLE_STRIP, 27, 5364}, {GL_TRIANGLE_STRIP, 23, 5391}, {GL_TRIANGLE_STRIP, 20, 5414}, {GL_TRIANGLE_STRIP, 24, 5434},
+	{GL_TRIANGLES, 3, 5458}, {GL_TRIANGLE_STRIP, 28, 5461}, {GL_TRIANGLE_STRIP, 32, 5489}, {GL_TRIANGLE_STRIP, 36, 5521},
+	{GL_TRIANGLE_STRIP, 76, 5557}, {GL_TRIANGLES, 3, 5633}, {GL_TRIANGLE_STRIP, 67, 5636}, {GL_TRIANGLES, 3, 5703},
+	{GL_TRIANGLE_STRIP, 59, 5706}, {GL_TRIANGLES, 3, 5765}, {GL_TRIANGLE_STRIP, 51, 5768}, {GL_TRIANGLES, 3, 5819},
+	{GL_TRIANGLE_STRIP, 43, 5822}, {GL_TRIANGLES, 3, 5865}, {GL_TRIANGLE_STRIP, 35, 5868}, {GL_TRIANGLES, 3, 5903},
+	{GL_TRIANGLE_STRIP, 27, 5906}, {GL_TRIANGLES, 3, 5933}, {GL_TRIANGLE_STRIP, 19, 5936}, {GL_TRIANGLES, 3, 5955},
+	{GL_TRIANGLE_STRIP, 11, 5958}, {GL_TRIANGLES, 3, 5969}, {GL_TRIANGLE_STRIP, 30, 5972}, {GL_TRIANGLES, 3, 6002},
+	{GL_TRIANGLE_STRIP, 11, 6005}, {GL_TRIANGLE_STRIP, 18, 6016}, {GL_TRIANGLES, 3, 6034}, {GL_TRIANGLES, 3, 6037},
+	{GL_TRIANGLE_STRIP, 5, 6040}, {GL_TRIANGLE_STRIP, 122, 6045}, {GL_TRIANGLE_STRIP, 75, 6167}, {GL_TRIANGLE_STRIP, 71, 6242},
+	{GL_TRIANGLE_STRIP, 67, 6313}, {GL_TRIANGLE_STRIP, 63, 6380}, {GL_TRIANGLE_STRIP, 59, 6443}, {GL_TRIANGLE_STRIP, 55, 6502},
+	{GL_TRIANGLE_STRIP, 51, 6557}, {GL_TRIANGLE_STRIP, 47, 6608}, {GL_TRIANGLE_STRIP, 43, 6655}, {GL_TRIANGLE_STRIP, 39, 6698},
+	{GL_TRIANGLE_STRIP, 35, 6737}, {GL_TRIANGLE_STRIP, 31, 6772}, {GL_TRIANGLE_STRIP, 27, 6803}, {GL_TRIANGLE_STRIP, 23, 6830},
+	{GL_TRIANGLE_STRIP, 19, 6853}, {GL_TRIANGLE_STRIP, 15, 6872}, {GL_TRIANGLE_STRIP, 11, 6887}, {GL_TRIANGLE_STRIP, 7, 6898}
+};
+const int teapotStripCount = sizeof(teapotStrips) / sizeof(teapotStrips[0]);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// material and vertex arrays of drawTeapot() and drawTeapotInstanced()
+///////////////////////////////////////////////////////////////////////////////
+void beginTeapot()
 {
 	float shininess = 15.0f;
 	float diffuseColor[4] = {0.929524f, 0.796542f, 0.178823f, 1.0f};
@@ -3750,189 +3811,28 @@ void drawTeapot()
 
 	glNormalPointer(GL_FLOAT, 0, teapotNormals);
 	glVertexPointer(3, GL_FLOAT, 0, teapotVertices);
+}
 
-	glDrawElements(GL_TRIANGLE_STRIP, 12, GL_UNSIGNED_SHORT, &teapotIndices[0]);
-	glDrawElements(GL_TRIANGLE_STRIP, 78, GL_UNSIGNED_SHORT, &teapotIndices[12]);
-	glDrawElements(GL_TRIANGLE_STRIP, 35, GL_UNSIGNED_SHORT, &teapotIndices[90]);
-	glDrawElements(GL_TRIANGLE_STRIP, 70, GL_UNSIGNED_SHORT, &teapotIndices[125]);
-	glDrawElements(GL_TRIANGLE_STRIP, 65, GL_UNSIGNED_SHORT, &teapotIndices[195]);
-	glDrawElements(GL_TRIANGLE_STRIP, 37, GL_UNSIGNED_SHORT, &teapotIndices[260]);
-	glDrawElements(GL_TRIANGLE_STRIP, 35, GL_UNSIGNED_SHORT, &teapotIndices[297]);
-	glDrawElements(GL_TRIANGLE_STRIP, 32, GL_UNSIGNED_SHORT, &teapotIndices[332]);
-	glDrawElements(GL_TRIANGLE_STRIP, 56, GL_UNSIGNED_SHORT, &teapotIndices[364]);
-	glDrawElements(GL_TRIANGLE_STRIP, 45, GL_UNSIGNED_SHORT, &teapotIndices[420]);
-	glDrawElements(GL_TRIANGLE_STRIP, 41, GL_UNSIGNED_SHORT, &teapotIndices[465]);
-	glDrawElements(GL_TRIANGLE_STRIP, 37, GL_UNSIGNED_SHORT, &teapotIndices[506]);
-	glDrawElements(GL_TRIANGLE_STRIP, 33, GL_UNSIGNED_SHORT, &teapotIndices[543]);
-	glDrawElements(GL_TRIANGLE_STRIP, 29, GL_UNSIGNED_SHORT, &teapotIndices[576]);
-	glDrawElements(GL_TRIANGLE_STRIP, 25, GL_UNSIGNED_SHORT, &teapotIndices[605]);
-	glDrawElements(GL_TRIANGLE_STRIP, 21, GL_UNSIGNED_SHORT, &teapotIndices[630]);
-	glDrawElements(GL_TRIANGLE_STRIP, 17, GL_UNSIGNED_SHORT, &teapotIndices[651]);
-	glDrawElements(GL_TRIANGLE_STRIP, 13, GL_UNSIGNED_SHORT, &teapotIndices[668]);
-	glDrawElements(GL_TRIANGLE_STRIP, 9, GL_UNSIGNED_SHORT, &teapotIndices[681]);
-	glDrawElements(GL_TRIANGLE_STRIP, 27, GL_UNSIGNED_SHORT, &teapotIndices[690]);
-	glDrawElements(GL_TRIANGLE_STRIP, 16, GL_UNSIGNED_SHORT, &teapotIndices[717]);
-	glDrawElements(GL_TRIANGLE_STRIP, 22, GL_UNSIGNED_SHORT, &teapotIndices[733]);
-	glDrawElements(GL_TRIANGLE_STRIP, 50, GL_UNSIGNED_SHORT, &teapotIndices[755]);
-	glDrawElements(GL_TRIANGLE_STRIP, 42, GL_UNSIGNED_SHORT, &teapotIndices[805]);
-	glDrawElements(GL_TRIANGLE_STRIP, 43, GL_UNSIGNED_SHORT, &teapotIndices[847]);
-	glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_SHORT, &teapotIndices[890]);
-	glDrawElements(GL_TRIANGLE_STRIP, 143, GL_UNSIGNED_SHORT, &teapotIndices[894]);
-	glDrawElements(GL_TRIANGLE_STRIP, 234, GL_UNSIGNED_SHORT, &teapotIndices[1037]);
-	glDrawElements(GL_TRIANGLE_STRIP, 224, GL_UNSIGNED_SHORT, &teapotIndices[1271]);
-	glDrawElements(GL_TRIANGLE_STRIP, 71, GL_UNSIGNED_SHORT, &teapotIndices[1495]);
-	glDrawElements(GL_TRIANGLE_STRIP, 69, GL_UNSIGNED_SHORT, &teapotIndices[1566]);
-	glDrawElements(GL_TRIANGLE_STRIP, 67, GL_UNSIGNED_SHORT, &teapotIndices[1635]);
-	glDrawElements(GL_TRIANGLE_STRIP, 65, GL_UNSIGNED_SHORT, &teapotIndices[1702]);
-	glDrawElements(GL_TRIANGLE_STRIP, 63, GL_UNSIGNED_SHORT, &teapotIndices[1767]);
-	glDrawElements(GL_TRIANGLE_STRIP, 61, GL_UNSIGNED_SHORT, &teapotIndices[1830]);
-	glDrawElements(GL_TRIANGLE_STRIP, 59, GL_UNSIGNED_SHORT, &teapotIndices[1891]);
-	glDrawElements(GL_TRIANGLE_STRIP, 57, GL_UNSIGNED_SHORT, &teapotIndices[1950]);
-	glDrawElements(GL_TRIANGLE_STRIP, 55, GL_UNSIGNED_SHORT, &teapotIndices[2007]);
-	glDrawElements(GL_TRIANGLE_STRIP, 53, GL_UNSIGNED_SHORT, &teapotIndices[2062]);
-	glDrawElements(GL_TRIANGLE_STRIP, 51, GL_UNSIGNED_SHORT, &teapotIndices[2115]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[2166]);
-	glDrawElements(GL_TRIANGLE_STRIP, 50, GL_UNSIGNED_SHORT, &teapotIndices[2169]);
-	glDrawElements(GL_TRIANGLE_STRIP, 48, GL_UNSIGNED_SHORT, &teapotIndices[2219]);
-	glDrawElements(GL_TRIANGLE_STRIP, 46, GL_UNSIGNED_SHORT, &teapotIndices[2267]);
-	glDrawElements(GL_TRIANGLE_STRIP, 44, GL_UNSIGNED_SHORT, &teapotIndices[2313]);
-	glDrawElements(GL_TRIANGLE_STRIP, 42, GL_UNSIGNED_SHORT, &teapotIndices[2357]);
-	glDrawElements(GL_TRIANGLE_STRIP, 40, GL_UNSIGNED_SHORT, &teapotIndices[2399]);
-	glDrawElements(GL_TRIANGLE_STRIP, 38, GL_UNSIGNED_SHORT, &teapotIndices[2439]);
-	glDrawElements(GL_TRIANGLE_STRIP, 36, GL_UNSIGNED_SHORT, &teapotIndices[2477]);
-	glDrawElements(GL_TRIANGLE_STRIP, 34, GL_UNSIGNED_SHORT, &teapotIndices[2513]);
-	glDrawElements(GL_TRIANGLE_STRIP, 32, GL_UNSIGNED_SHORT, &teapotIndices[2547]);
-	glDrawElements(GL_TRIANGLE_STRIP, 30, GL_UNSIGNED_SHORT, &teapotIndices[2579]);
-	glDrawElements(GL_TRIANGLE_STRIP, 28, GL_UNSIGNED_SHORT, &teapotIndices[2609]);
-	glDrawElements(GL_TRIANGLE_STRIP, 26, GL_UNSIGNED_SHORT, &teapotIndices[2637]);
-	glDrawElements(GL_TRIANGLE_STRIP, 24, GL_UNSIGNED_SHORT, &teapotIndices[2663]);
-	glDrawElements(GL_TRIANGLE_STRIP, 22, GL_UNSIGNED_SHORT, &teapotIndices[2687]);
-	glDrawElements(GL_TRIANGLE_STRIP, 20, GL_UNSIGNED_SHORT, &teapotIndices[2709]);
-	glDrawElements(GL_TRIANGLE_STRIP, 18, GL_UNSIGNED_SHORT, &teapotIndices[2729]);
-	glDrawElements(GL_TRIANGLE_STRIP, 16, GL_UNSIGNED_SHORT, &teapotIndices[2747]);
-	glDrawElements(GL_TRIANGLE_STRIP, 14, GL_UNSIGNED_SHORT, &teapotIndices[2763]);
-	glDrawElements(GL_TRIANGLE_STRIP, 12, GL_UNSIGNED_SHORT, &teapotIndices[2777]);
-	glDrawElements(GL_TRIANGLE_STRIP, 10, GL_UNSIGNED_SHORT, &teapotIndices[2789]);
-	glDrawElements(GL_TRIANGLE_STRIP, 8, GL_UNSIGNED_SHORT, &teapotIndices[2799]);
-	glDrawElements(GL_TRIANGLE_STRIP, 6, GL_UNSIGNED_SHORT, &teapotIndices[2807]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[2813]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[2816]);
-	glDrawElements(GL_TRIANGLE_STRIP, 200, GL_UNSIGNED_SHORT, &teapotIndices[2819]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3019]);
-	glDrawElements(GL_TRIANGLE_STRIP, 66, GL_UNSIGNED_SHORT, &teapotIndices[3022]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3088]);
-	glDrawElements(GL_TRIANGLE_STRIP, 209, GL_UNSIGNED_SHORT, &teapotIndices[3091]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3300]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3303]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3306]);
-	glDrawElements(GL_TRIANGLE_STRIP, 38, GL_UNSIGNED_SHORT, &teapotIndices[3309]);
-	glDrawElements(GL_TRIANGLE_STRIP, 15, GL_UNSIGNED_SHORT, &teapotIndices[3347]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3362]);
-	glDrawElements(GL_TRIANGLE_STRIP, 26, GL_UNSIGNED_SHORT, &teapotIndices[3365]);
-	glDrawElements(GL_TRIANGLE_STRIP, 9, GL_UNSIGNED_SHORT, &teapotIndices[3391]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3400]);
-	glDrawElements(GL_TRIANGLE_STRIP, 14, GL_UNSIGNED_SHORT, &teapotIndices[3403]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3417]);
-	glDrawElements(GL_TRIANGLE_STRIP, 115, GL_UNSIGNED_SHORT, &teapotIndices[3420]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3535]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3538]);
-	glDrawElements(GL_TRIANGLE_STRIP, 39, GL_UNSIGNED_SHORT, &teapotIndices[3541]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3580]);
-	glDrawElements(GL_TRIANGLE_STRIP, 91, GL_UNSIGNED_SHORT, &teapotIndices[3583]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3674]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3677]);
-	glDrawElements(GL_TRIANGLE_STRIP, 31, GL_UNSIGNED_SHORT, &teapotIndices[3680]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3711]);
-	glDrawElements(GL_TRIANGLE_STRIP, 67, GL_UNSIGNED_SHORT, &teapotIndices[3714]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3781]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3784]);
-	glDrawElements(GL_TRIANGLE_STRIP, 23, GL_UNSIGNED_SHORT, &teapotIndices[3787]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3810]);
-	glDrawElements(GL_TRIANGLE_STRIP, 45, GL_UNSIGNED_SHORT, &teapotIndices[3813]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3858]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3861]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3864]);
-	glDrawElements(GL_TRIANGLE_STRIP, 32, GL_UNSIGNED_SHORT, &teapotIndices[3867]);
-	glDrawElements(GL_TRIANGLE_STRIP, 38, GL_UNSIGNED_SHORT, &teapotIndices[3899]);
-	glDrawElements(GL_TRIANGLE_STRIP, 15, GL_UNSIGNED_SHORT, &teapotIndices[3937]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3952]);
-	glDrawElements(GL_TRIANGLE_STRIP, 26, GL_UNSIGNED_SHORT, &teapotIndices[3955]);
-	glDrawElements(GL_TRIANGLE_STRIP, 9, GL_UNSIGNED_SHORT, &teapotIndices[3981]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[3990]);
-	glDrawElements(GL_TRIANGLE_STRIP, 14, GL_UNSIGNED_SHORT, &teapotIndices[3993]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4007]);
-	glDrawElements(GL_TRIANGLE_STRIP, 135, GL_UNSIGNED_SHORT, &teapotIndices[4010]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4145]);
-	glDrawElements(GL_TRIANGLE_STRIP, 76, GL_UNSIGNED_SHORT, &teapotIndices[4148]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4224]);
-	glDrawElements(GL_TRIANGLE_STRIP, 60, GL_UNSIGNED_SHORT, &teapotIndices[4227]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4287]);
-	glDrawElements(GL_TRIANGLE_STRIP, 23, GL_UNSIGNED_SHORT, &teapotIndices[4290]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4313]);
-	glDrawElements(GL_TRIANGLE_STRIP, 26, GL_UNSIGNED_SHORT, &teapotIndices[4316]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[4342]);
-	glDrawElements(GL_TRIANGLE_STRIP, 6, GL_UNSIGNED_SHORT, &teapotIndices[4345]);
-	glDrawElements(GL_TRIANGLE_STRIP, 947, GL_UNSIGNED_SHORT, &teapotIndices[4351]);
-	glDrawElements(GL_TRIANGLE_STRIP, 35, GL_UNSIGNED_SHORT, &teapotIndices[5298]);
-	glDrawElements(GL_TRIANGLE_STRIP, 31, GL_UNSIGNED_SHORT, &teapotIndices[5333]);
-	glDrawElements(GL_TRIANGLE_STRIP, 27, GL_UNSIGNED_SHORT, &teapotIndices[5364]);
-	glDrawElements(GL_TRIANGLE_STRIP, 23, GL_UNSIGNED_SHORT, &teapotIndices[5391]);
-	glDrawElements(GL_TRIANGLE_STRIP, 20, GL_UNSIGNED_SHORT, &teapotIndices[5414]);
-	glDrawElements(GL_TRIANGLE_STRIP, 24, GL_UNSIGNED_SHORT, &teapotIndices[5434]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5458]);
-	glDrawElements(GL_TRIANGLE_STRIP, 28, GL_UNSIGNED_SHORT, &teapotIndices[5461]);
-	glDrawElements(GL_TRIANGLE_STRIP, 32, GL_UNSIGNED_SHORT, &teapotIndices[5489]);
-	glDrawElements(GL_TRIANGLE_STRIP, 36, GL_UNSIGNED_SHORT, &teapotIndices[5521]);
-	glDrawElements(GL_TRIANGLE_STRIP, 76, GL_UNSIGNED_SHORT, &teapotIndices[5557]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5633]);
-	glDrawElements(GL_TRIANGLE_STRIP, 67, GL_UNSIGNED_SHORT, &teapotIndices[5636]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5703]);
-	glDrawElements(GL_TRIANGLE_STRIP, 59, GL_UNSIGNED_SHORT, &teapotIndices[5706]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5765]);
-	glDrawElements(GL_TRIANGLE_STRIP, 51, GL_UNSIGNED_SHORT, &teapotIndices[5768]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5819]);
-	glDrawElements(GL_TRIANGLE_STRIP, 43, GL_UNSIGNED_SHORT, &teapotIndices[5822]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5865]);
-	glDrawElements(GL_TRIANGLE_STRIP, 35, GL_UNSIGNED_SHORT, &teapotIndices[5868]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5903]);
-	glDrawElements(GL_TRIANGLE_STRIP, 27, GL_UNSIGNED_SHORT, &teapotIndices[5906]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5933]);
-	glDrawElements(GL_TRIANGLE_STRIP, 19, GL_UNSIGNED_SHORT, &teapotIndices[5936]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5955]);
-	glDrawElements(GL_TRIANGLE_STRIP, 11, GL_UNSIGNED_SHORT, &teapotIndices[5958]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[5969]);
-	glDrawElements(GL_TRIANGLE_STRIP, 30, GL_UNSIGNED_SHORT, &teapotIndices[5972]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[6002]);
-	glDrawElements(GL_TRIANGLE_STRIP, 11, GL_UNSIGNED_SHORT, &teapotIndices[6005]);
-	glDrawElements(GL_TRIANGLE_STRIP, 18, GL_UNSIGNED_SHORT, &teapotIndices[6016]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[6034]);
-	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, &teapotIndices[6037]);
-	glDrawElements(GL_TRIANGLE_STRIP, 5, GL_UNSIGNED_SHORT, &teapotIndices[6040]);
-	glDrawElements(GL_TRIANGLE_STRIP, 122, GL_UNSIGNED_SHORT, &teapotIndices[6045]);
-	glDrawElements(GL_TRIANGLE_STRIP, 75, GL_UNSIGNED_SHORT, &teapotIndices[6167]);
-	glDrawElements(GL_TRIANGLE_STRIP, 71, GL_UNSIGNED_SHORT, &teapotIndices[6242]);
-	glDrawElements(GL_TRIANGLE_STRIP, 67, GL_UNSIGNED_SHORT, &teapotIndices[6313]);
-	glDrawElements(GL_TRIANGLE_STRIP, 63, GL_UNSIGNED_SHORT, &teapotIndices[6380]);
-	glDrawElements(GL_TRIANGLE_STRIP, 59, GL_UNSIGNED_SHORT, &teapotIndices[6443]);
-	glDrawElements(GL_TRIANGLE_STRIP, 55, GL_UNSIGNED_SHORT, &teapotIndices[6502]);
-	glDrawElements(GL_TRIANGLE_STRIP, 51, GL_UNSIGNED_SHORT, &teapotIndices[6557]);
-	glDrawElements(GL_TRIANGLE_STRIP, 47, GL_UNSIGNED_SHORT, &teapotIndices[6608]);
-	glDrawElements(GL_TRIANGLE_STRIP, 43, GL_UNSIGNED_SHORT, &teapotIndices[6655]);
-	glDrawElements(GL_TRIANGLE_STRIP, 39, GL_UNSIGNED_SHORT, &teapotIndices[6698]);
-	glDrawElements(GL_TRIANGLE_STRIP, 35, GL_UNSIGNED_SHORT, &teapotIndices[6737]);
-	glDrawElements(GL_TRIANGLE_STRIP, 31, GL_UNSIGNED_SHORT, &teapotIndices[6772]);
-	glDrawElements(GL_TRIANGLE_STRIP, 27, GL_UNSIGNED_SHORT, &teapotIndices[6803]);
-	glDrawElements(GL_TRIANGLE_STRIP, 23, GL_UNSIGNED_SHORT, &teapotIndices[6830]);
-	glDrawElements(GL_TRIANGLE_STRIP, 19, GL_UNSIGNED_SHORT, &teapotIndices[6853]);
-	glDrawElements(GL_TRIANGLE_STRIP, 15, GL_UNSIGNED_SHORT, &teapotIndices[6872]);
-	glDrawElements(GL_TRIANGLE_STRIP, 11, GL_UNSIGNED_SHORT, &teapotIndices[6887]);
-	glDrawElements(GL_TRIANGLE_STRIP, 7, GL_UNSIGNED_SHORT, &teapotIndices[6898]);
-
+void endTeapot()
+{
 	glDisableClientState(GL_VERTEX_ARRAY);	// disable vertex arrays
 	glDisableClientState(GL_NORMAL_ARRAY);	// disable normal arrays
 }
 
 
+
+///////////////////////////////////////////////////////////////////////////////
+// draw teapot using absolute pointers to indexed vertex array.
+///////////////////////////////////////////////////////////////////////////////
+void drawTeapot()
+{
+	beginTeapot();
+	for(int i = 0; i < teapotStripCount; ++i)
+		glDrawElements(teapotStrips[i].mode, teapotStrips[i].count, GL_UNSIGNED_SHORT, &teapotIndices[teapotStrips[i].first]);
+	endTeapot();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // create a display list for teapot
 // Call creatTeapotDL() once to create a DL. createTeapotDL() will return a ID
@@ -4370,4 +4270,19 @@ void drawTeapotVBO()
 	glDisableClientState(GL_NORMAL_ARRAY);	// disable normal arrays
 }
 
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw teapot instanceCount times with one call per strip (GL_ARB_draw_instanced).
+// The bound shader must place each instance using gl_InstanceIDARB.
+///////////////////////////////////////////////////////////////////////////////
+void drawTeapotInstanced(int instanceCount)
+{
+	beginTeapot();
+	for(int i = 0; i < teapotStripCount; ++i)
+		glDrawElementsInstancedARB(teapotStrips[i].mode, teapotStrips[i].count, GL_UNSIGNED_SHORT,
+		                           &teapotIndices[teapotStrips[i].first], instanceCount);
+	endTeapot();
+}
+
 #endif
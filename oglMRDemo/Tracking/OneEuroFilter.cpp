@@ -0,0 +1,525 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// OneEuroFilter.cpp
+// =================
+// Adaptive low-pass filter (One Euro filter) against tracking jitter.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstring>
+#include "OneEuroFilter.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define ONE_EURO_SSE
+#include <xmmintrin.h>
+#endif
+
+const float TWO_PI = 6.2831853f;
+const float MIN_CUTOFF = 0.001f;                    // Hz, keeps the time constant finite
+const float MAX_INTERVAL = 0.25f;                   // a longer gap restarts the filter (second)
+const float LATENCY_SMOOTHING = 0.02f;              // weight of a new sample in getLatency()
+const int VALUE_COUNT = 13;                         // floats of all channels
+
+// layout of the channels in a value array
+const int CHANNEL_OFFSET[] = { 0, 3, 7, 10 };
+const int CHANNEL_SIZE[] = { 3, 4, 3, 3 };
+const bool CHANNEL_UNIT[] = { false, true, false, true };      // normalized after filtering
+const float CHANNEL_SPEED_SCALE[] = { 1, 2, 1, 1 };            // chord of a unit quaternion is half the angle
+
+// what a pose does to the filter
+enum { STEP_HOLD = 0, STEP_RESTART, STEP_UPDATE };
+
+static void toValues(const TrackingPose& pose, float* values)
+{
+    values[0] = pose.glassPosition.x;
+    values[1] = pose.glassPosition.y;
+    values[2] = pose.glassPosition.z;
+    values[3] = pose.glassRotation.x;
+    values[4] = pose.glassRotation.y;
+    values[5] = pose.glassRotation.z;
+    values[6] = pose.glassRotation.w;
+    values[7] = pose.penPosition.x;
+    values[8] = pose.penPosition.y;
+    values[9] = pose.penPosition.z;
+    values[10] = pose.penDirection.x;
+    values[11] = pose.penDirection.y;
+    values[12] = pose.penDirection.z;
+}
+
+static void fromValues(const float* values, TrackingPose& pose)
+{
+    pose.glassPosition.x = values[0];
+    pose.glassPosition.y = values[1];
+    pose.glassPosition.z = values[2];
+    pose.glassRotation.x = values[3];
+    pose.glassRotation.y = values[4];
+    pose.glassRotation.z = values[5];
+    pose.glassRotation.w = values[6];
+    pose.penPosition.x = values[7];
+    pose.penPosition.y = values[8];
+    pose.penPosition.z = values[9];
+    pose.penDirection.x = values[10];
+    pose.penDirection.y = values[11];
+    pose.penDirection.z = values[12];
+}
+
+// parameters in their valid range
+static OneEuroFilter::Params clampParams(const OneEuroFilter::Params& params)
+{
+    OneEuroFilter::Params p;
+    p.minCutoff = params.minCutoff > MIN_CUTOFF ? params.minCutoff : MIN_CUTOFF;
+    p.beta = params.beta > 0 ? params.beta : 0;
+    p.derivativeCutoff = params.derivativeCutoff > MIN_CUTOFF ? params.derivativeCutoff : MIN_CUTOFF;
+    return p;
+}
+
+// time constant of a cutoff frequency
+static float toTimeConstant(float cutoff)
+{
+    return 1.0f / (TWO_PI * (cutoff > MIN_CUTOFF ? cutoff : MIN_CUTOFF));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+OneEuroFilter::OneEuroFilter() : settings(getDefaultSettings())
+{
+    reset();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// defaults for FSCore units (meter) and a hand-held pen
+///////////////////////////////////////////////////////////////////////////////
+OneEuroFilter::Settings OneEuroFilter::getDefaultSettings()
+{
+    Settings defaults;
+    Params position = { 1.5f, 20.0f, 1.0f };        // +20 Hz at 1 m/s
+    Params rotation = { 1.5f, 5.0f, 1.0f };         // +5 Hz at 1 rad/s
+    defaults.params[CHANNEL_GLASS_POSITION] = position;
+    defaults.params[CHANNEL_GLASS_ROTATION] = rotation;
+    defaults.params[CHANNEL_PEN_POSITION] = position;
+    defaults.params[CHANNEL_PEN_DIRECTION] = rotation;
+    return defaults;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters, used from the next pose
+///////////////////////////////////////////////////////////////////////////////
+void OneEuroFilter::setParams(int channel, const Params& params)
+{
+    if(channel >= 0 && channel < CHANNEL_COUNT)
+        settings.params[channel] = clampParams(params);
+}
+
+void OneEuroFilter::setSettings(const Settings& settings)
+{
+    for(int i = 0; i < CHANNEL_COUNT; ++i)
+        setParams(i, settings.params[i]);
+}
+
+void OneEuroFilter::reset()
+{
+    memset(states, 0, sizeof(states));
+    memset(raw, 0, sizeof(raw));
+    memset(output, 0, sizeof(output));
+    for(int i = 0; i < CHANNEL_COUNT; ++i)
+    {
+        latency[i] = 0;
+        cutoff[i] = settings.params[i].minCutoff;
+    }
+    lastTime = 0;
+    started = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// filter one pose, poses without new tracker data return the last output
+///////////////////////////////////////////////////////////////////////////////
+TrackingPose OneEuroFilter::filter(const TrackingPose& pose)
+{
+    float values[VALUE_COUNT];
+    toValues(pose, values);
+
+    int step = STEP_RESTART;
+    float dt = 0;
+    if(started)
+    {
+        dt = (pose.timestamp - lastTime) * 1e-6f;
+        if(memcmp(values, raw, sizeof(raw)) == 0)
+            step = STEP_HOLD;
+        else if(dt > 0 && dt <= MAX_INTERVAL)
+            step = STEP_UPDATE;
+    }
+
+    if(step != STEP_HOLD)
+    {
+        memcpy(raw, values, sizeof(raw));
+        lastTime = pose.timestamp;
+        started = true;
+    }
+
+    for(int c = 0; c < CHANNEL_COUNT && step != STEP_HOLD; ++c)
+    {
+        State& s = states[c];
+        const Params& p = settings.params[c];
+        float* x = values + CHANNEL_OFFSET[c];
+        int n = CHANNEL_SIZE[c];
+
+        if(step == STEP_RESTART)
+        {
+            memcpy(s.value, x, sizeof(float) * n);
+            s.speed = 0;
+            cutoff[c] = p.minCutoff;
+            continue;
+        }
+
+        // q and -q are the same rotation, take the one closer to the filtered value
+        if(c == CHANNEL_GLASS_ROTATION)
+        {
+            float dot = 0;
+            for(int k = 0; k < n; ++k)
+                dot += x[k] * s.value[k];
+            if(dot < 0)
+            {
+                for(int k = 0; k < n; ++k)
+                    x[k] = -x[k];
+            }
+        }
+
+        float d[4];
+        float distance2 = 0;
+        for(int k = 0; k < n; ++k)
+        {
+            d[k] = x[k] - s.value[k];
+            distance2 += d[k] * d[k];
+        }
+        float speed = sqrtf(distance2) * CHANNEL_SPEED_SCALE[c] / dt;
+
+        float alphaSpeed = dt / (dt + toTimeConstant(p.derivativeCutoff));
+        s.speed += alphaSpeed * (speed - s.speed);
+
+        cutoff[c] = p.minCutoff + p.beta * s.speed;
+        float tau = toTimeConstant(cutoff[c]);
+        float alpha = dt / (dt + tau);
+        for(int k = 0; k < n; ++k)
+            s.value[k] += alpha * d[k];
+
+        if(CHANNEL_UNIT[c])
+        {
+            float length2 = 0;
+            for(int k = 0; k < n; ++k)
+                length2 += s.value[k] * s.value[k];
+            float length = sqrtf(length2);
+            if(length > 0)
+            {
+                for(int k = 0; k < n; ++k)
+                    s.value[k] /= length;
+            }
+        }
+
+        latency[c] += LATENCY_SMOOTHING * (tau - latency[c]);
+    }
+
+    // filtered values with everything else of the newest pose
+    if(step != STEP_HOLD)
+    {
+        for(int c = 0; c < CHANNEL_COUNT; ++c)
+            memcpy(output + CHANNEL_OFFSET[c], states[c].value, sizeof(float) * CHANNEL_SIZE[c]);
+    }
+    TrackingPose result = pose;
+    fromValues(output, result);
+    return result;
+}
+
+
+
+#ifdef ONE_EURO_SSE
+///////////////////////////////////////////////////////////////////////////////
+// filter a trace with 4 parameter sets at once, one set per SSE lane
+// Same operations in the same order as OneEuroFilter::filter().
+///////////////////////////////////////////////////////////////////////////////
+static void filterTrace4(const std::vector<TrackingPose>& trace, const std::vector<float>& values,
+                         const std::vector<char>& steps, const std::vector<float>& intervals,
+                         const OneEuroFilter::Settings* sets[4], std::vector<TrackingPose>* outputs[4],
+                         float latencySum[4][OneEuroFilter::CHANNEL_COUNT])
+{
+    const int CHANNELS = OneEuroFilter::CHANNEL_COUNT;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    // per lane parameters
+    __m128 minCutoff[CHANNELS], beta[CHANNELS], tauSpeed[CHANNELS], scale[CHANNELS];
+    for(int c = 0; c < CHANNELS; ++c)
+    {
+        float m[4], b[4], t[4];
+        for(int lane = 0; lane < 4; ++lane)
+        {
+            OneEuroFilter::Params p = clampParams(sets[lane]->params[c]);
+            m[lane] = p.minCutoff;
+            b[lane] = p.beta;
+            t[lane] = toTimeConstant(p.derivativeCutoff);
+        }
+        minCutoff[c] = _mm_loadu_ps(m);
+        beta[c] = _mm_loadu_ps(b);
+        tauSpeed[c] = _mm_loadu_ps(t);
+        scale[c] = _mm_set1_ps(CHANNEL_SPEED_SCALE[c]);
+    }
+
+    __m128 value[VALUE_COUNT];
+    __m128 speed[CHANNELS];
+    __m128 latency[CHANNELS];
+    for(int c = 0; c < CHANNELS; ++c)
+        latency[c] = zero;
+
+    float lanes[VALUE_COUNT][4];
+    for(size_t i = 0; i < trace.size(); ++i)
+    {
+        const float* x = &values[i * VALUE_COUNT];
+        int step = steps[i];
+
+        if(step == STEP_RESTART)
+        {
+            for(int j = 0; j < VALUE_COUNT; ++j)
+                value[j] = _mm_set1_ps(x[j]);
+            for(int c = 0; c < CHANNELS; ++c)
+                speed[c] = zero;
+        }
+        else if(step == STEP_UPDATE)
+        {
+            const __m128 dt = _mm_set1_ps(intervals[i]);
+            for(int c = 0; c < CHANNELS; ++c)
+            {
+                int offset = CHANNEL_OFFSET[c];
+                int n = CHANNEL_SIZE[c];
+                __m128 xv[4] = { zero, zero, zero, zero }, d[4] = { zero, zero, zero, zero };
+                for(int k = 0; k < n; ++k)
+                    xv[k] = _mm_set1_ps(x[offset + k]);
+
+                if(c == OneEuroFilter::CHANNEL_GLASS_ROTATION)
+                {
+                    __m128 dot = _mm_mul_ps(xv[0], value[offset]);
+                    for(int k = 1; k < n; ++k)
+                        dot = _mm_add_ps(dot, _mm_mul_ps(xv[k], value[offset + k]));
+                    __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+                    for(int k = 0; k < n; ++k)
+                        xv[k] = _mm_xor_ps(xv[k], flip);
+                }
+
+                d[0] = _mm_sub_ps(xv[0], value[offset]);
+                __m128 distance2 = _mm_mul_ps(d[0], d[0]);
+                for(int k = 1; k < n; ++k)
+                {
+                    d[k] = _mm_sub_ps(xv[k], value[offset + k]);
+                    distance2 = _mm_add_ps(distance2, _mm_mul_ps(d[k], d[k]));
+                }
+                __m128 v = _mm_div_ps(_mm_mul_ps(_mm_sqrt_ps(distance2), scale[c]), dt);
+
+                __m128 alphaSpeed = _mm_div_ps(dt, _mm_add_ps(dt, tauSpeed[c]));
+                speed[c] = _mm_add_ps(speed[c], _mm_mul_ps(alphaSpeed, _mm_sub_ps(v, speed[c])));
+
+                __m128 cutoff = _mm_add_ps(minCutoff[c], _mm_mul_ps(beta[c], speed[c]));
+                cutoff = _mm_max_ps(cutoff, _mm_set1_ps(MIN_CUTOFF));
+                __m128 tau = _mm_div_ps(one, _mm_mul_ps(_mm_set1_ps(TWO_PI), cutoff));
+                __m128 alpha = _mm_div_ps(dt, _mm_add_ps(dt, tau));
+                for(int k = 0; k < n; ++k)
+                    value[offset + k] = _mm_add_ps(value[offset + k], _mm_mul_ps(alpha, d[k]));
+
+                if(CHANNEL_UNIT[c])
+                {
+                    __m128 length2 = _mm_mul_ps(value[offset], value[offset]);
+                    for(int k = 1; k < n; ++k)
+                        length2 = _mm_add_ps(length2, _mm_mul_ps(value[offset + k], value[offset + k]));
+                    __m128 length = _mm_sqrt_ps(length2);
+                    __m128 valid = _mm_cmpgt_ps(length, zero);
+                    length = _mm_or_ps(_mm_and_ps(valid, length), _mm_andnot_ps(valid, one));
+                    for(int k = 0; k < n; ++k)
+                        value[offset + k] = _mm_div_ps(value[offset + k], length);
+                }
+
+                latency[c] = _mm_add_ps(latency[c], tau);
+            }
+        }
+
+        if(step != STEP_HOLD)
+        {
+            for(int j = 0; j < VALUE_COUNT; ++j)
+                _mm_storeu_ps(lanes[j], value[j]);
+        }
+
+        for(int lane = 0; lane < 4; ++lane)
+        {
+            if(!outputs[lane])
+                continue;
+
+            float filtered[VALUE_COUNT];
+            for(int j = 0; j < VALUE_COUNT; ++j)
+                filtered[j] = lanes[j][lane];
+            TrackingPose& pose = (*outputs[lane])[i];
+            pose = trace[i];
+            fromValues(filtered, pose);
+        }
+    }
+
+    for(int c = 0; c < CHANNELS; ++c)
+    {
+        float sums[4];
+        _mm_storeu_ps(sums, latency[c]);
+        for(int lane = 0; lane < 4; ++lane)
+            latencySum[lane][c] = sums[lane];
+    }
+}
+#endif
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RMS of the 2nd difference of a channel over the poses with new data, the
+// quaternion is kept on one hemisphere
+///////////////////////////////////////////////////////////////////////////////
+static float getRoughness(const std::vector<TrackingPose>& poses, const std::vector<char>& steps, int channel)
+{
+    int offset = CHANNEL_OFFSET[channel];
+    int n = CHANNEL_SIZE[channel];
+    float history[3][4];
+    int count = 0;
+    double sum = 0;
+    int terms = 0;
+
+    for(size_t i = 0; i < poses.size(); ++i)
+    {
+        if(steps[i] == STEP_HOLD)
+            continue;
+        if(steps[i] == STEP_RESTART)
+            count = 0;
+
+        float values[VALUE_COUNT];
+        toValues(poses[i], values);
+        float* x = values + offset;
+        if(channel == OneEuroFilter::CHANNEL_GLASS_ROTATION && count > 0)
+        {
+            float dot = 0;
+            for(int k = 0; k < n; ++k)
+                dot += x[k] * history[(count - 1) % 3][k];
+            if(dot < 0)
+            {
+                for(int k = 0; k < n; ++k)
+                    x[k] = -x[k];
+            }
+        }
+        memcpy(history[count % 3], x, sizeof(float) * n);
+        ++count;
+
+        if(count >= 3)
+        {
+            const float* a = history[(count - 3) % 3];
+            const float* b = history[(count - 2) % 3];
+            const float* c = history[(count - 1) % 3];
+            for(int k = 0; k < n; ++k)
+            {
+                float d2 = a[k] - 2 * b[k] + c[k];
+                sum += d2 * d2;
+            }
+            ++terms;
+        }
+    }
+    return terms > 0 ? (float)sqrt(sum / terms) : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// filter a recorded trace with several parameter sets
+///////////////////////////////////////////////////////////////////////////////
+void filterTrace(const std::vector<TrackingPose>& trace, const std::vector<OneEuroFilter::Settings>& sets,
+                 std::vector<std::vector<TrackingPose> >& outputs, std::vector<OneEuroReport>& reports)
+{
+    const int CHANNELS = OneEuroFilter::CHANNEL_COUNT;
+    int setCount = (int)sets.size();
+    outputs.resize(setCount);
+    reports.resize(setCount);
+    for(int s = 0; s < setCount; ++s)
+        outputs[s].resize(trace.size());
+
+    // what each pose does, decided once for all sets (same rules as filter())
+    std::vector<float> values(trace.size() * VALUE_COUNT);
+    std::vector<char> steps(trace.size());
+    std::vector<float> intervals(trace.size());
+    int updates = 0;
+    size_t last = 0;                                // last pose that changed the filter
+    for(size_t i = 0; i < trace.size(); ++i)
+    {
+        float* x = &values[i * VALUE_COUNT];
+        toValues(trace[i], x);
+        steps[i] = STEP_RESTART;
+        intervals[i] = 0;
+        if(i > 0)
+        {
+            float dt = (trace[i].timestamp - trace[last].timestamp) * 1e-6f;
+            if(memcmp(x, &values[last * VALUE_COUNT], sizeof(float) * VALUE_COUNT) == 0)
+                steps[i] = STEP_HOLD;
+            else if(dt > 0 && dt <= MAX_INTERVAL)
+                steps[i] = STEP_UPDATE;
+            intervals[i] = dt;
+        }
+        if(steps[i] != STEP_HOLD)
+            last = i;
+        if(steps[i] == STEP_UPDATE)
+            ++updates;
+    }
+
+    std::vector<float> latencySums(setCount * CHANNELS, 0.0f);
+    int s = 0;
+#ifdef ONE_EURO_SSE
+    for(; s + 4 <= setCount; s += 4)
+    {
+        const OneEuroFilter::Settings* group[4];
+        std::vector<TrackingPose>* groupOutputs[4];
+        float sums[4][OneEuroFilter::CHANNEL_COUNT];
+        for(int lane = 0; lane < 4; ++lane)
+        {
+            group[lane] = &sets[s + lane];
+            groupOutputs[lane] = &outputs[s + lane];
+        }
+        filterTrace4(trace, values, steps, intervals, group, groupOutputs, sums);
+        for(int lane = 0; lane < 4; ++lane)
+            for(int c = 0; c < CHANNELS; ++c)
+                latencySums[(s + lane) * CHANNELS + c] = sums[lane][c];
+    }
+#endif
+
+    // the rest one by one
+    for(; s < setCount; ++s)
+    {
+        OneEuroFilter filter;
+        filter.setSettings(sets[s]);
+        for(size_t i = 0; i < trace.size(); ++i)
+        {
+            outputs[s][i] = filter.filter(trace[i]);
+            if(steps[i] == STEP_UPDATE)
+            {
+                for(int c = 0; c < CHANNELS; ++c)
+                    latencySums[s * CHANNELS + c] += toTimeConstant(filter.getCutoff(c));
+            }
+        }
+    }
+
+    for(int c = 0; c < CHANNELS; ++c)
+    {
+        float rawRoughness = getRoughness(trace, steps, c);
+        for(int i = 0; i < setCount; ++i)
+        {
+            reports[i].latency[c] = updates > 0 ? latencySums[i * CHANNELS + c] / updates : 0;
+            reports[i].jitter[c] = rawRoughness > 0 ? getRoughness(outputs[i], steps, c) / rawRoughness : 0;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// OneEuroFilter.h
+// ===============
+// Adaptive low-pass filter (One Euro filter, Casiez et al. 2012) against the
+// jitter of the tracked glasses and pen. The demo scales the tracking space
+// 30 times (k), so a fraction of a millimeter of sensor noise shakes the
+// camera and the pen ray visibly.
+//
+// Each channel is smoothed by an exponential filter whose cutoff grows with
+// the speed of the channel: cutoff = minCutoff + beta * speed. At rest the
+// cutoff is low and jitter disappears, in fast motion it is high and the lag
+// is small. The speed itself is low-passed with derivativeCutoff.
+//
+// channels
+// ========
+// GLASS_POSITION, PEN_POSITION: 3D vectors, speed in unit/s (FSCore unit)
+// GLASS_ROTATION: quaternion kept on the hemisphere of the filtered value,
+//                 interpolated with nlerp, speed in rad/s
+// PEN_DIRECTION : unit vector, interpolated and normalized, speed in rad/s
+// Status, key and other values are copied.
+//
+// The tracker is slower than the polling thread, so a pose without new
+// tracker data (same values as the previous one) does not advance the filter;
+// it gets the previous output. The cost per pose is constant.
+//
+// The lag a first-order filter adds to a steady motion is its time constant
+// 1 / (2 pi cutoff). getLatency() averages it over the recent samples.
+//
+// filterTrace() runs a recorded trace through several parameter sets, 4 sets
+// at a time with SSE, and reports latency and jitter of each set.
+//
+// Not thread-safe, owned by one thread (the tracking thread, see
+// TrackingThread::setFilterEnabled()).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ONE_EURO_FILTER_H
+#define ONE_EURO_FILTER_H
+
+#include <vector>
+#include "TrackingPose.h"
+
+class OneEuroFilter
+{
+public:
+    enum Channel
+    {
+        CHANNEL_GLASS_POSITION = 0,
+        CHANNEL_GLASS_ROTATION,
+        CHANNEL_PEN_POSITION,
+        CHANNEL_PEN_DIRECTION,
+        CHANNEL_COUNT
+    };
+
+    struct Params
+    {
+        float minCutoff;                            // Hz, cutoff at rest, lower is smoother
+        float beta;                                 // Hz per unit of speed, higher lags less in motion
+        float derivativeCutoff;                     // Hz, cutoff of the speed
+    };
+
+    // parameters of all channels
+    struct Settings
+    {
+        Params params[CHANNEL_COUNT];
+    };
+
+    OneEuroFilter();
+
+    void setParams(int channel, const Params& params);
+    const Params& getParams(int channel) const      { return settings.params[channel]; }
+    void setSettings(const Settings& settings);
+    const Settings& getSettings() const             { return settings; }
+    static Settings getDefaultSettings();
+    void reset();                                   // the next pose is taken as is
+
+    TrackingPose filter(const TrackingPose& pose);
+
+    float getLatency(int channel) const             { return latency[channel]; }   // second
+    float getCutoff(int channel) const              { return cutoff[channel]; }    // Hz, of the last sample
+
+private:
+    struct State
+    {
+        float value[4];                             // filtered value
+        float speed;                                // filtered speed
+    };
+
+    Settings settings;
+    State states[CHANNEL_COUNT];
+    float latency[CHANNEL_COUNT];
+    float cutoff[CHANNEL_COUNT];
+    float raw[13];                                  // previous input, to find poses without new data
+    float output[13];                               // filtered values of all channels
+    int64_t lastTime;
+    bool started;
+};
+
+// result of one parameter set over a trace
+struct OneEuroReport
+{
+    float latency[OneEuroFilter::CHANNEL_COUNT];    // average time constant in second
+    float jitter[OneEuroFilter::CHANNEL_COUNT];     // RMS of the 2nd difference, filtered / raw
+};
+
+// filter trace (sorted by timestamp) with each parameter set
+// outputs and reports are resized to the number of sets
+void filterTrace(const std::vector<TrackingPose>& trace, const std::vector<OneEuroFilter::Settings>& sets,
+                 std::vector<std::vector<TrackingPose> >& outputs, std::vector<OneEuroReport>& reports);
+
+#endif
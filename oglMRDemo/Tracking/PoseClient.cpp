@@ -0,0 +1,285 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PoseClient.cpp
+// ==============
+// Reader of the shared-memory pose ring.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "PoseClient.h"
+#include "PoseServer.h"
+
+const int MAX_RETRIES = 64;                         // a slot stays odd only if the server died while writing
+const char* const BENCHMARK_NAME = "fmTrackingPosesBenchmark";
+const int LATENCY_BUCKETS = 10000;                  // 1 us each, the last one holds everything above
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+PoseClient::PoseClient() : header(0), slots(0), lastRead(0), retries(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the ring and check that it has the layout this client was built with
+///////////////////////////////////////////////////////////////////////////////
+bool PoseClient::open(const char* name)
+{
+    close();
+    if(!memory.open(name) || memory.getSize() < POSE_SHM_SIZE)
+    {
+        memory.close();
+        return false;
+    }
+
+    const PoseShmHeader* h = (const PoseShmHeader*)memory.getData();
+    if(h->magic.load(std::memory_order_acquire) != POSE_SHM_MAGIC ||
+       h->version != POSE_SHM_VERSION ||
+       h->headerSize != sizeof(PoseShmHeader) ||
+       h->slotSize != sizeof(PoseShmSlot) ||
+       h->slotCount != POSE_SHM_SLOTS ||
+       h->recordSize != sizeof(TrackingRecord))
+    {
+        memory.close();                             // not ready yet, or another version
+        return false;
+    }
+
+    header = h;
+    slots = (const PoseShmSlot*)(h + 1);
+    lastRead = 0;
+    return true;
+}
+
+void PoseClient::close()
+{
+    memory.close();
+    header = 0;
+    slots = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// state of the server
+///////////////////////////////////////////////////////////////////////////////
+bool PoseClient::isProducerRunning() const
+{
+    return header && header->running.load(std::memory_order_acquire) != 0;
+}
+
+uint32_t PoseClient::getPublishedCount() const
+{
+    return header ? header->published.load(std::memory_order_acquire) : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// newest pose; if the server laps the reader during the copy, take the newer
+// one instead
+///////////////////////////////////////////////////////////////////////////////
+bool PoseClient::getPose(TrackingPose& pose)
+{
+    if(!header)
+        return false;
+
+    TrackingRecord record;
+    for(int i = 0; i < MAX_RETRIES; ++i)
+    {
+        uint32_t n = header->published.load(std::memory_order_acquire);
+        if(n == 0)
+            return false;
+
+        ReadResult result = readSlot(n, record);
+        if(result == READ_OK)
+        {
+            unpackTrackingRecord(record, pose);
+            bool newer = n != lastRead;
+            lastRead = n;
+            return newer;
+        }
+        if(result == READ_NOT_YET)
+            return false;                           // the server stopped in the middle of a write
+    }
+    return false;
+}
+
+bool PoseClient::readPose(uint32_t n, TrackingPose& pose)
+{
+    if(!header || n == 0)
+        return false;
+
+    TrackingRecord record;
+    if(readSlot(n, record) != READ_OK)
+        return false;
+
+    unpackTrackingRecord(record, pose);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy pose n out of its slot under the seqlock
+///////////////////////////////////////////////////////////////////////////////
+PoseClient::ReadResult PoseClient::readSlot(uint32_t n, TrackingRecord& record)
+{
+    const PoseShmSlot& slot = slots[(n - 1) % POSE_SHM_SLOTS];
+    const uint32_t done = 2 * n;
+    uint32_t words[POSE_SHM_WORDS];
+
+    for(int i = 0; i < MAX_RETRIES; ++i)
+    {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if(before != done)
+        {
+            if((int32_t)(before - done) > 0)
+                return READ_OVERWRITTEN;            // a later pose is in the slot
+            if(before != done - 1)
+                return READ_NOT_YET;                // an earlier pose is still in the slot
+            ++retries;                              // pose n is being written
+            continue;
+        }
+
+        for(int k = 0; k < POSE_SHM_WORDS; ++k)
+            words[k] = slot.words[k].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);    // the words are read before the check
+        if(slot.sequence.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(&record, words, sizeof(record));
+            return READ_OK;
+        }
+        ++retries;
+    }
+    return READ_NOT_YET;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// throughput and latency of the ring with several readers
+// Readers are threads with their own mapping, like separate processes. The
+// pose timestamp is set right before publish(), so the age of a pose when a
+// reader first sees it is the publish-to-read latency.
+///////////////////////////////////////////////////////////////////////////////
+bool benchmarkPoseShm(int readers, double seconds, double rate, PoseShmBenchmark& result)
+{
+    memset(&result, 0, sizeof(result));
+    result.readers = readers;
+
+    PoseServer server;
+    if(readers <= 0 || seconds <= 0 || !server.open(BENCHMARK_NAME))
+        return false;
+
+    std::vector<PoseClient> clients(readers);
+    for(int i = 0; i < readers; ++i)
+    {
+        if(!clients[i].open(BENCHMARK_NAME))
+            return false;
+    }
+
+    // per reader results, each in its own cache lines
+    struct ReaderStats
+    {
+        int64_t reads;
+        int64_t seen;
+        double latencySum;
+        double latencyMax;
+        std::vector<int64_t> histogram;
+        char padding[64];
+    };
+    std::vector<ReaderStats> stats(readers);
+    std::atomic<bool> loopFlag(true);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < readers; ++i)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            ReaderStats& s = stats[i];
+            s.reads = s.seen = 0;
+            s.latencySum = s.latencyMax = 0;
+            s.histogram.assign(LATENCY_BUCKETS, 0);
+            TrackingPose pose;
+            while(loopFlag.load(std::memory_order_relaxed))
+            {
+                ++s.reads;
+                if(!clients[i].getPose(pose))
+                    continue;
+
+                double latency = (double)(getTrackingTime() - pose.timestamp);
+                ++s.seen;
+                s.latencySum += latency;
+                s.latencyMax = std::max(s.latencyMax, latency);
+                ++s.histogram[std::min((int)latency, LATENCY_BUCKETS - 1)];
+            }
+        }));
+    }
+
+    // publish from this thread
+    TrackingPose pose;
+    memset(&pose, 0, sizeof(pose));
+    int64_t period = rate > 0 ? (int64_t)(1000000 / rate) : 0;
+    int64_t start = getTrackingTime();
+    int64_t end = start + (int64_t)(seconds * 1000000);
+    int64_t next = start;
+    int64_t now = start;
+    while(now < end)
+    {
+        pose.sequence = server.getPublishedCount() + 1;
+        pose.glassPosition.x = (float)pose.sequence;
+        pose.timestamp = getTrackingTime();
+        server.publish(pose);
+
+        if(period > 0)
+        {
+            next += period;
+            std::this_thread::sleep_until(toTimePoint(next));
+        }
+        now = getTrackingTime();
+    }
+    double elapsed = (now - start) * 1e-6;
+
+    loopFlag = false;
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    // merge
+    int64_t reads = 0, seen = 0, retries = 0;
+    double latencySum = 0;
+    std::vector<int64_t> histogram(LATENCY_BUCKETS, 0);
+    for(int i = 0; i < readers; ++i)
+    {
+        reads += stats[i].reads;
+        seen += stats[i].seen;
+        retries += clients[i].getRetryCount();
+        latencySum += stats[i].latencySum;
+        result.latencyMax = std::max(result.latencyMax, stats[i].latencyMax);
+        for(int k = 0; k < LATENCY_BUCKETS; ++k)
+            histogram[k] += stats[i].histogram[k];
+    }
+
+    result.publishRate = server.getPublishedCount() / elapsed;
+    result.readRate = reads / elapsed;
+    result.retryRatio = reads > 0 ? (double)retries / reads : 0;
+    result.latencyAverage = seen > 0 ? latencySum / seen : 0;
+    int64_t count = 0;
+    for(int k = 0; k < LATENCY_BUCKETS && seen > 0; ++k)
+    {
+        count += histogram[k];
+        if(count * 100 >= seen * 99)
+        {
+            result.latency99 = k + 1;
+            break;
+        }
+    }
+    return true;
+}
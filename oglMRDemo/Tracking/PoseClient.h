@@ -0,0 +1,86 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PoseClient.h
+// ============
+// Reader of the shared-memory pose ring written by PoseServer (see PoseShm.h).
+// Any number of clients in any number of processes read at the same time;
+// a read is a copy of 128 bytes between 2 loads, no lock and no syscall.
+//
+// USAGE (one thread per client):
+//     PoseClient client;
+//     if(client.open())                       // fails until a server is up
+//     {
+//         TrackingPose pose;
+//         if(client.getPose(pose))            // newest, true if not seen before
+//             ...
+//     }
+//
+// getPose() skips the poses published between 2 calls. A recorder that needs
+// every pose reads them one by one with readPose(n), up to POSE_SHM_SLOTS
+// poses behind the newest.
+//
+// benchmarkPoseShm() measures read throughput and publish-to-read latency
+// with a server and several reading threads, each with its own mapping.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef POSE_CLIENT_H
+#define POSE_CLIENT_H
+
+#include <cstdint>
+#include "PoseShm.h"
+#include "TrackingPose.h"
+#include "../Common/SharedMemory.h"
+
+class PoseClient
+{
+public:
+    PoseClient();
+
+    bool open(const char* name = POSE_SHM_NAME);    // map the ring of a running server
+    void close();
+    bool isOpen() const                             { return header != 0; }
+    bool isProducerRunning() const;                 // false once the server closed, reopen then
+    uint32_t getProducerId() const                  { return header ? header->producerId : 0; }
+
+    // number of the newest pose, 0 if none yet
+    uint32_t getPublishedCount() const;
+
+    // newest pose, return true if it is newer than the previous call
+    bool getPose(TrackingPose& pose);
+
+    // pose n (1, 2, ...), false if not published yet or already overwritten
+    bool readPose(uint32_t n, TrackingPose& pose);
+
+    // copies started again because the server wrote the slot meanwhile
+    int64_t getRetryCount() const                   { return retries; }
+
+private:
+    enum ReadResult { READ_OK, READ_NOT_YET, READ_OVERWRITTEN };
+    ReadResult readSlot(uint32_t n, TrackingRecord& record);
+
+    SharedMemory memory;
+    const PoseShmHeader* header;
+    const PoseShmSlot* slots;
+    uint32_t lastRead;                              // n returned by the last getPose()
+    int64_t retries;
+};
+
+// result of benchmarkPoseShm()
+struct PoseShmBenchmark
+{
+    int readers;
+    double publishRate;                             // poses per second
+    double readRate;                                // getPose() calls per second, all readers
+    double retryRatio;                              // retries per getPose()
+    double latencyAverage;                          // microseconds from publish() to the first getPose() returning it
+    double latency99;                               // 99th percentile
+    double latencyMax;
+};
+
+// publish at rate Hz (0 = as fast as possible) for seconds while readers
+// threads poll getPose(); the ring is created under a name of its own
+bool benchmarkPoseShm(int readers, double seconds, double rate, PoseShmBenchmark& result);
+
+#endif
@@ -0,0 +1,422 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PosePredictor.cpp
+// =================
+// Predict the glasses and pen pose at the time the frame is displayed.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "PosePredictor.h"
+
+const float DEFAULT_ALPHA = 0.5f;
+const float DEFAULT_PROCESS_NOISE = 50.0f;          // (unit/s^2)^2 * s, fast hand motion
+const float DEFAULT_MEASUREMENT_NOISE = 1e-6f;      // unit^2, about 1 mm
+const float MAX_INTERVAL = 0.25f;                   // a longer gap restarts the filter (second)
+const float RAD2DEG = 57.2957795f;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+PosePredictor::PosePredictor(Method method) : method(method), alpha(DEFAULT_ALPHA),
+                                              processNoise(DEFAULT_PROCESS_NOISE),
+                                              measurementNoise(DEFAULT_MEASUREMENT_NOISE)
+{
+    reset();
+}
+
+PosePredictor::~PosePredictor()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::setMethod(Method method)
+{
+    this->method = method;
+    reset();
+}
+
+void PosePredictor::setSmoothing(float alpha)
+{
+    if(alpha <= 0) alpha = 0.01f;
+    if(alpha > 1) alpha = 1;
+    this->alpha = alpha;
+}
+
+void PosePredictor::setKalmanNoise(float process, float measurement)
+{
+    processNoise = process > 0 ? process : 0;
+    measurementNoise = measurement > 0 ? measurement : 1e-12f;
+}
+
+void PosePredictor::reset()
+{
+    memset(history, 0, sizeof(history));
+    head = sampleCount = 0;
+    memset(lastRotation, 0, sizeof(lastRotation));
+    memset(smooth1, 0, sizeof(smooth1));
+    memset(smooth2, 0, sizeof(smooth2));
+    memset(kalmanX, 0, sizeof(kalmanX));
+    memset(kalmanV, 0, sizeof(kalmanV));
+    memset(kalmanP, 0, sizeof(kalmanP));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a latched pose
+// The render loop runs faster than the tracker, so the same tracker data is
+// latched several times. Those repeats are dropped, otherwise they look like
+// the target stopped and pull the velocity to 0.
+///////////////////////////////////////////////////////////////////////////////
+bool PosePredictor::addSample(const TrackingPose& pose)
+{
+    float values[CHANNEL_COUNT];
+    toChannels(pose, values);
+
+    float dt = 0;
+    if(sampleCount > 0)
+    {
+        const TrackingPose& last = getLastSample();
+        if(memcmp(&pose.glassPosition, &last.glassPosition, sizeof(pose.glassPosition)) == 0 &&
+           memcmp(&pose.glassRotation, &last.glassRotation, sizeof(pose.glassRotation)) == 0 &&
+           memcmp(&pose.penPosition, &last.penPosition, sizeof(pose.penPosition)) == 0 &&
+           memcmp(&pose.penDirection, &last.penDirection, sizeof(pose.penDirection)) == 0)
+            return false;
+
+        // keep the quaternion on the hemisphere of the previous one
+        if(values[3] * lastRotation[0] + values[4] * lastRotation[1] + values[5] * lastRotation[2] + values[6] * lastRotation[3] < 0)
+        {
+            for(int i = 3; i < 7; ++i)
+                values[i] = -values[i];
+        }
+
+        dt = (pose.timestamp - last.timestamp) * 1e-6f;
+        if(dt <= 0 || dt > MAX_INTERVAL)
+            sampleCount = 0;                        // clock jump or tracking lost, restart
+    }
+    memcpy(lastRotation, values + 3, sizeof(lastRotation));
+
+    history[head] = pose;
+    head = (head + 1) % HISTORY_SIZE;
+
+    if(sampleCount == 0)
+    {
+        for(int i = 0; i < CHANNEL_COUNT; ++i)
+        {
+            smooth1[i] = smooth2[i] = kalmanX[i] = values[i];
+            kalmanV[i] = 0;
+            kalmanP[i][0] = measurementNoise;
+            kalmanP[i][1] = 0;
+            kalmanP[i][2] = processNoise;
+        }
+    }
+    else if(method == METHOD_DOUBLE_EXPONENTIAL)
+    {
+        updateDoubleExponential(values);
+    }
+    else if(method == METHOD_KALMAN)
+    {
+        updateKalman(values, dt);
+    }
+
+    if(sampleCount < HISTORY_SIZE)
+        ++sampleCount;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// average interval of the samples in the history
+///////////////////////////////////////////////////////////////////////////////
+double PosePredictor::getAverageInterval() const
+{
+    if(sampleCount < 2)
+        return 0;
+
+    int64_t newest = history[(head + HISTORY_SIZE - 1) % HISTORY_SIZE].timestamp;
+    int64_t oldest = history[(head + HISTORY_SIZE - sampleCount) % HISTORY_SIZE].timestamp;
+    return (newest - oldest) * 1e-6 / (sampleCount - 1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// extrapolate the filtered pose to displayTime
+///////////////////////////////////////////////////////////////////////////////
+TrackingPose PosePredictor::predict(int64_t displayTime) const
+{
+    if(sampleCount == 0)
+    {
+        TrackingPose pose;
+        memset(&pose, 0, sizeof(pose));
+        return pose;
+    }
+
+    TrackingPose pose = getLastSample();
+    if(method == METHOD_NONE || sampleCount < 2)
+        return pose;
+
+    float ahead = (displayTime - pose.timestamp) * 1e-6f;
+    if(ahead < 0) ahead = 0;
+    if(ahead > MAX_INTERVAL) ahead = MAX_INTERVAL;
+
+    float values[CHANNEL_COUNT];
+    if(method == METHOD_DOUBLE_EXPONENTIAL)
+    {
+        // the filter steps are sample intervals, convert look-ahead to steps
+        float interval = (float)getAverageInterval();
+        float steps = interval > 0 ? ahead / interval : 0;
+        float a = alpha < 1 ? alpha / (1 - alpha) * steps : 0;
+        for(int i = 0; i < CHANNEL_COUNT; ++i)
+        {
+            if(alpha < 1)
+                values[i] = (2 + a) * smooth1[i] - (1 + a) * smooth2[i];
+            else
+                values[i] = smooth1[i];
+        }
+    }
+    else
+    {
+        // the filter state is at the last sample, move it forward
+        for(int i = 0; i < CHANNEL_COUNT; ++i)
+            values[i] = kalmanX[i] + kalmanV[i] * ahead;
+    }
+
+    fromChannels(values, pose);
+    return pose;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// double exponential smoothing
+//     s1 = a * x + (1 - a) * s1
+//     s2 = a * s1 + (1 - a) * s2
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::updateDoubleExponential(const float* values)
+{
+    for(int i = 0; i < CHANNEL_COUNT; ++i)
+    {
+        smooth1[i] = alpha * values[i] + (1 - alpha) * smooth1[i];
+        smooth2[i] = alpha * smooth1[i] + (1 - alpha) * smooth2[i];
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// constant-velocity Kalman filter, state [x v], measurement x
+//     F = |1 dt|   Q = q * |dt^3/3 dt^2/2|
+//         |0  1|           |dt^2/2 dt    |
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::updateKalman(const float* values, float dt)
+{
+    float q00 = processNoise * dt * dt * dt / 3;
+    float q01 = processNoise * dt * dt / 2;
+    float q11 = processNoise * dt;
+
+    for(int i = 0; i < CHANNEL_COUNT; ++i)
+    {
+        float* p = kalmanP[i];
+
+        // predict
+        float x = kalmanX[i] + kalmanV[i] * dt;
+        float v = kalmanV[i];
+        float p00 = p[0] + 2 * dt * p[1] + dt * dt * p[2] + q00;
+        float p01 = p[1] + dt * p[2] + q01;
+        float p11 = p[2] + q11;
+
+        // update
+        float s = p00 + measurementNoise;
+        float k0 = p00 / s;
+        float k1 = p01 / s;
+        float y = values[i] - x;
+        kalmanX[i] = x + k0 * y;
+        kalmanV[i] = v + k1 * y;
+        p[0] = (1 - k0) * p00;
+        p[1] = (1 - k0) * p01;
+        p[2] = p11 - k1 * p01;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// pose <-> filter channels
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::toChannels(const TrackingPose& pose, float* values) const
+{
+    values[0] = pose.glassPosition.x;
+    values[1] = pose.glassPosition.y;
+    values[2] = pose.glassPosition.z;
+    values[3] = pose.glassRotation.x;
+    values[4] = pose.glassRotation.y;
+    values[5] = pose.glassRotation.z;
+    values[6] = pose.glassRotation.w;
+    values[7] = pose.penPosition.x;
+    values[8] = pose.penPosition.y;
+    values[9] = pose.penPosition.z;
+    values[10] = pose.penDirection.x;
+    values[11] = pose.penDirection.y;
+    values[12] = pose.penDirection.z;
+}
+
+void PosePredictor::fromChannels(const float* values, TrackingPose& pose) const
+{
+    pose.glassPosition.x = values[0];
+    pose.glassPosition.y = values[1];
+    pose.glassPosition.z = values[2];
+    pose.penPosition.x = values[7];
+    pose.penPosition.y = values[8];
+    pose.penPosition.z = values[9];
+
+    float length = sqrtf(values[3] * values[3] + values[4] * values[4] + values[5] * values[5] + values[6] * values[6]);
+    if(length > 0)
+    {
+        pose.glassRotation.x = values[3] / length;
+        pose.glassRotation.y = values[4] / length;
+        pose.glassRotation.z = values[5] / length;
+        pose.glassRotation.w = values[6] / length;
+    }
+
+    length = sqrtf(values[10] * values[10] + values[11] * values[11] + values[12] * values[12]);
+    if(length > 0)
+    {
+        pose.penDirection.x = values[10] / length;
+        pose.penDirection.y = values[11] / length;
+        pose.penDirection.z = values[12] / length;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// recorded pose at time t, linear between samples (nlerp for rotation)
+///////////////////////////////////////////////////////////////////////////////
+static bool interpolatePose(const std::vector<TrackingPose>& trajectory, int64_t t, TrackingPose& pose)
+{
+    if(trajectory.empty() || t < trajectory.front().timestamp || t > trajectory.back().timestamp)
+        return false;
+
+    // binary search the first sample after t
+    size_t lo = 0, hi = trajectory.size() - 1;
+    while(lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if(trajectory[mid].timestamp <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    const TrackingPose& b = trajectory[lo];
+    const TrackingPose& a = trajectory[lo > 0 ? lo - 1 : 0];
+    float s = b.timestamp > a.timestamp ? (float)(t - a.timestamp) / (b.timestamp - a.timestamp) : 0;
+    if(s > 1) s = 1;
+
+    pose = a;
+    pose.timestamp = t;
+    pose.glassPosition.x += (b.glassPosition.x - a.glassPosition.x) * s;
+    pose.glassPosition.y += (b.glassPosition.y - a.glassPosition.y) * s;
+    pose.glassPosition.z += (b.glassPosition.z - a.glassPosition.z) * s;
+    pose.penPosition.x += (b.penPosition.x - a.penPosition.x) * s;
+    pose.penPosition.y += (b.penPosition.y - a.penPosition.y) * s;
+    pose.penPosition.z += (b.penPosition.z - a.penPosition.z) * s;
+
+    f3d::Quaternion qa = a.glassRotation, qb = b.glassRotation;
+    float sign = qa.x * qb.x + qa.y * qb.y + qa.z * qb.z + qa.w * qb.w < 0 ? -1.0f : 1.0f;
+    f3d::Quaternion q;
+    q.x = qa.x + (sign * qb.x - qa.x) * s;
+    q.y = qa.y + (sign * qb.y - qa.y) * s;
+    q.z = qa.z + (sign * qb.z - qa.z) * s;
+    q.w = qa.w + (sign * qb.w - qa.w) * s;
+    float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if(length > 0)
+    {
+        q.x /= length; q.y /= length; q.z /= length; q.w /= length;
+    }
+    pose.glassRotation = q;
+    return true;
+}
+
+static float distance(const f3d::Vector3& a, const f3d::Vector3& b)
+{
+    float x = a.x - b.x, y = a.y - b.y, z = a.z - b.z;
+    return sqrtf(x * x + y * y + z * z);
+}
+
+static float angle(const f3d::Quaternion& a, const f3d::Quaternion& b)
+{
+    float d = fabsf(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    if(d > 1) d = 1;
+    return 2 * acosf(d) * RAD2DEG;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// feed the trajectory sample by sample, predict every sample forward by each
+// look-ahead and compare with the recorded pose at that time
+///////////////////////////////////////////////////////////////////////////////
+std::vector<PredictionError> evaluatePrediction(const std::vector<TrackingPose>& trajectory,
+                                                const std::vector<int64_t>& lookAheads,
+                                                PosePredictor predictor)
+{
+    std::vector<PredictionError> errors;
+
+    for(size_t i = 0; i < lookAheads.size(); ++i)
+    {
+        PredictionError error;
+        memset(&error, 0, sizeof(error));
+        error.lookAhead = lookAheads[i];
+
+        predictor.reset();
+        double positionSum = 0, angleSum = 0;
+        std::chrono::steady_clock::duration cpuTime(0);
+        int calls = 0;
+
+        for(size_t j = 0; j < trajectory.size(); ++j)
+        {
+            int64_t displayTime = trajectory[j].timestamp + lookAheads[i];
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            predictor.addSample(trajectory[j]);
+            TrackingPose predicted = predictor.predict(displayTime);
+            cpuTime += std::chrono::steady_clock::now() - start;
+            ++calls;
+
+            TrackingPose truth;
+            if(!interpolatePose(trajectory, displayTime, truth))
+                continue;
+
+            float position = (distance(predicted.glassPosition, truth.glassPosition) +
+                              distance(predicted.penPosition, truth.penPosition)) * 0.5f;
+            float rotation = angle(predicted.glassRotation, truth.glassRotation);
+            positionSum += position;
+            angleSum += rotation;
+            if(position > error.maxPosition) error.maxPosition = position;
+            if(rotation > error.maxAngle) error.maxAngle = rotation;
+            ++error.count;
+        }
+
+        if(error.count > 0)
+        {
+            error.meanPosition = (float)(positionSum / error.count);
+            error.meanAngle = (float)(angleSum / error.count);
+        }
+        if(calls > 0)
+            error.cpuTimePerSample = std::chrono::duration<double, std::micro>(cpuTime).count() / calls;
+        errors.push_back(error);
+    }
+    return errors;
+}
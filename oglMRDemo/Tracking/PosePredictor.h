@@ -0,0 +1,110 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PosePredictor.h
+// ===============
+// Predict the glasses and pen pose at the time the frame is displayed.
+// FSCore updates the pose at the tracker rate (fmGetFps()), not the render
+// rate, and the frame is shown some time after it was sampled, so the pen ray
+// lags behind fast motion. addSample() takes every latched pose, keeps only
+// the ones carrying new tracker data in a timestamped history, and predict()
+// extrapolates the pose to a requested display time.
+//
+// 2 filters are available:
+// METHOD_DOUBLE_EXPONENTIAL: double exponential smoothing (Holt/LaViola), cheap,
+//                            one smoothing factor
+// METHOD_KALMAN:             constant-velocity Kalman filter per channel with
+//                            real sample intervals, process and measurement noise
+//
+// Rotation is filtered as 4 quaternion components kept on one hemisphere and
+// normalized after prediction, the pen direction is normalized the same way.
+// Status and key values are never predicted, they are copied from the newest
+// sample.
+//
+// evaluatePrediction() runs a predictor over a recorded trajectory offline and
+// reports the error against the recorded pose at t + look-ahead.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef POSE_PREDICTOR_H
+#define POSE_PREDICTOR_H
+
+#include <vector>
+#include "TrackingPose.h"
+
+class PosePredictor
+{
+public:
+    enum Method
+    {
+        METHOD_NONE = 0,                            // return the newest sample as is
+        METHOD_DOUBLE_EXPONENTIAL,
+        METHOD_KALMAN
+    };
+
+    PosePredictor(Method method = METHOD_NONE);
+    ~PosePredictor();
+
+    void setMethod(Method method);                  // also reset the filter
+    Method getMethod() const                        { return method; }
+    void setSmoothing(float alpha);                 // double exponential, (0,1], 1: no smoothing
+    void setKalmanNoise(float process, float measurement); // accel spectral density, measurement variance
+    void reset();
+
+    // return true if the pose has new tracker data and was added to the history
+    bool addSample(const TrackingPose& pose);
+
+    // pose extrapolated to displayTime (microseconds of getTrackingTime())
+    TrackingPose predict(int64_t displayTime) const;
+
+    int getSampleCount() const                      { return sampleCount; }
+    double getAverageInterval() const;              // average sample interval in the history (second)
+    const TrackingPose& getLastSample() const       { return history[(head + HISTORY_SIZE - 1) % HISTORY_SIZE]; }
+
+private:
+    enum { HISTORY_SIZE = 32 };
+    enum { CHANNEL_COUNT = 13 };                    // glass pos(3) + rot(4) + pen pos(3) + dir(3)
+
+    void toChannels(const TrackingPose& pose, float* values) const;
+    void fromChannels(const float* values, TrackingPose& pose) const;
+    void updateDoubleExponential(const float* values);
+    void updateKalman(const float* values, float dt);
+
+    Method method;
+    float alpha;
+    float processNoise;
+    float measurementNoise;
+
+    TrackingPose history[HISTORY_SIZE];             // ring buffer of accepted samples
+    int head;                                       // next slot to write
+    int sampleCount;
+    float lastRotation[4];                          // last quaternion on the filter hemisphere
+
+    // double exponential state
+    float smooth1[CHANNEL_COUNT];
+    float smooth2[CHANNEL_COUNT];
+
+    // Kalman state: position, velocity and covariance [p00 p01 p11] per channel
+    float kalmanX[CHANNEL_COUNT];
+    float kalmanV[CHANNEL_COUNT];
+    float kalmanP[CHANNEL_COUNT][3];
+};
+
+// error of a predictor for one look-ahead time over a trajectory
+struct PredictionError
+{
+    int64_t lookAhead;              // microseconds
+    int count;                      // number of predictions compared
+    float meanPosition;             // glasses and pen position error, same unit as FSCore
+    float maxPosition;
+    float meanAngle;                // glasses rotation error in degree
+    float maxAngle;
+    double cpuTimePerSample;        // addSample() + predict() in microseconds
+};
+
+// run predictor over trajectory (sorted by timestamp) once per look-ahead time
+std::vector<PredictionError> evaluatePrediction(const std::vector<TrackingPose>& trajectory,
+                                                const std::vector<int64_t>& lookAheads,
+                                                PosePredictor predictor);
+
+#endif
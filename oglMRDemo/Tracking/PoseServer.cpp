@@ -0,0 +1,131 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PoseServer.cpp
+// ==============
+// Producer of the shared-memory pose ring.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include "PoseServer.h"
+
+// true if the process may still be running
+static bool isProcessAlive(uint32_t id)
+{
+#ifdef _WIN32
+    HANDLE process = ::OpenProcess(SYNCHRONIZE, FALSE, (DWORD)id);
+    if(!process)
+        return ::GetLastError() == ERROR_ACCESS_DENIED;
+    bool alive = ::WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    ::CloseHandle(process);
+    return alive;
+#else
+    return ::kill((pid_t)id, 0) == 0 || errno == EPERM;
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+PoseServer::PoseServer() : header(0), slots(0), published(0)
+{
+}
+
+PoseServer::~PoseServer()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create the block and fill the header, magic last so clients never see a
+// partly written header
+///////////////////////////////////////////////////////////////////////////////
+bool PoseServer::open(const char* name)
+{
+    close();
+    if(!memory.create(name, POSE_SHM_SIZE))
+    {
+        // replace the ring only if its server is gone
+        SharedMemory old;
+        if(old.open(name) && old.getSize() >= sizeof(PoseShmHeader))
+        {
+            const PoseShmHeader* h = (const PoseShmHeader*)old.getData();
+            if(h->magic.load(std::memory_order_acquire) != POSE_SHM_MAGIC ||
+               (h->running.load(std::memory_order_acquire) && isProcessAlive(h->producerId)))
+                return false;
+        }
+        old.close();
+        SharedMemory::remove(name);
+        if(!memory.create(name, POSE_SHM_SIZE))
+            return false;
+    }
+
+    header = (PoseShmHeader*)memory.getData();      // zero filled
+    slots = (PoseShmSlot*)(header + 1);
+    header->version = POSE_SHM_VERSION;
+    header->headerSize = sizeof(PoseShmHeader);
+    header->slotSize = sizeof(PoseShmSlot);
+    header->slotCount = POSE_SHM_SLOTS;
+    header->recordSize = sizeof(TrackingRecord);
+#ifdef _WIN32
+    header->producerId = (uint32_t)::GetCurrentProcessId();
+#else
+    header->producerId = (uint32_t)::getpid();
+#endif
+    header->running.store(1, std::memory_order_relaxed);
+    header->published.store(0, std::memory_order_relaxed);
+    header->magic.store(POSE_SHM_MAGIC, std::memory_order_release);
+    published = 0;
+    return true;
+}
+
+void PoseServer::close()
+{
+    if(!header)
+        return;
+
+    header->running.store(0, std::memory_order_release);
+    memory.close();
+    header = 0;
+    slots = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// write the pose to the next slot under its seqlock, then advance the count
+///////////////////////////////////////////////////////////////////////////////
+void PoseServer::publish(const TrackingPose& pose)
+{
+    if(!header)
+        return;
+
+    TrackingRecord record;
+    packTrackingRecord(pose, record);
+    uint32_t words[POSE_SHM_WORDS];
+    memcpy(words, &record, sizeof(words));
+
+    uint32_t n = published + 1;
+    PoseShmSlot& slot = slots[(n - 1) % POSE_SHM_SLOTS];
+
+    slot.sequence.store(2 * n - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);    // odd sequence is seen before any word
+    for(int i = 0; i < POSE_SHM_WORDS; ++i)
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    slot.sequence.store(2 * n, std::memory_order_release);
+
+    header->published.store(n, std::memory_order_release);
+    published = n;
+}
@@ -0,0 +1,44 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PoseServer.h
+// ============
+// Producer of the shared-memory pose ring (see PoseShm.h). Stands in for the
+// local tracking service that fmInit(isStartServer) implies: the process
+// that polls FSCore publishes every pose, other processes read them with
+// PoseClient instead of calling the DLL.
+//
+// publish() is wait-free and must be called from one thread (the tracking
+// thread, see TrackingThread::setServer()).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef POSE_SERVER_H
+#define POSE_SERVER_H
+
+#include <cstdint>
+#include "PoseShm.h"
+#include "TrackingPose.h"
+#include "../Common/SharedMemory.h"
+
+class PoseServer
+{
+public:
+    PoseServer();
+    ~PoseServer();                                  // close
+
+    bool open(const char* name = POSE_SHM_NAME);    // create the ring, fails if a live server has it
+    void close();                                   // clients see the producer stopped
+    bool isOpen() const                             { return header != 0; }
+
+    void publish(const TrackingPose& pose);
+    uint32_t getPublishedCount() const              { return published; }
+
+private:
+    SharedMemory memory;
+    PoseShmHeader* header;
+    PoseShmSlot* slots;
+    uint32_t published;
+};
+
+#endif
@@ -0,0 +1,73 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// PoseShm.h
+// =========
+// Layout of the shared-memory pose ring written by PoseServer and read by
+// PoseClient, so several processes (this demo, the Unity bridge, recorders)
+// read the newest tracking pose without a DLL call or a syscall.
+//
+// memory layout
+// =============
+// [PoseShmHeader, 64 bytes][slot 0][slot 1]...[slot POSE_SHM_SLOTS-1]
+//
+// Poses are stored as TrackingRecord (fixed layout, see TrackingRecorder.h).
+// Pose n (1, 2, ...) goes to slot (n - 1) % POSE_SHM_SLOTS, and the header
+// counts the published poses. Each slot is a seqlock: its sequence is
+// 2n - 1 while pose n is written and 2n once it is complete. A reader copies
+// the slot between 2 reads of the sequence and retries if they differ or are
+// odd. The writer never waits for readers, and a reader only retries if the
+// writer comes back to the same slot during the copy, POSE_SHM_SLOTS poses
+// later.
+//
+// The record is kept in 32-bit atomic words, so the racing copy of a reader
+// is well defined; the loads and stores are plain moves on x86.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef POSE_SHM_H
+#define POSE_SHM_H
+
+#include <atomic>
+#include <cstdint>
+#include "TrackingRecorder.h"
+
+const char* const POSE_SHM_NAME = "fmTrackingPoses";
+const uint32_t POSE_SHM_MAGIC = 0x4D485346;        // "FSHM"
+const uint32_t POSE_SHM_VERSION = 1;
+const int POSE_SHM_SLOTS = 64;                      // 128 ms of history at 500 Hz
+const int POSE_SHM_WORDS = sizeof(TrackingRecord) / sizeof(uint32_t);
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared atomics must be lock-free");
+static_assert(sizeof(TrackingRecord) % sizeof(uint32_t) == 0, "record must be whole words");
+
+// 64 bytes, magic is written last when the producer is ready
+struct PoseShmHeader
+{
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t slotSize;
+    uint32_t slotCount;
+    uint32_t recordSize;
+    uint32_t producerId;                            // process id of the producer
+    std::atomic<uint32_t> running;                  // 0 once the producer closed
+    std::atomic<uint32_t> published;                // poses published so far, n of the newest
+    uint8_t reserved[28];
+};
+
+// one pose, 2 cache lines so neighbours do not share a line
+struct PoseShmSlot
+{
+    std::atomic<uint32_t> sequence;                 // 2n - 1 while pose n is written, 2n when done
+    uint32_t reserved;
+    std::atomic<uint32_t> words[POSE_SHM_WORDS];    // TrackingRecord
+    uint8_t padding[128 - 8 - POSE_SHM_WORDS * 4];
+};
+
+static_assert(sizeof(PoseShmHeader) == 64, "header layout");
+static_assert(sizeof(PoseShmSlot) == 128, "slot layout");
+
+const size_t POSE_SHM_SIZE = sizeof(PoseShmHeader) + sizeof(PoseShmSlot) * POSE_SHM_SLOTS;
+
+#endif
@@ -0,0 +1,153 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingEvents.cpp
+// ==================
+// Pen button and device status changes as events.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TrackingEvents.h"
+
+const int64_t DEFAULT_HOLD_TIME = 500000;           // 0.5 s
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+TrackingEvents::TrackingEvents() : dropped(0), holdTime(DEFAULT_HOLD_TIME)
+{
+    reset();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// start from no key down, nothing tracked and awake, so the first pose
+// reports the keys already down and the devices already tracked
+///////////////////////////////////////////////////////////////////////////////
+void TrackingEvents::reset()
+{
+    penKey = 0;
+    glassTracked = penTracked = sleeping = false;
+    for(int i = 0; i < KEY_COUNT; ++i)
+    {
+        pressTime[i] = 0;
+        holdSent[i] = false;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compare the pose with the previous one and emit the differences
+///////////////////////////////////////////////////////////////////////////////
+int TrackingEvents::update(const TrackingPose& pose)
+{
+    int count = 0;
+
+    // status first, so a pen connecting with a key down reports the
+    // connection before the press
+    bool sleep = pose.isSleep != 0;
+    if(sleep != sleeping)
+    {
+        emit(sleep ? TrackingEvent::SLEEP : TrackingEvent::WAKE, 0, pose);
+        sleeping = sleep;
+        ++count;
+    }
+
+    bool glass = pose.glassStatus != 0;
+    if(glass != glassTracked)
+    {
+        emit(glass ? TrackingEvent::GLASS_CONNECT : TrackingEvent::GLASS_DISCONNECT, 0, pose);
+        glassTracked = glass;
+        ++count;
+    }
+
+    bool pen = pose.penStatus != 0;
+    if(pen != penTracked)
+    {
+        emit(pen ? TrackingEvent::PEN_CONNECT : TrackingEvent::PEN_DISCONNECT, 0, pose);
+        penTracked = pen;
+        ++count;
+    }
+
+    int changed = pose.penKey ^ penKey;
+    for(int i = 0; i < KEY_COUNT; ++i)
+    {
+        int bit = 1 << i;
+        if(changed & bit)
+        {
+            if(pose.penKey & bit)
+            {
+                pressTime[i] = pose.timestamp;
+                holdSent[i] = false;
+                emit(TrackingEvent::KEY_PRESS, bit, pose);
+            }
+            else
+            {
+                emit(TrackingEvent::KEY_RELEASE, bit, pose, pose.timestamp - pressTime[i]);
+            }
+            ++count;
+        }
+        else if((pose.penKey & bit) && !holdSent[i] && pose.timestamp - pressTime[i] >= holdTime)
+        {
+            holdSent[i] = true;
+            emit(TrackingEvent::KEY_HOLD, bit, pose, pose.timestamp - pressTime[i]);
+            ++count;
+        }
+    }
+    penKey = pose.penKey;
+
+    return count;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// push an event to every consumer, drop it for consumers whose queue is full
+///////////////////////////////////////////////////////////////////////////////
+void TrackingEvents::emit(int type, int key, const TrackingPose& pose, int64_t duration)
+{
+    TrackingEvent event;
+    event.type = type;
+    event.key = key;
+    event.timestamp = pose.timestamp;
+    event.duration = duration;
+    event.sequence = pose.sequence;
+
+    for(int i = 0; i < CONSUMER_COUNT; ++i)
+    {
+        if(!queues[i].push(event))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// next event of a consumer, false if there is none
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingEvents::pop(int consumer, TrackingEvent& event)
+{
+    if(consumer < 0 || consumer >= CONSUMER_COUNT)
+        return false;
+    return queues[consumer].pop(event);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// name of an event type for the log
+///////////////////////////////////////////////////////////////////////////////
+const wchar_t* TrackingEvents::getTypeName(int type)
+{
+    static const wchar_t* names[] = { L"key press", L"key release", L"key hold",
+                                      L"glasses connect", L"glasses disconnect",
+                                      L"pen connect", L"pen disconnect",
+                                      L"sleep", L"wake" };
+    if(type < 0 || type >= (int)(sizeof(names) / sizeof(names[0])))
+        return L"unknown";
+    return names[type];
+}
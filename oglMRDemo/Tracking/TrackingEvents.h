@@ -0,0 +1,94 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingEvents.h
+// ================
+// Pen button and device status changes as events, instead of polling
+// fmGetPenKey()/fmGet*Status()/fmGetIsSleep() every frame.
+//
+// The tracking thread passes each pose to update(), which compares it with
+// the previous pose and pushes an event for every change into one queue per
+// consumer (UI thread and rendering thread). Each consumer drains its own
+// queue with pop(). The queues are lock-free; when a consumer does not drain
+// its queue, new events for it are dropped and counted, the tracking thread
+// never waits.
+//
+// The timestamp of an event is the sample time of the pose in which the
+// change was seen, not the time the consumer pops it.
+//
+// events
+// ======
+// KEY_PRESS, KEY_RELEASE: a bit of fmGetPenKey() changed, key is the bit
+// KEY_HOLD             : the key is down for hold time (once per press)
+// GLASS_/PEN_CONNECT, GLASS_/PEN_DISCONNECT: fmGet*Status() changed
+// SLEEP, WAKE          : fmGetIsSleep() changed
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACKING_EVENTS_H
+#define TRACKING_EVENTS_H
+
+#include <atomic>
+#include <cstdint>
+#include "TrackingPose.h"
+#include "../Common/MpscQueue.h"
+
+struct TrackingEvent
+{
+    enum Type
+    {
+        KEY_PRESS = 0,
+        KEY_RELEASE,
+        KEY_HOLD,
+        GLASS_CONNECT,
+        GLASS_DISCONNECT,
+        PEN_CONNECT,
+        PEN_DISCONNECT,
+        SLEEP,
+        WAKE
+    };
+
+    int type;
+    int key;                        // key bit of KEY_* events, 0 for others
+    int64_t timestamp;              // sample time of the pose, microseconds (steady clock)
+    int64_t duration;               // KEY_RELEASE, KEY_HOLD: time since KEY_PRESS, microseconds
+    uint32_t sequence;              // sequence of the pose
+};
+
+class TrackingEvents
+{
+public:
+    enum Consumer { CONSUMER_UI = 0, CONSUMER_RENDER, CONSUMER_COUNT };
+
+    TrackingEvents();
+
+    // producer (tracking thread)
+    int update(const TrackingPose& pose);           // return the number of events found
+    void reset();                                   // the next pose is compared with "nothing tracked"
+    void setHoldTime(int64_t time)                  { holdTime = time; }   // microseconds
+
+    // consumers, one thread per consumer
+    bool pop(int consumer, TrackingEvent& event);
+    int getDroppedCount() const                     { return dropped.load(std::memory_order_relaxed); }
+
+    static const wchar_t* getTypeName(int type);
+
+private:
+    static const int KEY_COUNT = 8;                 // bits of fmGetPenKey() watched
+
+    void emit(int type, int key, const TrackingPose& pose, int64_t duration = 0);
+
+    MpscQueue<TrackingEvent> queues[CONSUMER_COUNT];
+    std::atomic<int> dropped;
+
+    // state of the previous pose, owned by the producer
+    int penKey;
+    bool glassTracked;
+    bool penTracked;
+    bool sleeping;
+    int64_t pressTime[KEY_COUNT];
+    bool holdSent[KEY_COUNT];
+    int64_t holdTime;
+};
+
+#endif
@@ -0,0 +1,64 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingPose.cpp
+// ================
+// One snapshot of all tracked values (glasses and pen) taken at one instant.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <mutex>
+#include "TrackingPose.h"
+
+static std::mutex fsCoreLock;           // held during every fm*() call
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// read the glasses and pen with one call, so they are from the same instant
+///////////////////////////////////////////////////////////////////////////////
+TrackingPose sampleTrackingPose(uint32_t sequence)
+{
+    f3d::TrackingSnapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(fsCoreLock);
+        fmGetTrackingSnapshot(&snapshot);
+    }
+
+    TrackingPose pose;
+    pose.timestamp = snapshot.timestamp;
+    pose.glassPosition = snapshot.glassPosition;
+    pose.glassRotation = snapshot.glassRotation;
+    pose.penPosition = snapshot.penPosition;
+    pose.penDirection = snapshot.penDirection;
+    pose.penRoll = snapshot.penRoll;
+    pose.penKey = snapshot.penKey;
+    pose.glassStatus = snapshot.glassStatus;
+    pose.penStatus = snapshot.penStatus;
+    pose.slantAngle = snapshot.slantAngle;
+    pose.isSleep = snapshot.isSleep;
+    pose.sequence = sequence;
+    return pose;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// keep the tracker awake, FSCore sleeps without a call for 5 seconds
+///////////////////////////////////////////////////////////////////////////////
+void setTrackingActiveUser()
+{
+    std::lock_guard<std::mutex> lock(fsCoreLock);
+    fmSetActiveUser();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// switch the display between 3D (1) and 2D (0)
+///////////////////////////////////////////////////////////////////////////////
+void setTrackingVRMode(int flag)
+{
+    std::lock_guard<std::mutex> lock(fsCoreLock);
+    fmSetflagVRMode(flag);
+}
@@ -0,0 +1,65 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingPose.h
+// ==============
+// One snapshot of all tracked values (glasses and pen) taken at one instant.
+// A frame samples it once with sampleTrackingPose() and uses the same snapshot
+// for both eyes and the pen, instead of calling fmGet*() at different times
+// while drawing. All values come from one fmGetTrackingSnapshot() call.
+//
+// timestamp is in microseconds of std::chrono::steady_clock, the same clock
+// used by FrameScheduler, so sample-to-swap latency can be measured.
+//
+// FSCore is not documented as thread safe. After fmInit(), every fm*() call
+// goes through the functions at the end of this file, which share one lock,
+// so the tracking thread and the UI thread are never inside FSCore at once.
+// The tracking thread is the only regular caller, the lock is uncontended.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACKING_POSE_H
+#define TRACKING_POSE_H
+
+#include <chrono>
+#include <cstdint>
+#include "../FCore/FSCore.h"
+
+struct TrackingPose
+{
+    f3d::Vector3 glassPosition;
+    f3d::Quaternion glassRotation;
+    int glassStatus;                // fmGetGlassStatus()
+    f3d::Vector3 penPosition;
+    f3d::Vector3 penDirection;
+    float penRoll;
+    int penKey;                     // fmGetPenKey() bits
+    int penStatus;                  // fmGetPenStatus()
+    float slantAngle;               // fmGetSlantAngle()
+    int isSleep;                    // fmGetIsSleep()
+    int64_t timestamp;              // sample time in microseconds (steady clock)
+    uint32_t sequence;              // incremented by the sampler for each snapshot
+};
+
+// current time in microseconds of the steady clock
+inline int64_t getTrackingTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// convert tracking time back to a steady clock time point
+inline std::chrono::steady_clock::time_point toTimePoint(int64_t trackingTime)
+{
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(trackingTime)));
+}
+
+// read all tracked values from FSCore at once
+TrackingPose sampleTrackingPose(uint32_t sequence = 0);
+
+// other FSCore calls, serialized with sampleTrackingPose()
+void setTrackingActiveUser();                       // fmSetActiveUser()
+void setTrackingVRMode(int flag);                   // fmSetflagVRMode(), 1: 3D, 0: 2D
+
+#endif
@@ -0,0 +1,205 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingRecorder.cpp
+// ====================
+// Records every TrackingPose into an append-only, memory-mapped binary file.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "TrackingRecorder.h"
+
+static_assert(sizeof(TrackingRecord) == 88, "TrackingRecord is a disk format");
+static_assert(sizeof(TrackingBlockHeader) == 64, "TrackingBlockHeader is a disk format");
+static_assert(sizeof(TrackingFileHeader) <= TRACKING_HEADER_SIZE, "TrackingFileHeader is too large");
+
+const int RECORDS_PER_BLOCK = (TRACKING_BLOCK_SIZE - (int)sizeof(TrackingBlockHeader)) / (int)sizeof(TrackingRecord);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TrackingPose <-> TrackingRecord
+///////////////////////////////////////////////////////////////////////////////
+void packTrackingRecord(const TrackingPose& pose, TrackingRecord& record)
+{
+    record.timestamp = pose.timestamp;
+    record.sequence = pose.sequence;
+    record.glassPosition[0] = pose.glassPosition.x;
+    record.glassPosition[1] = pose.glassPosition.y;
+    record.glassPosition[2] = pose.glassPosition.z;
+    record.glassRotation[0] = pose.glassRotation.x;
+    record.glassRotation[1] = pose.glassRotation.y;
+    record.glassRotation[2] = pose.glassRotation.z;
+    record.glassRotation[3] = pose.glassRotation.w;
+    record.penPosition[0] = pose.penPosition.x;
+    record.penPosition[1] = pose.penPosition.y;
+    record.penPosition[2] = pose.penPosition.z;
+    record.penDirection[0] = pose.penDirection.x;
+    record.penDirection[1] = pose.penDirection.y;
+    record.penDirection[2] = pose.penDirection.z;
+    record.penRoll = pose.penRoll;
+    record.slantAngle = pose.slantAngle;
+    record.penKey = pose.penKey;
+    record.glassStatus = pose.glassStatus;
+    record.penStatus = pose.penStatus;
+    record.isSleep = pose.isSleep;
+}
+
+void unpackTrackingRecord(const TrackingRecord& record, TrackingPose& pose)
+{
+    pose.timestamp = record.timestamp;
+    pose.sequence = record.sequence;
+    pose.glassPosition.x = record.glassPosition[0];
+    pose.glassPosition.y = record.glassPosition[1];
+    pose.glassPosition.z = record.glassPosition[2];
+    pose.glassRotation.x = record.glassRotation[0];
+    pose.glassRotation.y = record.glassRotation[1];
+    pose.glassRotation.z = record.glassRotation[2];
+    pose.glassRotation.w = record.glassRotation[3];
+    pose.penPosition.x = record.penPosition[0];
+    pose.penPosition.y = record.penPosition[1];
+    pose.penPosition.z = record.penPosition[2];
+    pose.penDirection.x = record.penDirection[0];
+    pose.penDirection.y = record.penDirection[1];
+    pose.penDirection.z = record.penDirection[2];
+    pose.penRoll = record.penRoll;
+    pose.slantAngle = record.slantAngle;
+    pose.penKey = record.penKey;
+    pose.glassStatus = record.glassStatus;
+    pose.penStatus = record.penStatus;
+    pose.isSleep = record.isSleep;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+TrackingRecorder::TrackingRecorder() : header(0), block(0), records(0)
+{
+}
+
+TrackingRecorder::~TrackingRecorder()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create the file with its header, blocks are added by append()
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingRecorder::open(const char* fileName)
+{
+    close();
+
+    if(!file.open(fileName, true))
+        return false;
+
+    if(!file.resize(TRACKING_HEADER_SIZE) ||
+       !(header = (TrackingFileHeader*)file.map(0, TRACKING_HEADER_SIZE)))
+    {
+        file.close();
+        return false;
+    }
+
+    memset(header, 0, sizeof(TrackingFileHeader));
+    header->magic = TRACKING_FILE_MAGIC;
+    header->version = TRACKING_FILE_VERSION;
+    header->headerSize = TRACKING_HEADER_SIZE;
+    header->blockSize = TRACKING_BLOCK_SIZE;
+    header->blockHeaderSize = sizeof(TrackingBlockHeader);
+    header->recordSize = sizeof(TrackingRecord);
+    header->recordsPerBlock = RECORDS_PER_BLOCK;
+    header->createTime = getTrackingTime();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap the views and close the file
+///////////////////////////////////////////////////////////////////////////////
+void TrackingRecorder::close()
+{
+    endBlock();
+    if(header)
+    {
+        file.unmap(header, TRACKING_HEADER_SIZE);
+        header = 0;
+    }
+    file.close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// write a record, then commit it in the block and file headers
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingRecorder::append(const TrackingPose& pose)
+{
+    if(!header)
+        return false;
+
+    if(header->recordCount > 0 && pose.timestamp < header->lastTimestamp)
+        return false;                               // keep timestamps sorted for seeking
+
+    if(!block || block->recordCount >= (uint32_t)RECORDS_PER_BLOCK)
+    {
+        endBlock();
+        if(!beginBlock())
+            return false;
+    }
+
+    packTrackingRecord(pose, records[block->recordCount]);
+
+    if(block->recordCount == 0)
+        block->firstTimestamp = pose.timestamp;
+    block->lastTimestamp = pose.timestamp;
+    ++block->recordCount;
+
+    if(header->recordCount == 0)
+        header->firstTimestamp = pose.timestamp;
+    header->lastTimestamp = pose.timestamp;
+    ++header->recordCount;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a block at the end of the file
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingRecorder::beginBlock()
+{
+    int64_t offset = TRACKING_HEADER_SIZE + header->blockCount * TRACKING_BLOCK_SIZE;
+    if(!file.resize(offset + TRACKING_BLOCK_SIZE))
+        return false;
+
+    void* view = file.map(offset, TRACKING_BLOCK_SIZE);
+    if(!view)
+        return false;
+
+    block = (TrackingBlockHeader*)view;
+    records = (TrackingRecord*)((char*)view + sizeof(TrackingBlockHeader));
+
+    block->magic = TRACKING_BLOCK_MAGIC;
+    block->recordCount = 0;
+    block->blockIndex = header->blockCount;
+    block->firstRecord = header->recordCount;
+    block->firstTimestamp = block->lastTimestamp = 0;
+
+    ++header->blockCount;
+    return true;
+}
+
+void TrackingRecorder::endBlock()
+{
+    if(block)
+    {
+        file.unmap(block, TRACKING_BLOCK_SIZE);
+        block = 0;
+        records = 0;
+    }
+}
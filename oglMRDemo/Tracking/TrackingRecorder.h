@@ -0,0 +1,124 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingRecorder.h
+// ==================
+// Records every TrackingPose into an append-only, memory-mapped binary file,
+// so production motion can be replayed later by TrackingReplay.
+//
+// file layout (little endian)
+// ===========
+// [TrackingFileHeader, padded to TRACKING_HEADER_SIZE]
+// [block 0][block 1]...[block n-1]
+//
+// Each block is TRACKING_BLOCK_SIZE bytes: a TrackingBlockHeader followed by
+// up to recordsPerBlock fixed-size TrackingRecord. The block header is the
+// index of its block: number of records, first record number and first/last
+// timestamp. Blocks are at fixed offsets, so a reader finds the block of a
+// time with a binary search over the block headers, then the record with a
+// binary search inside the block, O(log n) for any length of recording.
+//
+// Records are never rewritten. The record counts in the file and block
+// headers are updated after each record is written, so a file cut off by a
+// crash is still readable up to the last complete record.
+//
+// The file grows one block at a time; only the header and the current block
+// are mapped, so the memory used does not depend on the recording length.
+//
+// USAGE (one writer thread):
+//     TrackingRecorder recorder;
+//     recorder.open("trace.f3dt");
+//     recorder.append(pose);                  // every sample
+//     recorder.close();
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACKING_RECORDER_H
+#define TRACKING_RECORDER_H
+
+#include <cstdint>
+#include "TrackingPose.h"
+#include "../Common/MappedFile.h"
+
+const uint32_t TRACKING_FILE_MAGIC = 0x54443346;    // "F3DT"
+const uint32_t TRACKING_BLOCK_MAGIC = 0x4B4C4254;   // "TBLK"
+const uint32_t TRACKING_FILE_VERSION = 1;
+const int TRACKING_HEADER_SIZE = 65536;             // multiple of the view granularity of Windows
+const int TRACKING_BLOCK_SIZE = 262144;
+
+// one sample on disk, 88 bytes
+struct TrackingRecord
+{
+    int64_t timestamp;                  // microseconds of steady clock at recording
+    uint32_t sequence;
+    float glassPosition[3];
+    float glassRotation[4];             // x, y, z, w
+    float penPosition[3];
+    float penDirection[3];
+    float penRoll;
+    float slantAngle;
+    int32_t penKey;
+    int32_t glassStatus;
+    int32_t penStatus;
+    int32_t isSleep;
+};
+
+struct TrackingFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t blockSize;
+    uint32_t blockHeaderSize;
+    uint32_t recordSize;
+    uint32_t recordsPerBlock;
+    uint32_t reserved;
+    int64_t createTime;                 // steady clock at open(), microseconds
+    int64_t recordCount;                // complete records in the file
+    int64_t blockCount;
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+};
+
+struct TrackingBlockHeader
+{
+    uint32_t magic;
+    uint32_t recordCount;               // complete records in this block
+    int64_t blockIndex;
+    int64_t firstRecord;                // record number of the first record in this block
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+    uint8_t reserved[24];               // pad to 64 bytes, keep records 8-byte aligned
+};
+
+// conversion between TrackingPose and its disk record
+void packTrackingRecord(const TrackingPose& pose, TrackingRecord& record);
+void unpackTrackingRecord(const TrackingRecord& record, TrackingPose& pose);
+
+class TrackingRecorder
+{
+public:
+    TrackingRecorder();
+    ~TrackingRecorder();                            // close the file
+
+    bool open(const char* fileName);                // create or truncate
+    void close();
+    bool isOpen() const                             { return header != 0; }
+
+    // timestamps must not decrease, an older sample is dropped and returns false
+    bool append(const TrackingPose& pose);
+
+    int64_t getRecordCount() const                  { return header ? header->recordCount : 0; }
+    int64_t getFileSize() const                     { return file.getSize(); }
+
+private:
+    bool beginBlock();                              // grow the file by a block and map it
+    void endBlock();
+
+    MappedFile file;
+    TrackingFileHeader* header;                     // mapped view of the header
+    TrackingBlockHeader* block;                     // mapped view of the current block
+    TrackingRecord* records;                        // records of the current block
+};
+
+#endif
@@ -0,0 +1,281 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingReplay.cpp
+// ==================
+// Plays back a file written by TrackingRecorder.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "TrackingReplay.h"
+
+const int64_t NO_SEEK = INT64_MIN;
+const int64_t NO_CLOCK = INT64_MIN;
+const int MAX_CURSOR_STEPS = 32;                    // forward steps before falling back to findRecord()
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+TrackingReplay::TrackingReplay() : data(0), recordCount(0), blockCount(0), recordsPerBlock(0),
+                                   startTime(0), endTime(0), clock(NO_CLOCK), origin(0), clockSpeed(1),
+                                   cursor(-1), loop(false), speed(1), seekTime(NO_SEEK), position(0),
+                                   finished(false)
+{
+}
+
+TrackingReplay::~TrackingReplay()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the file and check its header
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingReplay::open(const char* fileName)
+{
+    close();
+
+    if(!file.open(fileName, false))
+        return false;
+
+    int64_t size = file.getSize();
+    const TrackingFileHeader* header = 0;
+    if(size >= TRACKING_HEADER_SIZE && (uint64_t)size <= SIZE_MAX)   // a 32-bit process cannot map larger files
+    {
+        data = (const char*)file.map(0, (size_t)size);
+        header = (const TrackingFileHeader*)data;
+    }
+
+    if(!header ||
+       header->magic != TRACKING_FILE_MAGIC ||
+       header->version != TRACKING_FILE_VERSION ||
+       header->headerSize != TRACKING_HEADER_SIZE ||
+       header->blockSize != TRACKING_BLOCK_SIZE ||
+       header->blockHeaderSize != sizeof(TrackingBlockHeader) ||
+       header->recordSize != sizeof(TrackingRecord) ||
+       header->recordsPerBlock == 0)
+    {
+        close();
+        return false;
+    }
+
+    // trust the committed count, but never read past the end of the file
+    recordsPerBlock = header->recordsPerBlock;
+    int64_t fileBlocks = (size - TRACKING_HEADER_SIZE) / TRACKING_BLOCK_SIZE;
+    recordCount = header->recordCount;
+    if(recordCount > fileBlocks * recordsPerBlock)
+        recordCount = fileBlocks * recordsPerBlock;
+    if(recordCount < 0)
+        recordCount = 0;
+    blockCount = (recordCount + recordsPerBlock - 1) / recordsPerBlock;
+
+    if(recordCount > 0)
+    {
+        startTime = getRecordPointer(0)->timestamp;
+        endTime = getRecordPointer(recordCount - 1)->timestamp;
+    }
+
+    clock = NO_CLOCK;
+    cursor = -1;
+    seekTime.store(NO_SEEK);
+    position.store(startTime);
+    finished.store(false);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap and close the file
+///////////////////////////////////////////////////////////////////////////////
+void TrackingReplay::close()
+{
+    if(data)
+    {
+        file.unmap((void*)data, (size_t)file.getSize());
+        data = 0;
+    }
+    file.close();
+    recordCount = blockCount = 0;
+    startTime = endTime = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// location of a record or a block header in the mapped file
+///////////////////////////////////////////////////////////////////////////////
+const TrackingRecord* TrackingReplay::getRecordPointer(int64_t index) const
+{
+    int64_t block = index / recordsPerBlock;
+    int64_t offset = TRACKING_HEADER_SIZE + block * TRACKING_BLOCK_SIZE + sizeof(TrackingBlockHeader) +
+                     (index - block * recordsPerBlock) * sizeof(TrackingRecord);
+    return (const TrackingRecord*)(data + offset);
+}
+
+const TrackingBlockHeader* TrackingReplay::getBlock(int64_t index) const
+{
+    return (const TrackingBlockHeader*)(data + TRACKING_HEADER_SIZE + index * TRACKING_BLOCK_SIZE);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy a record
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingReplay::getRecord(int64_t index, TrackingPose& pose) const
+{
+    if(index < 0 || index >= recordCount)
+        return false;
+
+    unpackTrackingRecord(*getRecordPointer(index), pose);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// index of the last record with timestamp <= time
+// The block headers form the index: find the last block starting at or before
+// time, then the record inside it. Both are binary searches.
+///////////////////////////////////////////////////////////////////////////////
+int64_t TrackingReplay::findRecord(int64_t time) const
+{
+    if(recordCount == 0 || time < startTime)
+        return -1;
+    if(time >= endTime)
+        return recordCount - 1;
+
+    int64_t low = 0;
+    int64_t high = blockCount - 1;
+    while(low < high)
+    {
+        int64_t middle = (low + high + 1) / 2;
+        if(getBlock(middle)->firstTimestamp <= time)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    // records [first, last) of the block, the last block may be partial
+    int64_t first = low * recordsPerBlock;
+    int64_t last = first + recordsPerBlock;
+    if(last > recordCount)
+        last = recordCount;
+
+    // first record with timestamp > time, the one before it is the answer
+    while(first < last)
+    {
+        int64_t middle = (first + last) / 2;
+        if(getRecordPointer(middle)->timestamp <= time)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first - 1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// playback controls, applied by the next sample()
+///////////////////////////////////////////////////////////////////////////////
+void TrackingReplay::setSpeed(double value)
+{
+    speed.store(value > 0 ? value : 0, std::memory_order_relaxed);
+}
+
+void TrackingReplay::seek(int64_t time)
+{
+    seekTime.store(time, std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// advance the playback clock to now and return the record at that time
+///////////////////////////////////////////////////////////////////////////////
+TrackingPose TrackingReplay::sample(uint32_t sequence, int64_t now)
+{
+    TrackingPose pose;
+    memset(&pose, 0, sizeof(pose));
+    pose.timestamp = now;
+    pose.sequence = sequence;
+    if(recordCount == 0)
+        return pose;
+
+    double currentSpeed = speed.load(std::memory_order_relaxed);
+    int64_t pendingSeek = seekTime.exchange(NO_SEEK, std::memory_order_relaxed);
+
+    if(clock == NO_CLOCK)
+    {
+        clock = now;
+        origin = startTime;
+        clockSpeed = currentSpeed;
+    }
+    if(pendingSeek != NO_SEEK)
+    {
+        origin = pendingSeek < startTime ? startTime : (pendingSeek > endTime ? endTime : pendingSeek);
+        clock = now;
+        cursor = -1;
+        finished.store(false, std::memory_order_relaxed);
+    }
+    if(currentSpeed != clockSpeed)
+    {
+        // restart the clock at the current position with the new speed
+        origin += (int64_t)((now - clock) * clockSpeed);
+        clock = now;
+        clockSpeed = currentSpeed;
+    }
+
+    int64_t time = origin + (int64_t)((now - clock) * clockSpeed);
+    bool looping = loop.load(std::memory_order_relaxed) && endTime > startTime;
+    if(time > endTime && looping)
+    {
+        origin = startTime + (time - startTime) % (endTime - startTime);
+        clock = now;
+        time = origin;
+        cursor = -1;
+    }
+    else if(time >= endTime && !looping)
+    {
+        time = endTime;
+        finished.store(true, std::memory_order_relaxed);
+    }
+
+    // playback moves forward by a few records per sample, step the cursor
+    // and only search when it jumped
+    if(cursor < 0 || getRecordPointer(cursor)->timestamp > time)
+    {
+        cursor = findRecord(time);
+    }
+    else
+    {
+        int steps = 0;
+        while(cursor + 1 < recordCount && getRecordPointer(cursor + 1)->timestamp <= time && steps < MAX_CURSOR_STEPS)
+        {
+            ++cursor;
+            ++steps;
+        }
+        if(steps == MAX_CURSOR_STEPS)
+            cursor = findRecord(time);
+    }
+    if(cursor < 0)
+        cursor = 0;
+    position.store(time, std::memory_order_relaxed);
+
+    unpackTrackingRecord(*getRecordPointer(cursor), pose);
+    pose.sequence = sequence;
+
+    // the recorded sample was taken (time - timestamp) of recorded time ago
+    if(clockSpeed > 0)
+        pose.timestamp = now - (int64_t)((time - pose.timestamp) / clockSpeed);
+    else
+        pose.timestamp = now;
+    return pose;
+}
@@ -0,0 +1,88 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingReplay.h
+// ================
+// Plays back a file written by TrackingRecorder. sample() returns the same
+// TrackingPose that sampleTrackingPose() reads from the fm*() functions, so
+// TrackingThread (and everything after it) runs unchanged on recorded motion.
+//
+// Playback follows a clock: it starts at the first sample() call from the
+// first record (or the time given to seek()), then the recorded time advances
+// by speed times the real time, speed 1 is the original speed, 4 is 4x faster
+// and 0 pauses. The returned timestamp is the recorded timestamp mapped onto the
+// live clock, so prediction and latency measurement see the motion as if it
+// happened now at the given speed.
+//
+// Random access is independent from playback:
+//     getRecord(i)     O(1)
+//     findRecord(t)    O(log n), binary search over block headers, then records
+//
+// The whole file is mapped read-only at open(). setSpeed(), seek() and
+// setLoop() may be called from any thread while another thread calls sample().
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACKING_REPLAY_H
+#define TRACKING_REPLAY_H
+
+#include <atomic>
+#include <cstdint>
+#include "TrackingRecorder.h"
+
+class TrackingReplay
+{
+public:
+    TrackingReplay();
+    ~TrackingReplay();                              // close the file
+
+    bool open(const char* fileName);
+    void close();
+    bool isOpen() const                             { return data != 0; }
+
+    int64_t getRecordCount() const                  { return recordCount; }
+    int64_t getStartTime() const                    { return startTime; }   // recorded time of the first record
+    int64_t getEndTime() const                      { return endTime; }
+    int64_t getDuration() const                     { return endTime - startTime; }
+
+    // random access, time is the recorded timestamp in microseconds
+    bool getRecord(int64_t index, TrackingPose& pose) const;
+    int64_t findRecord(int64_t time) const;         // last record at or before time, -1 if before the first
+
+    // playback
+    void setSpeed(double speed);                    // 1: original speed, 0: pause
+    double getSpeed() const                         { return speed.load(std::memory_order_relaxed); }
+    void seek(int64_t time);                        // jump to a recorded time, applied by the next sample()
+    void rewind()                                   { seek(startTime); }
+    void setLoop(bool flag)                         { loop.store(flag, std::memory_order_relaxed); }
+    bool isFinished() const                         { return finished.load(std::memory_order_relaxed); }
+    int64_t getPosition() const                     { return position.load(std::memory_order_relaxed); }   // recorded time
+
+    // pose recorded at the current playback time, call from one thread only
+    TrackingPose sample(uint32_t sequence, int64_t now = getTrackingTime());
+
+private:
+    const TrackingRecord* getRecordPointer(int64_t index) const;
+    const TrackingBlockHeader* getBlock(int64_t index) const;
+
+    MappedFile file;
+    const char* data;                               // whole file mapped
+    int64_t recordCount;
+    int64_t blockCount;
+    int recordsPerBlock;
+    int64_t startTime;
+    int64_t endTime;
+
+    // playback, the reader thread owns clock, origin and cursor
+    int64_t clock;                                  // live time when the playback was at origin
+    int64_t origin;                                 // recorded time at clock
+    double clockSpeed;                              // speed used since clock
+    int64_t cursor;                                 // record index of the last sample
+    std::atomic<bool> loop;
+    std::atomic<double> speed;
+    std::atomic<int64_t> seekTime;                  // pending seek, NO_SEEK if none
+    std::atomic<int64_t> position;
+    std::atomic<bool> finished;
+};
+
+#endif
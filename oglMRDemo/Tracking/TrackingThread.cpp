@@ -0,0 +1,208 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingThread.cpp
+// ==================
+// Dedicated thread that polls FSCore and publishes TrackingPose snapshots.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TrackingThread.h"
+#include "../Common/Trace.h"
+
+const int64_t ACTIVE_USER_INTERVAL = 2000000;       // fmSetActiveUser() every 2 s, FSCore needs < 5 s
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor / dtor
+///////////////////////////////////////////////////////////////////////////////
+TrackingThread::TrackingThread() : loopFlag(false), running(false), period(2000),
+                                   publishCount(0), activeUserCount(0), recorder(0), replay(0),
+                                   server(0), filterEnabled(false)
+{
+    for(int i = 0; i < OneEuroFilter::CHANNEL_COUNT; ++i)
+        filterLatency[i] = 0;
+}
+
+TrackingThread::~TrackingThread()
+{
+    stop();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// start polling FSCore at rate Hz
+// The first pose is sampled here before returning, so the reader never sees
+// an empty pose.
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingThread::start(double rate)
+{
+    if(running)
+        return true;
+
+    period = rate > 0 ? (int64_t)(1000000 / rate) : 0;
+
+    setTrackingActiveUser();
+    activeUserCount.fetch_add(1, std::memory_order_relaxed);
+    poses.write(samplePose(publishCount.fetch_add(1, std::memory_order_relaxed) + 1));
+
+    loopFlag = true;
+    thread = std::thread(&TrackingThread::run, this);
+    running = true;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// stop and join the thread
+///////////////////////////////////////////////////////////////////////////////
+void TrackingThread::stop()
+{
+    if(!running)
+        return;
+
+    loopFlag = false;
+    thread.join();
+    running = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// newest published pose
+///////////////////////////////////////////////////////////////////////////////
+bool TrackingThread::getPose(TrackingPose& pose)
+{
+    return poses.read(pose);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the recording, the replay and the server, the lock waits for a sample in progress
+///////////////////////////////////////////////////////////////////////////////
+void TrackingThread::setRecorder(TrackingRecorder* recorder)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    this->recorder = recorder;
+}
+
+void TrackingThread::setReplay(TrackingReplay* replay)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    this->replay = replay;
+}
+
+void TrackingThread::setServer(PoseServer* server)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    this->server = server;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// jitter filter settings, used from the next sample
+///////////////////////////////////////////////////////////////////////////////
+void TrackingThread::setFilterEnabled(bool flag)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    if(flag && !filterEnabled)
+        filter.reset();                             // do not blend with a stale pose
+    filterEnabled = flag;
+    if(!flag)
+    {
+        for(int i = 0; i < OneEuroFilter::CHANNEL_COUNT; ++i)
+            filterLatency[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TrackingThread::isFilterEnabled()
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    return filterEnabled;
+}
+
+void TrackingThread::setFilterParams(int channel, const OneEuroFilter::Params& params)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    filter.setParams(channel, params);
+}
+
+OneEuroFilter::Params TrackingThread::getFilterParams(int channel)
+{
+    std::lock_guard<std::mutex> lock(sourceLock);
+    return filter.getParams(channel);
+}
+
+float TrackingThread::getFilterLatency(int channel) const
+{
+    if(channel < 0 || channel >= OneEuroFilter::CHANNEL_COUNT)
+        return 0;
+    return filterLatency[channel].load(std::memory_order_relaxed);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// one pose from the replay or FSCore, appended to the recording if any and
+// compared with the previous pose for events, then filtered if enabled and
+// shared with other processes
+///////////////////////////////////////////////////////////////////////////////
+TrackingPose TrackingThread::samplePose(uint32_t sequence)
+{
+    TRACE_ZONE("TrackingThread::samplePose");
+    TRACE_FLOW_BEGIN("pose", sequence);             // to the frame that latches it
+    std::lock_guard<std::mutex> lock(sourceLock);
+    TrackingPose pose = replay ? replay->sample(sequence) : sampleTrackingPose(sequence);
+    if(recorder)
+        recorder->append(pose);
+    events.update(pose);
+
+    if(filterEnabled)
+    {
+        pose = filter.filter(pose);
+        for(int i = 0; i < OneEuroFilter::CHANNEL_COUNT; ++i)
+            filterLatency[i].store(filter.getLatency(i), std::memory_order_relaxed);
+    }
+    if(server)
+        server->publish(pose);
+    return pose;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// polling loop
+///////////////////////////////////////////////////////////////////////////////
+void TrackingThread::run()
+{
+    setTraceThreadName("tracking");
+    int64_t lastActiveUser = getTrackingTime();
+    int64_t next = getTrackingTime();
+
+    while(loopFlag)
+    {
+        int64_t now = getTrackingTime();
+        if(now - lastActiveUser >= ACTIVE_USER_INTERVAL)
+        {
+            setTrackingActiveUser();//标记活动用户
+            activeUserCount.fetch_add(1, std::memory_order_relaxed);
+            lastActiveUser = now;
+        }
+
+        uint32_t sequence = publishCount.load(std::memory_order_relaxed) + 1;
+        poses.write(samplePose(sequence));
+        publishCount.store(sequence, std::memory_order_relaxed);
+
+        // sleep to the next slot, skip slots if it is late
+        next += period;
+        now = getTrackingTime();
+        if(next < now)
+            next = now;
+        std::this_thread::sleep_until(toTimePoint(next));
+    }
+}
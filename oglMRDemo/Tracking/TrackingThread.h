@@ -0,0 +1,99 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TrackingThread.h
+// ================
+// Dedicated thread that polls FSCore and publishes TrackingPose snapshots.
+// The render thread no longer calls fm*() functions itself, it reads the
+// newest published pose with getPose(), which is wait-free (TripleBuffer).
+//
+// The thread also calls fmSetActiveUser() at the cadence FSCore requires
+// (at least once in 5 seconds) instead of once per rendered frame.
+//
+// With setRecorder() every polled pose is also appended to a recording. With
+// setReplay() the poses come from a recording instead of FSCore. Both may be
+// changed while the thread runs; the thread holds a lock while it uses them,
+// so the recorder/replay can be closed once the setter returned.
+//
+// Pen key and status changes of the polled poses are found on this thread and
+// queued as TrackingEvent for the UI and rendering threads (popEvent()).
+//
+// With setServer() the published poses also go to a shared-memory ring that
+// other processes read with PoseClient.
+//
+// With setFilterEnabled() the published poses are smoothed by a OneEuroFilter
+// on this thread; recording and events still see the raw poses. The lag the
+// filter adds is published for other threads (getFilterLatency()).
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACKING_THREAD_H
+#define TRACKING_THREAD_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "OneEuroFilter.h"
+#include "PoseServer.h"
+#include "TrackingEvents.h"
+#include "TrackingPose.h"
+#include "TrackingRecorder.h"
+#include "TrackingReplay.h"
+#include "TripleBuffer.h"
+
+class TrackingThread
+{
+public:
+    TrackingThread();
+    ~TrackingThread();                              // stop the thread if running
+
+    bool start(double rate = 500);                  // polling rate in Hz
+    void stop();
+    bool isRunning() const                          { return running; }
+
+    // reader side, call from one thread only (render thread)
+    // return true if the pose is newer than the previous call
+    bool getPose(TrackingPose& pose);
+
+    // pen key and status events, one thread per consumer (TrackingEvents::CONSUMER_*)
+    bool popEvent(int consumer, TrackingEvent& event) { return events.pop(consumer, event); }
+    int getDroppedEventCount() const                { return events.getDroppedCount(); }
+
+    // source and sink of the poses, NULL to stop recording or to poll FSCore again
+    void setRecorder(TrackingRecorder* recorder);
+    void setReplay(TrackingReplay* replay);
+    void setServer(PoseServer* server);             // NULL to stop sharing
+
+    // jitter filter of the published poses, any thread
+    void setFilterEnabled(bool flag);               // the filter restarts when enabled
+    bool isFilterEnabled();
+    void setFilterParams(int channel, const OneEuroFilter::Params& params);
+    OneEuroFilter::Params getFilterParams(int channel);
+    float getFilterLatency(int channel) const;      // second, 0 if disabled
+
+    // counters
+    uint32_t getPublishCount() const                { return publishCount.load(std::memory_order_relaxed); }
+    int getActiveUserCount() const                  { return activeUserCount.load(std::memory_order_relaxed); }
+
+private:
+    void run();                                     // thread function
+    TrackingPose samplePose(uint32_t sequence);     // from replay or FSCore, and record it
+
+    std::thread thread;
+    std::atomic<bool> loopFlag;
+    bool running;
+    int64_t period;                                 // polling period in microseconds
+    TripleBuffer<TrackingPose> poses;
+    TrackingEvents events;                          // written by this thread only
+    std::atomic<uint32_t> publishCount;
+    std::atomic<int> activeUserCount;               // number of fmSetActiveUser() calls
+    std::mutex sourceLock;                          // guards recorder, replay, server and filter
+    TrackingRecorder* recorder;
+    TrackingReplay* replay;
+    PoseServer* server;
+    OneEuroFilter filter;
+    bool filterEnabled;
+    std::atomic<float> filterLatency[OneEuroFilter::CHANNEL_COUNT];
+};
+
+#endif
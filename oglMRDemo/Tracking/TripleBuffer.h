@@ -0,0 +1,56 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// TripleBuffer.h
+// ==============
+// Lock-free triple buffer for one writer thread and one reader thread.
+// The writer fills its back buffer and publishes it by swapping it with the
+// middle buffer. The reader swaps its front buffer with the middle buffer only
+// when a new value was published. Both sides are wait-free (one atomic
+// exchange, no retry loop), the reader always gets a whole value written by
+// one publish() and never blocks the writer.
+//
+// CREATED: 2026-10-18
+// UPDATED: 2026-10-18
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+template <class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : buffers(), middle(1), back(0), front(2) {}
+
+    // writer side
+    T& getBack()                                    { return buffers[back]; }
+    void publish()
+    {
+        int prev = middle.exchange(back | FRESH_BIT, std::memory_order_acq_rel);
+        back = prev & INDEX_MASK;
+    }
+    void write(const T& value)                      { buffers[back] = value; publish(); }
+
+    // reader side, return true if a new value was published since the last update()
+    bool update()
+    {
+        if((middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+            return false;
+        int prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX_MASK;
+        return true;
+    }
+    const T& getFront() const                       { return buffers[front]; }
+    bool read(T& value)                             { bool fresh = update(); value = buffers[front]; return fresh; }
+
+private:
+    enum { INDEX_MASK = 3, FRESH_BIT = 4 };
+
+    T buffers[3];
+    std::atomic<int> middle;                        // index of middle buffer | FRESH_BIT
+    int back;                                       // owned by the writer
+    int front;                                      // owned by the reader
+};
+
+#endif
@@ -303,33 +303,29 @@ void ViewFormGL::updateMatrices()
 {
     const float* matrix;
     std::wstringstream wss;
+    wchar_t number[NUMBER_MAX_LENGTH];
     int i;
 
     // convert number to string with limited decimal points
-    wss << std::fixed << std::setprecision(2);
-
     matrix = model->getViewMatrixElements();
     for(i = 0; i < 16; ++i)
     {
-        wss.str(L"");
-        wss << matrix[i] << std::ends;
-        mv[i].setText(wss.str().c_str());
+        formatNumber(number, NUMBER_MAX_LENGTH, matrix[i], 2);
+        mv[i].setText(number);
     }
 
     matrix = model->getModelMatrixElements();
     for(i = 0; i < 16; ++i)
     {
-        wss.str(L"");
-        wss << matrix[i] << std::ends;
-        mm[i].setText(wss.str().c_str());
+        formatNumber(number, NUMBER_MAX_LENGTH, matrix[i], 2);
+        mm[i].setText(number);
     }
 
     matrix = model->getModelViewMatrixElements();
     for(i = 0; i < 16; ++i)
     {
-        wss.str(L"");
-        wss << matrix[i] << std::ends;
-        mmv[i].setText(wss.str().c_str());
+        formatNumber(number, NUMBER_MAX_LENGTH, matrix[i], 2);
+        mmv[i].setText(number);
     }
 
     // update OpenGL function calls
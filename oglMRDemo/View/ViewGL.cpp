@@ -9,6 +9,7 @@
 #include "../GL/wglext.h"             // for wgl extensions after glext.h
 #include "../GL/glExtension.h"
 #include "../Common/Log.h"
+#include "../Common/Trace.h"
 using namespace Win;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -331,8 +332,21 @@ int ViewGL::findPixelFormatWithAttributes(int colorBits, int depthBits, int sten
 ///////////////////////////////////////////////////////////////////////////////
 void ViewGL::swapBuffers()
 {
+    TRACE_ZONE("ViewGL::swapBuffers");
     ::SwapBuffers(hdc);
 }
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// set swap interval of the current RC (WGL_EXT_swap_control)
+///////////////////////////////////////////////////////////////////////////////
+bool ViewGL::setSwapInterval(int interval)
+{
+    if(!wglSwapIntervalEXT)
+        return false;
+    return wglSwapIntervalEXT(interval) == TRUE;
+}
+
+
+
@@ -16,6 +16,7 @@ namespace Win
         void closeContext(HWND handle);
         void activateContext();
         void swapBuffers();
+        bool setSwapInterval(int interval);         // 1: vsync on, 0: off. return false if not supported
 
         HDC getDC() const { return hdc; };
         HGLRC getRC() const { return hglrc; };
@@ -4,6 +4,8 @@
 #include "stdafx.h"
 #include "oglMRDemo.h"
 #include "./Common/Log.h"
+#include "./Common/Trace.h"
+#include "./Common/wcharUtil.h"
 #include <windows.h>
 #include <commctrl.h>                   // common controls
 #include "./Base/Window.h"
@@ -20,6 +22,8 @@
 // 函数声明: 
 int mainMessageLoop(HACCEL hAccelTable = 0);
 
+const char* TRACE_FILE = "trace.json";
+
 
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
@@ -37,9 +41,21 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     DWORD style;
     DWORD styleEx;
 
-    Win::Log::getInstance().setMode(Win::LOG_MODE_BOTH);
+    // -binarylog: unformatted log.bin for the LogDecode tool instead of the dialog
+    if (lpCmdLine && wcsstr(lpCmdLine, L"-binarylog"))
+        Win::Log::getInstance().setMode(Win::LOG_MODE_BINARY);
+    else
+        Win::Log::getInstance().setMode(Win::LOG_MODE_BOTH);
     Win::log("Start!");
 
+    // -trace: frame timeline of the whole run to trace.json (chrome://tracing, ui.perfetto.dev)
+    bool tracing = lpCmdLine && wcsstr(lpCmdLine, L"-trace") != 0;
+    if (tracing)
+    {
+        setTraceThreadName("UI");
+        startTrace();
+    }
+
     // create model and view components for controller
     ModelGL modelGL;
     Win::ViewGL viewGL;
@@ -64,6 +80,105 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
     //创建OpenGL渲染窗口glWin，把它作为mainWin窗口的子窗口
     Win::ControllerGL glCtrl(&modelGL, &viewGL);
+
+    // -fps N: fixed frame rate of N Hz, -uncapped: no pacing (benchmark), vsync otherwise
+    // set before glWin.create(), which starts the rendering thread
+    const wchar_t* fpsArg = lpCmdLine ? wcsstr(lpCmdLine, L"-fps ") : 0;
+    double fps = fpsArg ? _wtof(fpsArg + 5) : 0;
+    if (fps > 0)
+    {
+        glCtrl.setFrameMode(FrameScheduler::MODE_FIXED_RATE, fps);
+        Win::log("Frame mode: fixed rate %g Hz", fps);
+    }
+    else if (lpCmdLine && wcsstr(lpCmdLine, L"-uncapped"))
+    {
+        glCtrl.setFrameMode(FrameScheduler::MODE_UNCAPPED);
+        Win::log("Frame mode: uncapped");
+    }
+
+    // -reproject: a missed VR frame is replaced by the last frame warped to the newest pose
+    if (lpCmdLine && wcsstr(lpCmdLine, L"-reproject"))
+    {
+        modelGL.setReprojection(true);
+        Win::log("Reprojection of missed VR frames is on.");
+    }
+
+    // -predict kalman|des: extrapolate the pose to the display time, ControllerGL sets the look-ahead
+    const wchar_t* predictArg = lpCmdLine ? wcsstr(lpCmdLine, L"-predict ") : 0;
+    if (predictArg && wcsncmp(predictArg + 9, L"kalman", 6) == 0)
+    {
+        modelGL.setPosePrediction(PosePredictor::METHOD_KALMAN);
+        Win::log("Pose prediction: Kalman filter");
+    }
+    else if (predictArg && wcsncmp(predictArg + 9, L"des", 3) == 0)
+    {
+        modelGL.setPosePrediction(PosePredictor::METHOD_DOUBLE_EXPONENTIAL);
+        Win::log("Pose prediction: double exponential smoothing");
+    }
+
+    // -filter [minCutoff beta]: One-Euro filter of the tracking poses, the values are for the
+    // positions (Hz, Hz per m/s), the rotations keep their defaults; F toggles it at runtime
+    const wchar_t* filterArg = lpCmdLine ? wcsstr(lpCmdLine, L"-filter") : 0;
+    if (filterArg)
+    {
+        float minCutoff, beta;
+        if (swscanf(filterArg + 7, L"%f %f", &minCutoff, &beta) == 2)
+        {
+            OneEuroFilter::Params params = modelGL.getPoseFilterParams(OneEuroFilter::CHANNEL_GLASS_POSITION);
+            modelGL.setPoseFilterParams(OneEuroFilter::CHANNEL_GLASS_POSITION, minCutoff, beta, params.derivativeCutoff);
+            modelGL.setPoseFilterParams(OneEuroFilter::CHANNEL_PEN_POSITION, minCutoff, beta, params.derivativeCutoff);
+        }
+        modelGL.setPoseFilter(true);
+        OneEuroFilter::Params params = modelGL.getPoseFilterParams(OneEuroFilter::CHANNEL_GLASS_POSITION);
+        Win::log("Pose filter is on: cutoff at rest %g Hz, beta %g", params.minCutoff, params.beta);
+    }
+
+    // -record file: every tracking pose to file (oglMRCheck -predict, -replay)
+    // -replay file [speed]: tracking poses from a recording instead of FSCore, speed 1 by default
+    wchar_t poseFile[MAX_PATH];
+    const wchar_t* recordArg = lpCmdLine ? wcsstr(lpCmdLine, L"-record ") : 0;
+    if (recordArg && swscanf(recordArg + 8, L"%259ls", poseFile) == 1)
+    {
+        const char* fileName = toChar(poseFile);
+        if (modelGL.startRecording(fileName))
+            Win::log("Tracking poses are recorded to %s.", fileName);
+        else
+            Win::log("[ERROR] Failed to create %s.", fileName);
+    }
+    const wchar_t* replayArg = lpCmdLine ? wcsstr(lpCmdLine, L"-replay ") : 0;
+    double replaySpeed = 1;
+    if (replayArg && swscanf(replayArg + 8, L"%259ls %lf", poseFile, &replaySpeed) >= 1)
+    {
+        const char* fileName = toChar(poseFile);
+        if (modelGL.startReplay(fileName, replaySpeed))
+            Win::log("Tracking poses are replayed from %s at %gx speed.", fileName, replaySpeed);
+        else
+            Win::log("[ERROR] Failed to open %s.", fileName);
+    }
+
+    // -viewers K: VR mode draws K viewers, each in its own region of the window; viewer n
+    // is read from the pose ring fmTrackingPoses<n> and is a spectator beside viewer 0 without it
+    const wchar_t* viewersArg = lpCmdLine ? wcsstr(lpCmdLine, L"-viewers ") : 0;
+    int viewerCount;
+    if (viewersArg && swscanf(viewersArg + 9, L"%d", &viewerCount) == 1)
+    {
+        if (viewerCount < 1)
+            viewerCount = 1;
+        else if (viewerCount > MultiViewPlanner::MAX_VIEWERS)
+            viewerCount = MultiViewPlanner::MAX_VIEWERS;
+        modelGL.setViewerCount(viewerCount);
+        Win::log("Viewers in VR mode: %d", viewerCount);
+    }
+
+    // -poseserver: share the tracking poses with other processes (PoseClient)
+    if (lpCmdLine && wcsstr(lpCmdLine, L"-poseserver"))
+    {
+        if (modelGL.startPoseServer())
+            Win::log("Tracking poses are shared as %s.", POSE_SHM_NAME);
+        else
+            Win::log("[WARNING] Tracking poses are not shared, another instance already does.");
+    }
+
     Win::Window glWin(hInstance, L"WindowGL", mainWin.getHandle(), &glCtrl);
     glWin.setClassStyle(CS_OWNDC);
     glWin.setWindowStyle(WS_CHILD | WS_CLIPSIBLINGS | WS_CLIPCHILDREN);
@@ -132,6 +247,15 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     //hAccelTable = ::LoadAccelerators(hInst, MAKEINTRESOURCE(ID_ACCEL));
     exitCode = mainMessageLoop(hAccelTable);
 
+    if (tracing)
+    {
+        int events, dropped;
+        if (stopTrace(TRACE_FILE, &events, &dropped))
+            Win::log("Trace is written to %s: %d events, %d dropped.", TRACE_FILE, events, dropped);
+        else
+            Win::log("[ERROR] Failed to write the trace to %s.", TRACE_FILE);
+    }
+
     Win::log("Application is terminated.");
     return exitCode;
 }